@@ -19,6 +19,9 @@
 #include <stdint.h>
 #include <avr/io.h>
 #include "adc.h"
+#if ADC_WITH_POWER_MANAGER
+#include <drivers/power.h>
+#endif
 
 //*****************************************************************************
 //*************************** DEFINES AND MACROS ******************************
@@ -259,6 +262,22 @@ void ADC_SetClockPrescaler(ADC_ClockPrescalerT clkPs)
 */
 void ADC_SetHardwareEnable(ADC_EnableDisableT mode)
 {
+#if ADC_WITH_POWER_MANAGER
+    // the ADC must be disabled before its clock is gated:
+    if(mode == ADC_DISABLE)
+    {
+        if (ADCSRA & (1 << ADEN))
+        {
+            ADCSRA &= ~(1 << ADEN);
+            (void) POWER_Release(POWER_Adc);
+        }
+    }
+    else if (!(ADCSRA & (1 << ADEN)))
+    {
+        (void) POWER_Acquire(POWER_Adc);
+        ADCSRA |= (1 << ADEN);
+    }
+#else
     if(mode == ADC_DISABLE)
     {
         ADCSRA &= ~(1 << ADEN);
@@ -267,6 +286,7 @@ void ADC_SetHardwareEnable(ADC_EnableDisableT mode)
     {
         ADCSRA |= (1 << ADEN);
     }
+#endif // ADC_WITH_POWER_MANAGER
     return;
 }
 
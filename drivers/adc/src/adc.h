@@ -25,6 +25,10 @@
 //*************************** DEFINES AND MACROS ******************************
 //*****************************************************************************
 
+//! Switch to acquire the ADC clock from the POWER manager (PRR).
+#ifndef ADC_WITH_POWER_MANAGER
+#define ADC_WITH_POWER_MANAGER  0
+#endif
 
 //*****************************************************************************
 //******************************** DATA TYPES *********************************
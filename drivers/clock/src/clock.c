@@ -0,0 +1,201 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   Runtime scaling of the system clock by means of CLKPR.
+**
+**          The system clock can be divided by 2^clockShift at runtime, e.g.,
+**          in order to idle at a low clock and to run at full speed only
+**          while bursts of work are processed. Drivers that derive their
+**          timing from the system clock register as listeners and are
+**          re-timed right after the clock has been changed:
+**
+**          - TIMER_ClockChanged() keeps the stopwatch and countdowns in
+**            units of undivided F_CPU cycles. Hence, the RUNLOOP task
+**            periods and the uptime stay correct, since the RUNLOOP derives
+**            them from the TIMER stopwatch.
+**          - UART_ClockChanged() recomputes the baud rate registers.
+**
+**          F_CPU always denotes the undivided clock frequency. SPI and TWI
+**          bus clocks simply scale with the system clock. The SOFTUART and
+**          SOFTPWM drivers are not re-timed and must be stopped while the
+**          clock is divided.
+**
+** \attention
+**          Characters that are being shifted in or out by the UART while
+**          the clock is changed are corrupted. Flush the UART before.
+**          If the CKDIV8 fuse is programmed, call CLOCK_SetShift() before
+**          any other driver is initialized.
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <avr/io.h>
+#include <avr/power.h>
+#include <drivers/irq.h>
+#include "clock.h"
+
+//*****************************************************************************
+//**************************** LOCAL DATA TYPES *******************************
+//*****************************************************************************
+
+//! Listener slot.
+typedef struct
+{
+    CLOCK_ListenerT listenerPtr; //!< NULL if the slot is free
+    void*           optArgPtr;
+} clockListenerT;
+
+//*****************************************************************************
+//**************************** LOCAL VARIABLES ********************************
+//*****************************************************************************
+
+//! Internal state of the clock manager.
+static struct
+{
+    clockListenerT listenerArr[CLOCK_MAX_LISTENERS];
+    uint8_t        clockShift;
+} clockState;
+
+//*****************************************************************************
+//*************************** PUBLIC FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   Register a listener that is notified on clock changes.
+**
+** \param   listenerPtr The listener.
+** \param   optArgPtr   Optional argument that is passed to the listener.
+**
+** \return
+**          - #CLOCK_OK on success.
+**          - #CLOCK_ERR_BAD_PARAMETER if listenerPtr is NULL.
+**          - #CLOCK_ERR_NO_LISTENER_SLOT if all slots are in use.
+**
+*******************************************************************************
+*/
+uint8_t CLOCK_AddListener (CLOCK_ListenerT listenerPtr, void* optArgPtr)
+{
+    uint8_t ii;
+
+    if (listenerPtr == NULL)
+    {
+        return (CLOCK_ERR_BAD_PARAMETER);
+    }
+    for (ii = 0; ii < CLOCK_MAX_LISTENERS; ii++)
+    {
+        if (clockState.listenerArr[ii].listenerPtr == NULL)
+        {
+            clockState.listenerArr[ii].optArgPtr   = optArgPtr;
+            clockState.listenerArr[ii].listenerPtr = listenerPtr;
+            return (CLOCK_OK);
+        }
+    }
+    return (CLOCK_ERR_NO_LISTENER_SLOT);
+}
+
+/*!
+*******************************************************************************
+** \brief   Unregister a listener.
+**
+** \param   listenerPtr The listener.
+** \param   optArgPtr   The argument that has been passed on registration.
+**
+** \return
+**          - #CLOCK_OK on success.
+**          - #CLOCK_ERR_LISTENER_NOT_FOUND if the listener is not registered.
+**
+*******************************************************************************
+*/
+uint8_t CLOCK_RemoveListener (CLOCK_ListenerT listenerPtr, void* optArgPtr)
+{
+    uint8_t ii;
+
+    for (ii = 0; ii < CLOCK_MAX_LISTENERS; ii++)
+    {
+        if ((clockState.listenerArr[ii].listenerPtr == listenerPtr)
+        &&  (clockState.listenerArr[ii].optArgPtr == optArgPtr))
+        {
+            clockState.listenerArr[ii].listenerPtr = NULL;
+            clockState.listenerArr[ii].optArgPtr   = NULL;
+            return (CLOCK_OK);
+        }
+    }
+    return (CLOCK_ERR_LISTENER_NOT_FOUND);
+}
+
+/*!
+*******************************************************************************
+** \brief   Divide the system clock by 2^clockShift and notify all listeners.
+**
+**          The clock change and the notification of the listeners form one
+**          critical section, so interrupt handlers never run with settings
+**          that do not match the current clock.
+**
+** \param   clockShift  0 ... #CLOCK_MAX_SHIFT, 0 selects the full F_CPU.
+**
+** \return
+**          - #CLOCK_OK on success.
+**          - #CLOCK_ERR_BAD_PARAMETER if clockShift is out of range.
+**
+*******************************************************************************
+*/
+uint8_t CLOCK_SetShift (uint8_t clockShift)
+{
+    clockListenerT* listener_ptr;
+    uint8_t         ii;
+
+    if (clockShift > CLOCK_MAX_SHIFT)
+    {
+        return (CLOCK_ERR_BAD_PARAMETER);
+    }
+
+    IRQ_GLOBAL_BLOCK(CLOCK_IRQ_SITE)
+    {
+        // timed sequence, the divisor must be written within 4 cycles:
+        clock_prescale_set((clock_div_t)clockShift);
+        clockState.clockShift = clockShift;
+        for (ii = 0; ii < CLOCK_MAX_LISTENERS; ii++)
+        {
+            listener_ptr = &clockState.listenerArr[ii];
+            if (listener_ptr->listenerPtr)
+            {
+                listener_ptr->listenerPtr(listener_ptr->optArgPtr, clockShift);
+            }
+        }
+    }
+    return (CLOCK_OK);
+}
+
+/*!
+*******************************************************************************
+** \brief   Get the current clock shift.
+**
+** \return  The system clock is F_CPU / 2^(return value).
+**
+*******************************************************************************
+*/
+uint8_t CLOCK_GetShift (void)
+{
+    return (clockState.clockShift);
+}
+
+/*!
+*******************************************************************************
+** \brief   Get the current system clock frequency in Hz.
+**
+*******************************************************************************
+*/
+uint32_t CLOCK_GetFrequency (void)
+{
+    return ((uint32_t)(F_CPU) >> clockState.clockShift);
+}
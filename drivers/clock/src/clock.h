@@ -0,0 +1,88 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   Runtime scaling of the system clock by means of CLKPR
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#ifndef CLOCK_H
+#define CLOCK_H
+
+#include <stdint.h>
+
+//*****************************************************************************
+//*************************** DEFINES AND MACROS ******************************
+//*****************************************************************************
+
+//! Undivided CPU frequency, i.e., at clock shift 0.
+#ifndef F_CPU
+#define F_CPU                           18432000
+#endif
+
+//! Number of listeners that are notified on clock changes.
+#ifndef CLOCK_MAX_LISTENERS
+#define CLOCK_MAX_LISTENERS             4
+#endif
+
+//! The system clock can be divided by up to 2^CLOCK_MAX_SHIFT.
+#define CLOCK_MAX_SHIFT                 8
+
+//! Critical section site of the driver, see IRQ_PROFILING.
+#ifndef CLOCK_IRQ_SITE
+#define CLOCK_IRQ_SITE                  (IRQ_SITE_BASE_DRIVER + 11)
+#endif
+
+//*****************************************************************************
+//************************* CLOCK SPECIFIC ERROR CODES ************************
+//*****************************************************************************
+
+/*! CLOCK specific error base */
+#ifndef CLOCK_ERR_BASE
+#define CLOCK_ERR_BASE                  180
+#endif
+
+/*! CLOCK returns with no errors. */
+#define CLOCK_OK                        0
+
+/*! A bad parameter has been passed. */
+#define CLOCK_ERR_BAD_PARAMETER         CLOCK_ERR_BASE + 0
+
+/*! There is no listener slot free. */
+#define CLOCK_ERR_NO_LISTENER_SLOT      CLOCK_ERR_BASE + 1
+
+/*! The listener has not been found. */
+#define CLOCK_ERR_LISTENER_NOT_FOUND    CLOCK_ERR_BASE + 2
+
+//*****************************************************************************
+//******************************** DATA TYPES *********************************
+//*****************************************************************************
+
+/*! Listener that is notified after the system clock has been changed.
+**  Listeners are executed with interrupts disabled and must be short.
+**  TIMER_ClockChanged() and UART_ClockChanged() match this type.
+**
+**  \param  optArgPtr   The argument that has been passed to
+**                      CLOCK_AddListener().
+**  \param  clockShift  The system clock is F_CPU / 2^clockShift now.
+*/
+typedef void (*CLOCK_ListenerT) (void* optArgPtr, uint8_t clockShift);
+
+//*****************************************************************************
+//************************* FUNCTION DECLARATIONS *****************************
+//*****************************************************************************
+
+uint8_t  CLOCK_AddListener (CLOCK_ListenerT listenerPtr, void* optArgPtr);
+uint8_t  CLOCK_RemoveListener (CLOCK_ListenerT listenerPtr, void* optArgPtr);
+uint8_t  CLOCK_SetShift (uint8_t clockShift);
+uint8_t  CLOCK_GetShift (void);
+uint32_t CLOCK_GetFrequency (void);
+
+#endif // CLOCK_H
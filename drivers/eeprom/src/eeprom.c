@@ -0,0 +1,350 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   Non-blocking EEPROM driver.
+**
+**          EEPROM_Write() copies the data into a write queue and returns
+**          immediately. The bytes are then programmed one after another
+**          from within the EE_READY interrupt. Each byte is compared to the
+**          current EEPROM content first: unchanged bytes are skipped, and
+**          erase-only or write-only programming is used where possible,
+**          which halves the programming time and reduces wear.
+**
+**          EEPROM_Read() returns the data as it will be after all queued
+**          writes have been programmed. It may have to wait for the byte
+**          that is currently being programmed (at most 3.4 ms).
+**
+** \attention
+**          The functions of this driver must not be called from within ISRs.
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <drivers/irq.h>
+#include "eeprom.h"
+
+//*****************************************************************************
+//*************************** DEFINES AND MACROS ******************************
+//*****************************************************************************
+
+//! Last valid EEPROM address.
+#define EEPROM_LAST_ADDRESS     E2END
+
+//! Critical section, which keeps the EE_READY interrupt from interfering:
+#define EEPROM_ENTER_CS         IRQ_EnterMask(EEPROM_IRQ_SITE, &EECR, \
+                                              (1 << EERIE))
+#define EEPROM_LEAVE_CS         IRQ_LeaveMask(EEPROM_IRQ_SITE, &EECR, \
+                                    eepromState.dataUsed ? (1 << EERIE) : 0)
+
+//*****************************************************************************
+//**************************** LOCAL DATA TYPES *******************************
+//*****************************************************************************
+
+//! A queued write request of count bytes starting at address.
+typedef struct
+{
+    uint16_t address;
+    uint8_t  count;
+} eepromRequestT;
+
+//*****************************************************************************
+//**************************** LOCAL VARIABLES ********************************
+//*****************************************************************************
+
+//! Internal state of the EEPROM driver.
+static struct
+{
+    uint8_t        dataArr[EEPROM_QUEUE_LENGTH];    //!< queued data bytes
+    eepromRequestT requestArr[EEPROM_REQUEST_COUNT]; //!< queued requests
+    uint8_t        dataReadPos;     //!< index of the next data byte
+    uint8_t        dataUsed;        //!< number of queued data bytes
+    uint8_t        requestReadPos;  //!< index of the head request
+    uint8_t        requestUsed;     //!< number of queued requests
+} eepromState;
+
+//*****************************************************************************
+//********************** LOCAL FUNCTION DECLARATIONS **************************
+//*****************************************************************************
+
+static inline uint8_t eepromReadByte (uint16_t address);
+
+//*****************************************************************************
+//**************************** LOCAL FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   Reads a byte from the EEPROM. No write may be in progress.
+**
+*******************************************************************************
+*/
+static inline uint8_t eepromReadByte (uint16_t address)
+{
+    EEAR = address;
+    EECR |= (1 << EERE);
+    return (EEDR);
+}
+
+//*****************************************************************************
+//*************************** PUBLIC FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   Queues data for writing to the EEPROM.
+**
+**          Either all bytes are queued or none.
+**
+** \param   address     EEPROM address of the first byte.
+** \param   dataPtr     The data to write. It is copied into the queue.
+** \param   count       The number of bytes to write.
+**
+** \return
+**          - #EEPROM_OK on success.
+**          - #EEPROM_ERR_BAD_PARAMETER if the range exceeds the EEPROM.
+**          - #EEPROM_ERR_TOO_LARGE if count exceeds EEPROM_QUEUE_LENGTH.
+**          - #EEPROM_ERR_QUEUE_FULL if there is not enough space in the queue.
+**
+*******************************************************************************
+*/
+uint8_t EEPROM_Write (uint16_t address, const uint8_t* dataPtr, uint8_t count)
+{
+    eepromRequestT* request_ptr;
+    uint8_t         write_pos;
+    uint8_t         ii;
+
+    if ((dataPtr == NULL) || (count == 0)
+    ||  ((uint32_t)address + count - 1 > EEPROM_LAST_ADDRESS))
+    {
+        return (EEPROM_ERR_BAD_PARAMETER);
+    }
+    if (count > EEPROM_QUEUE_LENGTH)
+    {
+        return (EEPROM_ERR_TOO_LARGE);
+    }
+
+    ////////////////
+    (void)EEPROM_ENTER_CS;
+    ////////////////
+
+    if (((uint16_t)eepromState.dataUsed + count > EEPROM_QUEUE_LENGTH)
+    ||  (eepromState.requestUsed >= EEPROM_REQUEST_COUNT))
+    {
+        EEPROM_LEAVE_CS;
+        return (EEPROM_ERR_QUEUE_FULL);
+    }
+
+    write_pos = (eepromState.dataReadPos + eepromState.dataUsed)
+              % EEPROM_QUEUE_LENGTH;
+    for (ii = 0; ii < count; ii++)
+    {
+        eepromState.dataArr[write_pos] = dataPtr[ii];
+        write_pos = (write_pos + 1) % EEPROM_QUEUE_LENGTH;
+    }
+    eepromState.dataUsed += count;
+
+    request_ptr = &eepromState.requestArr[(eepromState.requestReadPos
+                                           + eepromState.requestUsed)
+                                          % EEPROM_REQUEST_COUNT];
+    request_ptr->address = address;
+    request_ptr->count   = count;
+    eepromState.requestUsed++;
+
+    ////////////////
+    EEPROM_LEAVE_CS; // enables the EE_READY interrupt
+    ////////////////
+
+    return (EEPROM_OK);
+}
+
+/*!
+*******************************************************************************
+** \brief   Reads data from the EEPROM, including queued writes.
+**
+**          If a byte is currently being programmed, the function waits
+**          for its completion, which takes at most 3.4 ms according to
+**          the data sheet.
+**
+** \param   address     EEPROM address of the first byte.
+** \param   dataPtr     Destination of the data.
+** \param   count       The number of bytes to read.
+**
+** \return
+**          - #EEPROM_OK on success.
+**          - #EEPROM_ERR_BAD_PARAMETER if the range exceeds the EEPROM.
+**
+*******************************************************************************
+*/
+uint8_t EEPROM_Read (uint16_t address, uint8_t* dataPtr, uint8_t count)
+{
+    eepromRequestT* request_ptr;
+    uint16_t        req_address;
+    uint8_t         data_pos;
+    uint8_t         req_idx;
+    uint8_t         ii, jj;
+
+    if ((dataPtr == NULL) || (count == 0)
+    ||  ((uint32_t)address + count - 1 > EEPROM_LAST_ADDRESS))
+    {
+        return (EEPROM_ERR_BAD_PARAMETER);
+    }
+
+    ////////////////
+    (void)EEPROM_ENTER_CS;
+    ////////////////
+
+    // wait for the byte that is currently being programmed, EEPE is
+    // cleared by the hardware within the programming time (<= 3.4 ms):
+    while (EECR & (1 << EEPE));
+
+    for (ii = 0; ii < count; ii++)
+    {
+        dataPtr[ii] = eepromReadByte(address + ii);
+    }
+
+    // overlay queued data, later requests take precedence:
+    data_pos = eepromState.dataReadPos;
+    req_idx  = eepromState.requestReadPos;
+    for (ii = 0; ii < eepromState.requestUsed; ii++)
+    {
+        request_ptr = &eepromState.requestArr[req_idx];
+        req_address = request_ptr->address;
+        for (jj = 0; jj < request_ptr->count; jj++)
+        {
+            if ((req_address >= address) && (req_address - address < count))
+            {
+                dataPtr[req_address - address] = eepromState.dataArr[data_pos];
+            }
+            req_address++;
+            data_pos = (data_pos + 1) % EEPROM_QUEUE_LENGTH;
+        }
+        req_idx = (req_idx + 1) % EEPROM_REQUEST_COUNT;
+    }
+
+    ////////////////
+    EEPROM_LEAVE_CS;
+    ////////////////
+
+    return (EEPROM_OK);
+}
+
+/*!
+*******************************************************************************
+** \brief   Tests whether queued data is still being written.
+**
+** \return  1 if the driver is busy, 0 otherwise.
+**
+*******************************************************************************
+*/
+uint8_t EEPROM_IsBusy (void)
+{
+    return ((eepromState.dataUsed || (EECR & (1 << EEPE))) ? 1 : 0);
+}
+
+/*!
+*******************************************************************************
+** \brief   Get the number of bytes that can be queued.
+**
+** \return  The free size of the write queue in bytes. Returns 0 if no
+**          write request slot is available.
+**
+*******************************************************************************
+*/
+uint8_t EEPROM_GetFreeSize (void)
+{
+    if (eepromState.requestUsed >= EEPROM_REQUEST_COUNT)
+    {
+        return (0);
+    }
+    return (EEPROM_QUEUE_LENGTH - eepromState.dataUsed);
+}
+
+/*!
+*******************************************************************************
+** \brief   Waits until all queued data has been written to the EEPROM.
+**
+**          Interrupts must be enabled. This function blocks for up to
+**          3.4 ms per queued byte and should not be used in time critical
+**          code, e.g., before entering a sleep mode or before a reset.
+**
+*******************************************************************************
+*/
+void EEPROM_Flush (void)
+{
+    while (EEPROM_IsBusy());
+    return;
+}
+
+//*****************************************************************************
+//*********************** INTERRUPT SERVICE ROUTINES **************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   ISR for EEPROM ready.
+**
+**          Starts programming the next queued byte that differs from the
+**          EEPROM content. Disables itself when the queue is empty.
+**
+*******************************************************************************
+*/
+ISR (EE_READY_vect, ISR_BLOCK)
+{
+    eepromRequestT* request_ptr;
+    uint16_t        address;
+    uint8_t         old_byte;
+    uint8_t         new_byte;
+    uint8_t         mode;
+
+    while (eepromState.dataUsed)
+    {
+        request_ptr = &eepromState.requestArr[eepromState.requestReadPos];
+        address  = request_ptr->address;
+        new_byte = eepromState.dataArr[eepromState.dataReadPos];
+
+        eepromState.dataReadPos = (eepromState.dataReadPos + 1)
+                                % EEPROM_QUEUE_LENGTH;
+        eepromState.dataUsed--;
+        request_ptr->address++;
+        if (--request_ptr->count == 0)
+        {
+            eepromState.requestReadPos = (eepromState.requestReadPos + 1)
+                                       % EEPROM_REQUEST_COUNT;
+            eepromState.requestUsed--;
+        }
+
+        old_byte = eepromReadByte(address);
+        if (old_byte == new_byte)
+        {
+            continue;
+        }
+        if ((old_byte & new_byte) == new_byte)
+        {
+            mode = (1 << EEPM1); // write only, clears bits
+        }
+        else if (new_byte == 0xFF)
+        {
+            mode = (1 << EEPM0); // erase only
+        }
+        else
+        {
+            mode = 0;            // erase and write
+        }
+        EEDR = new_byte;
+        EECR = mode | (1 << EERIE) | (1 << EEMPE);
+        EECR |= (1 << EEPE);
+        return;
+    }
+    EECR &= ~(1 << EERIE);
+}
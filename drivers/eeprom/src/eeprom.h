@@ -0,0 +1,78 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   EEPROM driver declarations
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#ifndef EEPROM_H
+#define EEPROM_H
+
+#include <stdint.h>
+
+//*****************************************************************************
+//*************************** DEFINES AND MACROS ******************************
+//*****************************************************************************
+
+//! Number of data bytes that can be queued for writing, must be in [1 ... 255].
+#ifndef EEPROM_QUEUE_LENGTH
+#define EEPROM_QUEUE_LENGTH         32
+#endif
+
+//! Number of write requests that can be queued, must be in [1 ... 255].
+#ifndef EEPROM_REQUEST_COUNT
+#define EEPROM_REQUEST_COUNT        8
+#endif
+
+//! Critical section site of the driver, see IRQ_PROFILING.
+#ifndef EEPROM_IRQ_SITE
+#define EEPROM_IRQ_SITE                 (IRQ_SITE_BASE_DRIVER + 6)
+#endif
+
+//*****************************************************************************
+//************************ EEPROM SPECIFIC ERROR CODES ************************
+//*****************************************************************************
+
+/*! EEPROM specific error base */
+#ifndef EEPROM_ERR_BASE
+#define EEPROM_ERR_BASE             70
+#endif
+
+/*! EEPROM returns with no errors. */
+#define EEPROM_OK                   0
+
+/*! A bad parameter has been passed. */
+#define EEPROM_ERR_BAD_PARAMETER    EEPROM_ERR_BASE + 0
+
+/*! There is not enough space in the write queue. */
+#define EEPROM_ERR_QUEUE_FULL       EEPROM_ERR_BASE + 1
+
+/*! The store has not been initialized. */
+#define EEPROM_ERR_NOT_INITIALIZED  EEPROM_ERR_BASE + 2
+
+/*! The requested key or log entry has not been found. */
+#define EEPROM_ERR_NOT_FOUND        EEPROM_ERR_BASE + 3
+
+/*! The data exceeds EEPROM_QUEUE_LENGTH and can never be queued at once. */
+#define EEPROM_ERR_TOO_LARGE        EEPROM_ERR_BASE + 4
+
+
+//*****************************************************************************
+//************************* FUNCTION DECLARATIONS *****************************
+//*****************************************************************************
+
+uint8_t  EEPROM_Write (uint16_t address, const uint8_t* dataPtr, uint8_t count);
+uint8_t  EEPROM_Read (uint16_t address, uint8_t* dataPtr, uint8_t count);
+uint8_t  EEPROM_IsBusy (void);
+uint8_t  EEPROM_GetFreeSize (void);
+void     EEPROM_Flush (void);
+
+#endif // EEPROM_H
@@ -0,0 +1,339 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   Wear-levelled key/value store in the EEPROM.
+**
+**          The store is meant for configuration values such as CAN masks
+**          and filters or baud rates. The EEPROM region of the store is
+**          divided into record slots, which are written in a circular
+**          manner. Each EEPROM_KvSet() appends a new record with an
+**          increasing sequence number at the next slot that does not hold
+**          the current value of any key, so that the writes are spread
+**          over the whole region. EEPROM_KvInit() scans the region and
+**          selects the record with the highest sequence number for each
+**          key. Records are protected by a CRC, so that a record which
+**          has been torn by a power loss is ignored and the previous value
+**          of the key remains valid.
+**
+**          Records are written through the non-blocking write queue of the
+**          EEPROM driver, so EEPROM_KvSet() returns immediately.
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include <util/crc16.h>
+#include "eeprom.h"
+#include "eeprom_kv.h"
+
+//*****************************************************************************
+//*************************** DEFINES AND MACROS ******************************
+//*****************************************************************************
+
+//! Marks a key without a valid record.
+#define EEPROM_KV_NO_SLOT       0xFF
+
+//*****************************************************************************
+//**************************** LOCAL DATA TYPES *******************************
+//*****************************************************************************
+
+//! Layout of a record in the EEPROM.
+typedef struct
+{
+    uint32_t sequence;
+    uint8_t  key;
+    uint8_t  length;
+    uint8_t  valueArr[EEPROM_KV_VALUE_SIZE];
+    uint8_t  crc;
+} eepromKvRecordT;
+
+//*****************************************************************************
+//**************************** LOCAL VARIABLES ********************************
+//*****************************************************************************
+
+//! Internal state of the key/value store.
+static struct
+{
+    uint16_t baseAddress;
+    uint8_t  slotCount;
+    uint8_t  nextSlot;                       //!< where to search for a free slot
+    uint32_t nextSequence;                   //!< sequence of the next record
+    uint8_t  keySlotArr[EEPROM_KV_KEY_COUNT]; //!< current slot of each key
+    uint8_t  initialized : 1;
+} eepromKvState;
+
+//*****************************************************************************
+//********************** LOCAL FUNCTION DECLARATIONS **************************
+//*****************************************************************************
+
+static uint8_t eepromKvCrc (const eepromKvRecordT* recordPtr);
+static uint8_t eepromKvReadRecord (uint8_t slot, eepromKvRecordT* recordPtr);
+static uint8_t eepromKvIsLive (uint8_t slot);
+
+//*****************************************************************************
+//**************************** LOCAL FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   Computes the CRC of a record, excluding the CRC field.
+**
+*******************************************************************************
+*/
+static uint8_t eepromKvCrc (const eepromKvRecordT* recordPtr)
+{
+    const uint8_t* byte_ptr = (const uint8_t*)recordPtr;
+    uint8_t crc = 0;
+    uint8_t ii;
+
+    for (ii = 0; ii < sizeof(eepromKvRecordT) - 1; ii++)
+    {
+        crc = _crc8_ccitt_update(crc, byte_ptr[ii]);
+    }
+    return (crc);
+}
+
+/*!
+*******************************************************************************
+** \brief   Reads and validates the record of a slot.
+**
+** \return  1 if the record is valid, 0 otherwise.
+**
+*******************************************************************************
+*/
+static uint8_t eepromKvReadRecord (uint8_t slot, eepromKvRecordT* recordPtr)
+{
+    EEPROM_Read(eepromKvState.baseAddress +
+                (uint16_t)slot * sizeof(eepromKvRecordT),
+                (uint8_t*)recordPtr,
+                sizeof(eepromKvRecordT));
+    return ((recordPtr->key < EEPROM_KV_KEY_COUNT)
+        &&  (recordPtr->length <= EEPROM_KV_VALUE_SIZE)
+        &&  (recordPtr->crc == eepromKvCrc(recordPtr)));
+}
+
+/*!
+*******************************************************************************
+** \brief   Tests whether a slot holds the current record of any key.
+**
+*******************************************************************************
+*/
+static uint8_t eepromKvIsLive (uint8_t slot)
+{
+    uint8_t key;
+
+    for (key = 0; key < EEPROM_KV_KEY_COUNT; key++)
+    {
+        if (eepromKvState.keySlotArr[key] == slot)
+        {
+            return (1);
+        }
+    }
+    return (0);
+}
+
+//*****************************************************************************
+//*************************** PUBLIC FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   Initializes the key/value store and loads the index of the
+**          current records.
+**
+**          This function reads the whole region and may take a few
+**          milliseconds. It should be called once at startup.
+**
+** \param   baseAddress     EEPROM address of the region of the store.
+** \param   size            Size of the region in bytes. The region must
+**                          hold more than EEPROM_KV_KEY_COUNT and at most
+**                          254 records of EEPROM_KV_RECORD_SIZE bytes.
+**
+** \return
+**          - #EEPROM_OK on success.
+**          - #EEPROM_ERR_BAD_PARAMETER if the region is invalid.
+**
+*******************************************************************************
+*/
+uint8_t EEPROM_KvInit (uint16_t baseAddress, uint16_t size)
+{
+    eepromKvRecordT record;
+    eepromKvRecordT current;
+    uint16_t        slot_count;
+    uint32_t        newest_sequence = 0;
+    uint8_t         newest_slot = EEPROM_KV_NO_SLOT;
+    uint8_t         slot;
+
+    slot_count = size / sizeof(eepromKvRecordT);
+    if ((slot_count <= EEPROM_KV_KEY_COUNT)
+    ||  (slot_count >= EEPROM_KV_NO_SLOT)
+    ||  ((uint32_t)baseAddress + size - 1 > E2END))
+    {
+        return (EEPROM_ERR_BAD_PARAMETER);
+    }
+
+    eepromKvState.initialized = 0;
+    eepromKvState.baseAddress = baseAddress;
+    eepromKvState.slotCount   = (uint8_t)slot_count;
+    memset(eepromKvState.keySlotArr, EEPROM_KV_NO_SLOT,
+           sizeof(eepromKvState.keySlotArr));
+
+    for (slot = 0; slot < eepromKvState.slotCount; slot++)
+    {
+        if (!eepromKvReadRecord(slot, &record))
+        {
+            continue;
+        }
+        if ((eepromKvState.keySlotArr[record.key] == EEPROM_KV_NO_SLOT)
+        ||  !eepromKvReadRecord(eepromKvState.keySlotArr[record.key], &current)
+        ||  (record.sequence > current.sequence))
+        {
+            eepromKvState.keySlotArr[record.key] = slot;
+        }
+        if ((newest_slot == EEPROM_KV_NO_SLOT)
+        ||  (record.sequence > newest_sequence))
+        {
+            newest_slot = slot;
+            newest_sequence = record.sequence;
+        }
+    }
+
+    if (newest_slot == EEPROM_KV_NO_SLOT)
+    {
+        eepromKvState.nextSlot = 0;
+        eepromKvState.nextSequence = 0;
+    }
+    else
+    {
+        eepromKvState.nextSlot = (newest_slot + 1) % eepromKvState.slotCount;
+        eepromKvState.nextSequence = newest_sequence + 1;
+    }
+    eepromKvState.initialized = 1;
+    return (EEPROM_OK);
+}
+
+/*!
+*******************************************************************************
+** \brief   Reads the value of a key.
+**
+** \param   key         The key.
+** \param   valuePtr    Destination of the value, must provide space for
+**                      EEPROM_KV_VALUE_SIZE bytes.
+** \param   lengthPtr   Receives the length of the value. May be NULL.
+**
+** \return
+**          - #EEPROM_OK on success.
+**          - #EEPROM_ERR_BAD_PARAMETER if the key is out of range.
+**          - #EEPROM_ERR_NOT_INITIALIZED if the store is not initialized.
+**          - #EEPROM_ERR_NOT_FOUND if the key has never been set.
+**
+*******************************************************************************
+*/
+uint8_t EEPROM_KvGet (uint8_t key, uint8_t* valuePtr, uint8_t* lengthPtr)
+{
+    eepromKvRecordT record;
+
+    if ((key >= EEPROM_KV_KEY_COUNT) || (valuePtr == NULL))
+    {
+        return (EEPROM_ERR_BAD_PARAMETER);
+    }
+    if (!eepromKvState.initialized)
+    {
+        return (EEPROM_ERR_NOT_INITIALIZED);
+    }
+    if ((eepromKvState.keySlotArr[key] == EEPROM_KV_NO_SLOT)
+    ||  !eepromKvReadRecord(eepromKvState.keySlotArr[key], &record))
+    {
+        return (EEPROM_ERR_NOT_FOUND);
+    }
+    memcpy(valuePtr, record.valueArr, record.length);
+    if (lengthPtr)
+    {
+        *lengthPtr = record.length;
+    }
+    return (EEPROM_OK);
+}
+
+/*!
+*******************************************************************************
+** \brief   Sets the value of a key.
+**
+**          The record is queued for writing and the function returns
+**          immediately. Nothing is written if the value is unchanged.
+**
+** \param   key         The key.
+** \param   valuePtr    The value.
+** \param   length      Length of the value, at most EEPROM_KV_VALUE_SIZE.
+**
+** \return
+**          - #EEPROM_OK on success.
+**          - #EEPROM_ERR_BAD_PARAMETER if key or length are out of range.
+**          - #EEPROM_ERR_NOT_INITIALIZED if the store is not initialized.
+**          - #EEPROM_ERR_QUEUE_FULL if the EEPROM write queue is full.
+**          - #EEPROM_ERR_TOO_LARGE if a record exceeds EEPROM_QUEUE_LENGTH.
+**              Nothing has been changed and the call may be repeated later.
+**
+*******************************************************************************
+*/
+uint8_t EEPROM_KvSet (uint8_t key, const uint8_t* valuePtr, uint8_t length)
+{
+    eepromKvRecordT record;
+    uint8_t         slot;
+    uint8_t         result;
+
+    if ((key >= EEPROM_KV_KEY_COUNT)
+    ||  (length > EEPROM_KV_VALUE_SIZE)
+    ||  (length && (valuePtr == NULL)))
+    {
+        return (EEPROM_ERR_BAD_PARAMETER);
+    }
+    if (!eepromKvState.initialized)
+    {
+        return (EEPROM_ERR_NOT_INITIALIZED);
+    }
+
+    // skip unchanged values in order to save write cycles:
+    if ((eepromKvState.keySlotArr[key] != EEPROM_KV_NO_SLOT)
+    &&  eepromKvReadRecord(eepromKvState.keySlotArr[key], &record)
+    &&  (record.length == length)
+    &&  (memcmp(record.valueArr, valuePtr, length) == 0))
+    {
+        return (EEPROM_OK);
+    }
+
+    // find the next slot which does not hold a current record:
+    slot = eepromKvState.nextSlot;
+    while (eepromKvIsLive(slot))
+    {
+        slot = (slot + 1) % eepromKvState.slotCount;
+    }
+
+    memset(&record, 0xFF, sizeof(record));
+    record.sequence = eepromKvState.nextSequence;
+    record.key      = key;
+    record.length   = length;
+    memcpy(record.valueArr, valuePtr, length);
+    record.crc      = eepromKvCrc(&record);
+
+    result = EEPROM_Write(eepromKvState.baseAddress +
+                         (uint16_t)slot * sizeof(eepromKvRecordT),
+                         (const uint8_t*)&record,
+                         sizeof(eepromKvRecordT));
+    if (result != EEPROM_OK)
+    {
+        return (result);
+    }
+
+    eepromKvState.keySlotArr[key] = slot;
+    eepromKvState.nextSlot = (slot + 1) % eepromKvState.slotCount;
+    eepromKvState.nextSequence++;
+    return (EEPROM_OK);
+}
@@ -0,0 +1,54 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   Wear-levelled EEPROM key/value store declarations
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#ifndef EEPROM_KV_H
+#define EEPROM_KV_H
+
+#include <stdint.h>
+#include "eeprom.h"
+
+//*****************************************************************************
+//*************************** DEFINES AND MACROS ******************************
+//*****************************************************************************
+
+//! Number of keys, valid keys are in range [0 ... EEPROM_KV_KEY_COUNT - 1].
+#ifndef EEPROM_KV_KEY_COUNT
+#define EEPROM_KV_KEY_COUNT         16
+#endif
+
+//! Maximum size of a value in bytes.
+#ifndef EEPROM_KV_VALUE_SIZE
+#define EEPROM_KV_VALUE_SIZE        4
+#endif
+
+/*! Size of a record in the EEPROM: sequence number (4 bytes), key, length,
+**  value and CRC. The size of the region passed to EEPROM_KvInit() must
+**  provide space for more records than there are keys. */
+#define EEPROM_KV_RECORD_SIZE       (EEPROM_KV_VALUE_SIZE + 7)
+
+#if EEPROM_KV_RECORD_SIZE > EEPROM_QUEUE_LENGTH
+#error "EEPROM_KV_VALUE_SIZE + 7 must not exceed EEPROM_QUEUE_LENGTH"
+#endif
+
+
+//*****************************************************************************
+//************************* FUNCTION DECLARATIONS *****************************
+//*****************************************************************************
+
+uint8_t EEPROM_KvInit (uint16_t baseAddress, uint16_t size);
+uint8_t EEPROM_KvGet (uint8_t key, uint8_t* valuePtr, uint8_t* lengthPtr);
+uint8_t EEPROM_KvSet (uint8_t key, const uint8_t* valuePtr, uint8_t length);
+
+#endif // EEPROM_KV_H
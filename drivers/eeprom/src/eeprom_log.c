@@ -0,0 +1,309 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   Append-only ring log in the EEPROM.
+**
+**          The log is meant for fault records. Entries of a fixed size are
+**          appended in a circular manner, so that the oldest entry is
+**          overwritten when the region is full and each slot is written
+**          equally often. Each entry carries a sequence number and a CRC.
+**          EEPROM_LogInit() locates the newest entry and counts the
+**          consecutive valid entries before it. An entry which has been
+**          torn by a power loss is simply not counted.
+**
+**          Entries are written through the non-blocking write queue of the
+**          EEPROM driver, so EEPROM_LogAppend() returns immediately.
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <util/crc16.h>
+#include "eeprom.h"
+#include "eeprom_log.h"
+
+//*****************************************************************************
+//*************************** DEFINES AND MACROS ******************************
+//*****************************************************************************
+
+/*! Sequence number of an erased entry. Sequence numbers count modulo this
+**  value, so that it never occurs in a valid entry. */
+#define EEPROM_LOG_NO_SEQUENCE  0xFFFF
+
+//*****************************************************************************
+//**************************** LOCAL DATA TYPES *******************************
+//*****************************************************************************
+
+//! Layout of a log entry in the EEPROM.
+typedef struct
+{
+    uint16_t sequence;
+    uint8_t  entryArr[EEPROM_LOG_ENTRY_SIZE];
+    uint8_t  crc;
+} eepromLogRecordT;
+
+//*****************************************************************************
+//**************************** LOCAL VARIABLES ********************************
+//*****************************************************************************
+
+//! Internal state of the log.
+static struct
+{
+    uint16_t baseAddress;
+    uint8_t  slotCount;
+    uint8_t  head;          //!< slot of the next entry
+    uint8_t  count;         //!< number of valid entries
+    uint16_t nextSequence;  //!< sequence of the next entry
+    uint8_t  initialized : 1;
+} eepromLogState;
+
+//*****************************************************************************
+//********************** LOCAL FUNCTION DECLARATIONS **************************
+//*****************************************************************************
+
+static uint8_t eepromLogCrc (const eepromLogRecordT* recordPtr);
+static uint8_t eepromLogReadRecord (uint8_t slot, eepromLogRecordT* recordPtr);
+
+//*****************************************************************************
+//**************************** LOCAL FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   Computes the CRC of an entry, excluding the CRC field.
+**
+*******************************************************************************
+*/
+static uint8_t eepromLogCrc (const eepromLogRecordT* recordPtr)
+{
+    const uint8_t* byte_ptr = (const uint8_t*)recordPtr;
+    uint8_t crc = 0;
+    uint8_t ii;
+
+    for (ii = 0; ii < sizeof(eepromLogRecordT) - 1; ii++)
+    {
+        crc = _crc8_ccitt_update(crc, byte_ptr[ii]);
+    }
+    return (crc);
+}
+
+/*!
+*******************************************************************************
+** \brief   Reads and validates the entry of a slot.
+**
+** \return  1 if the entry is valid, 0 otherwise.
+**
+*******************************************************************************
+*/
+static uint8_t eepromLogReadRecord (uint8_t slot, eepromLogRecordT* recordPtr)
+{
+    EEPROM_Read(eepromLogState.baseAddress +
+                (uint16_t)slot * sizeof(eepromLogRecordT),
+                (uint8_t*)recordPtr,
+                sizeof(eepromLogRecordT));
+    return ((recordPtr->sequence != EEPROM_LOG_NO_SEQUENCE)
+        &&  (recordPtr->crc == eepromLogCrc(recordPtr)));
+}
+
+//*****************************************************************************
+//*************************** PUBLIC FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   Initializes the log and locates the newest entry.
+**
+**          This function reads the whole region and may take a few
+**          milliseconds. It should be called once at startup.
+**
+** \param   baseAddress     EEPROM address of the region of the log.
+** \param   size            Size of the region in bytes. The region must hold
+**                          at least 2 and at most 255 entries of
+**                          EEPROM_LOG_RECORD_SIZE bytes.
+**
+** \return
+**          - #EEPROM_OK on success.
+**          - #EEPROM_ERR_BAD_PARAMETER if the region is invalid.
+**
+*******************************************************************************
+*/
+uint8_t EEPROM_LogInit (uint16_t baseAddress, uint16_t size)
+{
+    eepromLogRecordT record;
+    uint16_t         slot_count;
+    uint16_t         newest_sequence = 0;
+    uint8_t          newest_valid = 0;
+    uint8_t          newest_slot = 0;
+    uint8_t          slot;
+
+    slot_count = size / sizeof(eepromLogRecordT);
+    if ((slot_count < 2) || (slot_count > 255)
+    ||  ((uint32_t)baseAddress + size - 1 > E2END))
+    {
+        return (EEPROM_ERR_BAD_PARAMETER);
+    }
+
+    eepromLogState.initialized = 0;
+    eepromLogState.baseAddress = baseAddress;
+    eepromLogState.slotCount   = (uint8_t)slot_count;
+
+    // the newest entry is the one which is newer than all others:
+    for (slot = 0; slot < eepromLogState.slotCount; slot++)
+    {
+        if (!eepromLogReadRecord(slot, &record))
+        {
+            continue;
+        }
+        if (!newest_valid
+        ||  ((int16_t)(record.sequence - newest_sequence) > 0))
+        {
+            newest_valid = 1;
+            newest_slot = slot;
+            newest_sequence = record.sequence;
+        }
+    }
+
+    eepromLogState.count = 0;
+    if (!newest_valid)
+    {
+        eepromLogState.head = 0;
+        eepromLogState.nextSequence = 0;
+    }
+    else
+    {
+        eepromLogState.head = (newest_slot + 1) % eepromLogState.slotCount;
+        eepromLogState.nextSequence = (newest_sequence + 1)
+                                    % EEPROM_LOG_NO_SEQUENCE;
+
+        // count consecutive entries backwards from the newest one:
+        slot = newest_slot;
+        while ((eepromLogState.count < eepromLogState.slotCount)
+        &&     eepromLogReadRecord(slot, &record)
+        &&     (record.sequence == newest_sequence))
+        {
+            eepromLogState.count++;
+            slot = slot ? (slot - 1) : (eepromLogState.slotCount - 1);
+            newest_sequence = newest_sequence ? (newest_sequence - 1)
+                                              : (EEPROM_LOG_NO_SEQUENCE - 1);
+        }
+    }
+    eepromLogState.initialized = 1;
+    return (EEPROM_OK);
+}
+
+/*!
+*******************************************************************************
+** \brief   Appends an entry to the log. The oldest entry is overwritten
+**          if the log is full.
+**
+** \param   entryPtr    The payload of EEPROM_LOG_ENTRY_SIZE bytes.
+**
+** \return
+**          - #EEPROM_OK on success.
+**          - #EEPROM_ERR_BAD_PARAMETER if entryPtr is NULL.
+**          - #EEPROM_ERR_NOT_INITIALIZED if the log is not initialized.
+**          - #EEPROM_ERR_QUEUE_FULL if the EEPROM write queue is full.
+**          - #EEPROM_ERR_TOO_LARGE if a record exceeds EEPROM_QUEUE_LENGTH.
+**
+*******************************************************************************
+*/
+uint8_t EEPROM_LogAppend (const uint8_t* entryPtr)
+{
+    eepromLogRecordT record;
+    uint8_t          result;
+
+    if (entryPtr == NULL)
+    {
+        return (EEPROM_ERR_BAD_PARAMETER);
+    }
+    if (!eepromLogState.initialized)
+    {
+        return (EEPROM_ERR_NOT_INITIALIZED);
+    }
+
+    record.sequence = eepromLogState.nextSequence;
+    memcpy(record.entryArr, entryPtr, EEPROM_LOG_ENTRY_SIZE);
+    record.crc = eepromLogCrc(&record);
+
+    result = EEPROM_Write(eepromLogState.baseAddress +
+                         (uint16_t)eepromLogState.head * sizeof(eepromLogRecordT),
+                         (const uint8_t*)&record,
+                         sizeof(eepromLogRecordT));
+    if (result != EEPROM_OK)
+    {
+        return (result);
+    }
+
+    eepromLogState.head = (eepromLogState.head + 1) % eepromLogState.slotCount;
+    eepromLogState.nextSequence = (eepromLogState.nextSequence + 1)
+                                % EEPROM_LOG_NO_SEQUENCE;
+    if (eepromLogState.count < eepromLogState.slotCount)
+    {
+        eepromLogState.count++;
+    }
+    return (EEPROM_OK);
+}
+
+/*!
+*******************************************************************************
+** \brief   Reads an entry from the log.
+**
+** \param   index       0 denotes the newest entry, 1 the entry before, etc.
+** \param   entryPtr    Destination of the payload of EEPROM_LOG_ENTRY_SIZE
+**                      bytes.
+**
+** \return
+**          - #EEPROM_OK on success.
+**          - #EEPROM_ERR_BAD_PARAMETER if entryPtr is NULL.
+**          - #EEPROM_ERR_NOT_INITIALIZED if the log is not initialized.
+**          - #EEPROM_ERR_NOT_FOUND if there is no valid entry at the index.
+**
+*******************************************************************************
+*/
+uint8_t EEPROM_LogRead (uint8_t index, uint8_t* entryPtr)
+{
+    eepromLogRecordT record;
+    uint8_t          slot;
+
+    if (entryPtr == NULL)
+    {
+        return (EEPROM_ERR_BAD_PARAMETER);
+    }
+    if (!eepromLogState.initialized)
+    {
+        return (EEPROM_ERR_NOT_INITIALIZED);
+    }
+    if (index >= eepromLogState.count)
+    {
+        return (EEPROM_ERR_NOT_FOUND);
+    }
+
+    slot = (uint8_t)(((uint16_t)eepromLogState.head + eepromLogState.slotCount
+                      - 1 - index) % eepromLogState.slotCount);
+    if (!eepromLogReadRecord(slot, &record))
+    {
+        return (EEPROM_ERR_NOT_FOUND);
+    }
+    memcpy(entryPtr, record.entryArr, EEPROM_LOG_ENTRY_SIZE);
+    return (EEPROM_OK);
+}
+
+/*!
+*******************************************************************************
+** \brief   Get the number of valid entries in the log.
+**
+*******************************************************************************
+*/
+uint8_t EEPROM_LogGetCount (void)
+{
+    return (eepromLogState.count);
+}
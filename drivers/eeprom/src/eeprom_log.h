@@ -0,0 +1,49 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   Append-only EEPROM ring log declarations
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#ifndef EEPROM_LOG_H
+#define EEPROM_LOG_H
+
+#include <stdint.h>
+#include "eeprom.h"
+
+//*****************************************************************************
+//*************************** DEFINES AND MACROS ******************************
+//*****************************************************************************
+
+//! Size of the payload of a log entry in bytes.
+#ifndef EEPROM_LOG_ENTRY_SIZE
+#define EEPROM_LOG_ENTRY_SIZE       8
+#endif
+
+/*! Size of a log entry in the EEPROM: sequence number (2 bytes), payload
+**  and CRC. */
+#define EEPROM_LOG_RECORD_SIZE      (EEPROM_LOG_ENTRY_SIZE + 3)
+
+#if EEPROM_LOG_RECORD_SIZE > EEPROM_QUEUE_LENGTH
+#error "EEPROM_LOG_ENTRY_SIZE + 3 must not exceed EEPROM_QUEUE_LENGTH"
+#endif
+
+
+//*****************************************************************************
+//************************* FUNCTION DECLARATIONS *****************************
+//*****************************************************************************
+
+uint8_t EEPROM_LogInit (uint16_t baseAddress, uint16_t size);
+uint8_t EEPROM_LogAppend (const uint8_t* entryPtr);
+uint8_t EEPROM_LogRead (uint8_t index, uint8_t* entryPtr);
+uint8_t EEPROM_LogGetCount (void);
+
+#endif // EEPROM_LOG_H
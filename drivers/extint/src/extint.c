@@ -0,0 +1,564 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   External and pin change interrupt manager.
+**
+**          The EXTINT driver owns the vectors of the external interrupts
+**          INTn and of the pin change interrupts PCINTn and dispatches
+**          them to callbacks, so that several drivers and applications can
+**          share interrupt inputs without defining the same vector twice.
+**          The vectors owned by the driver are selected by means of the
+**          EXTINT_USE_INTn and EXTINT_USE_PCINTn macros. None is owned by
+**          default, so that the driver does not collide with drivers that
+**          serve their interrupt themselves, e.g., the MCP2515 driver.
+**
+**          Pin change interrupts fire for all enabled pins of a port. The
+**          ISR takes a snapshot of the PIN register, compares it to the
+**          previous snapshot and executes the callbacks of those pins that
+**          have changed in the requested direction. If a pin toggles twice
+**          before the ISR reads the PIN register, both edges are missed.
+**
+**          Optionally, each ISR captures a timestamp from a free-running
+**          timer counter before anything else, so that edges can be timed
+**          independently of the dispatch latency.
+**
+** \attention
+**          Callbacks are executed from within ISRs and should return
+**          quickly. Callbacks of level-triggered interrupts must release
+**          the interrupt line before they return.
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <drivers/macros_pin.h>
+#include <drivers/irq.h>
+#include "extint.h"
+
+//*****************************************************************************
+//*************************** DEFINES AND MACROS ******************************
+//*****************************************************************************
+
+#if (defined atmega644) || (defined atmega644p)
+
+//! Pins of the external interrupts INTn:
+#define EXTINT_INT0_PIN         D,2
+#define EXTINT_INT1_PIN         D,3
+#define EXTINT_INT2_PIN         B,2
+
+#endif // atmega644 || atmega644p
+
+//! Captures the timestamp at the beginning of an ISR.
+#if EXTINT_WITH_TIMESTAMP
+#define EXTINT_GET_TIMESTAMP    EXTINT_TIMESTAMP_COUNTER
+#else
+#define EXTINT_GET_TIMESTAMP    0
+#endif // EXTINT_WITH_TIMESTAMP
+
+//! Mask of the INTn vectors that are owned by the driver.
+#define EXTINT_INT_AVAILABLE    ((EXTINT_USE_INT0 ? 0x01 : 0) | \
+                                 (EXTINT_USE_INT1 ? 0x02 : 0) | \
+                                 (EXTINT_USE_INT2 ? 0x04 : 0))
+
+//! Mask of the PCINTn vectors that are owned by the driver.
+#define EXTINT_PCINT_AVAILABLE  ((EXTINT_USE_PCINT0 ? 0x01 : 0) | \
+                                 (EXTINT_USE_PCINT1 ? 0x02 : 0) | \
+                                 (EXTINT_USE_PCINT2 ? 0x04 : 0) | \
+                                 (EXTINT_USE_PCINT3 ? 0x08 : 0))
+
+//*****************************************************************************
+//**************************** LOCAL DATA TYPES *******************************
+//*****************************************************************************
+
+//! Callback of a pin change interrupt.
+typedef struct
+{
+    EXTINT_CallbackT callbackPtr;   //!< NULL if the slot is free
+    void*            optArgPtr;
+    uint8_t          port;
+    uint8_t          mask;          //!< bit of the pin in the port
+    uint8_t          edge;          //!< EXTINT_EdgeT
+} extintPinT;
+
+//*****************************************************************************
+//**************************** LOCAL VARIABLES ********************************
+//*****************************************************************************
+
+//! Internal state of the EXTINT driver.
+static struct
+{
+    EXTINT_CallbackT intCallbackArr[EXTINT_INT_COUNT];
+    void*            intArgArr[EXTINT_INT_COUNT];
+    extintPinT       pinArr[EXTINT_PIN_CALLBACK_COUNT];
+    uint8_t          levelArr[EXTINT_PortCount]; //!< previous PIN snapshots
+} extintState;
+
+//*****************************************************************************
+//********************** LOCAL FUNCTION DECLARATIONS **************************
+//*****************************************************************************
+
+static volatile uint8_t* extintGetPcmsk (EXTINT_PortT port);
+static uint8_t extintReadPort (EXTINT_PortT port);
+static inline void extintDispatchInt (uint8_t intNo,
+                                      uint8_t level,
+                                      uint16_t timestamp);
+static inline void extintDispatchPort (EXTINT_PortT port,
+                                       uint8_t level,
+                                       uint8_t enabled,
+                                       uint16_t timestamp);
+
+//*****************************************************************************
+//**************************** LOCAL FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   Get the pin change mask register of a port.
+**
+*******************************************************************************
+*/
+static volatile uint8_t* extintGetPcmsk (EXTINT_PortT port)
+{
+    switch (port)
+    {
+        case EXTINT_PortA: return (&PCMSK0);
+        case EXTINT_PortB: return (&PCMSK1);
+        case EXTINT_PortC: return (&PCMSK2);
+        default:           return (&PCMSK3);
+    }
+}
+
+/*!
+*******************************************************************************
+** \brief   Read the PIN register of a port.
+**
+*******************************************************************************
+*/
+static uint8_t extintReadPort (EXTINT_PortT port)
+{
+    switch (port)
+    {
+        case EXTINT_PortA: return (PINA);
+        case EXTINT_PortB: return (PINB);
+        case EXTINT_PortC: return (PINC);
+        default:           return (PIND);
+    }
+}
+
+/*!
+*******************************************************************************
+** \brief   Execute the callback of an external interrupt.
+**
+*******************************************************************************
+*/
+static inline void extintDispatchInt (uint8_t intNo,
+                                      uint8_t level,
+                                      uint16_t timestamp)
+{
+    if (extintState.intCallbackArr[intNo])
+    {
+        extintState.intCallbackArr[intNo](level,
+                                          timestamp,
+                                          extintState.intArgArr[intNo]);
+    }
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Decode the changed pins of a port and execute their callbacks.
+**
+** \param   port        The port.
+** \param   level       Snapshot of the PIN register.
+** \param   enabled     The pin change mask of the port.
+** \param   timestamp   Timestamp of the ISR.
+**
+*******************************************************************************
+*/
+static inline void extintDispatchPort (EXTINT_PortT port,
+                                       uint8_t level,
+                                       uint8_t enabled,
+                                       uint16_t timestamp)
+{
+    extintPinT* pin_ptr;
+    uint8_t     changed;
+    uint8_t     pin_level;
+    uint8_t     ii;
+
+    changed = (level ^ extintState.levelArr[port]) & enabled;
+    extintState.levelArr[port] = level;
+    if (!changed)
+    {
+        return;
+    }
+    for (ii = 0; ii < EXTINT_PIN_CALLBACK_COUNT; ii++)
+    {
+        pin_ptr = &extintState.pinArr[ii];
+        if (pin_ptr->callbackPtr
+        &&  (pin_ptr->port == port)
+        &&  (pin_ptr->mask & changed))
+        {
+            pin_level = (level & pin_ptr->mask) ? 1 : 0;
+            if (pin_ptr->edge & (pin_level ? EXTINT_Edge_Rising
+                                           : EXTINT_Edge_Falling))
+            {
+                pin_ptr->callbackPtr(pin_level, timestamp, pin_ptr->optArgPtr);
+            }
+        }
+    }
+    return;
+}
+
+//*****************************************************************************
+//*************************** PUBLIC FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   Attach a callback to an external interrupt and enable it.
+**
+** \param   intNo       Number of the external interrupt (INTn).
+** \param   sense       The interrupt sense control.
+** \param   callbackPtr The callback, which is executed from within the ISR.
+** \param   optArgPtr   Optional argument that is passed to the callback.
+**
+** \return
+**          - #EXTINT_OK on success.
+**          - #EXTINT_ERR_BAD_PARAMETER if intNo or sense is out of range or
+**              callbackPtr is NULL.
+**          - #EXTINT_ERR_NOT_AVAILABLE if the vector is not owned by EXTINT.
+**          - #EXTINT_ERR_IN_USE if a callback is already attached.
+**
+*******************************************************************************
+*/
+uint8_t EXTINT_AttachInt (uint8_t intNo,
+                          EXTINT_SenseT sense,
+                          EXTINT_CallbackT callbackPtr,
+                          void* optArgPtr)
+{
+    uint8_t result = EXTINT_OK;
+
+    if ((intNo >= EXTINT_INT_COUNT)
+    ||  (sense > EXTINT_Sense_RisingEdge)
+    ||  (callbackPtr == NULL))
+    {
+        return (EXTINT_ERR_BAD_PARAMETER);
+    }
+    if (!(EXTINT_INT_AVAILABLE & (1 << intNo)))
+    {
+        return (EXTINT_ERR_NOT_AVAILABLE);
+    }
+
+    IRQ_GLOBAL_BLOCK(EXTINT_IRQ_SITE)
+    {
+        if (extintState.intCallbackArr[intNo])
+        {
+            result = EXTINT_ERR_IN_USE;
+        }
+        else
+        {
+            EIMSK &= ~(1 << intNo);
+            EICRA = (EICRA & ~(0x03 << (intNo * 2))) | (sense << (intNo * 2));
+            EIFR = (1 << intNo); // clear flags raised by the sense change
+            extintState.intCallbackArr[intNo] = callbackPtr;
+            extintState.intArgArr[intNo] = optArgPtr;
+            EIMSK |= (1 << intNo);
+        }
+    }
+    return (result);
+}
+
+/*!
+*******************************************************************************
+** \brief   Disable an external interrupt and detach its callback.
+**
+** \param   intNo       Number of the external interrupt (INTn).
+**
+** \return
+**          - #EXTINT_OK on success.
+**          - #EXTINT_ERR_BAD_PARAMETER if intNo is out of range.
+**          - #EXTINT_ERR_NOT_AVAILABLE if the vector is not owned by EXTINT.
+**
+*******************************************************************************
+*/
+uint8_t EXTINT_DetachInt (uint8_t intNo)
+{
+    if (intNo >= EXTINT_INT_COUNT)
+    {
+        return (EXTINT_ERR_BAD_PARAMETER);
+    }
+    if (!(EXTINT_INT_AVAILABLE & (1 << intNo)))
+    {
+        return (EXTINT_ERR_NOT_AVAILABLE);
+    }
+
+    IRQ_GLOBAL_BLOCK(EXTINT_IRQ_SITE)
+    {
+        EIMSK &= ~(1 << intNo);
+        extintState.intCallbackArr[intNo] = NULL;
+        extintState.intArgArr[intNo] = NULL;
+    }
+    return (EXTINT_OK);
+}
+
+/*!
+*******************************************************************************
+** \brief   Attach a callback to a pin change interrupt and enable it.
+**
+**          The pin is not configured as input by this function.
+**
+** \param   port        The port of the pin.
+** \param   pinIdx      Index of the pin within the port (0 ... 7).
+** \param   edge        The edge(s) that trigger the callback.
+** \param   callbackPtr The callback, which is executed from within the ISR.
+** \param   optArgPtr   Optional argument that is passed to the callback.
+**
+** \return
+**          - #EXTINT_OK on success.
+**          - #EXTINT_ERR_BAD_PARAMETER if a parameter is out of range or
+**              callbackPtr is NULL.
+**          - #EXTINT_ERR_NOT_AVAILABLE if the vector of the port is not
+**              owned by EXTINT.
+**          - #EXTINT_ERR_IN_USE if a callback is already attached to the pin.
+**          - #EXTINT_ERR_NO_SLOT_FREE if all pin callback slots are in use.
+**
+*******************************************************************************
+*/
+uint8_t EXTINT_AttachPin (EXTINT_PortT port,
+                          uint8_t pinIdx,
+                          EXTINT_EdgeT edge,
+                          EXTINT_CallbackT callbackPtr,
+                          void* optArgPtr)
+{
+    extintPinT* free_ptr = NULL;
+    extintPinT* pin_ptr;
+    uint8_t     mask;
+    uint8_t     result = EXTINT_OK;
+    uint8_t     ii;
+
+    if ((port >= EXTINT_PortCount)
+    ||  (pinIdx > 7)
+    ||  (edge < EXTINT_Edge_Rising) || (edge > EXTINT_Edge_Any)
+    ||  (callbackPtr == NULL))
+    {
+        return (EXTINT_ERR_BAD_PARAMETER);
+    }
+    if (!(EXTINT_PCINT_AVAILABLE & (1 << port)))
+    {
+        return (EXTINT_ERR_NOT_AVAILABLE);
+    }
+    mask = (1 << pinIdx);
+
+    IRQ_GLOBAL_BLOCK(EXTINT_IRQ_SITE)
+    {
+        for (ii = 0; ii < EXTINT_PIN_CALLBACK_COUNT; ii++)
+        {
+            pin_ptr = &extintState.pinArr[ii];
+            if (pin_ptr->callbackPtr == NULL)
+            {
+                if (free_ptr == NULL)
+                {
+                    free_ptr = pin_ptr;
+                }
+            }
+            else if ((pin_ptr->port == port) && (pin_ptr->mask == mask))
+            {
+                result = EXTINT_ERR_IN_USE;
+            }
+        }
+        if ((result == EXTINT_OK) && (free_ptr == NULL))
+        {
+            result = EXTINT_ERR_NO_SLOT_FREE;
+        }
+        if (result == EXTINT_OK)
+        {
+            free_ptr->port = port;
+            free_ptr->mask = mask;
+            free_ptr->edge = edge;
+            free_ptr->optArgPtr = optArgPtr;
+            free_ptr->callbackPtr = callbackPtr;
+
+            // take over the current level of this pin only, so that pending
+            // changes of other pins of the port are not lost:
+            extintState.levelArr[port] = (extintState.levelArr[port] & ~mask)
+                                       | (extintReadPort(port) & mask);
+            *extintGetPcmsk(port) |= mask;
+            PCICR |= (1 << port);
+        }
+    }
+    return (result);
+}
+
+/*!
+*******************************************************************************
+** \brief   Disable the pin change interrupt of a pin and detach its
+**          callback.
+**
+** \param   port        The port of the pin.
+** \param   pinIdx      Index of the pin within the port (0 ... 7).
+**
+** \return
+**          - #EXTINT_OK on success.
+**          - #EXTINT_ERR_BAD_PARAMETER if a parameter is out of range.
+**          - #EXTINT_ERR_NOT_AVAILABLE if the vector of the port is not
+**              owned by EXTINT.
+**
+*******************************************************************************
+*/
+uint8_t EXTINT_DetachPin (EXTINT_PortT port, uint8_t pinIdx)
+{
+    volatile uint8_t* pcmsk_ptr;
+    extintPinT*       pin_ptr;
+    uint8_t           mask;
+    uint8_t           ii;
+
+    if ((port >= EXTINT_PortCount) || (pinIdx > 7))
+    {
+        return (EXTINT_ERR_BAD_PARAMETER);
+    }
+    if (!(EXTINT_PCINT_AVAILABLE & (1 << port)))
+    {
+        return (EXTINT_ERR_NOT_AVAILABLE);
+    }
+    mask = (1 << pinIdx);
+    pcmsk_ptr = extintGetPcmsk(port);
+
+    IRQ_GLOBAL_BLOCK(EXTINT_IRQ_SITE)
+    {
+        for (ii = 0; ii < EXTINT_PIN_CALLBACK_COUNT; ii++)
+        {
+            pin_ptr = &extintState.pinArr[ii];
+            if (pin_ptr->callbackPtr
+            &&  (pin_ptr->port == port)
+            &&  (pin_ptr->mask == mask))
+            {
+                pin_ptr->callbackPtr = NULL;
+            }
+        }
+        *pcmsk_ptr &= ~mask;
+        if (*pcmsk_ptr == 0)
+        {
+            PCICR &= ~(1 << port);
+        }
+    }
+    return (EXTINT_OK);
+}
+
+//*****************************************************************************
+//*********************** INTERRUPT SERVICE ROUTINES **************************
+//*****************************************************************************
+
+#if EXTINT_USE_INT0
+/*!
+*******************************************************************************
+** \brief   ISR for external interrupt 0.
+**
+*******************************************************************************
+*/
+ISR (INT0_vect, ISR_BLOCK)
+{
+    uint16_t timestamp = EXTINT_GET_TIMESTAMP;
+
+    extintDispatchInt(0, IS_HIGH(EXTINT_INT0_PIN), timestamp);
+}
+#endif // EXTINT_USE_INT0
+
+#if EXTINT_USE_INT1
+/*!
+*******************************************************************************
+** \brief   ISR for external interrupt 1.
+**
+*******************************************************************************
+*/
+ISR (INT1_vect, ISR_BLOCK)
+{
+    uint16_t timestamp = EXTINT_GET_TIMESTAMP;
+
+    extintDispatchInt(1, IS_HIGH(EXTINT_INT1_PIN), timestamp);
+}
+#endif // EXTINT_USE_INT1
+
+#if EXTINT_USE_INT2
+/*!
+*******************************************************************************
+** \brief   ISR for external interrupt 2.
+**
+*******************************************************************************
+*/
+ISR (INT2_vect, ISR_BLOCK)
+{
+    uint16_t timestamp = EXTINT_GET_TIMESTAMP;
+
+    extintDispatchInt(2, IS_HIGH(EXTINT_INT2_PIN), timestamp);
+}
+#endif // EXTINT_USE_INT2
+
+#if EXTINT_USE_PCINT0
+/*!
+*******************************************************************************
+** \brief   ISR for pin change interrupt 0 (port A).
+**
+*******************************************************************************
+*/
+ISR (PCINT0_vect, ISR_BLOCK)
+{
+    uint16_t timestamp = EXTINT_GET_TIMESTAMP;
+
+    extintDispatchPort(EXTINT_PortA, PINA, PCMSK0, timestamp);
+}
+#endif // EXTINT_USE_PCINT0
+
+#if EXTINT_USE_PCINT1
+/*!
+*******************************************************************************
+** \brief   ISR for pin change interrupt 1 (port B).
+**
+*******************************************************************************
+*/
+ISR (PCINT1_vect, ISR_BLOCK)
+{
+    uint16_t timestamp = EXTINT_GET_TIMESTAMP;
+
+    extintDispatchPort(EXTINT_PortB, PINB, PCMSK1, timestamp);
+}
+#endif // EXTINT_USE_PCINT1
+
+#if EXTINT_USE_PCINT2
+/*!
+*******************************************************************************
+** \brief   ISR for pin change interrupt 2 (port C).
+**
+*******************************************************************************
+*/
+ISR (PCINT2_vect, ISR_BLOCK)
+{
+    uint16_t timestamp = EXTINT_GET_TIMESTAMP;
+
+    extintDispatchPort(EXTINT_PortC, PINC, PCMSK2, timestamp);
+}
+#endif // EXTINT_USE_PCINT2
+
+#if EXTINT_USE_PCINT3
+/*!
+*******************************************************************************
+** \brief   ISR for pin change interrupt 3 (port D).
+**
+*******************************************************************************
+*/
+ISR (PCINT3_vect, ISR_BLOCK)
+{
+    uint16_t timestamp = EXTINT_GET_TIMESTAMP;
+
+    extintDispatchPort(EXTINT_PortD, PIND, PCMSK3, timestamp);
+}
+#endif // EXTINT_USE_PCINT3
@@ -0,0 +1,169 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   External and pin change interrupt manager
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#ifndef EXTINT_H
+#define EXTINT_H
+
+#include <stdint.h>
+
+//*****************************************************************************
+//*************************** DEFINES AND MACROS ******************************
+//*****************************************************************************
+
+/*! Set to 1 for each external interrupt vector INTn that shall be owned
+**  by the EXTINT driver. All vectors are disabled by default, since other
+**  drivers serve their interrupts themselves, e.g., the vector given by
+**  MCP2515_INTNO_MAIN. A vector must not be owned by two drivers. */
+#ifndef EXTINT_USE_INT0
+#define EXTINT_USE_INT0                 0
+#endif
+
+#ifndef EXTINT_USE_INT1
+#define EXTINT_USE_INT1                 0
+#endif
+
+#ifndef EXTINT_USE_INT2
+#define EXTINT_USE_INT2                 0
+#endif
+
+/*! Set to 1 for each pin change interrupt vector PCINTn that shall be owned
+**  by the EXTINT driver. PCINT0 ... PCINT3 serve the ports A ... D. */
+#ifndef EXTINT_USE_PCINT0
+#define EXTINT_USE_PCINT0               0
+#endif
+
+#ifndef EXTINT_USE_PCINT1
+#define EXTINT_USE_PCINT1               0
+#endif
+
+#ifndef EXTINT_USE_PCINT2
+#define EXTINT_USE_PCINT2               0
+#endif
+
+#ifndef EXTINT_USE_PCINT3
+#define EXTINT_USE_PCINT3               0
+#endif
+
+//! Maximum number of pins with pin change callbacks.
+#ifndef EXTINT_PIN_CALLBACK_COUNT
+#define EXTINT_PIN_CALLBACK_COUNT       8
+#endif
+
+/*! If set to 1, the value of #EXTINT_TIMESTAMP_COUNTER is captured at the
+**  beginning of each ISR and passed to the callbacks. The counter is
+**  typically the free-running counter of the timer that is also used by
+**  the runloop. */
+#ifndef EXTINT_WITH_TIMESTAMP
+#define EXTINT_WITH_TIMESTAMP           0
+#endif
+
+//! 16 bit counter register that provides the timestamps.
+#ifndef EXTINT_TIMESTAMP_COUNTER
+#define EXTINT_TIMESTAMP_COUNTER        TCNT1
+#endif
+
+//! Number of external interrupts INTn.
+#define EXTINT_INT_COUNT                3
+
+//! Critical section site of the driver, see IRQ_PROFILING.
+#ifndef EXTINT_IRQ_SITE
+#define EXTINT_IRQ_SITE                 (IRQ_SITE_BASE_DRIVER + 7)
+#endif
+
+//*****************************************************************************
+//************************* EXTINT SPECIFIC ERROR CODES ***********************
+//*****************************************************************************
+
+/*! EXTINT specific error base */
+#ifndef EXTINT_ERR_BASE
+#define EXTINT_ERR_BASE                 80
+#endif
+
+/*! EXTINT returns with no errors. */
+#define EXTINT_OK                       0
+
+/*! A bad parameter has been passed. */
+#define EXTINT_ERR_BAD_PARAMETER        EXTINT_ERR_BASE + 0
+
+/*! The vector of the interrupt is not owned by the EXTINT driver. */
+#define EXTINT_ERR_NOT_AVAILABLE        EXTINT_ERR_BASE + 1
+
+/*! A callback has already been attached to the interrupt or pin. */
+#define EXTINT_ERR_IN_USE               EXTINT_ERR_BASE + 2
+
+/*! All pin callback slots are in use. */
+#define EXTINT_ERR_NO_SLOT_FREE         EXTINT_ERR_BASE + 3
+
+//*****************************************************************************
+//******************************** DATA TYPES *********************************
+//*****************************************************************************
+
+/*! Interrupt sense control of the external interrupts INTn. The values
+**  correspond to the ISCn1 and ISCn0 bits in EICRA. */
+typedef enum
+{
+    EXTINT_Sense_LowLevel = 0,
+    EXTINT_Sense_AnyEdge,
+    EXTINT_Sense_FallingEdge,
+    EXTINT_Sense_RisingEdge
+} EXTINT_SenseT;
+
+/*! Edges that trigger a pin callback. Pin change interrupts fire on both
+**  edges, the edge is decoded from the pin level. */
+typedef enum
+{
+    EXTINT_Edge_Rising = 1,
+    EXTINT_Edge_Falling,
+    EXTINT_Edge_Any
+} EXTINT_EdgeT;
+
+//! Ports with pin change interrupts.
+typedef enum
+{
+    EXTINT_PortA = 0,
+    EXTINT_PortB,
+    EXTINT_PortC,
+    EXTINT_PortD,
+    EXTINT_PortCount
+} EXTINT_PortT;
+
+/*! Callback that is executed from within the ISR.
+**
+**  \param  level       Level of the pin after the edge (0 or 1).
+**  \param  timestamp   Value of #EXTINT_TIMESTAMP_COUNTER at the beginning of
+**                      the ISR, 0 if EXTINT_WITH_TIMESTAMP is disabled.
+**  \param  optArgPtr   The argument that has been passed when attaching.
+*/
+typedef void (*EXTINT_CallbackT) (uint8_t level,
+                                  uint16_t timestamp,
+                                  void* optArgPtr);
+
+//*****************************************************************************
+//************************* FUNCTION DECLARATIONS *****************************
+//*****************************************************************************
+
+uint8_t EXTINT_AttachInt (uint8_t intNo,
+                          EXTINT_SenseT sense,
+                          EXTINT_CallbackT callbackPtr,
+                          void* optArgPtr);
+uint8_t EXTINT_DetachInt (uint8_t intNo);
+uint8_t EXTINT_AttachPin (EXTINT_PortT port,
+                          uint8_t pinIdx,
+                          EXTINT_EdgeT edge,
+                          EXTINT_CallbackT callbackPtr,
+                          void* optArgPtr);
+uint8_t EXTINT_DetachPin (EXTINT_PortT port, uint8_t pinIdx);
+
+#endif // EXTINT_H
@@ -0,0 +1,218 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   Common critical section primitives for AVR3nk drivers and
+**          subsystems.
+**
+**          The inline primitives are implemented in irq.h. This file holds
+**          the nesting counter for IRQ_Lock() and IRQ_Unlock() as well as the
+**          optional profiling of critical section durations.
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#include <stdint.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include "irq.h"
+
+//*****************************************************************************
+//*************************** DEFINES AND MACROS ******************************
+//*****************************************************************************
+
+
+//*****************************************************************************
+//**************************** LOCAL DATA TYPES *******************************
+//*****************************************************************************
+
+
+//*****************************************************************************
+//**************************** LOCAL VARIABLES ********************************
+//*****************************************************************************
+
+//! Nesting depth of IRQ_Lock() calls.
+static volatile uint8_t irqLockNesting = 0;
+
+//! SREG as saved by the outermost IRQ_Lock() call.
+static volatile uint8_t irqLockSreg = 0;
+
+#if IRQ_PROFILING
+//! Counter values at the start of the currently entered sections.
+static uint16_t irqStartTicksArr[IRQ_PROFILING_DEPTH];
+
+//! Number of currently entered sections.
+static uint8_t irqProfileDepth = 0;
+
+//! Longest section duration of each kind and site.
+static volatile uint16_t irqMaxTicksArr[IRQ_SECTION_KIND_COUNT][IRQ_SITE_COUNT];
+#endif // IRQ_PROFILING
+
+//*****************************************************************************
+//*************************** PUBLIC FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   Disable all interrupts. Calls may be nested. Interrupts are
+**          restored to their previous state by the IRQ_Unlock() call that
+**          matches the outermost IRQ_Lock() call.
+**
+*******************************************************************************
+*/
+void IRQ_Lock (void)
+{
+    uint8_t sreg_save;
+
+    sreg_save = SREG;
+    cli();
+    if (irqLockNesting == 0)
+    {
+        irqLockSreg = sreg_save;
+    }
+    irqLockNesting++;
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Release a lock that has been acquired by IRQ_Lock().
+**
+*******************************************************************************
+*/
+void IRQ_Unlock (void)
+{
+    if (irqLockNesting == 0)
+    {
+        return;
+    }
+    irqLockNesting--;
+    if (irqLockNesting == 0)
+    {
+        __asm__ __volatile__ ("" ::: "memory");
+        SREG = irqLockSreg;
+    }
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Get the current nesting depth of IRQ_Lock() calls.
+**
+** \return  The number of IRQ_Lock() calls without matching IRQ_Unlock().
+**
+*******************************************************************************
+*/
+uint8_t IRQ_GetLockNesting (void)
+{
+    return (irqLockNesting);
+}
+
+#if IRQ_PROFILING
+
+/*!
+*******************************************************************************
+** \brief   Record the start of a critical section. Must be called with
+**          interrupts disabled.
+**
+*******************************************************************************
+*/
+void IRQ_ProfileStart (void)
+{
+    if (irqProfileDepth < IRQ_PROFILING_DEPTH)
+    {
+        irqStartTicksArr[irqProfileDepth] = IRQ_PROFILING_COUNTER;
+    }
+    if (irqProfileDepth < UINT8_MAX)
+    {
+        irqProfileDepth++;
+    }
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Record the end of the innermost critical section and update the
+**          maximum duration of the site. Must be called with interrupts
+**          disabled.
+**
+** \param   site    Call site identifier.
+** \param   kind    Kind of the section.
+**
+*******************************************************************************
+*/
+void IRQ_ProfileStop (IRQ_SiteT site, IRQ_SectionT kind)
+{
+    uint16_t ticks;
+
+    if (irqProfileDepth == 0)
+    {
+        return;
+    }
+    irqProfileDepth--;
+    if ((irqProfileDepth < IRQ_PROFILING_DEPTH)
+    &&  (site < IRQ_SITE_COUNT)
+    &&  (kind < IRQ_SECTION_KIND_COUNT))
+    {
+        ticks = IRQ_PROFILING_COUNTER - irqStartTicksArr[irqProfileDepth];
+        if (ticks > irqMaxTicksArr[kind][site])
+        {
+            irqMaxTicksArr[kind][site] = ticks;
+        }
+    }
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Get the longest critical section duration of a site.
+**
+** \param   site    Call site identifier.
+** \param   kind    Kind of the sections, i.e., global or masked.
+**
+** \return  Duration in ticks of #IRQ_PROFILING_COUNTER.
+**
+*******************************************************************************
+*/
+uint16_t IRQ_GetMaxTicks (IRQ_SiteT site, IRQ_SectionT kind)
+{
+    uint16_t ticks = 0;
+
+    if ((site < IRQ_SITE_COUNT) && (kind < IRQ_SECTION_KIND_COUNT))
+    {
+        IRQ_GLOBAL_BLOCK(IRQ_SITE_NONE)
+        {
+            ticks = irqMaxTicksArr[kind][site];
+        }
+    }
+    return (ticks);
+}
+
+/*!
+*******************************************************************************
+** \brief   Reset the recorded durations of all sites.
+**
+*******************************************************************************
+*/
+void IRQ_ResetStatistics (void)
+{
+    uint8_t idx;
+
+    IRQ_GLOBAL_BLOCK(IRQ_SITE_NONE)
+    {
+        for (idx = 0; idx < IRQ_SITE_COUNT; idx++)
+        {
+            irqMaxTicksArr[IRQ_SECTION_GLOBAL][idx] = 0;
+            irqMaxTicksArr[IRQ_SECTION_MASK][idx] = 0;
+        }
+    }
+    return;
+}
+
+#endif // IRQ_PROFILING
@@ -0,0 +1,279 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   Common critical section primitives for AVR3nk drivers and
+**          subsystems.
+**
+**          Three kinds of critical sections are provided:
+**          - Global sections save SREG, disable all interrupts and restore
+**            SREG on exit (IRQ_EnterGlobal(), IRQ_LeaveGlobal() and the
+**            IRQ_GLOBAL_BLOCK() statement).
+**          - Masked sections disable only the interrupt sources given by a
+**            bit mask within an interrupt mask register and restore the
+**            previous enable bits on exit (IRQ_EnterMask(), IRQ_LeaveMask()).
+**          - Nested locks disable all interrupts on the outermost
+**            IRQ_Lock() and restore SREG on the matching IRQ_Unlock().
+**
+**          Every section is tagged with an IRQ_SiteT identifier. Clients
+**          define their own site IDs in their headers as an offset to
+**          IRQ_SITE_BASE_DRIVER, IRQ_SITE_BASE_SUBSYSTEM or IRQ_SITE_BASE_APP.
+**          If IRQ_PROFILING is set to 1, the longest duration of global and
+**          masked sections is recorded separately per site in ticks of
+**          IRQ_PROFILING_COUNTER. Note that interrupts which are not masked
+**          keep running during masked sections.
+**
+**          Sections may be nested and interrupted by ISRs which enter
+**          sections of their own, but must be left in the reverse order of
+**          entering them.
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#ifndef IRQ_H
+#define IRQ_H
+
+#include <stdint.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+
+//*****************************************************************************
+//*************************** DEFINES AND MACROS ******************************
+//*****************************************************************************
+
+/*! Set to 1 in order to measure the longest duration of critical sections
+**  per call site. Adds a few cycles to each critical section. */
+#ifndef IRQ_PROFILING
+#define IRQ_PROFILING                       0
+#endif
+
+/*! Free-running 16 bit counter which is used for profiling, typically the
+**  TCNT1 register of a timer that is run by the application without
+**  overflow interrupt. Durations are reported in ticks of this counter. */
+#ifndef IRQ_PROFILING_COUNTER
+#define IRQ_PROFILING_COUNTER               TCNT1
+#endif
+
+/*! Number of site IDs for which profiling results are recorded. Sections
+**  of sites with higher IDs are not profiled. */
+#ifndef IRQ_SITE_COUNT
+#define IRQ_SITE_COUNT                      32
+#endif
+
+/*! Maximum nesting depth of profiled sections, including sections entered
+**  by ISRs. Deeper sections are not profiled. */
+#ifndef IRQ_PROFILING_DEPTH
+#define IRQ_PROFILING_DEPTH                 8
+#endif
+
+//! Base of the site IDs of drivers.
+#define IRQ_SITE_BASE_DRIVER                0
+
+//! Base of the site IDs of subsystems.
+#define IRQ_SITE_BASE_SUBSYSTEM             16
+
+//! Base of the site IDs of applications.
+#define IRQ_SITE_BASE_APP                   24
+
+//! Site ID of sections which are not profiled.
+#define IRQ_SITE_NONE                       0xFF
+
+/*!
+*******************************************************************************
+** \brief   Executes the following block as a global critical section.
+**
+**          The statement works like ATOMIC_BLOCK(ATOMIC_RESTORESTATE) from
+**          avr-libc, i.e., SREG is restored also when the block is left
+**          through a return statement. In addition, the duration of the
+**          block is profiled for the given site if IRQ_PROFILING is set.
+**
+*******************************************************************************
+*/
+#define IRQ_GLOBAL_BLOCK(site)                                              \
+    for (uint16_t irq_block_state                                           \
+             __attribute__((__cleanup__(IRQ_LeaveGlobalBlock))) =           \
+             IRQ_EnterGlobalBlock(site),                                    \
+         irq_block_once = 1;                                                \
+         irq_block_once;                                                    \
+         irq_block_once = 0)
+
+//*****************************************************************************
+//******************************** DATA TYPES *********************************
+//*****************************************************************************
+
+/*! State that is returned when entering a critical section and that must be
+**  passed back when leaving it. */
+typedef uint8_t IRQ_StateT;
+
+/*! Identifier of the call site of a critical section. Profiling results are
+**  recorded separately for each site. */
+typedef uint8_t IRQ_SiteT;
+
+//! Kinds of critical sections which are profiled separately.
+typedef enum
+{
+    IRQ_SECTION_GLOBAL = 0, //!< all interrupts disabled
+    IRQ_SECTION_MASK,       //!< particular interrupt sources masked
+    IRQ_SECTION_KIND_COUNT
+} IRQ_SectionT;
+
+//*****************************************************************************
+//************************* FUNCTION DECLARATIONS *****************************
+//*****************************************************************************
+
+void     IRQ_Lock (void);
+void     IRQ_Unlock (void);
+uint8_t  IRQ_GetLockNesting (void);
+
+#if IRQ_PROFILING
+void     IRQ_ProfileStart (void);
+void     IRQ_ProfileStop (IRQ_SiteT site, IRQ_SectionT kind);
+uint16_t IRQ_GetMaxTicks (IRQ_SiteT site, IRQ_SectionT kind);
+void     IRQ_ResetStatistics (void);
+#endif // IRQ_PROFILING
+
+//*****************************************************************************
+//*************************** INLINE FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   Enter a global critical section.
+**
+** \param   site    Call site identifier used for profiling.
+**
+** \return  The saved SREG, which must be passed to IRQ_LeaveGlobal().
+**
+*******************************************************************************
+*/
+static inline IRQ_StateT IRQ_EnterGlobal (IRQ_SiteT site)
+{
+    IRQ_StateT sreg_save;
+
+    sreg_save = SREG;
+    cli();
+#if IRQ_PROFILING
+    IRQ_ProfileStart();
+#endif // IRQ_PROFILING
+    (void)site;
+    return (sreg_save);
+}
+
+/*!
+*******************************************************************************
+** \brief   Leave a global critical section.
+**
+** \param   site    Call site identifier used for profiling.
+** \param   state   The state returned by IRQ_EnterGlobal().
+**
+*******************************************************************************
+*/
+static inline void IRQ_LeaveGlobal (IRQ_SiteT site, IRQ_StateT state)
+{
+#if IRQ_PROFILING
+    IRQ_ProfileStop(site, IRQ_SECTION_GLOBAL);
+#else
+    (void)site;
+#endif // IRQ_PROFILING
+    // Keep accesses to protected data inside the section, see ATOMIC_BLOCK:
+    __asm__ __volatile__ ("" ::: "memory");
+    SREG = state;
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Enter a critical section by masking particular interrupt sources.
+**
+**          The mask register is modified with interrupts disabled for a few
+**          cycles, so that concurrent modifications of other bits in the
+**          same register by ISRs cannot get lost.
+**
+** \param   site        Call site identifier used for profiling.
+** \param   maskRegPtr  Points to the interrupt mask register, e.g., EIMSK.
+** \param   maskBits    The enable bits that will be cleared.
+**
+** \return  The previous state of the enable bits given by maskBits,
+**          which must be passed to IRQ_LeaveMask().
+**
+*******************************************************************************
+*/
+static inline IRQ_StateT IRQ_EnterMask (IRQ_SiteT site,
+                                        volatile uint8_t* maskRegPtr,
+                                        uint8_t maskBits)
+{
+    IRQ_StateT enabled;
+    uint8_t    sreg_save;
+
+    sreg_save = SREG;
+    cli();
+    enabled = *maskRegPtr & maskBits;
+    *maskRegPtr &= ~maskBits;
+#if IRQ_PROFILING
+    IRQ_ProfileStart();
+#endif // IRQ_PROFILING
+    (void)site;
+    SREG = sreg_save;
+    return (enabled);
+}
+
+/*!
+*******************************************************************************
+** \brief   Leave a masked critical section.
+**
+** \param   site        Call site identifier used for profiling.
+** \param   maskRegPtr  Points to the interrupt mask register.
+** \param   state       The enable bits that will be set again, typically
+**                      the value returned by IRQ_EnterMask().
+**
+*******************************************************************************
+*/
+static inline void IRQ_LeaveMask (IRQ_SiteT site,
+                                  volatile uint8_t* maskRegPtr,
+                                  IRQ_StateT state)
+{
+    uint8_t sreg_save;
+
+    sreg_save = SREG;
+    cli();
+#if IRQ_PROFILING
+    IRQ_ProfileStop(site, IRQ_SECTION_MASK);
+#else
+    (void)site;
+#endif // IRQ_PROFILING
+    *maskRegPtr |= state;
+    SREG = sreg_save;
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Helper for IRQ_GLOBAL_BLOCK(), do not call directly.
+**
+*******************************************************************************
+*/
+static inline uint16_t IRQ_EnterGlobalBlock (IRQ_SiteT site)
+{
+    return (((uint16_t)site << 8) | IRQ_EnterGlobal(site));
+}
+
+/*!
+*******************************************************************************
+** \brief   Helper for IRQ_GLOBAL_BLOCK(), do not call directly.
+**
+*******************************************************************************
+*/
+static inline void IRQ_LeaveGlobalBlock (const uint16_t* statePtr)
+{
+    IRQ_LeaveGlobal((IRQ_SiteT)(*statePtr >> 8), (IRQ_StateT)*statePtr);
+    __asm__ volatile ("" ::: "memory");
+    return;
+}
+
+#endif // IRQ_H
@@ -24,6 +24,7 @@
 #include <util/delay.h>
 #include <drivers/macros_pin.h>
 #include <drivers/spi_m.h>
+#include <drivers/irq.h>
 
 #if MCP2515_DEBUG
 #include <stdio.h>
@@ -33,18 +34,27 @@
 //*************************** DEFINES AND MACROS ******************************
 //*****************************************************************************
 
-// Critical Section handling by disabling the corresponding interrupts:
+// Critical Section handling by disabling the corresponding interrupts and
+// locking the SPI against other bus users. The enable bits which were set
+// before entering are restored on leaving:
 #if MCP2515_USE_RX_INT
-#define MCP2515_ENTER_CS    EIMSK &= ~((1 << MCP2515_INTNO_MAIN) | \
-                                       (1 << MCP2515_INTNO_RXB0) | \
-                                       (1 << MCP2515_INTNO_RXB1))
-#define MCP2515_LEAVE_CS    EIMSK |=  ((1 << MCP2515_INTNO_MAIN) | \
-                                       (mcp2515State.rxIrqEnable << MCP2515_INTNO_RXB0) | \
-                                       (mcp2515State.rxIrqEnable << MCP2515_INTNO_RXB1))
+#define MCP2515_CS_MASK     ((1 << MCP2515_INTNO_MAIN) | \
+                             (1 << MCP2515_INTNO_RXB0) | \
+                             (1 << MCP2515_INTNO_RXB1))
 #else
-#define MCP2515_ENTER_CS    EIMSK &= ~(1 << MCP2515_INTNO_MAIN)
-#define MCP2515_LEAVE_CS    EIMSK |=  (1 << MCP2515_INTNO_MAIN)
+#define MCP2515_CS_MASK     (1 << MCP2515_INTNO_MAIN)
 #endif // MCP2515_USE_RX_INT
+#define MCP2515_ENTER_CS    mcp2515EnterCs()
+#define MCP2515_LEAVE_CS(state) \
+                            mcp2515LeaveCs(state)
+
+// Received frames are only read if someone is interested in them:
+#if MCP2515_WITH_RTR_RESPONDER
+#define MCP2515_RX_REQUIRED (mcp2515RxCallback || mcp2515RawRxCallback || \
+                             mcp2515ResponderCount)
+#else
+#define MCP2515_RX_REQUIRED (mcp2515RxCallback || mcp2515RawRxCallback)
+#endif // MCP2515_WITH_RTR_RESPONDER
 
 // Debugging print:
 #if MCP2515_DEBUG
@@ -85,6 +95,27 @@
 #define MCP2515_INT_RXB1_vect BADISR_vect
 #endif
 
+// The vectors above must not be owned by the EXTINT driver as well. Its
+// EXTINT_USE_INTn switches are 0 unless the application enables them:
+#define MCP2515_OWNS_INT(n) ((MCP2515_INTNO_MAIN == (n)) ||          \
+                             (MCP2515_USE_RX_INT &&                  \
+                              ((MCP2515_INTNO_RXB0 == (n)) ||        \
+                               (MCP2515_INTNO_RXB1 == (n)))))
+
+#if EXTINT_USE_INT0 && MCP2515_OWNS_INT(0)
+#error "INT0 is served by the MCP2515 driver, set EXTINT_USE_INT0 to 0"
+#endif
+#if EXTINT_USE_INT1 && MCP2515_OWNS_INT(1)
+#error "INT1 is served by the MCP2515 driver, set EXTINT_USE_INT1 to 0"
+#endif
+#if EXTINT_USE_INT2 && MCP2515_OWNS_INT(2)
+#error "INT2 is served by the MCP2515 driver, set EXTINT_USE_INT2 to 0"
+#endif
+
+#if MCP2515_ISR_FRAME_BUDGET < 1
+#error "MCP2515_ISR_FRAME_BUDGET must be at least 1"
+#endif
+
 //******** ATmega16 setup ********
 
 #ifdef atmega16
@@ -113,6 +144,7 @@
 //*****************************************************************************
 
 static MCP2515_RxCallbackT    mcp2515RxCallback           = NULL;
+static MCP2515_RawRxCallbackT mcp2515RawRxCallback        = NULL;
 static MCP2515_TxCallbackT    mcp2515TxCallback           = NULL;
 
 #if MCP2515_ERROR_CALLBACK_SUPPORT
@@ -121,6 +153,11 @@ static MCP2515_VoidCallbackT  mcp2515WakeupCallback       = NULL;
 static MCP2515_ErrorCallbackT mcp2515ErrorCallback        = NULL;
 #endif // MCP2515_ERROR_CALLBACK_SUPPORT
 
+#if MCP2515_WITH_RTR_RESPONDER
+static MCP2515_RtrResponderT* mcp2515ResponderArr         = NULL;
+static uint8_t                mcp2515ResponderCount       = 0;
+#endif // MCP2515_WITH_RTR_RESPONDER
+
 //! Internal state of the MCP2515 driver.
 static struct
 {
@@ -135,6 +172,8 @@ static struct
 //********************** LOCAL FUNCTION DECLARATIONS **************************
 //*****************************************************************************
 
+static inline IRQ_StateT mcp2515EnterCs(void);
+static inline void mcp2515LeaveCs(IRQ_StateT irqState);
 static inline void mcp2515CmdReadAddressBurst (uint8_t address, uint8_t num, uint8_t* destPtr);
 static inline void mcp2515CmdWriteAddressBurst(uint8_t address, uint8_t num, uint8_t* srcPtr);
 static inline void mcp2515CmdBitModify(uint8_t address, uint8_t mask, uint8_t data);
@@ -148,10 +187,63 @@ static void mcp2515SetHeaderFormat(uint8_t address, \
 static void mcp2515SetHeaderFormat(uint8_t address, uint16_t sid);
 #endif // MCP2515_CAN_2_B_SUPPORT
 
+static void mcp2515ReadRxBuffer(uint8_t readCommand, \
+                                MCP2515_CanMessageT* msgPtr);
+static void mcp2515ReadRawRxBuffer(uint8_t readCommand, \
+                                   MCP2515_RawMessageT* msgPtr);
+static MCP2515_TxBufferIdT mcp2515Transmit(MCP2515_CanMessageT* messagePtr, \
+                                           MCP2515_RawMessageT* rawPtr, \
+                                           MCP2515_TxParamsT txParams);
+static IRQ_StateT mcp2515UpdateRxIrq(IRQ_StateT irqState);
+#if MCP2515_WITH_RTR_RESPONDER
+static uint8_t mcp2515IsSameId(const MCP2515_CanMessageT* aPtr, \
+                               const MCP2515_CanMessageT* bPtr);
+static uint8_t mcp2515AnswerRemoteFrame(const MCP2515_CanMessageT* msgPtr);
+#endif // MCP2515_WITH_RTR_RESPONDER
+static void mcp2515ReceiveFrame(uint8_t readCommand);
+static uint8_t mcp2515HandleInterrupt(void);
+
 //*****************************************************************************
 //**************************** LOCAL FUNCTIONS ********************************
 //*****************************************************************************
 
+/*!
+*******************************************************************************
+** \brief   Enter the critical section of the driver.
+**
+**          The interrupts are masked before the SPI is locked, so the lock
+**          saves them as disabled. Hence, modifications of the returned
+**          state, see mcp2515UpdateRxIrq(), are not overridden on unlock.
+**
+** \return  The state to pass to mcp2515LeaveCs().
+**
+*******************************************************************************
+*/
+static inline IRQ_StateT mcp2515EnterCs(void)
+{
+    IRQ_StateT irq_state;
+
+    irq_state = IRQ_EnterMask(MCP2515_IRQ_SITE, &EIMSK, MCP2515_CS_MASK);
+    SPI_M_Lock();
+    return (irq_state);
+}
+
+/*!
+*******************************************************************************
+** \brief   Leave the critical section of the driver.
+**
+** \param   irqState
+**              The state returned by mcp2515EnterCs().
+**
+*******************************************************************************
+*/
+static inline void mcp2515LeaveCs(IRQ_StateT irqState)
+{
+    SPI_M_Unlock();
+    IRQ_LeaveMask(MCP2515_IRQ_SITE, &EIMSK, irqState);
+    return;
+}
+
 /*!
 *******************************************************************************
 ** \brief   Read registers from the MCP2515.
@@ -307,169 +399,743 @@ static void mcp2515SetHeaderFormat(uint8_t address, uint16_t sid)
 }
 #endif // MCP2515_CAN_2_B_SUPPORT
 
-
-//*****************************************************************************
-//*************************** PUBLIC FUNCTIONS ********************************
-//*****************************************************************************
-
 /*!
 *******************************************************************************
-** \brief   Initializes the MCP2515 hardware with given parameters.
+** \brief   Read a received frame from a receive buffer of the MCP2515.
 **
-** \param   initParamsPtr
-**              Points to a structure with all required initialization
-**              parameters.
+**          CANINTF.RXnIF is cleared automatically when CS is raised
+**          (see MCP2515-I-P.pdf 12.4).
 **
-** \return
-**          - #MCP2515_OK on success.
-**          - #MCP2515_ERR_ALREADY_INITIALIZED if the driver has already
-**              been initialized.
-**          - #MCP2515_ERR_SPI_NOT_INITIALIZED if the SPI driver is not
-**              initialized.
-**          - #MCP2515_ERR_VERIFY_FAIL if the verification
-**              of the MCP2515_CNF1 register failed.
+** \param   readCommand
+**              MCP2515_SPI_READ_RXB0SIDH or MCP2515_SPI_READ_RXB1SIDH.
+** \param   msgPtr
+**              Receives the frame.
 **
 *******************************************************************************
 */
-uint8_t MCP2515_Init(const MCP2515_InitParamsT* initParamsPtr)
+static void mcp2515ReadRxBuffer(uint8_t readCommand, \
+                                MCP2515_CanMessageT* msgPtr)
 {
-    uint8_t val;
+    uint8_t tmp;
 
-    if(mcp2515State.initialized)
+    SET_LOW(MCP2515_CS);
+    (void)SPI_M_Transceive(readCommand);
+#if MCP2515_CAN_2_B_SUPPORT
+    msgPtr->sid  = ((uint32_t)SPI_M_Transceive(0xFF)) << 3; // SIDH
+    tmp = SPI_M_Transceive(0xFF); // SIDL
+    msgPtr->sid |= (uint32_t) (tmp >> 5);
+    if(tmp & (1 << MCP2515_IDE))
     {
-        return(MCP2515_ERR_ALREADY_INITIALIZED);
+        // extended frame
+        msgPtr->ief  = 1;
+        msgPtr->eid  = ((uint32_t) (tmp & 0x03)) << 16;
+        msgPtr->eid |= ((uint32_t) SPI_M_Transceive(0xFF)) << 8; // EIDH
+        msgPtr->eid |= (uint32_t) SPI_M_Transceive(0xFF); // EIDL
+        tmp = SPI_M_Transceive(0xFF); // DLC
+        msgPtr->rtr  = (tmp & (1 << MCP2515_RTR)) ? 1 : 0;
+        msgPtr->dlc  = tmp & 0x0F;
     }
-    // Disable interrupt(s):
-    EIMSK &= ~(1 << MCP2515_INTNO_MAIN);
-#if MCP2515_USE_RX_INT
-    EIMSK &= ~((1 << MCP2515_INTNO_RXB0) | (1 << MCP2515_INTNO_RXB1));
-#endif // MCP2515_USE_RX_INT
-
-    // Initialize state variable:
-    memset(&mcp2515State, 0, sizeof(mcp2515State));
-
-    // initialize SPI
-    if(initParamsPtr->initSPI)
+    else
     {
-        (void)SPI_M_Init(MCP2515_SPI_CLOCK_DIVIDER,   \
-                         MCP2515_SPI_DATA_ORDER,      \
-                         MCP2515_SPI_CLOCK_PARITY,    \
-                         MCP2515_SPI_CLOCK_PHASE);
+        // standard frame
+        msgPtr->ief  = 0;
+        msgPtr->rtr  = (tmp & (1 << MCP2515_SRR)) ? 1 : 0;
+        (void)SPI_M_Transceive(0xFF); // EIDH
+        (void)SPI_M_Transceive(0xFF); // EIDL
+        msgPtr->dlc  = SPI_M_Transceive(0xFF) & 0x0F; // DLC
     }
-
-    // check if SPI is initialized:
-    if(!SPI_M_IsInitialized())
+#else // CAN 2.0A only
+    msgPtr->sid  = ((uint16_t) SPI_M_Transceive(0xFF)) << 3; // SIDH
+    tmp = SPI_M_Transceive(0xFF); // SIDL
+    msgPtr->sid |= (uint16_t) (tmp >> 5);
+    msgPtr->rtr  = (uint16_t) ((tmp & (1 << MCP2515_SRR)) ? 1 : 0);
+    (void)SPI_M_Transceive(0xFF); // EIDH
+    (void)SPI_M_Transceive(0xFF); // EIDL
+    msgPtr->dlc  = (uint16_t) (SPI_M_Transceive(0xFF) & 0x0F); // DLC
+#endif // MCP2515_CAN_2_B_SUPPORT
+    if(msgPtr->rtr == 0)
     {
-        return(MCP2515_ERR_SPI_NOT_INITIALIZED);
+        for(tmp = 0; tmp < msgPtr->dlc; tmp++)
+        {
+            msgPtr->dataArray[tmp] = SPI_M_Transceive(0xFF);
+        }
     }
-
-    // set up CS line:
-    SET_OUTPUT(MCP2515_CS);
     SET_HIGH(MCP2515_CS);
+    return;
+}
 
-    // reset the MCP2515 and enter configuration mode
-    // see MCP2515-I-P.pdf chapter 9.0 for RESET pin
-    _delay_us(10);
-    SET_LOW(MCP2515_CS);
-    (void)SPI_M_Transceive(MCP2515_SPI_RESET);
-    SET_HIGH(MCP2515_CS);
-    _delay_us(10);
+/*!
+*******************************************************************************
+** \brief   Read a received frame in the register layout from a receive
+**          buffer of the MCP2515 (see mcp2515ReadRxBuffer()).
+**
+**          The header and the data are read in block transfers. For
+**          standard frames, the remote flag SIDL.SRR is copied to DLC.RTR.
+**
+*******************************************************************************
+*/
+static void mcp2515ReadRawRxBuffer(uint8_t readCommand, \
+                                   MCP2515_RawMessageT* msgPtr)
+{
+    uint8_t tmp;
 
-    // set up bit timing configuration registers:
-    // set up CNF1:
-    val  = ((uint8_t)initParamsPtr->synchronisationJumpWidth) << 6;
-    val |= initParamsPtr->baudRatePrescaler;
-    mcp2515CmdWriteAddressBurst(MCP2515_CNF1, 1, &val);
-    // set up CNF2:
-    val  = (1 << MCP2515_BTLMODE); // see MCP2515-I-P.pdf 5.5
-    val |= ((uint8_t)initParamsPtr->samplePointCount) << 6;
-    val |= ((uint8_t)initParamsPtr->phaseSegment1Length) << 3;
-    val |= ((uint8_t)initParamsPtr->propagationSegmentLength);
-    mcp2515CmdWriteAddressBurst(MCP2515_CNF2, 1, &val);
-    // set up CNF3:
-    val  = ((uint8_t)initParamsPtr->wakeupLowPassFilter) << 6;
-    val |= ((uint8_t)initParamsPtr->phaseSegment2Length);
-    mcp2515CmdWriteAddressBurst(MCP2515_CNF3, 1, &val);
-    // Verify CNF1 register:
-    mcp2515CmdReadAddressBurst(MCP2515_CNF1, 1, &val);
-    if(val != ((((uint8_t)initParamsPtr->synchronisationJumpWidth) << 6) | \
-               initParamsPtr->baudRatePrescaler))
+    SET_LOW(MCP2515_CS);
+    (void)SPI_M_Transceive(readCommand);
+    SPI_M_ReceiveBlock(&msgPtr->sidh, 5); // SIDH, SIDL, EIDH, EIDL, DLC
+    if(!(msgPtr->sidl & (1 << MCP2515_IDE)))
     {
-#if MCP2515_DEBUG
-        printf("CNF1 = 0x%02x\n", val);
-        printf("expected: 0x%02x\n", \
-              ((((uint8_t)initParamsPtr->synchronisationJumpWidth) << 6) | \
-               initParamsPtr->baudRatePrescaler));
-#endif // MCP2515_DEBUG
-        return(MCP2515_ERR_VERIFY_FAIL);
+        // standard frame: the remote flag is SIDL.SRR
+        msgPtr->dlc &= ~(1 << MCP2515_RTR);
+        if(msgPtr->sidl & (1 << MCP2515_SRR))
+        {
+            msgPtr->dlc |= (1 << MCP2515_RTR);
+        }
     }
-    if(mcp2515RxCallback)
+    if(!(msgPtr->dlc & (1 << MCP2515_RTR)))
     {
-        mcp2515State.rxIrqEnable = 1;
+        tmp = msgPtr->dlc & 0x0F;
+        SPI_M_ReceiveBlock(msgPtr->dataArray, (tmp > 8) ? 8 : tmp);
     }
+    SET_HIGH(MCP2515_CS);
+    return;
+}
 
-    // enable interrupts: see MCP2515-I-P.pdf chapter 7
-    val = 0x00;
-#if MCP2515_ERROR_CALLBACK_SUPPORT
-    if(mcp2515MessageErrorCallback)
+/*!
+*******************************************************************************
+** \brief   Load a message into one of the given transmit buffers and
+**          request its transmission (see MCP2515_Transmit()).
+**
+** \param   messagePtr
+**              The decoded message, only used if rawPtr is NULL.
+** \param   rawPtr
+**              The message in the register layout, may be NULL.
+**
+** \sa      MCP2515-I-P.pdf 12.8
+**
+*******************************************************************************
+*/
+static MCP2515_TxBufferIdT mcp2515Transmit(MCP2515_CanMessageT* messagePtr, \
+                                           MCP2515_RawMessageT* rawPtr, \
+                                           MCP2515_TxParamsT txParams)
+{
+    uint8_t val, command, ii;
+    MCP2515_TxPriorityT current_prio;
+    IRQ_StateT irq_state;
+
+    // check if driver is initialized:
+    if(mcp2515State.initialized == 0)
     {
-        val |= (1 << MCP2515_MERRE);
+        return 0;
     }
-    if(mcp2515WakeupCallback)
+
+    // read status bits:
+    irq_state = MCP2515_ENTER_CS;
+    SET_LOW(MCP2515_CS);
+    (void)SPI_M_Transceive(MCP2515_SPI_READ_STATUS);
+    val = SPI_M_Transceive(0xFF);
+    SET_HIGH(MCP2515_CS);
+
+    // see MCP2515-I-P.pdf figure 12.8 for bit assignments
+    if ((txParams.bufferId & MCP2515_TX_BUFFER_2) && \
+        ((val & (1 << MCP2515_RS_TX2REQ)) == 0))
     {
-        val |=  (1 << MCP2515_WAKIE);
+        val = MCP2515_TX_BUFFER_2; // tx buffer index
+        current_prio = mcp2515State.txb2Priority;
+        command = MCP2515_SPI_WRITE_TXB2SIDH;
     }
-    if(mcp2515ErrorCallback)
+    else if ((txParams.bufferId & MCP2515_TX_BUFFER_1) && \
+             ((val & (1 << MCP2515_RS_TX1REQ)) == 0))
     {
-        val |= (1 << MCP2515_ERRIE);
+        val = MCP2515_TX_BUFFER_1; // tx buffer index
+        current_prio = mcp2515State.txb1Priority;
+        command = MCP2515_SPI_WRITE_TXB1SIDH;
     }
-#endif // MCP2515_ERROR_CALLBACK_SUPPORT
-    if(mcp2515TxCallback)
+    else if ((txParams.bufferId & MCP2515_TX_BUFFER_0) && \
+             ((val & (1 << MCP2515_RS_TX0REQ)) == 0))
     {
-        val |= (1 << MCP2515_TX2IE) | \
-               (1 << MCP2515_TX1IE) | \
-               (1 << MCP2515_TX0IE);
+        val = MCP2515_TX_BUFFER_0; // tx buffer index
+        current_prio = mcp2515State.txb0Priority;
+        command = MCP2515_SPI_WRITE_TXB0SIDH;
     }
-#if !MCP2515_USE_RX_INT
-    if(mcp2515State.rxIrqEnable)
+    else
     {
-        val |= (1 << MCP2515_RX1IE) | \
-               (1 << MCP2515_RX0IE);
+        MCP2515_LEAVE_CS(irq_state);
+        return 0;
     }
-#endif // !MCP2515_USE_RX_INT
-
-    mcp2515CmdWriteAddressBurst(MCP2515_CANINTE, 1, &val);
-
-    // configure RXnBF pins (see MCP2515-I-P.pdf 4.4)
-#if MCP2515_USE_RX_INT // enable RX interrupt pins
-    val = (1 << MCP2515_B0BFM) |
-          (1 << MCP2515_B1BFM) |
-          (1 << MCP2515_B0BFE) |
-          (1 << MCP2515_B1BFE);
-#else
-    val = 0x00; // disable RX interrupt pins
-#endif // MCP2515_USE_RX_INT
-    mcp2515CmdWriteAddressBurst(MCP2515_BFPCTRL, 1, &val);
-
-    // disable TXnRTS pins (not used) - see MCP2515-I-P.pdf chapter 3.5
-    val = 0x00;
-    mcp2515CmdWriteAddressBurst(MCP2515_TXRTSCTRL, 1, &val);
 
-    // set up message reception mode - see MCP2515-I-P.pdf 4.2.1 and 4.2.2
+    // transmit sid/eid, rtr, dlc and data:
+    SET_LOW(MCP2515_CS);
+    (void)SPI_M_Transceive(command);
+    if(rawPtr)
+    {
+        ii = 0;
+        if(!(rawPtr->dlc & (1 << MCP2515_RTR)))
+        {
+            ii = rawPtr->dlc & 0x0F;
+            if(ii > 8)
+            {
+                ii = 8;
+            }
+        }
+        SPI_M_TransmitBlock(&rawPtr->sidh, 5 + ii);
+    }
+    else
+    {
 #if MCP2515_CAN_2_B_SUPPORT
-    val = 0x00; // standard and extended frames
-#else
-    val = 0x01 << MCP2515_RXM0; // standard frames only
+        (void)SPI_M_Transceive((messagePtr->sid >> 3) & 0xFF);
+        if(messagePtr->ief)
+        {
+            (void)SPI_M_Transceive(((messagePtr->sid << 5) & 0xE0) | \
+                                   (1 << MCP2515_EXIDE) | \
+                                   ((messagePtr->eid >> 16) & 0x03));
+            (void)SPI_M_Transceive((messagePtr->eid >> 8) & 0xFF);
+            (void)SPI_M_Transceive(messagePtr->eid & 0xFF);
+        }
+        else
+        {
+            (void)SPI_M_Transceive((messagePtr->sid << 5) & 0xE0);
+            (void)SPI_M_Transceive(0xFF); // override extended identifier
+            (void)SPI_M_Transceive(0xFF); // override extended identifier
+        }
+        (void)SPI_M_Transceive((messagePtr->rtr << MCP2515_RTR) | \
+                               (messagePtr->dlc & 0x0F));
+#else // CAN 2.0A only
+        (void)SPI_M_Transceive((messagePtr->sid >> 3) & 0xFF);
+        (void)SPI_M_Transceive((messagePtr->sid << 5) & 0xE0);
+        (void)SPI_M_Transceive(0xFF); // override extended identifier
+        (void)SPI_M_Transceive(0xFF); // override extended identifier
+        (void)SPI_M_Transceive((messagePtr->rtr << MCP2515_RTR) | \
+                               (messagePtr->dlc & 0x0F));
 #endif // MCP2515_CAN_2_B_SUPPORT
-    mcp2515CmdWriteAddressBurst(MCP2515_RXB1CTRL, 1, &val);
-    val |= ((uint8_t)initParamsPtr->rolloverMode) << MCP2515_BUKT;
-    mcp2515CmdWriteAddressBurst(MCP2515_RXB0CTRL, 1, &val);
+        if( ! messagePtr->rtr )
+        {
+            for(ii = 0; ii < messagePtr->dlc; ii++)
+            {
+                (void)SPI_M_Transceive(messagePtr->dataArray[ii]);
+            }
+        }
+    }
+    SET_HIGH(MCP2515_CS);
 
-    // set up filters and masks - see MCP2515-I-P.pdf 4.5
-#if MCP2515_CAN_2_B_SUPPORT
-    mcp2515SetHeaderFormat(MCP2515_RXM0SIDH, \
-                           initParamsPtr->rxBuffer0MaskSid, 0, \
-                           initParamsPtr->rxBuffer0MaskEid);
+    // Check if priority level is already correctly set, otherwise set it:
+    if(current_prio == txParams.priority)
+    {
+        // set only ready-to-send bit:
+        switch(val)
+        {
+            case(MCP2515_TX_BUFFER_2):
+                command = MCP2515_SPI_RTS_TXB2;
+                break;
+            case(MCP2515_TX_BUFFER_1):
+                command = MCP2515_SPI_RTS_TXB1;
+                break;
+            case(MCP2515_TX_BUFFER_0):
+                command = MCP2515_SPI_RTS_TXB0;
+                break;
+        }
+        SET_LOW(MCP2515_CS);
+        (void)SPI_M_Transceive(command);
+        SET_HIGH(MCP2515_CS);
+    }
+    else
+    {
+        // set ready-to-send bit and transmit buffer priority:
+        switch(val)
+        {
+            case(MCP2515_TX_BUFFER_2):
+                command = MCP2515_TXB2CTRL;
+                mcp2515State.txb2Priority = txParams.priority;
+                break;
+            case(MCP2515_TX_BUFFER_1):
+                command = MCP2515_TXB1CTRL;
+                mcp2515State.txb1Priority = txParams.priority;
+                break;
+            case(MCP2515_TX_BUFFER_0):
+                command = MCP2515_TXB0CTRL;
+                mcp2515State.txb0Priority = txParams.priority;
+                break;
+        }
+        SET_LOW(MCP2515_CS);
+        (void)SPI_M_Transceive(MCP2515_SPI_WRITE);
+        (void)SPI_M_Transceive(command);
+        (void)SPI_M_Transceive((1 << MCP2515_TXREQ) | txParams.priority);
+        SET_HIGH(MCP2515_CS);
+    }
+    MCP2515_LEAVE_CS(irq_state);
+
+    return val;
+}
+
+/*!
+*******************************************************************************
+** \brief   Enable or disable the receive interrupts depending on whether
+**          received frames are required by a callback or the RTR responder.
+**          Pending received frames are discarded.
+**
+**          Must be called within MCP2515_ENTER_CS and MCP2515_LEAVE_CS.
+**
+** \param   irqState
+**              The state returned by MCP2515_ENTER_CS.
+**
+** \return  The state to pass to MCP2515_LEAVE_CS.
+**
+*******************************************************************************
+*/
+static IRQ_StateT mcp2515UpdateRxIrq(IRQ_StateT irqState)
+{
+    uint8_t enable = MCP2515_RX_REQUIRED ? 1 : 0;
+
+    if(mcp2515State.initialized)
+    {
+        mcp2515State.rxIrqEnable = enable;
+
+        // clear rx buffers:
+        mcp2515CmdBitModify( MCP2515_CANINTF, \
+                            (1 << MCP2515_RX1IF) | (1 << MCP2515_RX0IF), 0);
+
+#if !MCP2515_USE_RX_INT
+        // modify interrupt mask:
+        mcp2515CmdBitModify( \
+            MCP2515_CANINTE, \
+            (1 << MCP2515_RX1IE) | (1 << MCP2515_RX0IE), \
+            enable ? (1 << MCP2515_RX1IE) | (1 << MCP2515_RX0IE) : 0);
+#endif // !MCP2515_USE_RX_INT
+    }
+#if MCP2515_USE_RX_INT
+    // the rx buffer interrupts follow the new setting:
+    irqState &= ~((1 << MCP2515_INTNO_RXB0) | (1 << MCP2515_INTNO_RXB1));
+    if(mcp2515State.rxIrqEnable)
+    {
+        irqState |= ((1 << MCP2515_INTNO_RXB0) | (1 << MCP2515_INTNO_RXB1));
+    }
+#endif // MCP2515_USE_RX_INT
+    return (irqState);
+}
+
+#if MCP2515_WITH_RTR_RESPONDER
+/*!
+*******************************************************************************
+** \brief   Compare the identifiers of two messages.
+**
+** \return  1 if both identifiers and their formats are equal, 0 otherwise.
+**
+*******************************************************************************
+*/
+static uint8_t mcp2515IsSameId(const MCP2515_CanMessageT* aPtr, \
+                               const MCP2515_CanMessageT* bPtr)
+{
+#if MCP2515_CAN_2_B_SUPPORT
+    if((aPtr->sid != bPtr->sid) || (aPtr->ief != bPtr->ief))
+    {
+        return (0);
+    }
+    return (aPtr->ief ? (aPtr->eid == bPtr->eid) : 1);
+#else
+    return (aPtr->sid == bPtr->sid);
+#endif // MCP2515_CAN_2_B_SUPPORT
+}
+
+/*!
+*******************************************************************************
+** \brief   Answer a received remote frame from the responder table.
+**
+**          Runs in the receive interrupt, where the MCP2515 interrupts are
+**          masked, so the table is accessed consistently.
+**
+** \param   msgPtr
+**              The received frame.
+**
+** \return  1 if the response has been loaded into the reserved transmit
+**          buffer, 0 if the frame has to be passed to the receiver callback.
+**
+*******************************************************************************
+*/
+static uint8_t mcp2515AnswerRemoteFrame(const MCP2515_CanMessageT* msgPtr)
+{
+    MCP2515_RtrResponderT* responder_ptr;
+    MCP2515_TxParamsT tx_params;
+    uint8_t ii;
+
+    if(!msgPtr->rtr)
+    {
+        return (0);
+    }
+    for(ii = 0; ii < mcp2515ResponderCount; ii++)
+    {
+        responder_ptr = &mcp2515ResponderArr[ii];
+        if(!mcp2515IsSameId(msgPtr, &responder_ptr->msg))
+        {
+            continue;
+        }
+        if(responder_ptr->onlyFresh && !responder_ptr->fresh)
+        {
+            return (0);
+        }
+        tx_params.bufferId = MCP2515_RTR_RESPONDER_BUFFER;
+        tx_params.priority = MCP2515_RTR_RESPONDER_PRIORITY;
+        if(!mcp2515Transmit(&responder_ptr->msg, NULL, tx_params))
+        {
+            return (0); // previous response still pending
+        }
+        responder_ptr->fresh = 0;
+        return (1);
+    }
+    return (0);
+}
+#endif // MCP2515_WITH_RTR_RESPONDER
+
+/*!
+*******************************************************************************
+** \brief   Read a received frame and pass it to the RTR responder and,
+**          if it has not been answered there, to the receiver callback.
+**
+**          The frame is read in the register layout if a raw receiver
+**          callback is set, otherwise it is decoded.
+**
+** \param   readCommand
+**              MCP2515_SPI_READ_RXB0SIDH or MCP2515_SPI_READ_RXB1SIDH.
+**
+*******************************************************************************
+*/
+static void mcp2515ReceiveFrame(uint8_t readCommand)
+{
+    MCP2515_CanMessageT can_msg;
+    MCP2515_RawMessageT raw_msg;
+
+    if(mcp2515RawRxCallback)
+    {
+        mcp2515ReadRawRxBuffer(readCommand, &raw_msg);
+#if MCP2515_WITH_RTR_RESPONDER
+        if(MCP2515_RawIsRtr(&raw_msg))
+        {
+            // only the identifier is compared by the responder:
+            can_msg.sid = MCP2515_RawGetStdId(&raw_msg);
+#if MCP2515_CAN_2_B_SUPPORT
+            can_msg.ief = MCP2515_RawIsExtended(&raw_msg) ? 1 : 0;
+            can_msg.eid = MCP2515_RawGetExtId(&raw_msg);
+#endif // MCP2515_CAN_2_B_SUPPORT
+            can_msg.rtr = 1;
+            if(mcp2515AnswerRemoteFrame(&can_msg))
+            {
+                return;
+            }
+        }
+#endif // MCP2515_WITH_RTR_RESPONDER
+        mcp2515RawRxCallback(&raw_msg);
+        return;
+    }
+    mcp2515ReadRxBuffer(readCommand, &can_msg);
+#if MCP2515_WITH_RTR_RESPONDER
+    if(mcp2515AnswerRemoteFrame(&can_msg))
+    {
+        return;
+    }
+#endif // MCP2515_WITH_RTR_RESPONDER
+    if(mcp2515RxCallback)
+    {
+        mcp2515RxCallback(&can_msg);
+    }
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Read the interrupt flags of the MCP2515 and service them.
+**
+**          CANINTF is read once and all flagged sources are serviced from
+**          this snapshot, including both receive buffers. Flags raised in
+**          the meantime are left for the next call, so the main ISR calls
+**          this function repeatedly until no flag is pending.
+**
+** \return  1 if any interrupt flag has been serviced, 0 otherwise.
+**
+*******************************************************************************
+*/
+static uint8_t mcp2515HandleInterrupt(void)
+{
+    uint8_t interrupt_code, tmp;
+    uint8_t serviced = 0;
+
+    SET_LOW(MCP2515_CS);
+    (void)SPI_M_Transceive(MCP2515_SPI_READ);
+    (void)SPI_M_Transceive(MCP2515_CANINTF);
+    interrupt_code = SPI_M_Transceive(0xFF);
+    SET_HIGH(MCP2515_CS);
+
+#if MCP2515_ERROR_CALLBACK_SUPPORT
+    if(mcp2515MessageErrorCallback && (interrupt_code & (1 << MCP2515_MERRF)))
+    {
+        PRINT_DEBUG("message error interrupt\n");
+        // tmp_b = 0x00;
+        // (void)SPI_M_Transceive(MCP2515_SPI_READ);
+        // (void)SPI_M_Transceive(MCP2515_TXB0CTRL);
+        // tmp_a = SPI_M_Transceive(0xFF);
+        // if(tmp_a & (1 << MCP2515_TXERR))
+        // {
+        //     tmp_b |= MCP2515_MSG_ERR_TXERR_0;
+        // }
+        // (void)SPI_M_Transceive(MCP2515_SPI_READ);
+        // (void)SPI_M_Transceive(MCP2515_TXB1CTRL);
+        // tmp_a = SPI_M_Transceive(0xFF);
+        // if(tmp_a & (1 << MCP2515_TXERR))
+        // {
+        //     tmp_b |= MCP2515_MSG_ERR_TXERR_1;
+        // }
+        // (void)SPI_M_Transceive(MCP2515_SPI_READ);
+        // (void)SPI_M_Transceive(MCP2515_TXB2CTRL);
+        // tmp_a = SPI_M_Transceive(0xFF);
+        // if(tmp_a & (1 << MCP2515_TXERR))
+        // {
+        //     tmp_b |= MCP2515_MSG_ERR_TXERR_2;
+        // }
+        mcp2515MessageErrorCallback();
+    }
+    if(mcp2515WakeupCallback && (interrupt_code & (1 << MCP2515_WAKIF)))
+    {
+        PRINT_DEBUG("wakeup interrupt\n");
+        mcp2515WakeupCallback();
+    }
+    if(mcp2515ErrorCallback && (interrupt_code & (1 << MCP2515_ERRIF)))
+    {
+        PRINT_DEBUG("error interrupt\n");
+        (void)SPI_M_Transceive(MCP2515_SPI_READ);
+        (void)SPI_M_Transceive(MCP2515_EFLG);
+        tmp = SPI_M_Transceive(0xFF);
+        mcp2515ErrorCallback(tmp);
+        // clear flags:
+        if(tmp & ((1 << MCP2515_RX1OVR) | (1 << MCP2515_RX0OVR)))
+        {
+            mcp2515CmdBitModify(MCP2515_EFLG, \
+                (1 << MCP2515_RX1OVR) | (1 << MCP2515_RX0OVR), 0);
+        }
+    }
+#endif // MCP2515_ERROR_CALLBACK_SUPPORT
+    if(mcp2515TxCallback)
+    {
+        if(interrupt_code & (1 << MCP2515_TX0IF))
+        {
+            PRINT_DEBUG("tx0 interrupt\n");
+            mcp2515TxCallback(MCP2515_TX_BUFFER_0);
+        }
+        if(interrupt_code & (1 << MCP2515_TX1IF))
+        {
+            PRINT_DEBUG("tx1 interrupt\n");
+            mcp2515TxCallback(MCP2515_TX_BUFFER_1);
+        }
+        if(interrupt_code & (1 << MCP2515_TX2IF))
+        {
+            PRINT_DEBUG("tx2 interrupt\n");
+            mcp2515TxCallback(MCP2515_TX_BUFFER_2);
+        }
+    }
+    tmp = (1 << MCP2515_TX0IF) | \
+          (1 << MCP2515_TX1IF) | \
+          (1 << MCP2515_TX2IF);
+#if MCP2515_ERROR_CALLBACK_SUPPORT
+    tmp |= (1 << MCP2515_MERRF) | \
+           (1 << MCP2515_WAKIF) | \
+           (1 << MCP2515_ERRIF);
+#endif // MCP2515_ERROR_CALLBACK_SUPPORT
+    if(interrupt_code & tmp)
+    {
+        // clear only the flags of the snapshot:
+        mcp2515CmdBitModify(MCP2515_CANINTF, interrupt_code & tmp, 0x00);
+        serviced = 1;
+    }
+    if(MCP2515_RX_REQUIRED && \
+       (interrupt_code & ((1 << MCP2515_RX0IF) | (1 << MCP2515_RX1IF))))
+    {
+#if !MCP2515_USE_RX_INT
+        // RXB0 first, as it holds the older frame in rollover mode:
+        if(interrupt_code & (1 << MCP2515_RX0IF))
+        {
+            mcp2515ReceiveFrame(MCP2515_SPI_READ_RXB0SIDH);
+        }
+        if(interrupt_code & (1 << MCP2515_RX1IF))
+        {
+            mcp2515ReceiveFrame(MCP2515_SPI_READ_RXB1SIDH);
+        }
+        serviced = 1;
+#else
+        PRINT_DEBUG("ISR: unexpected RX0/RX1 handling!\n");
+#endif // !MCP2515_USE_RX_INT
+    }
+
+    return (serviced);
+}
+
+
+//*****************************************************************************
+//*************************** PUBLIC FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   Initializes the MCP2515 hardware with given parameters.
+**
+** \param   initParamsPtr
+**              Points to a structure with all required initialization
+**              parameters.
+**
+** \return
+**          - #MCP2515_OK on success.
+**          - #MCP2515_ERR_ALREADY_INITIALIZED if the driver has already
+**              been initialized.
+**          - #MCP2515_ERR_SPI_NOT_INITIALIZED if the SPI driver is not
+**              initialized.
+**          - #MCP2515_ERR_VERIFY_FAIL if the verification
+**              of the MCP2515_CNF1 register failed.
+**          - #SPI_M_ERR_NO_SLOT if the interrupts of the driver could not
+**              be registered with the SPI driver.
+**
+*******************************************************************************
+*/
+uint8_t MCP2515_Init(const MCP2515_InitParamsT* initParamsPtr)
+{
+    uint8_t val;
+
+    if(mcp2515State.initialized)
+    {
+        return(MCP2515_ERR_ALREADY_INITIALIZED);
+    }
+    // Disable interrupt(s):
+    EIMSK &= ~(1 << MCP2515_INTNO_MAIN);
+#if MCP2515_USE_RX_INT
+    EIMSK &= ~((1 << MCP2515_INTNO_RXB0) | (1 << MCP2515_INTNO_RXB1));
+#endif // MCP2515_USE_RX_INT
+
+    // Initialize state variable:
+    memset(&mcp2515State, 0, sizeof(mcp2515State));
+
+    // initialize SPI
+    if(initParamsPtr->initSPI)
+    {
+        (void)SPI_M_Init(MCP2515_SPI_CLOCK_DIVIDER,   \
+                         MCP2515_SPI_DATA_ORDER,      \
+                         MCP2515_SPI_CLOCK_PARITY,    \
+                         MCP2515_SPI_CLOCK_PHASE);
+    }
+
+    // check if SPI is initialized:
+    if(!SPI_M_IsInitialized())
+    {
+        return(MCP2515_ERR_SPI_NOT_INITIALIZED);
+    }
+
+    // mask our interrupts while other drivers hold the SPI:
+    val = SPI_M_AddIrqUser(&EIMSK, MCP2515_CS_MASK);
+    if(val != SPI_M_OK)
+    {
+        return(val);
+    }
+
+    // set up CS line:
+    SET_OUTPUT(MCP2515_CS);
+    SET_HIGH(MCP2515_CS);
+
+    // reset the MCP2515 and enter configuration mode
+    // see MCP2515-I-P.pdf chapter 9.0 for RESET pin
+    _delay_us(10);
+    SET_LOW(MCP2515_CS);
+    (void)SPI_M_Transceive(MCP2515_SPI_RESET);
+    SET_HIGH(MCP2515_CS);
+    _delay_us(10);
+
+    // set up bit timing configuration registers:
+    // set up CNF1:
+    val  = ((uint8_t)initParamsPtr->synchronisationJumpWidth) << 6;
+    val |= initParamsPtr->baudRatePrescaler;
+    mcp2515CmdWriteAddressBurst(MCP2515_CNF1, 1, &val);
+    // set up CNF2:
+    val  = (1 << MCP2515_BTLMODE); // see MCP2515-I-P.pdf 5.5
+    val |= ((uint8_t)initParamsPtr->samplePointCount) << 6;
+    val |= ((uint8_t)initParamsPtr->phaseSegment1Length) << 3;
+    val |= ((uint8_t)initParamsPtr->propagationSegmentLength);
+    mcp2515CmdWriteAddressBurst(MCP2515_CNF2, 1, &val);
+    // set up CNF3:
+    val  = ((uint8_t)initParamsPtr->wakeupLowPassFilter) << 6;
+    val |= ((uint8_t)initParamsPtr->phaseSegment2Length);
+    mcp2515CmdWriteAddressBurst(MCP2515_CNF3, 1, &val);
+    // Verify CNF1 register:
+    mcp2515CmdReadAddressBurst(MCP2515_CNF1, 1, &val);
+    if(val != ((((uint8_t)initParamsPtr->synchronisationJumpWidth) << 6) | \
+               initParamsPtr->baudRatePrescaler))
+    {
+#if MCP2515_DEBUG
+        printf("CNF1 = 0x%02x\n", val);
+        printf("expected: 0x%02x\n", \
+              ((((uint8_t)initParamsPtr->synchronisationJumpWidth) << 6) | \
+               initParamsPtr->baudRatePrescaler));
+#endif // MCP2515_DEBUG
+        return(MCP2515_ERR_VERIFY_FAIL);
+    }
+    if(MCP2515_RX_REQUIRED)
+    {
+        mcp2515State.rxIrqEnable = 1;
+    }
+
+    // enable interrupts: see MCP2515-I-P.pdf chapter 7
+    val = 0x00;
+#if MCP2515_ERROR_CALLBACK_SUPPORT
+    if(mcp2515MessageErrorCallback)
+    {
+        val |= (1 << MCP2515_MERRE);
+    }
+    if(mcp2515WakeupCallback)
+    {
+        val |=  (1 << MCP2515_WAKIE);
+    }
+    if(mcp2515ErrorCallback)
+    {
+        val |= (1 << MCP2515_ERRIE);
+    }
+#endif // MCP2515_ERROR_CALLBACK_SUPPORT
+    if(mcp2515TxCallback)
+    {
+        val |= (1 << MCP2515_TX2IE) | \
+               (1 << MCP2515_TX1IE) | \
+               (1 << MCP2515_TX0IE);
+    }
+#if !MCP2515_USE_RX_INT
+    if(mcp2515State.rxIrqEnable)
+    {
+        val |= (1 << MCP2515_RX1IE) | \
+               (1 << MCP2515_RX0IE);
+    }
+#endif // !MCP2515_USE_RX_INT
+
+    mcp2515CmdWriteAddressBurst(MCP2515_CANINTE, 1, &val);
+
+    // configure RXnBF pins (see MCP2515-I-P.pdf 4.4)
+#if MCP2515_USE_RX_INT // enable RX interrupt pins
+    val = (1 << MCP2515_B0BFM) |
+          (1 << MCP2515_B1BFM) |
+          (1 << MCP2515_B0BFE) |
+          (1 << MCP2515_B1BFE);
+#else
+    val = 0x00; // disable RX interrupt pins
+#endif // MCP2515_USE_RX_INT
+    mcp2515CmdWriteAddressBurst(MCP2515_BFPCTRL, 1, &val);
+
+    // disable TXnRTS pins (not used) - see MCP2515-I-P.pdf chapter 3.5
+    val = 0x00;
+    mcp2515CmdWriteAddressBurst(MCP2515_TXRTSCTRL, 1, &val);
+
+    // set up message reception mode - see MCP2515-I-P.pdf 4.2.1 and 4.2.2
+#if MCP2515_CAN_2_B_SUPPORT
+    val = 0x00; // standard and extended frames
+#else
+    val = 0x01 << MCP2515_RXM0; // standard frames only
+#endif // MCP2515_CAN_2_B_SUPPORT
+    mcp2515CmdWriteAddressBurst(MCP2515_RXB1CTRL, 1, &val);
+    val |= ((uint8_t)initParamsPtr->rolloverMode) << MCP2515_BUKT;
+    mcp2515CmdWriteAddressBurst(MCP2515_RXB0CTRL, 1, &val);
+
+    // set up filters and masks - see MCP2515-I-P.pdf 4.5
+#if MCP2515_CAN_2_B_SUPPORT
+    mcp2515SetHeaderFormat(MCP2515_RXM0SIDH, \
+                           initParamsPtr->rxBuffer0MaskSid, 0, \
+                           initParamsPtr->rxBuffer0MaskEid);
     mcp2515SetHeaderFormat(MCP2515_RXF0SIDH, \
                            initParamsPtr->rxBuffer0Filter0Sid, \
                            initParamsPtr->rxBuffer0Filter0Ext, \
@@ -580,6 +1246,7 @@ void MCP2515_Exit(void)
 
     // clear callbacks and state:
     mcp2515RxCallback           = NULL;
+    mcp2515RawRxCallback        = NULL;
     mcp2515TxCallback           = NULL;
 
 #if MCP2515_ERROR_CALLBACK_SUPPORT
@@ -588,6 +1255,11 @@ void MCP2515_Exit(void)
     mcp2515ErrorCallback        = NULL;
 #endif // MCP2515_ERROR_CALLBACK_SUPPORT
 
+#if MCP2515_WITH_RTR_RESPONDER
+    mcp2515ResponderArr         = NULL;
+    mcp2515ResponderCount       = 0;
+#endif // MCP2515_WITH_RTR_RESPONDER
+
     memset(&mcp2515State, 0, sizeof(mcp2515State));
 
     // disable clock output pin (power saving) and enter sleep mode:
@@ -620,41 +1292,46 @@ void MCP2515_Exit(void)
 **          initialization of the driver. However, it may still be modified
 **          during runtime.
 **          It is allowed to set the rxCallback to NULL. The receive interrupt
-**          will be disabled then accordingly.
+**          will be disabled then accordingly, unless RTR responders are set.
 **
 *******************************************************************************
 */
 void MCP2515_SetRxCallback(MCP2515_RxCallbackT rxCallback)
 {
-    uint8_t eimsk_save;
+    IRQ_StateT irq_state;
 
-    // DO NOT use LEAVE_CS here, since interrupts may still be disabled
-    eimsk_save = EIMSK;
-    MCP2515_ENTER_CS;
+    irq_state = MCP2515_ENTER_CS;
     mcp2515RxCallback = rxCallback;
-    if(mcp2515State.initialized)
-    {
-        mcp2515State.rxIrqEnable = rxCallback ? 1 : 0;
+    irq_state = mcp2515UpdateRxIrq(irq_state);
+    MCP2515_LEAVE_CS(irq_state);
+    return;
+}
 
-        // clear rx buffers:
-        mcp2515CmdBitModify( MCP2515_CANINTF, \
-                            (1 << MCP2515_RX1IF) | (1 << MCP2515_RX0IF), 0);
+/*!
+*******************************************************************************
+** \brief   Set the raw receiver callback function.
+**
+** \param   rawRxCallback
+**              The callback function that will be registered with the driver.
+**
+**          Like the receiver callback (see MCP2515_SetRxCallback()), but
+**          received messages are passed in the register layout of the
+**          MCP2515, which is read in block transfers. While a raw receiver
+**          callback is set, it receives all messages instead of the
+**          receiver callback.
+**          It is allowed to set the rawRxCallback to NULL, which passes the
+**          received messages to the receiver callback again.
+**
+*******************************************************************************
+*/
+void MCP2515_SetRawRxCallback(MCP2515_RawRxCallbackT rawRxCallback)
+{
+    IRQ_StateT irq_state;
 
-#if !MCP2515_USE_RX_INT
-        // modify interrupt mask:
-        mcp2515CmdBitModify( \
-            MCP2515_CANINTE, \
-            (1 << MCP2515_RX1IE) | (1 << MCP2515_RX0IE), \
-            rxCallback ? (1 << MCP2515_RX1IE) | (1 << MCP2515_RX0IE) : 0);
-#endif // !MCP2515_USE_RX_INT
-    }
-    EIMSK  = eimsk_save;
-#if MCP2515_USE_RX_INT
-    if(mcp2515State.rxIrqEnable)
-    {
-        EIMSK |= ((1 << MCP2515_INTNO_RXB0) | (1 << MCP2515_INTNO_RXB1));
-    }
-#endif // MCP2515_USE_RX_INT
+    irq_state = MCP2515_ENTER_CS;
+    mcp2515RawRxCallback = rawRxCallback;
+    irq_state = mcp2515UpdateRxIrq(irq_state);
+    MCP2515_LEAVE_CS(irq_state);
     return;
 }
 
@@ -683,11 +1360,9 @@ void MCP2515_SetRxCallback(MCP2515_RxCallbackT rxCallback)
 */
 void MCP2515_SetTxCallback(MCP2515_TxCallbackT txCallback)
 {
-    uint8_t eimsk_save;
+    IRQ_StateT irq_state;
 
-    // DO NOT use LEAVE_CS here, since interrupts may still be disabled
-    eimsk_save = EIMSK;
-    MCP2515_ENTER_CS;
+    irq_state = MCP2515_ENTER_CS;
     mcp2515TxCallback = txCallback;
     if(mcp2515State.initialized)
     {   // modify interrupt mask:
@@ -697,7 +1372,7 @@ void MCP2515_SetTxCallback(MCP2515_TxCallbackT txCallback)
             txCallback ? \
             (1 << MCP2515_TX2IE) | (1 << MCP2515_TX1IE) | (1 << MCP2515_TX0IE) : 0);
     }
-    EIMSK = eimsk_save;
+    MCP2515_LEAVE_CS(irq_state);
     return;
 }
 
@@ -714,6 +1389,8 @@ void MCP2515_SetTxCallback(MCP2515_TxCallbackT txCallback)
 **              several buffer IDs. The driver will then select one buffer
 **              out of these. If all specified buffers are currently in use, a
 **              corresponding error code will be returned.
+**              The buffer reserved for RTR responses is never used if
+**              MCP2515_WITH_RTR_RESPONDER is enabled.
 **              The priority denotes the transmission priority of a message.
 **              The transmit buffer with the highest priority will send the
 **              next message on the CAN bus, independently of the content of
@@ -733,134 +1410,39 @@ void MCP2515_SetTxCallback(MCP2515_TxCallbackT txCallback)
 MCP2515_TxBufferIdT MCP2515_Transmit(MCP2515_CanMessageT* messagePtr, \
                                      MCP2515_TxParamsT txParams)
 {
-    uint8_t val, command, ii;
-    MCP2515_TxPriorityT current_prio;
-
-    // check if driver is initialized:
-    if(mcp2515State.initialized == 0)
-    {
-        return 0;
-    }
-
-    // read status bits:
-    MCP2515_ENTER_CS;
-    SET_LOW(MCP2515_CS);
-    (void)SPI_M_Transceive(MCP2515_SPI_READ_STATUS);
-    val = SPI_M_Transceive(0xFF);
-    SET_HIGH(MCP2515_CS);
-
-    // see MCP2515-I-P.pdf figure 12.8 for bit assignments
-    if ((txParams.bufferId & MCP2515_TX_BUFFER_2) && \
-        ((val & (1 << MCP2515_RS_TX2REQ)) == 0))
-    {
-        val = MCP2515_TX_BUFFER_2; // tx buffer index
-        current_prio = mcp2515State.txb2Priority;
-        command = MCP2515_SPI_WRITE_TXB2SIDH;
-    }
-    else if ((txParams.bufferId & MCP2515_TX_BUFFER_1) && \
-             ((val & (1 << MCP2515_RS_TX1REQ)) == 0))
-    {
-        val = MCP2515_TX_BUFFER_1; // tx buffer index
-        current_prio = mcp2515State.txb1Priority;
-        command = MCP2515_SPI_WRITE_TXB1SIDH;
-    }
-    else if ((txParams.bufferId & MCP2515_TX_BUFFER_0) && \
-             ((val & (1 << MCP2515_RS_TX0REQ)) == 0))
-    {
-        val = MCP2515_TX_BUFFER_0; // tx buffer index
-        current_prio = mcp2515State.txb0Priority;
-        command = MCP2515_SPI_WRITE_TXB0SIDH;
-    }
-    else
-    {
-        return 0;
-    }
-
-    // transmit sid/eid, rtr, dlc and data:
-    SET_LOW(MCP2515_CS);
-    (void)SPI_M_Transceive(command);
-#if MCP2515_CAN_2_B_SUPPORT
-    (void)SPI_M_Transceive((messagePtr->sid >> 3) & 0xFF);
-    if(messagePtr->ief)
-    {
-        (void)SPI_M_Transceive(((messagePtr->sid << 5) & 0xE0) | \
-                               (1 << MCP2515_EXIDE) | \
-                               ((messagePtr->eid >> 16) & 0x03));
-        (void)SPI_M_Transceive((messagePtr->eid >> 8) & 0xFF);
-        (void)SPI_M_Transceive(messagePtr->eid & 0xFF);
-    }
-    else
-    {
-        (void)SPI_M_Transceive((messagePtr->sid << 5) & 0xE0);
-        (void)SPI_M_Transceive(0xFF); // override extended identifier
-        (void)SPI_M_Transceive(0xFF); // override extended identifier
-    }
-    (void)SPI_M_Transceive((messagePtr->rtr << MCP2515_RTR) | \
-                           (messagePtr->dlc & 0x0F));
-#else // CAN 2.0A only
-    (void)SPI_M_Transceive((messagePtr->sid >> 3) & 0xFF);
-    (void)SPI_M_Transceive((messagePtr->sid << 5) & 0xE0);
-    (void)SPI_M_Transceive(0xFF); // override extended identifier
-    (void)SPI_M_Transceive(0xFF); // override extended identifier
-    (void)SPI_M_Transceive((messagePtr->rtr << MCP2515_RTR) | \
-                           (messagePtr->dlc & 0x0F));
-#endif // MCP2515_CAN_2_B_SUPPORT
-    if( ! messagePtr->rtr )
-    {
-        for(ii = 0; ii < messagePtr->dlc; ii++)
-        {
-            (void)SPI_M_Transceive(messagePtr->dataArray[ii]);
-        }
-    }
-    SET_HIGH(MCP2515_CS);
-
-    // Check if priority level is already correctly set, otherwise set it:
-    if(current_prio == txParams.priority)
-    {
-        // set only ready-to-send bit:
-        switch(val)
-        {
-            case(MCP2515_TX_BUFFER_2):
-                command = MCP2515_SPI_RTS_TXB2;
-                break;
-            case(MCP2515_TX_BUFFER_1):
-                command = MCP2515_SPI_RTS_TXB1;
-                break;
-            case(MCP2515_TX_BUFFER_0):
-                command = MCP2515_SPI_RTS_TXB0;
-                break;
-        }
-        SET_LOW(MCP2515_CS);
-        (void)SPI_M_Transceive(command);
-        SET_HIGH(MCP2515_CS);
-    }
-    else
-    {
-        // set ready-to-send bit and transmit buffer priority:
-        switch(val)
-        {
-            case(MCP2515_TX_BUFFER_2):
-                command = MCP2515_TXB2CTRL;
-                mcp2515State.txb2Priority = txParams.priority;
-                break;
-            case(MCP2515_TX_BUFFER_1):
-                command = MCP2515_TXB1CTRL;
-                mcp2515State.txb1Priority = txParams.priority;
-                break;
-            case(MCP2515_TX_BUFFER_0):
-                command = MCP2515_TXB0CTRL;
-                mcp2515State.txb0Priority = txParams.priority;
-                break;
-        }
-        SET_LOW(MCP2515_CS);
-        (void)SPI_M_Transceive(MCP2515_SPI_WRITE);
-        (void)SPI_M_Transceive(command);
-        (void)SPI_M_Transceive((1 << MCP2515_TXREQ) | txParams.priority);
-        SET_HIGH(MCP2515_CS);
-    }
-    MCP2515_LEAVE_CS;
+#if MCP2515_WITH_RTR_RESPONDER
+    txParams.bufferId &= ~MCP2515_RTR_RESPONDER_BUFFER;
+#endif // MCP2515_WITH_RTR_RESPONDER
+    return (mcp2515Transmit(messagePtr, NULL, txParams));
+}
 
-    return val;
+/*!
+*******************************************************************************
+** \brief   Transmit a message in the register layout of the MCP2515 over
+**          the CAN bus.
+**
+**          The header and the data are loaded in a single block transfer,
+**          so headers of frames that are transmitted repeatedly may be built
+**          once with the MCP2515_Raw...() helpers.
+**
+** \param   msgPtr
+**              A pointer to the message which will be sent via CAN bus.
+** \param   txParams
+**              Transmit parameters, see MCP2515_Transmit().
+** \return
+**          - A MCP2515_TxBufferIdT type, denoting the buffer to which
+**            the message was loaded.
+**          - 0 if all transmit buffers are occupied.
+**
+*******************************************************************************
+*/
+MCP2515_TxBufferIdT MCP2515_TransmitRaw(MCP2515_RawMessageT* msgPtr, \
+                                        MCP2515_TxParamsT txParams)
+{
+#if MCP2515_WITH_RTR_RESPONDER
+    txParams.bufferId &= ~MCP2515_RTR_RESPONDER_BUFFER;
+#endif // MCP2515_WITH_RTR_RESPONDER
+    return (mcp2515Transmit(NULL, msgPtr, txParams));
 }
 
 #if MCP2515_ERROR_CALLBACK_SUPPORT
@@ -890,18 +1472,16 @@ MCP2515_TxBufferIdT MCP2515_Transmit(MCP2515_CanMessageT* messagePtr, \
 */
 void MCP2515_SetMessageErrorCallback(MCP2515_VoidCallbackT callback)
 {
-    uint8_t eimsk_save;
+    IRQ_StateT irq_state;
 
-    // DO NOT use LEAVE_CS here, since interrupts may still be disabled
-    eimsk_save = EIMSK;
-    MCP2515_ENTER_CS;
+    irq_state = MCP2515_ENTER_CS;
     mcp2515MessageErrorCallback = callback;
     if(mcp2515State.initialized)
     {   // modify interrupt mask:
         mcp2515CmdBitModify(MCP2515_CANINTE, \
                     (1 << MCP2515_MERRE), callback ? 0xFF : 0x00);
     }
-    EIMSK = eimsk_save;
+    MCP2515_LEAVE_CS(irq_state);
     return;
 }
 
@@ -928,18 +1508,16 @@ void MCP2515_SetMessageErrorCallback(MCP2515_VoidCallbackT callback)
 */
 void MCP2515_SetWakeupCallback(MCP2515_VoidCallbackT callback)
 {
-    uint8_t eimsk_save;
+    IRQ_StateT irq_state;
 
-    // DO NOT use LEAVE_CS here, since interrupts may still be disabled
-    eimsk_save = EIMSK;
-    MCP2515_ENTER_CS;
+    irq_state = MCP2515_ENTER_CS;
     mcp2515WakeupCallback = callback;
     if(mcp2515State.initialized)
     {   // modify interrupt mask:
         mcp2515CmdBitModify(MCP2515_CANINTE, \
                     (1 << MCP2515_WAKIE), callback ? 0xFF : 0x00);
     }
-    EIMSK = eimsk_save;
+    MCP2515_LEAVE_CS(irq_state);
     return;
 }
 
@@ -978,23 +1556,94 @@ void MCP2515_SetWakeupCallback(MCP2515_VoidCallbackT callback)
 */
 void MCP2515_SetErrorCallback(MCP2515_ErrorCallbackT callback)
 {
-    uint8_t eimsk_save;
+    IRQ_StateT irq_state;
 
-    // DO NOT use LEAVE_CS here, since interrupts may still be disabled
-    eimsk_save = EIMSK;
-    MCP2515_ENTER_CS;
+    irq_state = MCP2515_ENTER_CS;
     mcp2515ErrorCallback = callback;
     if(mcp2515State.initialized)
     {   // modify interrupt mask:
         mcp2515CmdBitModify(MCP2515_CANINTE, \
                     (1 << MCP2515_ERRIE), callback ? 0xFF : 0x00);
     }
-    EIMSK = eimsk_save;
+    MCP2515_LEAVE_CS(irq_state);
     return;
 }
 
 #endif // MCP2515_ERROR_CALLBACK_SUPPORT
 
+#if MCP2515_WITH_RTR_RESPONDER
+
+/*!
+*******************************************************************************
+** \brief   Set the table of RTR responses.
+**
+** \param   responderArr
+**              The table, which must remain valid until it is replaced.
+**              May be NULL in order to disable the RTR responder.
+** \param   responderCount
+**              The number of entries in the table.
+**
+**          Received remote frames whose identifier matches an entry are
+**          answered directly within the receive interrupt by loading the
+**          response into the transmit buffer MCP2515_RTR_RESPONDER_BUFFER,
+**          without invoking the receiver callback. The receive interrupt
+**          is enabled while a table is set, even without receiver callback.
+**          Entries with onlyFresh set are answered only if their data
+**          has been updated by MCP2515_UpdateRtrResponse() since their
+**          previous response.
+**
+*******************************************************************************
+*/
+void MCP2515_SetRtrResponders(MCP2515_RtrResponderT* responderArr, \
+                              uint8_t responderCount)
+{
+    IRQ_StateT irq_state;
+
+    irq_state = MCP2515_ENTER_CS;
+    mcp2515ResponderArr = responderArr;
+    mcp2515ResponderCount = responderArr ? responderCount : 0;
+    irq_state = mcp2515UpdateRxIrq(irq_state);
+    MCP2515_LEAVE_CS(irq_state);
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Update the data of an RTR response and mark it as fresh.
+**
+** \param   index
+**              The index of the entry in the responder table.
+** \param   dataPtr
+**              The new data.
+** \param   length
+**              The number of bytes to copy (0 ... 8). The DLC of the
+**              response is not modified.
+**
+** \return
+**          - #MCP2515_OK on success.
+**          - #MCP2515_ERR_BAD_PARAMETER if a bad parameter has been passed.
+**
+*******************************************************************************
+*/
+uint8_t MCP2515_UpdateRtrResponse(uint8_t index, \
+                                  const uint8_t* dataPtr, \
+                                  uint8_t length)
+{
+    IRQ_StateT irq_state;
+
+    if((index >= mcp2515ResponderCount) || (dataPtr == NULL) || (length > 8))
+    {
+        return (MCP2515_ERR_BAD_PARAMETER);
+    }
+    irq_state = MCP2515_ENTER_CS;
+    memcpy(mcp2515ResponderArr[index].msg.dataArray, dataPtr, length);
+    mcp2515ResponderArr[index].fresh = 1;
+    MCP2515_LEAVE_CS(irq_state);
+    return (MCP2515_OK);
+}
+
+#endif // MCP2515_WITH_RTR_RESPONDER
+
 
 //*****************************************************************************
 //*********************** INTERRUPT SERVICE ROUTINES **************************
@@ -1004,14 +1653,17 @@ void MCP2515_SetErrorCallback(MCP2515_ErrorCallbackT callback)
 *******************************************************************************
 ** \brief   MCP2515 main interrupt service routine.
 **
+**          Services the MCP2515 interrupt flags until none are pending or
+**          MCP2515_ISR_FRAME_BUDGET snapshots of CANINTF have been serviced.
+**          Remaining flags keep the low-level triggered interrupt line
+**          asserted, so the ISR is entered again right after returning.
+**
 *******************************************************************************
 */
 ISR(MCP2515_INT_MAIN_vect, ISR_BLOCK)
 {
-    uint8_t interrupt_code, tmp;
-#if !MCP2515_USE_RX_INT
-    MCP2515_CanMessageT can_msg;
-#endif // !MCP2515_USE_RX_INT
+    uint8_t serviced;
+    uint8_t budget = MCP2515_ISR_FRAME_BUDGET;
 
     EIMSK &= ~(1 << MCP2515_INTNO_MAIN);
 #if MCP2515_USE_RX_INT
@@ -1019,250 +1671,15 @@ ISR(MCP2515_INT_MAIN_vect, ISR_BLOCK)
     EIMSK &= ~((1 << MCP2515_INTNO_RXB0) | (1 << MCP2515_INTNO_RXB1));
 #endif // MCP2515_USE_RX_INT
     sei();
+    SPI_M_Lock();
 
-#if MCP2515_ERROR_CALLBACK_SUPPORT
-// *************  ISR WITH ERROR CALLBACK SUPPORT *************
-
-    SET_LOW(MCP2515_CS);
-    (void)SPI_M_Transceive(MCP2515_SPI_READ);
-    (void)SPI_M_Transceive(MCP2515_CANINTF);
-    interrupt_code = SPI_M_Transceive(0xFF);
-    SET_HIGH(MCP2515_CS);
-
-    if(mcp2515MessageErrorCallback && (interrupt_code & (1 << MCP2515_MERRF)))
-    {
-        PRINT_DEBUG("message error interrupt\n");
-        // tmp_b = 0x00;
-        // (void)SPI_M_Transceive(MCP2515_SPI_READ);
-        // (void)SPI_M_Transceive(MCP2515_TXB0CTRL);
-        // tmp_a = SPI_M_Transceive(0xFF);
-        // if(tmp_a & (1 << MCP2515_TXERR))
-        // {
-        //     tmp_b |= MCP2515_MSG_ERR_TXERR_0;
-        // }
-        // (void)SPI_M_Transceive(MCP2515_SPI_READ);
-        // (void)SPI_M_Transceive(MCP2515_TXB1CTRL);
-        // tmp_a = SPI_M_Transceive(0xFF);
-        // if(tmp_a & (1 << MCP2515_TXERR))
-        // {
-        //     tmp_b |= MCP2515_MSG_ERR_TXERR_1;
-        // }
-        // (void)SPI_M_Transceive(MCP2515_SPI_READ);
-        // (void)SPI_M_Transceive(MCP2515_TXB2CTRL);
-        // tmp_a = SPI_M_Transceive(0xFF);
-        // if(tmp_a & (1 << MCP2515_TXERR))
-        // {
-        //     tmp_b |= MCP2515_MSG_ERR_TXERR_2;
-        // }
-        mcp2515MessageErrorCallback();
-    }
-    if(mcp2515WakeupCallback && (interrupt_code & (1 << MCP2515_WAKIF)))
-    {
-        PRINT_DEBUG("wakeup interrupt\n");
-        mcp2515WakeupCallback();
-    }
-    if(mcp2515ErrorCallback && (interrupt_code & (1 << MCP2515_ERRIF)))
-    {
-        PRINT_DEBUG("error interrupt\n");
-        (void)SPI_M_Transceive(MCP2515_SPI_READ);
-        (void)SPI_M_Transceive(MCP2515_EFLG);
-        tmp = SPI_M_Transceive(0xFF);
-        mcp2515ErrorCallback(tmp);
-        // clear flags:
-        if(tmp & ((1 << MCP2515_RX1OVR) | (1 << MCP2515_RX0OVR)))
-        {
-            mcp2515CmdBitModify(MCP2515_EFLG, \
-                (1 << MCP2515_RX1OVR) | (1 << MCP2515_RX0OVR), 0);
-        }
-    }
-    if(mcp2515TxCallback)
-    {
-        if(interrupt_code & (1 << MCP2515_TX0IF))
-        {
-            PRINT_DEBUG("tx0 interrupt\n");
-            mcp2515TxCallback(MCP2515_TX_BUFFER_0);
-        }
-        if(interrupt_code & (1 << MCP2515_TX1IF))
-        {
-            PRINT_DEBUG("tx1 interrupt\n");
-            mcp2515TxCallback(MCP2515_TX_BUFFER_1);
-        }
-        if(interrupt_code & (1 << MCP2515_TX2IF))
-        {
-            PRINT_DEBUG("tx2 interrupt\n");
-            mcp2515TxCallback(MCP2515_TX_BUFFER_2);
-        }
-    }
-    tmp = (1 << MCP2515_MERRF) | \
-          (1 << MCP2515_WAKIF) | \
-          (1 << MCP2515_ERRIF) | \
-          (1 << MCP2515_TX0IF) | \
-          (1 << MCP2515_TX1IF) | \
-          (1 << MCP2515_TX2IF);
-    if(interrupt_code & tmp)
-    {
-        mcp2515CmdBitModify(MCP2515_CANINTF, tmp, 0x00);
-    }
-    if(mcp2515RxCallback && \
-       (interrupt_code & ((1 << MCP2515_RX0IF) | (1 << MCP2515_RX1IF))))
-    {
-#if !MCP2515_USE_RX_INT
-        if(interrupt_code & (1 << MCP2515_RX0IF))
-        {
-            tmp = MCP2515_SPI_READ_RXB0SIDH;
-        }
-        else
-        {
-            tmp = MCP2515_SPI_READ_RXB1SIDH;
-        }
-        SET_LOW(MCP2515_CS);
-        (void)SPI_M_Transceive(tmp);
-#if MCP2515_CAN_2_B_SUPPORT
-        can_msg.sid  = ((uint32_t)SPI_M_Transceive(0xFF)) << 3; // SIDH
-        tmp = SPI_M_Transceive(0xFF); // SIDL
-        can_msg.sid |= (uint32_t) (tmp >> 5);
-        if(tmp & (1 << MCP2515_IDE))
-        {
-            // extended frame
-            can_msg.ief  = 1;
-            can_msg.eid  = ((uint32_t) (tmp & 0x03)) << 16;
-            can_msg.eid |= ((uint32_t) SPI_M_Transceive(0xFF)) << 8; // EIDH
-            can_msg.eid |= (uint32_t) SPI_M_Transceive(0xFF); // EIDL
-            tmp = SPI_M_Transceive(0xFF); // DLC
-            can_msg.rtr  = (tmp & (1 << MCP2515_RTR)) ? 1 : 0;
-            can_msg.dlc  = tmp & 0x0F;
-        }
-        else
-        {
-            // standard frame
-            can_msg.ief  = 0;
-            can_msg.rtr  = (tmp & (1 << MCP2515_SRR)) ? 1 : 0;
-            (void)SPI_M_Transceive(0xFF); // EIDH
-            (void)SPI_M_Transceive(0xFF); // EIDL
-            can_msg.dlc  = SPI_M_Transceive(0xFF) & 0x0F; // DLC
-        }
-#else // CAN 2.0A only
-        can_msg.sid  = ((uint16_t) SPI_M_Transceive(0xFF)) << 3; // SIDH
-        tmp = SPI_M_Transceive(0xFF); // SIDL
-        can_msg.sid |= (uint16_t) (tmp >> 5);
-        can_msg.rtr  = (uint16_t) ((tmp & (1 << MCP2515_SRR)) ? 1 : 0);
-        (void)SPI_M_Transceive(0xFF); // EIDH
-        (void)SPI_M_Transceive(0xFF); // EIDL
-        can_msg.dlc  = (uint16_t) (SPI_M_Transceive(0xFF) & 0x0F); // DLC
-#endif // MCP2515_CAN_2_B_SUPPORT
-        if(can_msg.rtr == 0)
-        {
-            for(tmp = 0; tmp < can_msg.dlc; tmp++)
-            {
-                can_msg.dataArray[tmp] = SPI_M_Transceive(0xFF);
-            }
-        }
-        SET_HIGH(MCP2515_CS);
-        // CANINTF.RXnIF is being cleared automatically (see 12.4).
-        mcp2515RxCallback(&can_msg);
-#else
-        PRINT_DEBUG("ISR: unexpected RX0/RX1 handling!\n");
-#endif // !MCP2515_USE_RX_INT
-    }
-
-#else // MCP2515_ERROR_CALLBACK_SUPPORT
-// *************  ISR WITHOUT ERROR CALLBACK SUPPORT *************
-
-    SET_LOW(MCP2515_CS);
-    (void)SPI_M_Transceive(MCP2515_SPI_READ_STATUS);
-    interrupt_code = SPI_M_Transceive(0xFF);
-    SET_HIGH(MCP2515_CS);
-
-    if(mcp2515TxCallback)
-    {
-        if(interrupt_code & (1 << MCP2515_RS_TX0IF))
-        {
-            PRINT_DEBUG("tx0 interrupt\n");
-            mcp2515TxCallback(MCP2515_TX_BUFFER_0);
-        }
-        if(interrupt_code & (1 << MCP2515_RS_TX1IF))
-        {
-            PRINT_DEBUG("tx1 interrupt\n");
-            mcp2515TxCallback(MCP2515_TX_BUFFER_1);
-        }
-        if(interrupt_code & (1 << MCP2515_RS_TX2IF))
-        {
-            PRINT_DEBUG("tx2 interrupt\n");
-            mcp2515TxCallback(MCP2515_TX_BUFFER_2);
-        }
-        tmp = (1 << MCP2515_RS_TX0IF) | \
-              (1 << MCP2515_RS_TX1IF) | \
-              (1 << MCP2515_RS_TX2IF);
-        if(interrupt_code & tmp)
-        {
-            mcp2515CmdBitModify(MCP2515_CANINTF, tmp, 0x00);
-        }
-    }
-    if(mcp2515RxCallback && \
-       (interrupt_code & ((1 << MCP2515_RS_RX0IF) | (1 << MCP2515_RS_RX1IF))))
+    // Drain all pending interrupt flags within the frame budget:
+    do
     {
-#if !MCP2515_USE_RX_INT
-        if(interrupt_code & (1 << MCP2515_RS_RX0IF))
-        {
-            tmp = MCP2515_SPI_READ_RXB0SIDH;
-        }
-        else
-        {
-            tmp = MCP2515_SPI_READ_RXB1SIDH;
-        }
-        SET_LOW(MCP2515_CS);
-        (void)SPI_M_Transceive(tmp);
-#if MCP2515_CAN_2_B_SUPPORT
-        can_msg.sid  = ((uint32_t)SPI_M_Transceive(0xFF)) << 3; // SIDH
-        tmp = SPI_M_Transceive(0xFF); // SIDL
-        can_msg.sid |= (uint32_t) (tmp >> 5);
-        if(tmp & (1 << MCP2515_IDE))
-        {
-            // extended frame
-            can_msg.ief  = 1;
-            can_msg.eid  = ((uint32_t) (tmp & 0x03)) << 16;
-            can_msg.eid |= ((uint32_t) SPI_M_Transceive(0xFF)) << 8; // EIDH
-            can_msg.eid |= (uint32_t) SPI_M_Transceive(0xFF); // EIDL
-            tmp = SPI_M_Transceive(0xFF); // DLC
-            can_msg.rtr  = (tmp & (1 << MCP2515_RTR)) ? 1 : 0;
-            can_msg.dlc  = tmp & 0x0F;
-        }
-        else
-        {
-            // standard frame
-            can_msg.ief  = 0;
-            can_msg.rtr  = (tmp & (1 << MCP2515_SRR)) ? 1 : 0;
-            (void)SPI_M_Transceive(0xFF); // EIDH
-            (void)SPI_M_Transceive(0xFF); // EIDL
-            can_msg.dlc  = SPI_M_Transceive(0xFF) & 0x0F; // DLC
-        }
-#else // CAN 2.0A only
-        can_msg.sid  = ((uint16_t) SPI_M_Transceive(0xFF)) << 3; // SIDH
-        tmp = SPI_M_Transceive(0xFF); // SIDL
-        can_msg.sid |= (uint16_t) (tmp >> 5);
-        can_msg.rtr  = (uint16_t) ((tmp & (1 << MCP2515_SRR)) ? 1 : 0);
-        (void)SPI_M_Transceive(0xFF); // EIDH
-        (void)SPI_M_Transceive(0xFF); // EIDL
-        can_msg.dlc  = (uint16_t) (SPI_M_Transceive(0xFF) & 0x0F); // DLC
-#endif // MCP2515_CAN_2_B_SUPPORT
-        if(can_msg.rtr == 0)
-        {
-            for(tmp = 0; tmp < can_msg.dlc; tmp++)
-            {
-                can_msg.dataArray[tmp] = SPI_M_Transceive(0xFF);
-            }
-        }
-        SET_HIGH(MCP2515_CS);
-        // CANINTF.RXnIF is being cleared automatically (see 12.4).
-        mcp2515RxCallback(&can_msg);
-#else
-        PRINT_DEBUG("ISR: unexpected RX0/RX1 handling!\n");
-#endif // !MCP2515_USE_RX_INT
-    }
-
-#endif // MCP2515_ERROR_CALLBACK_SUPPORT
-// **********  END OF ISR WITHOUT ERROR CALLBACK SUPPORT *********
+        serviced = mcp2515HandleInterrupt();
+    } while(serviced && --budget);
 
+    SPI_M_Unlock();
     cli();
     EIMSK |= (1 << MCP2515_INTNO_MAIN);
 #if MCP2515_USE_RX_INT
@@ -1285,58 +1702,13 @@ ISR(MCP2515_INT_MAIN_vect, ISR_BLOCK)
 */
 ISR(MCP2515_INT_RXB0_vect, ISR_BLOCK)
 {
-    uint8_t ii, tmp;
-    MCP2515_CanMessageT can_msg;
-
     EIMSK &= ~((1 << MCP2515_INTNO_MAIN) | \
                (1 << MCP2515_INTNO_RXB0) | \
                (1 << MCP2515_INTNO_RXB1));
     sei();
-    SET_LOW(MCP2515_CS);
-    (void)SPI_M_Transceive(MCP2515_SPI_READ_RXB0SIDH);
-#if MCP2515_CAN_2_B_SUPPORT
-    can_msg.sid  = ((uint32_t)SPI_M_Transceive(0xFF)) << 3; // SIDH
-    tmp = SPI_M_Transceive(0xFF); // SIDL
-    can_msg.sid |= (uint32_t) (tmp >> 5);
-    if(tmp & (1 << MCP2515_IDE))
-    {
-        // extended frame
-        can_msg.ief  = 1;
-        can_msg.eid  = ((uint32_t) (tmp & 0x03)) << 16;
-        can_msg.eid |= ((uint32_t) SPI_M_Transceive(0xFF)) << 8; // EIDH
-        can_msg.eid |= (uint32_t) SPI_M_Transceive(0xFF); // EIDL
-        tmp = SPI_M_Transceive(0xFF); // DLC
-        can_msg.rtr  = (tmp & (1 << MCP2515_RTR)) ? 1 : 0;
-        can_msg.dlc  = tmp & 0x0F;
-    }
-    else
-    {
-        // standard frame
-        can_msg.ief  = 0;
-        can_msg.rtr  = (tmp & (1 << MCP2515_SRR)) ? 1 : 0;
-        (void)SPI_M_Transceive(0xFF); // EIDH
-        (void)SPI_M_Transceive(0xFF); // EIDL
-        can_msg.dlc  = SPI_M_Transceive(0xFF) & 0x0F; // DLC
-    }
-#else // CAN 2.0A only
-    can_msg.sid  = ((uint16_t) SPI_M_Transceive(0xFF)) << 3; // SIDH
-    tmp = SPI_M_Transceive(0xFF); // SIDL
-    can_msg.sid |= (uint16_t) (tmp >> 5);
-    can_msg.rtr  = (uint16_t) ((tmp & (1 << MCP2515_SRR)) ? 1 : 0);
-    (void)SPI_M_Transceive(0xFF); // EIDH
-    (void)SPI_M_Transceive(0xFF); // EIDL
-    can_msg.dlc  = (uint16_t) (SPI_M_Transceive(0xFF) & 0x0F); // DLC
-#endif // MCP2515_CAN_2_B_SUPPORT
-    if(can_msg.rtr == 0)
-    {
-        for(ii = 0; ii < can_msg.dlc; ii++)
-        {
-            can_msg.dataArray[ii] = SPI_M_Transceive(0xFF);
-        }
-    }
-    SET_HIGH(MCP2515_CS);
-    // CANINTF.RXnIF is being cleared automatically (see 12.4).
-    mcp2515RxCallback(&can_msg);
+    SPI_M_Lock();
+    mcp2515ReceiveFrame(MCP2515_SPI_READ_RXB0SIDH);
+    SPI_M_Unlock();
     cli();
     EIMSK |= ((1 << MCP2515_INTNO_MAIN) | \
               (1 << MCP2515_INTNO_RXB0) | \
@@ -1352,58 +1724,13 @@ ISR(MCP2515_INT_RXB0_vect, ISR_BLOCK)
 */
 ISR(MCP2515_INT_RXB1_vect, ISR_BLOCK)
 {
-    uint8_t ii, tmp;
-    MCP2515_CanMessageT can_msg;
-
     EIMSK &= ~((1 << MCP2515_INTNO_MAIN) | \
                (1 << MCP2515_INTNO_RXB0) | \
                (1 << MCP2515_INTNO_RXB1));
     sei();
-    SET_LOW(MCP2515_CS);
-    (void)SPI_M_Transceive(MCP2515_SPI_READ_RXB1SIDH);
-#if MCP2515_CAN_2_B_SUPPORT
-    can_msg.sid  = ((uint32_t)SPI_M_Transceive(0xFF)) << 3; // SIDH
-    tmp = SPI_M_Transceive(0xFF); // SIDL
-    can_msg.sid |= (uint32_t) (tmp >> 5);
-    if(tmp & (1 << MCP2515_IDE))
-    {
-        // extended frame
-        can_msg.ief  = 1;
-        can_msg.eid  = ((uint32_t) (tmp & 0x03)) << 16;
-        can_msg.eid |= ((uint32_t) SPI_M_Transceive(0xFF)) << 8; // EIDH
-        can_msg.eid |= (uint32_t) SPI_M_Transceive(0xFF); // EIDL
-        tmp = SPI_M_Transceive(0xFF); // DLC
-        can_msg.rtr  = (tmp & (1 << MCP2515_RTR)) ? 1 : 0;
-        can_msg.dlc  = tmp & 0x0F;
-    }
-    else
-    {
-        // standard frame
-        can_msg.ief  = 0;
-        can_msg.rtr  = (tmp & (1 << MCP2515_SRR)) ? 1 : 0;
-        (void)SPI_M_Transceive(0xFF); // EIDH
-        (void)SPI_M_Transceive(0xFF); // EIDL
-        can_msg.dlc  = SPI_M_Transceive(0xFF) & 0x0F; // DLC
-    }
-#else // CAN 2.0A only
-    can_msg.sid  = ((uint16_t) SPI_M_Transceive(0xFF)) << 3; // SIDH
-    tmp = SPI_M_Transceive(0xFF); // SIDL
-    can_msg.sid |= (uint16_t) (tmp >> 5);
-    can_msg.rtr  = (uint16_t) ((tmp & (1 << MCP2515_SRR)) ? 1 : 0);
-    (void)SPI_M_Transceive(0xFF); // EIDH
-    (void)SPI_M_Transceive(0xFF); // EIDL
-    can_msg.dlc  = (uint16_t) (SPI_M_Transceive(0xFF) & 0x0F); // DLC
-#endif // MCP2515_CAN_2_B_SUPPORT
-    if(can_msg.rtr == 0)
-    {
-        for(ii = 0; ii < can_msg.dlc; ii++)
-        {
-            can_msg.dataArray[ii] = SPI_M_Transceive(0xFF);
-        }
-    }
-    SET_HIGH(MCP2515_CS);
-    // CANINTF.RXnIF is being cleared automatically (see 12.4).
-    mcp2515RxCallback(&can_msg);
+    SPI_M_Lock();
+    mcp2515ReceiveFrame(MCP2515_SPI_READ_RXB1SIDH);
+    SPI_M_Unlock();
     cli();
     EIMSK |= ((1 << MCP2515_INTNO_MAIN) | \
               (1 << MCP2515_INTNO_RXB0) | \
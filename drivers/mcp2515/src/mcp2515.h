@@ -36,6 +36,33 @@
     #define MCP2515_ERROR_CALLBACK_SUPPORT  0
 #endif
 
+/*! Maximum number of passes of the main ISR over the interrupt flags
+**  of the MCP2515 per ISR entry. Each pass reads CANINTF once and services
+**  all flagged sources, i.e. up to two received frames. Must be >= 1.
+*/
+#ifndef MCP2515_ISR_FRAME_BUDGET
+    #define MCP2515_ISR_FRAME_BUDGET        4
+#endif
+
+/*! Set to 1 in order to answer remote frames from a table of responses
+**  within the receive interrupt (see MCP2515_SetRtrResponders()).
+*/
+#ifndef MCP2515_WITH_RTR_RESPONDER
+    #define MCP2515_WITH_RTR_RESPONDER      0
+#endif
+
+/*! Transmit buffer reserved for RTR responses. MCP2515_Transmit() does not
+**  use this buffer if MCP2515_WITH_RTR_RESPONDER is enabled.
+*/
+#ifndef MCP2515_RTR_RESPONDER_BUFFER
+    #define MCP2515_RTR_RESPONDER_BUFFER    MCP2515_TX_BUFFER_0
+#endif
+
+//! Transmit priority of RTR responses.
+#ifndef MCP2515_RTR_RESPONDER_PRIORITY
+    #define MCP2515_RTR_RESPONDER_PRIORITY  MCP2515_TX_PRIORITY_3
+#endif
+
 //! Chip Select (port,pin) for MCP2515 (required)
 #ifndef MCP2515_CS
     #define MCP2515_CS              B,4
@@ -80,6 +107,11 @@
 #endif // MCP2515_LABEL_DEBUG
 
 
+//! Critical section site of the driver, see IRQ_PROFILING.
+#ifndef MCP2515_IRQ_SITE
+#define MCP2515_IRQ_SITE                (IRQ_SITE_BASE_DRIVER + 4)
+#endif
+
 //*****************************************************************************
 //*********************** MCP2515 SPECIFIC ERROR CODES ************************
 //*****************************************************************************
@@ -405,6 +437,31 @@ typedef struct
     uint8_t  dataArray[8];    //!< message data
 } MCP2515_CanBMessageT;
 
+/*!
+*******************************************************************************
+** \brief   CAN message structure in the register layout of the MCP2515.
+**
+**          The header bytes equal the registers SIDH, SIDL, EID8, EID0 and
+**          DLC of a transmit or receive buffer, which are streamed in a
+**          single SPI block transfer instead of being packed and unpacked
+**          for every frame (see MCP2515_TransmitRaw() and
+**          MCP2515_SetRawRxCallback()). Use the MCP2515_Raw...()
+**          helpers to access them. Headers of frames that are transmitted
+**          repeatedly may be built once. For received standard frames, the
+**          driver copies the remote flag from SIDL.SRR to DLC.RTR.
+**
+*******************************************************************************
+*/
+typedef struct
+{
+    uint8_t sidh;             //!< SID10:3
+    uint8_t sidl;             //!< SID2:0, SRR, IDE, EID17:16
+    uint8_t eid8;             //!< EID15:8
+    uint8_t eid0;             //!< EID7:0
+    uint8_t dlc;              //!< RTR, DLC3:0
+    uint8_t dataArray[8];     //!< message data
+} MCP2515_RawMessageT;
+
 /*!
 *******************************************************************************
 ** \brief   CAN message structure.
@@ -472,6 +529,13 @@ typedef struct
 */
 typedef void (*MCP2515_RxCallbackT) (MCP2515_CanMessageT* canMessagePtr);
 
+/*!
+*******************************************************************************
+** \brief   Interface for raw receiver callback
+*******************************************************************************
+*/
+typedef void (*MCP2515_RawRxCallbackT) (MCP2515_RawMessageT* rawMessagePtr);
+
 /*!
 *******************************************************************************
 ** \brief   Interface for transmitter callback
@@ -505,6 +569,95 @@ typedef void (*MCP2515_VoidCallbackT) (void);
 */
 typedef void (*MCP2515_ErrorCallbackT) (uint8_t errState);
 
+/*!
+*******************************************************************************
+** \brief   Entry of the RTR responder table.
+**
+**          A received remote frame with the identifier of msg is answered
+**          by loading msg into the reserved transmit buffer. The RTR flag
+**          of msg must be cleared. Requests which are not answered, e.g.,
+**          because the reserved buffer is still occupied, are passed to
+**          the receiver callback.
+**
+*******************************************************************************
+*/
+typedef struct
+{
+    MCP2515_CanMessageT msg;        //!< response
+    uint8_t             onlyFresh : 1; //!< answer only with updated data
+    uint8_t             fresh     : 1; //!< managed by the driver
+} MCP2515_RtrResponderT;
+
+
+//*****************************************************************************
+//************************* RAW MESSAGE HELPERS *******************************
+//*****************************************************************************
+
+//! Bit positions within the raw message header.
+#define MCP2515_RAW_SIDL_SRR        4
+#define MCP2515_RAW_SIDL_IDE        3
+#define MCP2515_RAW_DLC_RTR         6
+
+//! Set a standard identifier.
+static inline void MCP2515_RawSetStdId (MCP2515_RawMessageT* msgPtr,
+                                        uint16_t sid)
+{
+    msgPtr->sidh = (uint8_t)(sid >> 3);
+    msgPtr->sidl = (uint8_t)(sid << 5);
+    msgPtr->eid8 = 0;
+    msgPtr->eid0 = 0;
+}
+
+//! Set an extended identifier, composed of sid (11 bit) and eid (18 bit).
+static inline void MCP2515_RawSetExtId (MCP2515_RawMessageT* msgPtr,
+                                        uint16_t sid,
+                                        uint32_t eid)
+{
+    msgPtr->sidh = (uint8_t)(sid >> 3);
+    msgPtr->sidl = (uint8_t)(sid << 5) | (1 << MCP2515_RAW_SIDL_IDE)
+                 | ((uint8_t)(eid >> 16) & 0x03);
+    msgPtr->eid8 = (uint8_t)(eid >> 8);
+    msgPtr->eid0 = (uint8_t)eid;
+}
+
+//! Set the data length code and the remote transmission request flag.
+static inline void MCP2515_RawSetDlc (MCP2515_RawMessageT* msgPtr,
+                                      uint8_t dlc,
+                                      uint8_t rtr)
+{
+    msgPtr->dlc = (dlc & 0x0F) | (rtr ? (1 << MCP2515_RAW_DLC_RTR) : 0);
+}
+
+//! Get the standard identifier (the 11 most significant identifier bits).
+static inline uint16_t MCP2515_RawGetStdId (const MCP2515_RawMessageT* msgPtr)
+{
+    return (((uint16_t)msgPtr->sidh << 3) | (msgPtr->sidl >> 5));
+}
+
+//! Get the 18 bit extended identifier part.
+static inline uint32_t MCP2515_RawGetExtId (const MCP2515_RawMessageT* msgPtr)
+{
+    return (((uint32_t)(msgPtr->sidl & 0x03) << 16)
+           | ((uint16_t)msgPtr->eid8 << 8) | msgPtr->eid0);
+}
+
+//! Check whether the identifier is extended.
+static inline uint8_t MCP2515_RawIsExtended (const MCP2515_RawMessageT* msgPtr)
+{
+    return (msgPtr->sidl & (1 << MCP2515_RAW_SIDL_IDE));
+}
+
+//! Check whether the message is a remote transmission request.
+static inline uint8_t MCP2515_RawIsRtr (const MCP2515_RawMessageT* msgPtr)
+{
+    return (msgPtr->dlc & (1 << MCP2515_RAW_DLC_RTR));
+}
+
+//! Get the data length code.
+static inline uint8_t MCP2515_RawGetDlc (const MCP2515_RawMessageT* msgPtr)
+{
+    return (msgPtr->dlc & 0x0F);
+}
 
 //*****************************************************************************
 //************************* FUNCTION DECLARATIONS *****************************
@@ -516,6 +669,9 @@ void    MCP2515_SetRxCallback(MCP2515_RxCallbackT rxCallback);
 void    MCP2515_SetTxCallback(MCP2515_TxCallbackT txCallback);
 MCP2515_TxBufferIdT MCP2515_Transmit(MCP2515_CanMessageT* messagePtr, \
                                      MCP2515_TxParamsT txParams);
+void    MCP2515_SetRawRxCallback(MCP2515_RawRxCallbackT rawRxCallback);
+MCP2515_TxBufferIdT MCP2515_TransmitRaw(MCP2515_RawMessageT* msgPtr, \
+                                        MCP2515_TxParamsT txParams);
 
 #if MCP2515_ERROR_CALLBACK_SUPPORT
 void    MCP2515_SetMessageErrorCallback(MCP2515_VoidCallbackT callback);
@@ -523,4 +679,12 @@ void    MCP2515_SetWakeupCallback(MCP2515_VoidCallbackT callback);
 void    MCP2515_SetErrorCallback(MCP2515_ErrorCallbackT callback);
 #endif // MCP2515_ERROR_CALLBACK_SUPPORT
 
+#if MCP2515_WITH_RTR_RESPONDER
+void    MCP2515_SetRtrResponders(MCP2515_RtrResponderT* responderArr, \
+                                 uint8_t responderCount);
+uint8_t MCP2515_UpdateRtrResponse(uint8_t index, \
+                                  const uint8_t* dataPtr, \
+                                  uint8_t length);
+#endif // MCP2515_WITH_RTR_RESPONDER
+
 #endif // MCP2515_H
@@ -0,0 +1,203 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   Reference counted power reduction (PRR) manager.
+**
+**          Drivers acquire the clock of their peripheral before they access
+**          its registers and release it when they are shut down. The
+**          clock of a peripheral is gated by means of the power reduction
+**          register as soon as its last reference has been released.
+**          POWER_GateUnused() additionally shuts down all peripherals that
+**          have never been acquired; the RUNLOOP calls it when it starts if
+**          RUNLOOP_WITH_POWER_MANAGER is set.
+**
+**          The power management of the drivers is enabled by the
+**          UART_WITH_POWER_MANAGER, SPI_WITH_POWER_MANAGER,
+**          TIMER_WITH_POWER_MANAGER, ADC_WITH_POWER_MANAGER and
+**          TWI_WITH_POWER_MANAGER switches.
+**
+** \attention
+**          Peripherals that are used without a power managed driver must be
+**          listed in #POWER_KEEP_MASK. Timer 2 in asynchronous mode, e.g.,
+**          by the RTC driver, keeps running while PRTIM2 is set.
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#include <stdint.h>
+#include <avr/io.h>
+#include <avr/sleep.h>
+#include <drivers/irq.h>
+#include "power.h"
+
+//*****************************************************************************
+//*************************** DEFINES AND MACROS ******************************
+//*****************************************************************************
+
+#if defined(PRR0)
+#define POWER_PRR                       PRR0
+#else
+#define POWER_PRR                       PRR
+#endif
+
+//! Peripherals that are clocked by clkIO and stop in all modes but idle.
+#define POWER_IO_CLOCK_MASK             ((1 << POWER_Usart0) \
+                                       | (1 << POWER_Usart1) \
+                                       | (1 << POWER_Spi)    \
+                                       | (1 << POWER_Timer0) \
+                                       | (1 << POWER_Timer1) \
+                                       | (1 << POWER_Twi))
+
+//*****************************************************************************
+//**************************** LOCAL VARIABLES ********************************
+//*****************************************************************************
+
+//! Internal state of the power manager.
+static struct
+{
+    uint8_t refCountArr[POWER_PeripheralCount];
+    uint8_t activeMask; //!< peripherals with references
+} powerState;
+
+//*****************************************************************************
+//*************************** PUBLIC FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   Acquire a peripheral and enable its clock.
+**
+** \param   peripheral  The peripheral.
+**
+** \return
+**          - #POWER_OK on success.
+**          - #POWER_ERR_BAD_PARAMETER if peripheral is out of range or has
+**              been acquired 255 times.
+**
+*******************************************************************************
+*/
+uint8_t POWER_Acquire (POWER_PeripheralT peripheral)
+{
+    uint8_t result = POWER_OK;
+
+    if (peripheral >= POWER_PeripheralCount)
+    {
+        return (POWER_ERR_BAD_PARAMETER);
+    }
+    IRQ_GLOBAL_BLOCK(POWER_IRQ_SITE)
+    {
+        if (powerState.refCountArr[peripheral] == UINT8_MAX)
+        {
+            result = POWER_ERR_BAD_PARAMETER;
+        }
+        else if (powerState.refCountArr[peripheral]++ == 0)
+        {
+            powerState.activeMask |= (1 << peripheral);
+            POWER_PRR &= ~(1 << peripheral);
+        }
+    }
+    return (result);
+}
+
+/*!
+*******************************************************************************
+** \brief   Release a peripheral. The clock is gated with the last reference.
+**
+**          The peripheral must have been disabled by its driver before,
+**          e.g., the ADC must be switched off by clearing ADEN.
+**
+** \param   peripheral  The peripheral.
+**
+** \return
+**          - #POWER_OK on success.
+**          - #POWER_ERR_BAD_PARAMETER if peripheral is out of range.
+**          - #POWER_ERR_NOT_ACQUIRED if there is no reference to release.
+**
+*******************************************************************************
+*/
+uint8_t POWER_Release (POWER_PeripheralT peripheral)
+{
+    uint8_t result = POWER_OK;
+
+    if (peripheral >= POWER_PeripheralCount)
+    {
+        return (POWER_ERR_BAD_PARAMETER);
+    }
+    IRQ_GLOBAL_BLOCK(POWER_IRQ_SITE)
+    {
+        if (powerState.refCountArr[peripheral] == 0)
+        {
+            result = POWER_ERR_NOT_ACQUIRED;
+        }
+        else if (--powerState.refCountArr[peripheral] == 0)
+        {
+            powerState.activeMask &= ~(1 << peripheral);
+            if (!(POWER_KEEP_MASK & (1 << peripheral)))
+            {
+                POWER_PRR |= (1 << peripheral);
+            }
+        }
+    }
+    return (result);
+}
+
+/*!
+*******************************************************************************
+** \brief   Shut down all peripherals that are neither acquired nor listed
+**          in #POWER_KEEP_MASK. Should be called once all drivers have been
+**          initialized.
+**
+*******************************************************************************
+*/
+void POWER_GateUnused (void)
+{
+    IRQ_GLOBAL_BLOCK(POWER_IRQ_SITE)
+    {
+        POWER_PRR |= (uint8_t)~(powerState.activeMask | (POWER_KEEP_MASK));
+    }
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Get the deepest sleep mode that keeps all acquired peripherals
+**          and the peripherals in #POWER_KEEP_MASK operational.
+**
+** \return  SLEEP_MODE_IDLE if a peripheral needs clkIO,
+**          SLEEP_MODE_ADC if only the ADC is in use,
+**          SLEEP_MODE_PWR_SAVE if timer 2 runs in asynchronous mode,
+**          SLEEP_MODE_PWR_DOWN otherwise.
+**
+*******************************************************************************
+*/
+uint8_t POWER_GetSleepMode (void)
+{
+    uint8_t active_mask = powerState.activeMask | (POWER_KEEP_MASK);
+    uint8_t io_mask = POWER_IO_CLOCK_MASK;
+
+    // timer 2 needs clkIO unless it is clocked asynchronously:
+    if (!(ASSR & (1 << AS2)))
+    {
+        io_mask |= (1 << POWER_Timer2);
+    }
+    if (active_mask & io_mask)
+    {
+        return (SLEEP_MODE_IDLE);
+    }
+    if (active_mask & (1 << POWER_Adc))
+    {
+        return (SLEEP_MODE_ADC);
+    }
+    if (ASSR & (1 << AS2))
+    {
+        return (SLEEP_MODE_PWR_SAVE);
+    }
+    return (SLEEP_MODE_PWR_DOWN);
+}
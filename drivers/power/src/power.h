@@ -0,0 +1,82 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   Reference counted power reduction (PRR) manager
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#ifndef POWER_H
+#define POWER_H
+
+#include <stdint.h>
+
+//*****************************************************************************
+//*************************** DEFINES AND MACROS ******************************
+//*****************************************************************************
+
+/*! Peripherals that are used by the application without a power managed
+**  driver, as a bit mask of (1 << #POWER_PeripheralT). POWER_GateUnused()
+**  never shuts these down. */
+#ifndef POWER_KEEP_MASK
+#define POWER_KEEP_MASK                 0x00
+#endif
+
+//! Critical section site of the driver, see IRQ_PROFILING.
+#ifndef POWER_IRQ_SITE
+#define POWER_IRQ_SITE                  (IRQ_SITE_BASE_DRIVER + 12)
+#endif
+
+//*****************************************************************************
+//************************* POWER SPECIFIC ERROR CODES ************************
+//*****************************************************************************
+
+/*! POWER specific error base */
+#ifndef POWER_ERR_BASE
+#define POWER_ERR_BASE                  190
+#endif
+
+/*! POWER returns with no errors. */
+#define POWER_OK                        0
+
+/*! A bad parameter has been passed. */
+#define POWER_ERR_BAD_PARAMETER         POWER_ERR_BASE + 0
+
+/*! The peripheral has been released more often than acquired. */
+#define POWER_ERR_NOT_ACQUIRED          POWER_ERR_BASE + 1
+
+//*****************************************************************************
+//******************************** DATA TYPES *********************************
+//*****************************************************************************
+
+//! Peripherals, the values are the bit positions in PRR0.
+typedef enum
+{
+    POWER_Adc = 0,
+    POWER_Usart0,
+    POWER_Spi,
+    POWER_Timer1,
+    POWER_Usart1,
+    POWER_Timer0,
+    POWER_Timer2,
+    POWER_Twi,
+    POWER_PeripheralCount
+} POWER_PeripheralT;
+
+//*****************************************************************************
+//************************* FUNCTION DECLARATIONS *****************************
+//*****************************************************************************
+
+uint8_t POWER_Acquire (POWER_PeripheralT peripheral);
+uint8_t POWER_Release (POWER_PeripheralT peripheral);
+void    POWER_GateUnused (void);
+uint8_t POWER_GetSleepMode (void);
+
+#endif // POWER_H
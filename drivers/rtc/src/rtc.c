@@ -0,0 +1,552 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   Real-time clock based on timer 2 in asynchronous mode.
+**
+**          Timer 2 is clocked by a 32.768 kHz watch crystal on the TOSC1
+**          and TOSC2 pins, divided by 128. Hence, TCNT2 is a sub-second
+**          counter with a resolution of 1/256 s and wraps once per second.
+**          The output compare B interrupt at TCNT2 = 0 counts the seconds
+**          and checks the alarms. As the timer keeps running in power-save
+**          sleep mode, this interrupt wakes the MCU once per second and the
+**          time stays accurate while the system clock is stopped.
+**
+**          The time is kept as seconds since January 1st of
+**          #RTC_EPOCH_YEAR and converted to calendar time on demand. A
+**          separate uptime counter is not affected by RTC_SetTime(), so it
+**          serves as a monotonic time base.
+**
+** \attention
+**          The RTC requires #RTC_USE_TIMER2. Timer 2 must not be used by
+**          the TIMER driver while the RTC is initialized. The crystal
+**          oscillator needs up to 1 s to settle after RTC_Init(). In
+**          asynchronous mode, writes to the timer 2 registers take effect
+**          after up to 2 crystal clock cycles, which is handled by waiting
+**          for the update busy flags in ASSR. Before entering power-save
+**          mode, call RTC_PrepareSleep().
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <drivers/irq.h>
+#include "rtc.h"
+
+//*****************************************************************************
+//*************************** DEFINES AND MACROS ******************************
+//*****************************************************************************
+
+#if (RTC_EPOCH_YEAR % 4)
+#error "RTC_EPOCH_YEAR must be a leap year"
+#endif
+
+//! All update busy flags in ASSR.
+#define RTC_ASSR_BUSY   ((1 << TCN2UB) | (1 << OCR2AUB) | (1 << OCR2BUB) \
+                       | (1 << TCR2AUB) | (1 << TCR2BUB))
+
+#define RTC_SECONDS_PER_DAY     86400UL
+
+//*****************************************************************************
+//**************************** LOCAL DATA TYPES *******************************
+//*****************************************************************************
+
+//! Alarm slot.
+typedef struct
+{
+    RTC_AlarmCallbackT callbackPtr; //!< NULL if the slot is free
+    void*              optArgPtr;
+    uint32_t           seconds;
+} rtcAlarmT;
+
+//*****************************************************************************
+//**************************** LOCAL VARIABLES ********************************
+//*****************************************************************************
+
+//! Internal state of the RTC.
+static struct
+{
+    volatile uint32_t seconds;
+    volatile uint32_t uptimeSeconds; //!< seconds since RTC_Init()
+    uint8_t           uptimeTicks;   //!< counter value lost by RTC_SetTime()
+    rtcAlarmT         alarmArr[RTC_ALARM_COUNT];
+    uint8_t           initialized;
+} rtcState;
+
+//! Days per month in a common year.
+static const uint8_t rtcDaysPerMonthArr[12] =
+{
+    31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31
+};
+
+//*****************************************************************************
+//********************** LOCAL FUNCTION DECLARATIONS **************************
+//*****************************************************************************
+
+static uint8_t rtcIsLeapYear (uint16_t year);
+static uint8_t rtcDaysPerMonth (uint16_t year, uint8_t month);
+
+//*****************************************************************************
+//**************************** LOCAL FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   Tests whether year is a leap year.
+**
+*******************************************************************************
+*/
+static uint8_t rtcIsLeapYear (uint16_t year)
+{
+    return (((year % 4) == 0) && (((year % 100) != 0) || ((year % 400) == 0)));
+}
+
+/*!
+*******************************************************************************
+** \brief   Get the number of days of a month (1 ... 12).
+**
+*******************************************************************************
+*/
+static uint8_t rtcDaysPerMonth (uint16_t year, uint8_t month)
+{
+    if ((month == 2) && rtcIsLeapYear(year))
+    {
+        return (29);
+    }
+    return (rtcDaysPerMonthArr[month - 1]);
+}
+
+//*****************************************************************************
+//*************************** PUBLIC FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   Initializes timer 2 in asynchronous mode and starts the RTC at
+**          second 0 of #RTC_EPOCH_YEAR.
+**
+**          The function blocks for up to 2 crystal clock cycles until the
+**          timer 2 registers have been updated.
+**
+** \return
+**          - #RTC_OK on success.
+**          - #RTC_ERR_NOT_AVAILABLE if #RTC_USE_TIMER2 is not set.
+**
+*******************************************************************************
+*/
+uint8_t RTC_Init (void)
+{
+#if RTC_USE_TIMER2
+    memset(&rtcState, 0, sizeof(rtcState));
+
+    // the sequence follows the data sheet for switching to async mode:
+    TIMSK2 = 0;
+    ASSR   = (1 << AS2);
+    TCNT2  = 0;
+    OCR2B  = 0;
+    TCCR2A = 0;
+    TCCR2B = (1 << CS22) | (1 << CS20); // 32768 Hz / 128
+    while (ASSR & RTC_ASSR_BUSY);
+    TIFR2  = (1 << OCF2B) | (1 << OCF2A) | (1 << TOV2);
+
+    rtcState.initialized = 1;
+    TIMSK2 = (1 << OCIE2B);
+    return (RTC_OK);
+#else
+    return (RTC_ERR_NOT_AVAILABLE);
+#endif // RTC_USE_TIMER2
+}
+
+/*!
+*******************************************************************************
+** \brief   Stops timer 2 and switches it back to the system clock.
+**
+*******************************************************************************
+*/
+void RTC_Exit (void)
+{
+    if (!rtcState.initialized)
+    {
+        return;
+    }
+    TIMSK2 = 0;
+    TCCR2B = 0;
+    while (ASSR & RTC_ASSR_BUSY);
+    ASSR = 0;
+    TIFR2 = (1 << OCF2B) | (1 << OCF2A) | (1 << TOV2);
+    rtcState.initialized = 0;
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Sets the calendar time. The sub-second counter is reset, the
+**          uptime is not affected.
+**
+** \param   timePtr     The new time.
+**
+** \return
+**          - #RTC_OK on success.
+**          - #RTC_ERR_BAD_PARAMETER if timePtr is NULL or out of range.
+**          - #RTC_ERR_NOT_INITIALIZED if the RTC is not running.
+**
+*******************************************************************************
+*/
+uint8_t RTC_SetTime (const RTC_TimeT* timePtr)
+{
+    uint32_t seconds;
+    uint16_t ticks;
+
+    if ((timePtr == NULL)
+    ||  (timePtr->year < RTC_EPOCH_YEAR)
+    ||  (timePtr->year > RTC_EPOCH_YEAR + 135)
+    ||  (timePtr->month < 1) || (timePtr->month > 12)
+    ||  (timePtr->day < 1)
+    ||  (timePtr->day > rtcDaysPerMonth(timePtr->year, timePtr->month))
+    ||  (timePtr->hour > 23) || (timePtr->minute > 59)
+    ||  (timePtr->second > 59))
+    {
+        return (RTC_ERR_BAD_PARAMETER);
+    }
+    if (!rtcState.initialized)
+    {
+        return (RTC_ERR_NOT_INITIALIZED);
+    }
+    seconds = RTC_TimeToSeconds(timePtr);
+
+    while (ASSR & (1 << TCN2UB));
+    IRQ_GLOBAL_BLOCK(RTC_IRQ_SITE)
+    {
+        // carry the elapsed part of the second over to the uptime:
+        ticks = TCNT2;
+        if ((TIFR2 & (1 << OCF2B)) && (ticks < RTC_TICKS_PER_SECOND / 2))
+        {
+            rtcState.uptimeSeconds++;
+        }
+        ticks += rtcState.uptimeTicks;
+        if (ticks >= RTC_TICKS_PER_SECOND)
+        {
+            rtcState.uptimeSeconds++;
+            ticks -= RTC_TICKS_PER_SECOND;
+        }
+        rtcState.uptimeTicks = (uint8_t)ticks;
+
+        TCNT2 = 0;
+        TIFR2 = (1 << OCF2B);
+        rtcState.seconds = seconds;
+    }
+    while (ASSR & (1 << TCN2UB));
+    return (RTC_OK);
+}
+
+/*!
+*******************************************************************************
+** \brief   Get the calendar time.
+**
+** \param   timePtr     Receives the time.
+**
+** \return
+**          - #RTC_OK on success.
+**          - #RTC_ERR_BAD_PARAMETER if timePtr is NULL.
+**
+*******************************************************************************
+*/
+uint8_t RTC_GetTime (RTC_TimeT* timePtr)
+{
+    uint32_t seconds;
+
+    if (timePtr == NULL)
+    {
+        return (RTC_ERR_BAD_PARAMETER);
+    }
+    RTC_GetTimestamp(&seconds, NULL);
+    RTC_SecondsToTime(seconds, timePtr);
+    return (RTC_OK);
+}
+
+/*!
+*******************************************************************************
+** \brief   Get the seconds since #RTC_EPOCH_YEAR and the sub-second
+**          counter as a consistent pair.
+**
+** \param   secondsPtr  Receives the seconds, may be NULL.
+** \param   ticksPtr    Receives the sub-second counter in units of
+**                      1 / #RTC_TICKS_PER_SECOND s, may be NULL.
+**
+*******************************************************************************
+*/
+void RTC_GetTimestamp (uint32_t* secondsPtr, uint8_t* ticksPtr)
+{
+    uint32_t seconds = 0;
+    uint8_t  ticks = 0;
+
+    IRQ_GLOBAL_BLOCK(RTC_IRQ_SITE)
+    {
+        ticks = TCNT2;
+        seconds = rtcState.seconds;
+        // the counter has wrapped, but the ISR has not run yet:
+        if ((TIFR2 & (1 << OCF2B)) && (ticks < RTC_TICKS_PER_SECOND / 2))
+        {
+            seconds++;
+        }
+    }
+    if (secondsPtr)
+    {
+        *secondsPtr = seconds;
+    }
+    if (ticksPtr)
+    {
+        *ticksPtr = ticks;
+    }
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Get the time since RTC_Init() as a consistent pair of seconds
+**          and sub-second counter.
+**
+**          In contrast to RTC_GetTimestamp(), the uptime is monotonic, as
+**          it is not modified by RTC_SetTime().
+**
+** \param   secondsPtr  Receives the seconds, may be NULL.
+** \param   ticksPtr    Receives the sub-second counter in units of
+**                      1 / #RTC_TICKS_PER_SECOND s, may be NULL.
+**
+*******************************************************************************
+*/
+void RTC_GetUptime (uint32_t* secondsPtr, uint8_t* ticksPtr)
+{
+    uint32_t seconds = 0;
+    uint16_t ticks = 0;
+
+    IRQ_GLOBAL_BLOCK(RTC_IRQ_SITE)
+    {
+        ticks = TCNT2;
+        seconds = rtcState.uptimeSeconds;
+        // the counter has wrapped, but the ISR has not run yet:
+        if ((TIFR2 & (1 << OCF2B)) && (ticks < RTC_TICKS_PER_SECOND / 2))
+        {
+            seconds++;
+        }
+        ticks += rtcState.uptimeTicks;
+    }
+    if (ticks >= RTC_TICKS_PER_SECOND)
+    {
+        seconds++;
+        ticks -= RTC_TICKS_PER_SECOND;
+    }
+    if (secondsPtr)
+    {
+        *secondsPtr = seconds;
+    }
+    if (ticksPtr)
+    {
+        *ticksPtr = (uint8_t)ticks;
+    }
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Converts a calendar time to seconds since #RTC_EPOCH_YEAR.
+**
+** \param   timePtr     The calendar time, which must be valid.
+**
+** \return  The seconds since January 1st of #RTC_EPOCH_YEAR.
+**
+*******************************************************************************
+*/
+uint32_t RTC_TimeToSeconds (const RTC_TimeT* timePtr)
+{
+    uint32_t days = 0;
+    uint16_t year;
+    uint8_t  month;
+
+    for (year = RTC_EPOCH_YEAR; year < timePtr->year; year++)
+    {
+        days += rtcIsLeapYear(year) ? 366 : 365;
+    }
+    for (month = 1; month < timePtr->month; month++)
+    {
+        days += rtcDaysPerMonth(timePtr->year, month);
+    }
+    days += timePtr->day - 1;
+    return (days * RTC_SECONDS_PER_DAY
+            + (uint32_t)timePtr->hour * 3600
+            + (uint16_t)timePtr->minute * 60
+            + timePtr->second);
+}
+
+/*!
+*******************************************************************************
+** \brief   Converts seconds since #RTC_EPOCH_YEAR to calendar time.
+**
+** \param   seconds     The seconds since January 1st of #RTC_EPOCH_YEAR.
+** \param   timePtr     Receives the calendar time.
+**
+*******************************************************************************
+*/
+void RTC_SecondsToTime (uint32_t seconds, RTC_TimeT* timePtr)
+{
+    uint32_t days = seconds / RTC_SECONDS_PER_DAY;
+    uint32_t rest = seconds % RTC_SECONDS_PER_DAY;
+    uint16_t days_per_year;
+    uint8_t  days_per_month;
+
+    timePtr->hour   = rest / 3600;
+    rest           %= 3600;
+    timePtr->minute = rest / 60;
+    timePtr->second = rest % 60;
+
+    timePtr->year = RTC_EPOCH_YEAR;
+    days_per_year = 366;
+    while (days >= days_per_year)
+    {
+        days -= days_per_year;
+        timePtr->year++;
+        days_per_year = rtcIsLeapYear(timePtr->year) ? 366 : 365;
+    }
+    timePtr->month = 1;
+    days_per_month = rtcDaysPerMonth(timePtr->year, 1);
+    while (days >= days_per_month)
+    {
+        days -= days_per_month;
+        timePtr->month++;
+        days_per_month = rtcDaysPerMonth(timePtr->year, timePtr->month);
+    }
+    timePtr->day = days + 1;
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Sets an alarm, which executes the callback once when the given
+**          second is reached.
+**
+** \param   alarmId     Index of the alarm (0 ... RTC_ALARM_COUNT - 1).
+** \param   seconds     Seconds since #RTC_EPOCH_YEAR, see
+**                      RTC_TimeToSeconds().
+** \param   callbackPtr The callback, which is executed from within the ISR.
+** \param   optArgPtr   Optional argument that is passed to the callback.
+**
+** \return
+**          - #RTC_OK on success.
+**          - #RTC_ERR_BAD_PARAMETER if alarmId is out of range or
+**              callbackPtr is NULL.
+**
+*******************************************************************************
+*/
+uint8_t RTC_SetAlarm (uint8_t alarmId,
+                      uint32_t seconds,
+                      RTC_AlarmCallbackT callbackPtr,
+                      void* optArgPtr)
+{
+    if ((alarmId >= RTC_ALARM_COUNT) || (callbackPtr == NULL))
+    {
+        return (RTC_ERR_BAD_PARAMETER);
+    }
+    IRQ_GLOBAL_BLOCK(RTC_IRQ_SITE)
+    {
+        rtcState.alarmArr[alarmId].callbackPtr = callbackPtr;
+        rtcState.alarmArr[alarmId].optArgPtr   = optArgPtr;
+        rtcState.alarmArr[alarmId].seconds     = seconds;
+    }
+    return (RTC_OK);
+}
+
+/*!
+*******************************************************************************
+** \brief   Clears an alarm.
+**
+** \param   alarmId     Index of the alarm (0 ... RTC_ALARM_COUNT - 1).
+**
+** \return
+**          - #RTC_OK on success.
+**          - #RTC_ERR_BAD_PARAMETER if alarmId is out of range.
+**
+*******************************************************************************
+*/
+uint8_t RTC_ClearAlarm (uint8_t alarmId)
+{
+    if (alarmId >= RTC_ALARM_COUNT)
+    {
+        return (RTC_ERR_BAD_PARAMETER);
+    }
+    IRQ_GLOBAL_BLOCK(RTC_IRQ_SITE)
+    {
+        rtcState.alarmArr[alarmId].callbackPtr = NULL;
+    }
+    return (RTC_OK);
+}
+
+/*!
+*******************************************************************************
+** \brief   Must be called before entering power-save mode.
+**
+**          After a wake-up by timer 2, at least one crystal clock cycle
+**          must elapse before power-save mode is entered again, otherwise
+**          the interrupt logic may not be ready and the MCU would not wake
+**          up again. This is ensured by rewriting OCR2B and waiting for the
+**          update busy flag.
+**
+*******************************************************************************
+*/
+void RTC_PrepareSleep (void)
+{
+    if (!rtcState.initialized)
+    {
+        return;
+    }
+    OCR2B = 0;
+    while (ASSR & (1 << OCR2BUB));
+    return;
+}
+
+//*****************************************************************************
+//*********************** INTERRUPT SERVICE ROUTINES **************************
+//*****************************************************************************
+
+#if RTC_USE_TIMER2
+
+/*!
+*******************************************************************************
+** \brief   ISR for output compare match B of timer 2, once per second.
+**
+**          Counts the seconds and executes expired alarms.
+**
+*******************************************************************************
+*/
+ISR (TIMER2_COMPB_vect, ISR_BLOCK)
+{
+    rtcAlarmT*         alarm_ptr;
+    RTC_AlarmCallbackT callback_ptr;
+    uint32_t           seconds = rtcState.seconds + 1;
+    uint8_t            ii;
+
+    rtcState.seconds = seconds;
+    rtcState.uptimeSeconds++;
+    for (ii = 0; ii < RTC_ALARM_COUNT; ii++)
+    {
+        alarm_ptr = &rtcState.alarmArr[ii];
+        if ((alarm_ptr->callbackPtr) && (alarm_ptr->seconds == seconds))
+        {
+            // free the slot first, so the callback may set a new alarm:
+            callback_ptr = alarm_ptr->callbackPtr;
+            alarm_ptr->callbackPtr = NULL;
+            callback_ptr(ii, alarm_ptr->optArgPtr);
+        }
+    }
+}
+
+#endif // RTC_USE_TIMER2
@@ -0,0 +1,114 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   Real-time clock based on timer 2 in asynchronous mode
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#ifndef RTC_H
+#define RTC_H
+
+#include <stdint.h>
+
+//*****************************************************************************
+//*************************** DEFINES AND MACROS ******************************
+//*****************************************************************************
+
+/*! Resolution of the sub-second counter. Timer 2 counts the 32.768 kHz
+**  crystal clock divided by 128 and wraps once per second. */
+#define RTC_TICKS_PER_SECOND            256
+
+/*! Set to 1 in order to let the RTC own timer 2 including its output
+**  compare B vector. Disabled by default, so that the vector does not
+**  collide with other drivers which may use timer 2, e.g., SOFTUART and
+**  SOFTPWM. These drivers reject timer 2 at compile time if it is set. */
+#ifndef RTC_USE_TIMER2
+#define RTC_USE_TIMER2                  0
+#endif
+
+//! Number of alarms.
+#ifndef RTC_ALARM_COUNT
+#define RTC_ALARM_COUNT                 2
+#endif
+
+//! Year of second 0, must be a leap year.
+#ifndef RTC_EPOCH_YEAR
+#define RTC_EPOCH_YEAR                  2000
+#endif
+
+//! Critical section site of the driver, see IRQ_PROFILING.
+#ifndef RTC_IRQ_SITE
+#define RTC_IRQ_SITE                    (IRQ_SITE_BASE_DRIVER + 10)
+#endif
+
+//*****************************************************************************
+//************************** RTC SPECIFIC ERROR CODES *************************
+//*****************************************************************************
+
+/*! RTC specific error base */
+#ifndef RTC_ERR_BASE
+#define RTC_ERR_BASE                    170
+#endif
+
+/*! RTC returns with no errors. */
+#define RTC_OK                          0
+
+/*! A bad parameter has been passed. */
+#define RTC_ERR_BAD_PARAMETER           RTC_ERR_BASE + 0
+
+/*! The RTC has not been initialized. */
+#define RTC_ERR_NOT_INITIALIZED         RTC_ERR_BASE + 1
+
+/*! Timer 2 is not owned by the RTC, see #RTC_USE_TIMER2. */
+#define RTC_ERR_NOT_AVAILABLE           RTC_ERR_BASE + 2
+
+//*****************************************************************************
+//******************************** DATA TYPES *********************************
+//*****************************************************************************
+
+//! Calendar time.
+typedef struct
+{
+    uint16_t year;      //!< RTC_EPOCH_YEAR ... RTC_EPOCH_YEAR + 135
+    uint8_t  month;     //!< 1 ... 12
+    uint8_t  day;       //!< 1 ... 31
+    uint8_t  hour;      //!< 0 ... 23
+    uint8_t  minute;    //!< 0 ... 59
+    uint8_t  second;    //!< 0 ... 59
+} RTC_TimeT;
+
+/*! Alarm callback, executed from within the timer 2 ISR.
+**
+**  \param  alarmId     Index of the alarm that has expired.
+**  \param  optArgPtr   The argument that has been passed to RTC_SetAlarm().
+*/
+typedef void (*RTC_AlarmCallbackT) (uint8_t alarmId, void* optArgPtr);
+
+//*****************************************************************************
+//************************* FUNCTION DECLARATIONS *****************************
+//*****************************************************************************
+
+uint8_t  RTC_Init (void);
+void     RTC_Exit (void);
+uint8_t  RTC_SetTime (const RTC_TimeT* timePtr);
+uint8_t  RTC_GetTime (RTC_TimeT* timePtr);
+void     RTC_GetTimestamp (uint32_t* secondsPtr, uint8_t* ticksPtr);
+void     RTC_GetUptime (uint32_t* secondsPtr, uint8_t* ticksPtr);
+uint32_t RTC_TimeToSeconds (const RTC_TimeT* timePtr);
+void     RTC_SecondsToTime (uint32_t seconds, RTC_TimeT* timePtr);
+uint8_t  RTC_SetAlarm (uint8_t alarmId,
+                       uint32_t seconds,
+                       RTC_AlarmCallbackT callbackPtr,
+                       void* optArgPtr);
+uint8_t  RTC_ClearAlarm (uint8_t alarmId);
+void     RTC_PrepareSleep (void);
+
+#endif // RTC_H
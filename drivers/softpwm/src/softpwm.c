@@ -0,0 +1,392 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   Software PWM with bit angle modulation.
+**
+**          Drives up to #SOFTPWM_MAX_CHANNELS arbitrary pins with PWM by
+**          means of bit angle modulation (BAM): a PWM period consists of
+**          one slot per bit of the duty cycle, and the slot of bit k lasts
+**          SOFTPWM_LSB_TICKS * 2^k timer ticks. During the slot of bit k,
+**          a channel is high if bit k of its duty cycle is set. Hence, only
+**          SOFTPWM_RESOLUTION interrupts are required per period.
+**
+**          The output compare unit B of a free-running timer schedules the
+**          slots by advancing OCRnB by the duration of each slot. The port
+**          values of all slots are precomputed per port, so that the ISR
+**          just writes one byte to each port in use and its execution time
+**          does not depend on the number of channels.
+**
+**          Duty cycles are set with SOFTPWM_SetDuty() and take effect with
+**          SOFTPWM_Commit(), which computes the port values into a second
+**          buffer. The ISR switches to that buffer at the beginning of the
+**          next period, so that all channels change synchronously.
+**
+** \attention
+**          The ISR performs read-modify-write operations on the ports of
+**          the channels. Other pins of these ports must not be modified by
+**          non-atomic read-modify-write operations while the software PWM
+**          is running. Single bit operations on I/O ports (sbi/cbi) are
+**          safe.
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <drivers/irq.h>
+#include <drivers/rtc.h>
+#include "softpwm.h"
+
+//*****************************************************************************
+//*************************** DEFINES AND MACROS ******************************
+//*****************************************************************************
+
+#if (SOFTPWM_RESOLUTION < 1) || (SOFTPWM_RESOLUTION > 8)
+#error "SOFTPWM_RESOLUTION must be in range 1 ... 8"
+#endif
+
+#if (SOFTPWM_MAX_CHANNELS < 1) || (SOFTPWM_MAX_CHANNELS > 32)
+#error "SOFTPWM_MAX_CHANNELS must be in range 1 ... 32"
+#endif
+
+//! Maximum number of ports that can be driven.
+#define SOFTPWM_MAX_PORTS       4
+
+// Registers of the timer:
+#if SOFTPWM_TIMER == 0
+#define SOFTPWM_TCNT            TCNT0
+#define SOFTPWM_OCR             OCR0B
+#define SOFTPWM_TIMSK           TIMSK0
+#define SOFTPWM_OCIE            OCIE0B
+#define SOFTPWM_TIFR            TIFR0
+#define SOFTPWM_OCF             OCF0B
+#define SOFTPWM_vect            TIMER0_COMPB_vect
+#define SOFTPWM_COUNTER_T       uint8_t
+#elif SOFTPWM_TIMER == 1
+#define SOFTPWM_TCNT            TCNT1
+#define SOFTPWM_OCR             OCR1B
+#define SOFTPWM_TIMSK           TIMSK1
+#define SOFTPWM_OCIE            OCIE1B
+#define SOFTPWM_TIFR            TIFR1
+#define SOFTPWM_OCF             OCF1B
+#define SOFTPWM_vect            TIMER1_COMPB_vect
+#define SOFTPWM_COUNTER_T       uint16_t
+#elif SOFTPWM_TIMER == 2
+#define SOFTPWM_TCNT            TCNT2
+#define SOFTPWM_OCR             OCR2B
+#define SOFTPWM_TIMSK           TIMSK2
+#define SOFTPWM_OCIE            OCIE2B
+#define SOFTPWM_TIFR            TIFR2
+#define SOFTPWM_OCF             OCF2B
+#define SOFTPWM_vect            TIMER2_COMPB_vect
+#define SOFTPWM_COUNTER_T       uint8_t
+#else
+#error "SOFTPWM_TIMER must be 0, 1 or 2"
+#endif
+
+// The RTC clocks timer 2 asynchronously from its crystal, which leaves no
+// compare unit for the PWM slots:
+#if RTC_USE_TIMER2 && (SOFTPWM_TIMER == 2)
+#error "Timer 2 is owned by the RTC, see RTC_USE_TIMER2"
+#endif
+
+#if (SOFTPWM_TIMER != 1) \
+ && ((SOFTPWM_LSB_TICKS << (SOFTPWM_RESOLUTION - 1)) > 255)
+#error "The longest slot exceeds the range of the 8 bit timer"
+#endif
+
+//*****************************************************************************
+//**************************** LOCAL DATA TYPES *******************************
+//*****************************************************************************
+
+//! Output of a channel.
+typedef struct
+{
+    uint8_t port;   //!< index into portPtrArr
+    uint8_t mask;   //!< bit of the pin
+} softpwmChannelT;
+
+//*****************************************************************************
+//**************************** LOCAL VARIABLES ********************************
+//*****************************************************************************
+
+//! Internal state of the software PWM.
+static struct
+{
+    //! Port values per buffer, slot and port:
+    uint8_t           valueArr[2][SOFTPWM_RESOLUTION][SOFTPWM_MAX_PORTS];
+    volatile uint8_t* portPtrArr[SOFTPWM_MAX_PORTS];
+    uint8_t           portMaskArr[SOFTPWM_MAX_PORTS];
+    softpwmChannelT   channelArr[SOFTPWM_MAX_CHANNELS];
+    uint8_t           dutyArr[SOFTPWM_MAX_CHANNELS];
+    uint8_t           channelCount;
+    uint8_t           portCount;
+    uint8_t           slot;         //!< slot that is output next
+    uint8_t           active;       //!< buffer used by the ISR
+    volatile uint8_t  commitPending;
+    uint8_t           initialized;
+} softpwmState;
+
+//*****************************************************************************
+//********************** LOCAL FUNCTION DECLARATIONS **************************
+//*****************************************************************************
+
+static void softpwmCompute (uint8_t buffer);
+
+//*****************************************************************************
+//**************************** LOCAL FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   Computes the port values of all slots from the duty cycles.
+**
+** \param   buffer      The buffer to compute, must not be used by the ISR.
+**
+*******************************************************************************
+*/
+static void softpwmCompute (uint8_t buffer)
+{
+    softpwmChannelT* channel_ptr;
+    uint8_t          slot;
+    uint8_t          ii;
+
+    memset(softpwmState.valueArr[buffer], 0,
+           sizeof(softpwmState.valueArr[buffer]));
+    for (ii = 0; ii < softpwmState.channelCount; ii++)
+    {
+        channel_ptr = &softpwmState.channelArr[ii];
+        for (slot = 0; slot < SOFTPWM_RESOLUTION; slot++)
+        {
+            if (softpwmState.dutyArr[ii] & (1 << slot))
+            {
+                softpwmState.valueArr[buffer][slot][channel_ptr->port] |=
+                    channel_ptr->mask;
+            }
+        }
+    }
+    return;
+}
+
+//*****************************************************************************
+//*************************** PUBLIC FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   Initializes the software PWM and starts it with all duty cycles
+**          set to 0.
+**
+**          The pins are configured as outputs. The timer given by
+**          #SOFTPWM_TIMER must already be running freely, see there.
+**
+** \param   pinArr          Output pins of the channels, e.g.,
+**                          { SOFTPWM_PIN(LED_0), SOFTPWM_PIN(LED_1) }.
+** \param   channelCount    Number of channels in pinArr.
+**
+** \return
+**          - #SOFTPWM_OK on success.
+**          - #SOFTPWM_ERR_BAD_PARAMETER if pinArr is NULL or channelCount
+**              is out of range.
+**          - #SOFTPWM_ERR_TOO_MANY_PORTS if the pins are spread over more
+**              than 4 ports.
+**
+*******************************************************************************
+*/
+uint8_t SOFTPWM_Init (const SOFTPWM_PinT* pinArr, uint8_t channelCount)
+{
+    uint8_t port;
+    uint8_t ii;
+
+    if ((pinArr == NULL)
+    ||  (channelCount == 0)
+    ||  (channelCount > SOFTPWM_MAX_CHANNELS))
+    {
+        return (SOFTPWM_ERR_BAD_PARAMETER);
+    }
+
+    SOFTPWM_Exit();
+    memset(&softpwmState, 0, sizeof(softpwmState));
+
+    // group the channels by port:
+    for (ii = 0; ii < channelCount; ii++)
+    {
+        if ((pinArr[ii].portPtr == NULL)
+        ||  (pinArr[ii].ddrPtr == NULL)
+        ||  (pinArr[ii].idx > 7))
+        {
+            return (SOFTPWM_ERR_BAD_PARAMETER);
+        }
+        for (port = 0; port < softpwmState.portCount; port++)
+        {
+            if (softpwmState.portPtrArr[port] == pinArr[ii].portPtr)
+            {
+                break;
+            }
+        }
+        if (port == softpwmState.portCount)
+        {
+            if (port == SOFTPWM_MAX_PORTS)
+            {
+                return (SOFTPWM_ERR_TOO_MANY_PORTS);
+            }
+            softpwmState.portPtrArr[port] = pinArr[ii].portPtr;
+            softpwmState.portCount++;
+        }
+        softpwmState.channelArr[ii].port = port;
+        softpwmState.channelArr[ii].mask = (1 << pinArr[ii].idx);
+        softpwmState.portMaskArr[port] |= (1 << pinArr[ii].idx);
+    }
+    softpwmState.channelCount = channelCount;
+
+    for (ii = 0; ii < channelCount; ii++)
+    {
+        *pinArr[ii].portPtr &= ~(1 << pinArr[ii].idx);
+        *pinArr[ii].ddrPtr  |=  (1 << pinArr[ii].idx);
+    }
+
+    IRQ_GLOBAL_BLOCK(SOFTPWM_IRQ_SITE)
+    {
+        softpwmState.initialized = 1;
+        SOFTPWM_OCR = SOFTPWM_TCNT + SOFTPWM_LSB_TICKS;
+        SOFTPWM_TIFR = (1 << SOFTPWM_OCF);
+        SOFTPWM_TIMSK |= (1 << SOFTPWM_OCIE);
+    }
+    return (SOFTPWM_OK);
+}
+
+/*!
+*******************************************************************************
+** \brief   Stops the software PWM. The pins keep their current levels.
+**
+*******************************************************************************
+*/
+void SOFTPWM_Exit (void)
+{
+    IRQ_GLOBAL_BLOCK(SOFTPWM_IRQ_SITE)
+    {
+        SOFTPWM_TIMSK &= ~(1 << SOFTPWM_OCIE);
+        softpwmState.initialized = 0;
+    }
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Sets the duty cycle of a channel. The duty cycle takes effect
+**          with the next call of SOFTPWM_Commit().
+**
+** \param   channel     Index of the channel in the pinArr passed to
+**                      SOFTPWM_Init().
+** \param   duty        Duty cycle in range 0 ... 2^SOFTPWM_RESOLUTION - 1.
+**
+** \return
+**          - #SOFTPWM_OK on success.
+**          - #SOFTPWM_ERR_BAD_PARAMETER if channel or duty is out of range.
+**
+*******************************************************************************
+*/
+uint8_t SOFTPWM_SetDuty (uint8_t channel, uint8_t duty)
+{
+    if ((channel >= softpwmState.channelCount)
+    ||  ((uint16_t)duty >> SOFTPWM_RESOLUTION))
+    {
+        return (SOFTPWM_ERR_BAD_PARAMETER);
+    }
+    softpwmState.dutyArr[channel] = duty;
+    return (SOFTPWM_OK);
+}
+
+/*!
+*******************************************************************************
+** \brief   Applies the duty cycles of all channels at the beginning of the
+**          next PWM period.
+**
+** \return
+**          - #SOFTPWM_OK on success.
+**          - #SOFTPWM_ERR_NOT_INITIALIZED if the software PWM is not running.
+**          - #SOFTPWM_ERR_BUSY if the previous commit has not been taken
+**              over yet. Nothing has been changed and the call may be
+**              repeated later.
+**
+*******************************************************************************
+*/
+uint8_t SOFTPWM_Commit (void)
+{
+    if (!softpwmState.initialized)
+    {
+        return (SOFTPWM_ERR_NOT_INITIALIZED);
+    }
+    if (softpwmState.commitPending)
+    {
+        return (SOFTPWM_ERR_BUSY);
+    }
+    softpwmCompute(softpwmState.active ^ 1);
+    softpwmState.commitPending = 1;
+    return (SOFTPWM_OK);
+}
+
+/*!
+*******************************************************************************
+** \brief   Tests whether committed duty cycles wait for the next period.
+**
+*******************************************************************************
+*/
+uint8_t SOFTPWM_IsCommitPending (void)
+{
+    return (softpwmState.commitPending);
+}
+
+//*****************************************************************************
+//*********************** INTERRUPT SERVICE ROUTINES **************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   ISR for output compare match B of the PWM timer.
+**
+**          Outputs the port values of the current slot and schedules the
+**          next slot.
+**
+*******************************************************************************
+*/
+ISR (SOFTPWM_vect, ISR_BLOCK)
+{
+    const uint8_t* value_ptr;
+    uint8_t        slot = softpwmState.slot;
+    uint8_t        port;
+
+    SOFTPWM_OCR += (SOFTPWM_COUNTER_T)(SOFTPWM_LSB_TICKS << slot);
+
+    if (slot == 0)
+    {
+        if (softpwmState.commitPending)
+        {
+            softpwmState.active ^= 1;
+            softpwmState.commitPending = 0;
+        }
+    }
+    value_ptr = softpwmState.valueArr[softpwmState.active][slot];
+    for (port = 0; port < softpwmState.portCount; port++)
+    {
+        *softpwmState.portPtrArr[port] =
+            (*softpwmState.portPtrArr[port] & ~softpwmState.portMaskArr[port])
+            | value_ptr[port];
+    }
+
+    if (++slot >= SOFTPWM_RESOLUTION)
+    {
+        slot = 0;
+    }
+    softpwmState.slot = slot;
+}
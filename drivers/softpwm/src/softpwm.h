@@ -0,0 +1,111 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   Software PWM with bit angle modulation
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#ifndef SOFTPWM_H
+#define SOFTPWM_H
+
+#include <stdint.h>
+
+//*****************************************************************************
+//*************************** DEFINES AND MACROS ******************************
+//*****************************************************************************
+
+/*! Timer whose output compare unit B is used (0, 1 or 2). The timer must be
+**  set up by the application by means of the TIMER driver in normal mode
+**  with output mode B set to normal port operation and must be running.
+**  The slots are scheduled relative to the previous compare match, so the
+**  counter must run freely: neither a countdown nor the stopwatch of the
+**  TIMER driver may be used on this timer, since both reset the counter. */
+#ifndef SOFTPWM_TIMER
+#define SOFTPWM_TIMER                   1
+#endif
+
+//! Maximum number of channels.
+#ifndef SOFTPWM_MAX_CHANNELS
+#define SOFTPWM_MAX_CHANNELS            24
+#endif
+
+//! Resolution of the duty cycles in bits (1 ... 8).
+#ifndef SOFTPWM_RESOLUTION
+#define SOFTPWM_RESOLUTION              8
+#endif
+
+/*! Duration of the least significant bit in timer ticks. It must exceed the
+**  execution time of the ISR (about 100 clock cycles). The PWM period is
+**  SOFTPWM_LSB_TICKS * (2^SOFTPWM_RESOLUTION - 1) timer ticks. For the
+**  8 bit timers, SOFTPWM_LSB_TICKS << (SOFTPWM_RESOLUTION - 1) must not
+**  exceed 255. */
+#ifndef SOFTPWM_LSB_TICKS
+#define SOFTPWM_LSB_TICKS               128
+#endif
+
+/*! Builds a SOFTPWM_PinT initializer from a (PORT,PIN) macro in the style
+**  of macros_pin.h, e.g., SOFTPWM_PIN(LED_RED) with
+**  #define LED_RED B,3 */
+#define SOFTPWM_PIN(x)                  _xSOFTPWM_PIN(x)
+#define _xSOFTPWM_PIN(x,y)              { &PORT ## x, &DDR ## x, (y) }
+
+//! Critical section site of the driver, see IRQ_PROFILING.
+#ifndef SOFTPWM_IRQ_SITE
+#define SOFTPWM_IRQ_SITE                (IRQ_SITE_BASE_DRIVER + 8)
+#endif
+
+//*****************************************************************************
+//************************ SOFTPWM SPECIFIC ERROR CODES ***********************
+//*****************************************************************************
+
+/*! SOFTPWM specific error base */
+#ifndef SOFTPWM_ERR_BASE
+#define SOFTPWM_ERR_BASE                90
+#endif
+
+/*! SOFTPWM returns with no errors. */
+#define SOFTPWM_OK                      0
+
+/*! A bad parameter has been passed. */
+#define SOFTPWM_ERR_BAD_PARAMETER       SOFTPWM_ERR_BASE + 0
+
+/*! The software PWM has not been initialized. */
+#define SOFTPWM_ERR_NOT_INITIALIZED     SOFTPWM_ERR_BASE + 1
+
+/*! The channels use more than 4 different ports. */
+#define SOFTPWM_ERR_TOO_MANY_PORTS      SOFTPWM_ERR_BASE + 2
+
+/*! The previously committed duty cycles have not been taken over yet. */
+#define SOFTPWM_ERR_BUSY                SOFTPWM_ERR_BASE + 3
+
+//*****************************************************************************
+//******************************** DATA TYPES *********************************
+//*****************************************************************************
+
+//! Output pin of a channel.
+typedef struct
+{
+    volatile uint8_t* portPtr;
+    volatile uint8_t* ddrPtr;
+    uint8_t           idx;
+} SOFTPWM_PinT;
+
+//*****************************************************************************
+//************************* FUNCTION DECLARATIONS *****************************
+//*****************************************************************************
+
+uint8_t SOFTPWM_Init (const SOFTPWM_PinT* pinArr, uint8_t channelCount);
+void    SOFTPWM_Exit (void);
+uint8_t SOFTPWM_SetDuty (uint8_t channel, uint8_t duty);
+uint8_t SOFTPWM_Commit (void);
+uint8_t SOFTPWM_IsCommitPending (void);
+
+#endif // SOFTPWM_H
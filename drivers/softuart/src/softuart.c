@@ -0,0 +1,634 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   Timer driven software UART with 8 data bits, no parity and
+**          1 stop bit.
+**
+**          The TX bits are clocked by output compare unit B of
+**          #SOFTUART_TX_TIMER. Each compare match ISR drives the TX pin and
+**          advances OCRnB by one bit time. The falling edge of the start
+**          bit is detected by external interrupt #SOFTUART_RX_INT through
+**          the EXTINT driver. Its callback masks the external interrupt and
+**          schedules output compare unit B of #SOFTUART_RX_TIMER to sample
+**          the data bits in the middle of each bit and finally the stop
+**          bit. As TX and RX use separate compare units, the software UART
+**          operates full duplex. Received and transmitted bytes are stored
+**          in BUFFER ring buffers.
+**
+**          ISR cost at 18.432 MHz (approximate, including prologue and
+**          epilogue):
+**          - TX: 60 cycles per bit, 150 cycles for the bit that fetches
+**            the next byte from the tx buffer.
+**          - RX: 100 cycles for the start bit (EXTINT dispatch and
+**            callback), 50 cycles per data bit, 150 cycles for the stop
+**            bit, which stores the byte in the rx buffer.
+**          At 38400 baud full duplex, this sums up to roughly 5 million
+**          cycles per second, i.e., 30 % of the CPU. Other ISRs and global
+**          critical sections must not delay these ISRs by more than about
+**          a quarter bit time (120 cycles at 38400 baud).
+**
+**          Buffer accesses of the main program mask only the compare
+**          interrupt of the respective direction and copy fields byte by
+**          byte, so that the bit timing is disturbed by a few cycles at
+**          most.
+**
+** \attention
+**          The driver uses the output compare B interrupt of the TX and RX
+**          timers, which the TIMER driver leaves alone. The timers must
+**          not be reconfigured while the software UART is initialized.
+**          The external interrupt is temporarily disabled in EIMSK while a
+**          byte is being received.
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <drivers/macros_pin.h>
+#include <drivers/buffer.h>
+#include <drivers/irq.h>
+#include <drivers/extint.h>
+#include <drivers/rtc.h>
+#include "softuart.h"
+
+//*****************************************************************************
+//*************************** DEFINES AND MACROS ******************************
+//*****************************************************************************
+
+#if (SOFTUART_TX_TIMER < 0) || (SOFTUART_TX_TIMER > 2) \
+ || (SOFTUART_RX_TIMER < 0) || (SOFTUART_RX_TIMER > 2)
+#error "SOFTUART_TX_TIMER and SOFTUART_RX_TIMER must be 0, 1 or 2"
+#endif
+
+#if SOFTUART_TX_TIMER == SOFTUART_RX_TIMER
+#error "SOFTUART_TX_TIMER and SOFTUART_RX_TIMER must be different"
+#endif
+
+// The bit timing cannot run on timer 2 while the RTC clocks it from the
+// 32.768 kHz crystal:
+#if RTC_USE_TIMER2 && ((SOFTUART_TX_TIMER == 2) || (SOFTUART_RX_TIMER == 2))
+#error "Timer 2 is owned by the RTC, see RTC_USE_TIMER2"
+#endif
+
+#if (SOFTUART_RX_INT < 0) || (SOFTUART_RX_INT >= EXTINT_INT_COUNT)
+#error "SOFTUART_RX_INT is not available"
+#endif
+
+//! Builds the name of a timer register, e.g., SOFTUART_REG(OCR, 0, B).
+#define SOFTUART_REG(prefix, timer, suffix) \
+    _xSOFTUART_REG(prefix, timer, suffix)
+#define _xSOFTUART_REG(prefix, timer, suffix)   prefix ## timer ## suffix
+
+// Registers of the TX timer:
+#define SOFTUART_TX_TCNT        SOFTUART_REG(TCNT,  SOFTUART_TX_TIMER, )
+#define SOFTUART_TX_OCR         SOFTUART_REG(OCR,   SOFTUART_TX_TIMER, B)
+#define SOFTUART_TX_TIMSK       SOFTUART_REG(TIMSK, SOFTUART_TX_TIMER, )
+#define SOFTUART_TX_OCIE        SOFTUART_REG(OCIE,  SOFTUART_TX_TIMER, B)
+#define SOFTUART_TX_TIFR        SOFTUART_REG(TIFR,  SOFTUART_TX_TIMER, )
+#define SOFTUART_TX_OCF         SOFTUART_REG(OCF,   SOFTUART_TX_TIMER, B)
+#define SOFTUART_TX_vect        SOFTUART_REG(TIMER, SOFTUART_TX_TIMER, _COMPB_vect)
+
+// Registers of the RX timer:
+#define SOFTUART_RX_TCNT        SOFTUART_REG(TCNT,  SOFTUART_RX_TIMER, )
+#define SOFTUART_RX_OCR         SOFTUART_REG(OCR,   SOFTUART_RX_TIMER, B)
+#define SOFTUART_RX_TIMSK       SOFTUART_REG(TIMSK, SOFTUART_RX_TIMER, )
+#define SOFTUART_RX_OCIE        SOFTUART_REG(OCIE,  SOFTUART_RX_TIMER, B)
+#define SOFTUART_RX_TIFR        SOFTUART_REG(TIFR,  SOFTUART_RX_TIMER, )
+#define SOFTUART_RX_OCF         SOFTUART_REG(OCF,   SOFTUART_RX_TIMER, B)
+#define SOFTUART_RX_vect        SOFTUART_REG(TIMER, SOFTUART_RX_TIMER, _COMPB_vect)
+
+// Counter types of the timers:
+#if SOFTUART_TX_TIMER == 1
+#define SOFTUART_TX_COUNTER_T   uint16_t
+#define SOFTUART_TX_COUNTER_MAX 0xFFFF
+#else
+#define SOFTUART_TX_COUNTER_T   uint8_t
+#define SOFTUART_TX_COUNTER_MAX 0xFF
+#endif
+
+#if SOFTUART_RX_TIMER == 1
+#define SOFTUART_RX_COUNTER_T   uint16_t
+#define SOFTUART_RX_COUNTER_MAX 0xFFFF
+#else
+#define SOFTUART_RX_COUNTER_T   uint8_t
+#define SOFTUART_RX_COUNTER_MAX 0xFF
+#endif
+
+/*! Minimum bit time in system clock cycles. Below, the ISRs would not
+**  leave enough headroom for jitter and the rest of the application. */
+#define SOFTUART_MIN_BIT_CYCLES 300
+
+//! Bits per frame including start and stop bit.
+#define SOFTUART_FRAME_BITS     10
+
+//*****************************************************************************
+//**************************** LOCAL VARIABLES ********************************
+//*****************************************************************************
+
+//! Internal state of the software UART.
+static struct
+{
+    BUFFER_BufT       rxBuffer;
+    BUFFER_BufT       txBuffer;
+    uint16_t          bitTicks;     //!< bit time in timer ticks
+    uint16_t          txFrame;      //!< remaining bits of the tx frame
+    uint8_t           txBits;       //!< count of remaining bits in txFrame
+    volatile uint8_t  txActive;
+    uint8_t           rxShift;      //!< data bits received so far
+    uint8_t           rxBits;       //!< count of data bits received so far
+    volatile uint8_t  frameErrorCount;
+    volatile uint8_t  overflowCount;
+    uint8_t           initialized;
+} softuartState;
+
+static uint8_t softuartRxArr[SOFTUART_BUFFER_LENGTH_RX];
+static uint8_t softuartTxArr[SOFTUART_BUFFER_LENGTH_TX];
+
+//*****************************************************************************
+//********************** LOCAL FUNCTION DECLARATIONS **************************
+//*****************************************************************************
+
+static void softuartRxStart (uint8_t level, uint16_t timestamp, void* optArgPtr);
+
+//*****************************************************************************
+//**************************** LOCAL FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   EXTINT callback on the falling edge of the start bit.
+**
+**          Disables the external interrupt for the duration of the frame
+**          and schedules the sample of the first data bit 1.5 bit times
+**          after the edge.
+**
+*******************************************************************************
+*/
+static void softuartRxStart (uint8_t level, uint16_t timestamp, void* optArgPtr)
+{
+    (void)level;
+    (void)timestamp;
+    (void)optArgPtr;
+
+    SOFTUART_RX_OCR = SOFTUART_RX_TCNT
+        + (SOFTUART_RX_COUNTER_T)(softuartState.bitTicks
+                                  + (softuartState.bitTicks >> 1)
+                                  - SOFTUART_RX_LATENCY_TICKS);
+    SOFTUART_RX_TIFR = (1 << SOFTUART_RX_OCF);
+    SOFTUART_RX_TIMSK |= (1 << SOFTUART_RX_OCIE);
+    EIMSK &= ~(1 << SOFTUART_RX_INT);
+    softuartState.rxBits = 0;
+    return;
+}
+
+//*****************************************************************************
+//*************************** PUBLIC FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   Initializes the software UART.
+**
+**          The TX and RX timers must already be running, see
+**          #SOFTUART_TX_TIMER. The external interrupt #SOFTUART_RX_INT is
+**          attached by means of the EXTINT driver.
+**
+** \param   baudRate    The baud rate in bit/s.
+**
+** \return
+**          - #SOFTUART_OK on success.
+**          - #SOFTUART_ERR_BAD_BAUD_RATE if the bit time is too short for
+**              the ISRs or too long for the timers.
+**          - #SOFTUART_ERR_BAD_PARAMETER if the external interrupt cannot
+**              be attached, e.g., if its vector is not owned by the EXTINT
+**              driver.
+**
+*******************************************************************************
+*/
+uint8_t SOFTUART_Init (uint32_t baudRate)
+{
+    uint32_t bit_ticks;
+
+    if (baudRate == 0)
+    {
+        return (SOFTUART_ERR_BAD_BAUD_RATE);
+    }
+    bit_ticks = (F_CPU / SOFTUART_TIMER_PRESCALER + baudRate / 2) / baudRate;
+    // TX steps by one bit, RX by 1.5 bits from the start bit edge:
+    if ((bit_ticks * SOFTUART_TIMER_PRESCALER < SOFTUART_MIN_BIT_CYCLES)
+    ||  (bit_ticks > SOFTUART_TX_COUNTER_MAX)
+    ||  (bit_ticks + (bit_ticks >> 1) > SOFTUART_RX_COUNTER_MAX))
+    {
+        return (SOFTUART_ERR_BAD_BAUD_RATE);
+    }
+
+    SOFTUART_Exit();
+    memset(&softuartState, 0, sizeof(softuartState));
+    softuartState.bitTicks = (uint16_t)bit_ticks;
+    BUFFER_InitBuffer(&softuartState.rxBuffer,
+                      softuartRxArr, SOFTUART_BUFFER_LENGTH_RX);
+    BUFFER_InitBuffer(&softuartState.txBuffer,
+                      softuartTxArr, SOFTUART_BUFFER_LENGTH_TX);
+
+    // idle level:
+    SET_HIGH(SOFTUART_TX);
+    SET_OUTPUT(SOFTUART_TX);
+    SET_INPUT(SOFTUART_RX);
+    SET_HIGH(SOFTUART_RX); // pull-up
+
+    if (EXTINT_AttachInt(SOFTUART_RX_INT, EXTINT_Sense_FallingEdge,
+                         softuartRxStart, NULL) != EXTINT_OK)
+    {
+        return (SOFTUART_ERR_BAD_PARAMETER);
+    }
+    softuartState.initialized = 1;
+    return (SOFTUART_OK);
+}
+
+/*!
+*******************************************************************************
+** \brief   Stops the software UART immediately and detaches the external
+**          interrupt. Pending tx data is discarded.
+**
+*******************************************************************************
+*/
+void SOFTUART_Exit (void)
+{
+    if (!softuartState.initialized)
+    {
+        return;
+    }
+    (void)EXTINT_DetachInt(SOFTUART_RX_INT);
+    IRQ_GLOBAL_BLOCK(SOFTUART_IRQ_SITE)
+    {
+        SOFTUART_TX_TIMSK &= ~(1 << SOFTUART_TX_OCIE);
+        SOFTUART_RX_TIMSK &= ~(1 << SOFTUART_RX_OCIE);
+        softuartState.txActive = 0;
+        softuartState.initialized = 0;
+    }
+    SET_HIGH(SOFTUART_TX);
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Transmit a single character.
+**
+**          If the tx buffer is full, active waiting is performed until
+**          there is space for the character.
+**
+** \param   byte    The value that will be transmitted.
+**
+*******************************************************************************
+*/
+void SOFTUART_TxByte (uint8_t byte)
+{
+    IRQ_StateT irq_state;
+
+    if (!softuartState.initialized) return;
+
+    ////////////////
+    irq_state = IRQ_EnterMask(SOFTUART_IRQ_SITE, &SOFTUART_TX_TIMSK,
+                              (1 << SOFTUART_TX_OCIE));
+    ////////////////
+
+    // active waiting if buffer impends to overflow:
+    while (BUFFER_GetFreeSize(&softuartState.txBuffer) == 0)
+    {
+        ////////////////
+        IRQ_LeaveMask(SOFTUART_IRQ_SITE, &SOFTUART_TX_TIMSK, irq_state);
+        ////////////////
+
+        ; // no-op -> allow TX interrupt
+
+        ////////////////
+        irq_state = IRQ_EnterMask(SOFTUART_IRQ_SITE, &SOFTUART_TX_TIMSK,
+                                  (1 << SOFTUART_TX_OCIE));
+        ////////////////
+    }
+
+    BUFFER_WriteByte(&softuartState.txBuffer, byte, NULL);
+    if (!softuartState.txActive)
+    {
+        // the first compare match outputs the start bit:
+        IRQ_GLOBAL_BLOCK(SOFTUART_IRQ_SITE)
+        {
+            SOFTUART_TX_OCR = SOFTUART_TX_TCNT
+                + (SOFTUART_TX_COUNTER_T)softuartState.bitTicks;
+            SOFTUART_TX_TIFR = (1 << SOFTUART_TX_OCF);
+        }
+        softuartState.txBits = 0;
+        softuartState.txActive = 1;
+        irq_state = (1 << SOFTUART_TX_OCIE);
+    }
+
+    ////////////////
+    IRQ_LeaveMask(SOFTUART_IRQ_SITE, &SOFTUART_TX_TIMSK, irq_state);
+    ////////////////
+
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Read a single character from the receive buffer.
+**
+**          If the receive buffer is empty, active waiting will be performed
+**          until a character arrives.
+**
+** \return  The read character.
+**
+*******************************************************************************
+*/
+uint8_t SOFTUART_RxByte (void)
+{
+    uint8_t    rx_byte;
+    IRQ_StateT irq_state;
+
+    if (!softuartState.initialized) return ('\0');
+
+    ////////////////
+    irq_state = IRQ_EnterMask(SOFTUART_IRQ_SITE, &SOFTUART_RX_TIMSK,
+                              (1 << SOFTUART_RX_OCIE));
+    ////////////////
+
+    // active waiting if buffer is empty, wait for valid input data
+    while (BUFFER_GetUsedSize(&softuartState.rxBuffer) == 0)
+    {
+        ////////////////
+        IRQ_LeaveMask(SOFTUART_IRQ_SITE, &SOFTUART_RX_TIMSK, irq_state);
+        ////////////////
+
+        ; // no-op -> allow RX interrupt
+
+        ////////////////
+        irq_state = IRQ_EnterMask(SOFTUART_IRQ_SITE, &SOFTUART_RX_TIMSK,
+                                  (1 << SOFTUART_RX_OCIE));
+        ////////////////
+    }
+    rx_byte = BUFFER_ReadByte(&softuartState.rxBuffer, NULL);
+
+    ////////////////
+    IRQ_LeaveMask(SOFTUART_IRQ_SITE, &SOFTUART_RX_TIMSK, irq_state);
+    ////////////////
+
+    return (rx_byte);
+}
+
+/*!
+*******************************************************************************
+** \brief   Transmit a couple of characters.
+**
+**          In contrast to UART_TxField(), the characters are inserted one
+**          by one, so that the TX interrupt is masked for a few cycles
+**          only.
+**
+** \param   fieldPtr    Points to the values that will be transmitted.
+** \param   byteCount   The number of bytes that will be transmitted.
+**
+** \return  The number of bytes that have actually been written to the
+**          tx buffer. This value may be less than byteCount if the
+**          tx buffer was not able to store byteCount values.
+**
+*******************************************************************************
+*/
+uint8_t SOFTUART_TxField (uint8_t* fieldPtr, uint8_t byteCount)
+{
+    uint8_t tx_count;
+
+    if ((fieldPtr == NULL) || (!softuartState.initialized)) return (0);
+
+    for (tx_count = 0; tx_count < byteCount; tx_count++)
+    {
+        // the tx buffer is only drained by the ISR, so this cannot block:
+        if (BUFFER_GetFreeSize(&softuartState.txBuffer) == 0)
+        {
+            break;
+        }
+        SOFTUART_TxByte(fieldPtr[tx_count]);
+    }
+    return (tx_count);
+}
+
+/*!
+*******************************************************************************
+** \brief   Reads a couple of characters from the receive buffer.
+**
+**          The characters are read one by one, so that the RX interrupt is
+**          masked for a few cycles only.
+**
+** \param   fieldPtr    Points to the location where the values from the
+**                      receive buffer will be copied to.
+** \param   byteCount   The number of bytes that will be read.
+**
+** \return  The number of bytes that have actually been read from the
+**          rx buffer. If the receive buffer was empty, the function
+**          returns with 0.
+**
+*******************************************************************************
+*/
+uint8_t SOFTUART_RxField (uint8_t* fieldPtr, uint8_t byteCount)
+{
+    uint8_t    rx_count;
+    uint8_t    empty;
+    IRQ_StateT irq_state;
+
+    if ((fieldPtr == NULL) || (!softuartState.initialized)) return (0);
+
+    for (rx_count = 0; rx_count < byteCount; rx_count++)
+    {
+        ////////////////
+        irq_state = IRQ_EnterMask(SOFTUART_IRQ_SITE, &SOFTUART_RX_TIMSK,
+                                  (1 << SOFTUART_RX_OCIE));
+        ////////////////
+
+        empty = (BUFFER_GetUsedSize(&softuartState.rxBuffer) == 0);
+        if (!empty)
+        {
+            fieldPtr[rx_count] = BUFFER_ReadByte(&softuartState.rxBuffer,
+                                                 NULL);
+        }
+
+        ////////////////
+        IRQ_LeaveMask(SOFTUART_IRQ_SITE, &SOFTUART_RX_TIMSK, irq_state);
+        ////////////////
+
+        if (empty)
+        {
+            break;
+        }
+    }
+    return (rx_count);
+}
+
+/*!
+*******************************************************************************
+** \brief   Discard the rx buffer.
+**
+*******************************************************************************
+*/
+void SOFTUART_RxDiscard (void)
+{
+    IRQ_StateT irq_state;
+
+    ////////////////
+    irq_state = IRQ_EnterMask(SOFTUART_IRQ_SITE, &SOFTUART_RX_TIMSK,
+                              (1 << SOFTUART_RX_OCIE));
+    ////////////////
+
+    BUFFER_Discard(&softuartState.rxBuffer);
+
+    ////////////////
+    IRQ_LeaveMask(SOFTUART_IRQ_SITE, &SOFTUART_RX_TIMSK, irq_state);
+    ////////////////
+
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Flush the tx buffer.
+**
+**          Active waiting until all characters in the transmit buffer
+**          have been transmitted, including the stop bit of the last one.
+**
+*******************************************************************************
+*/
+void SOFTUART_TxFlush (void)
+{
+    while (softuartState.txActive);
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Get the count of frame errors and of bytes that have been
+**          dropped because the rx buffer was full. Both counters saturate
+**          at 255.
+**
+** \param   frameErrorCountPtr  Receives the frame error count, may be NULL.
+** \param   overflowCountPtr    Receives the overflow count, may be NULL.
+**
+*******************************************************************************
+*/
+void SOFTUART_GetErrorCounts (uint8_t* frameErrorCountPtr,
+                              uint8_t* overflowCountPtr)
+{
+    if (frameErrorCountPtr != NULL)
+    {
+        *frameErrorCountPtr = softuartState.frameErrorCount;
+    }
+    if (overflowCountPtr != NULL)
+    {
+        *overflowCountPtr = softuartState.overflowCount;
+    }
+    return;
+}
+
+//*****************************************************************************
+//*********************** INTERRUPT SERVICE ROUTINES **************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   ISR for output compare match B of the TX timer.
+**
+**          Outputs the next bit of the current frame. After the stop bit,
+**          the next byte is fetched from the tx buffer or the transmitter
+**          is stopped if the buffer is empty.
+**
+*******************************************************************************
+*/
+ISR (SOFTUART_TX_vect, ISR_BLOCK)
+{
+    SOFTUART_TX_OCR += (SOFTUART_TX_COUNTER_T)softuartState.bitTicks;
+
+    if (softuartState.txBits == 0)
+    {
+        if (BUFFER_GetUsedSize(&softuartState.txBuffer) == 0)
+        {
+            SOFTUART_TX_TIMSK &= ~(1 << SOFTUART_TX_OCIE);
+            softuartState.txActive = 0;
+            return;
+        }
+        // start bit, 8 data bits (LSB first), stop bit:
+        softuartState.txFrame =
+            ((uint16_t)BUFFER_ReadByte(&softuartState.txBuffer, NULL) << 1)
+            | (1 << (SOFTUART_FRAME_BITS - 1));
+        softuartState.txBits = SOFTUART_FRAME_BITS;
+    }
+
+    if (softuartState.txFrame & 0x01)
+    {
+        SET_HIGH(SOFTUART_TX);
+    }
+    else
+    {
+        SET_LOW(SOFTUART_TX);
+    }
+    softuartState.txFrame >>= 1;
+    softuartState.txBits--;
+}
+
+/*!
+*******************************************************************************
+** \brief   ISR for output compare match B of the RX timer.
+**
+**          Samples a data bit or, after 8 data bits, the stop bit. The
+**          stop bit completes the frame and re-enables the start bit
+**          detection.
+**
+*******************************************************************************
+*/
+ISR (SOFTUART_RX_vect, ISR_BLOCK)
+{
+    uint8_t sample = IS_HIGH(SOFTUART_RX);
+
+    SOFTUART_RX_OCR += (SOFTUART_RX_COUNTER_T)softuartState.bitTicks;
+
+    if (softuartState.rxBits < 8)
+    {
+        softuartState.rxShift >>= 1;
+        if (sample)
+        {
+            softuartState.rxShift |= 0x80;
+        }
+        softuartState.rxBits++;
+        return;
+    }
+
+    // stop bit:
+    SOFTUART_RX_TIMSK &= ~(1 << SOFTUART_RX_OCIE);
+    if (!sample)
+    {
+        if (softuartState.frameErrorCount < 0xFF)
+        {
+            softuartState.frameErrorCount++;
+        }
+    }
+    else if (BUFFER_GetFreeSize(&softuartState.rxBuffer) == 0)
+    {
+        if (softuartState.overflowCount < 0xFF)
+        {
+            softuartState.overflowCount++;
+        }
+    }
+    else
+    {
+        BUFFER_WriteByte(&softuartState.rxBuffer, softuartState.rxShift, NULL);
+    }
+
+    // discard edges of the data bits and wait for the next start bit:
+    EIFR = (1 << SOFTUART_RX_INT);
+    EIMSK |= (1 << SOFTUART_RX_INT);
+}
@@ -0,0 +1,120 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   Timer driven software UART
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#ifndef SOFTUART_H
+#define SOFTUART_H
+
+#include <stdint.h>
+
+//*****************************************************************************
+//*************************** DEFINES AND MACROS ******************************
+//*****************************************************************************
+
+//! CPU frequency
+#ifndef F_CPU
+#define F_CPU                           18432000
+#endif
+
+//! TX pin in the style of macros_pin.h
+#ifndef SOFTUART_TX
+#define SOFTUART_TX                     B,1
+#endif
+
+//! RX pin in the style of macros_pin.h, must be the pin of SOFTUART_RX_INT.
+#ifndef SOFTUART_RX
+#define SOFTUART_RX                     D,3
+#endif
+
+/*! External interrupt that detects the start bit (INTn on SOFTUART_RX).
+**  Its vector must be owned by the EXTINT driver, see EXTINT_USE_INTn. */
+#ifndef SOFTUART_RX_INT
+#define SOFTUART_RX_INT                 1
+#endif
+
+/*! Timers whose output compare unit B clocks the TX and RX bits (0, 1 or
+**  2). Both timers must be set up by the application by means of the TIMER
+**  driver in normal mode with output mode B set to normal port operation,
+**  with a clock prescaler of #SOFTUART_TIMER_PRESCALER, and must be
+**  running freely, i.e., without a countdown or stopwatch of the TIMER
+**  driver. Timer 2 is not available if it is owned by the RTC, see
+**  RTC_USE_TIMER2. */
+#ifndef SOFTUART_TX_TIMER
+#define SOFTUART_TX_TIMER               0
+#endif
+
+#ifndef SOFTUART_RX_TIMER
+#define SOFTUART_RX_TIMER               2
+#endif
+
+//! Clock prescaler of the TX and RX timers.
+#ifndef SOFTUART_TIMER_PRESCALER
+#define SOFTUART_TIMER_PRESCALER        8
+#endif
+
+/*! Timer ticks that elapse between the falling edge of the start bit and
+**  the moment when the RX timer is read within the EXTINT callback. */
+#ifndef SOFTUART_RX_LATENCY_TICKS
+#define SOFTUART_RX_LATENCY_TICKS       8
+#endif
+
+//! rx buffer length, must be in range [1 ... 255]
+#ifndef SOFTUART_BUFFER_LENGTH_RX
+#define SOFTUART_BUFFER_LENGTH_RX       32
+#endif
+
+//! tx buffer length, must be in range [1 ... 255]
+#ifndef SOFTUART_BUFFER_LENGTH_TX
+#define SOFTUART_BUFFER_LENGTH_TX       64
+#endif
+
+//! Critical section site of the driver, see IRQ_PROFILING.
+#ifndef SOFTUART_IRQ_SITE
+#define SOFTUART_IRQ_SITE               (IRQ_SITE_BASE_DRIVER + 9)
+#endif
+
+//*****************************************************************************
+//*********************** SOFTUART SPECIFIC ERROR CODES ***********************
+//*****************************************************************************
+
+/*! SOFTUART specific error base */
+#ifndef SOFTUART_ERR_BASE
+#define SOFTUART_ERR_BASE               95
+#endif
+
+/*! SOFTUART returns with no errors. */
+#define SOFTUART_OK                     0
+
+/*! A bad parameter has been passed. */
+#define SOFTUART_ERR_BAD_PARAMETER      SOFTUART_ERR_BASE + 0
+
+/*! The baud rate cannot be generated with the configured timers. */
+#define SOFTUART_ERR_BAD_BAUD_RATE      SOFTUART_ERR_BASE + 1
+
+//*****************************************************************************
+//************************* FUNCTION DECLARATIONS *****************************
+//*****************************************************************************
+
+uint8_t SOFTUART_Init (uint32_t baudRate);
+void    SOFTUART_Exit (void);
+void    SOFTUART_TxByte (uint8_t byte);
+uint8_t SOFTUART_RxByte (void);
+uint8_t SOFTUART_TxField (uint8_t* fieldPtr, uint8_t byteCount);
+uint8_t SOFTUART_RxField (uint8_t* fieldPtr, uint8_t byteCount);
+void    SOFTUART_RxDiscard (void);
+void    SOFTUART_TxFlush (void);
+void    SOFTUART_GetErrorCounts (uint8_t* frameErrorCountPtr,
+                                 uint8_t* overflowCountPtr);
+
+#endif // SOFTUART_H
@@ -20,6 +20,11 @@
 //*************************** DEFINES AND MACROS ******************************
 //*****************************************************************************
 
+//! Switch to acquire the SPI clock from the POWER manager (PRR).
+#ifndef SPI_WITH_POWER_MANAGER
+#define SPI_WITH_POWER_MANAGER  0
+#endif
+
 // SPI port settings:
 
 //******** ATmega644 setup ********
@@ -6,6 +6,13 @@
 **          This driver runs the SPI in master mode. The chip select lines
 **          must be driven by the actual device drivers.
 **
+**          Device drivers that share the bus serialize their transfers with
+**          SPI_M_Lock() and SPI_M_Unlock(). Drivers that access the SPI in
+**          their own ISRs register the enable bits of these interrupts with
+**          SPI_M_AddIrqUser(), so that they are masked while the bus is
+**          locked. ISRs of other modules, e.g., timer callbacks, must use
+**          SPI_M_TryLock() and retry later if the bus is busy.
+**
 ** \author  Robin Klose
 **
 ** Copyright (C) 2009-2014 Robin Klose
@@ -17,9 +24,14 @@
 */
 
 #include <stdint.h>
+#include <stdlib.h>
 #include <avr/io.h>
 #include <drivers/macros_pin.h>
+#include <drivers/irq.h>
 #include "spi_m.h"
+#if SPI_WITH_POWER_MANAGER
+#include <drivers/power.h>
+#endif
 
 #if SPI_M_DEBUG
 #include <stdio.h>
@@ -50,11 +62,57 @@
 //**************************** LOCAL VARIABLES ********************************
 //*****************************************************************************
 
+//! Interrupt sources of a driver that accesses the SPI in its ISRs.
+typedef struct
+{
+    volatile uint8_t* maskRegPtr; //!< interrupt mask register, e.g., EIMSK
+    uint8_t maskBits;             //!< enable bits of the interrupts
+    IRQ_StateT state;             //!< enable bits saved by the lock
+} spimIrqUserT;
+
 static struct
 {
+    spimIrqUserT irqUserArr[SPI_M_MAX_IRQ_USERS]; //!< registered ISR users
+    uint8_t irqUserCount;    //!< number of registered ISR users
+    uint8_t lockNesting;     //!< nesting level of SPI_M_Lock()
     uint8_t initialized : 1; //<! Indicates whether SPI_M has been initialized
 } spimState;
 
+//*****************************************************************************
+//********************** LOCAL FUNCTION DECLARATIONS **************************
+//*****************************************************************************
+
+static void spimEnterLock (void);
+
+//*****************************************************************************
+//**************************** LOCAL FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   Increments the lock nesting and masks all registered interrupt
+**          users when the bus is locked initially.
+**          Must be called with interrupts disabled.
+**
+*******************************************************************************
+*/
+static void spimEnterLock (void)
+{
+    uint8_t ii;
+
+    if (spimState.lockNesting++ == 0)
+    {
+        for (ii = 0; ii < spimState.irqUserCount; ii++)
+        {
+            spimState.irqUserArr[ii].state =
+                IRQ_EnterMask(SPI_M_IRQ_SITE,
+                              spimState.irqUserArr[ii].maskRegPtr,
+                              spimState.irqUserArr[ii].maskBits);
+        }
+    }
+    return;
+}
+
 //*****************************************************************************
 //*************************** PUBLIC FUNCTIONS ********************************
 //*****************************************************************************
@@ -85,6 +143,14 @@ uint8_t SPI_M_Init (SPI_ClockDivisionT clockDivider,
 {
     uint8_t accu = 0;
 
+#if SPI_WITH_POWER_MANAGER
+    // there is no exit path, so acquire the clock only once:
+    if (!spimState.initialized)
+    {
+        (void) POWER_Acquire(POWER_Spi);
+    }
+#endif
+
     // disable SPI block:
     SPCR = 0x00;
     SPSR = 0x00;
@@ -301,6 +367,185 @@ uint8_t SPI_M_Transceive (uint8_t byte)
     return(tmp);
 }
 
+/*!
+*******************************************************************************
+** \brief   Transmit a block of bytes via the SPI and discard the received
+**          bytes.
+**
+** \param   srcPtr  The bytes that will be shifted out to the slave.
+** \param   count   The number of bytes.
+**
+*******************************************************************************
+*/
+void SPI_M_TransmitBlock (const uint8_t* srcPtr, uint8_t count)
+{
+    while(count--)
+    {
+        SPDR = *srcPtr++;
+        while(!(SPSR & (1 << SPIF)));
+    }
+    (void)SPDR;
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Receive a block of bytes via the SPI while shifting out 0xFF.
+**
+** \param   destPtr Receives the bytes shifted in from the slave.
+** \param   count   The number of bytes.
+**
+*******************************************************************************
+*/
+void SPI_M_ReceiveBlock (uint8_t* destPtr, uint8_t count)
+{
+    while(count--)
+    {
+        SPDR = 0xFF;
+        while(!(SPSR & (1 << SPIF)));
+        *destPtr++ = SPDR;
+    }
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Registers the interrupt sources of a driver which accesses the
+**          SPI in its ISRs. These interrupts are masked while the bus is
+**          locked, so the ISRs can use SPI_M_Lock() without waiting.
+**          Registering the same sources again has no effect.
+**
+** \param   maskRegPtr  Points to the interrupt mask register, e.g., EIMSK.
+** \param   maskBits    The enable bits of the interrupts.
+**
+** \return
+**          - #SPI_M_OK on success.
+**          - #SPI_M_ERR_BAD_PARAMETER if a bad parameter has been passed.
+**          - #SPI_M_ERR_NO_SLOT if SPI_M_MAX_IRQ_USERS is exceeded.
+**
+*******************************************************************************
+*/
+uint8_t SPI_M_AddIrqUser (volatile uint8_t* maskRegPtr, uint8_t maskBits)
+{
+    uint8_t ii;
+
+    if ((maskRegPtr == NULL) || (maskBits == 0))
+    {
+        return (SPI_M_ERR_BAD_PARAMETER);
+    }
+    IRQ_GLOBAL_BLOCK(SPI_M_IRQ_SITE)
+    {
+        for (ii = 0; ii < spimState.irqUserCount; ii++)
+        {
+            if ((spimState.irqUserArr[ii].maskRegPtr == maskRegPtr)
+            &&  (spimState.irqUserArr[ii].maskBits == maskBits))
+            {
+                return (SPI_M_OK);
+            }
+        }
+        if (spimState.irqUserCount >= SPI_M_MAX_IRQ_USERS)
+        {
+            return (SPI_M_ERR_NO_SLOT);
+        }
+        spimState.irqUserArr[ii].maskRegPtr = maskRegPtr;
+        spimState.irqUserArr[ii].maskBits = maskBits;
+        if (spimState.lockNesting)
+        {
+            // the bus is held already:
+            spimState.irqUserArr[ii].state =
+                IRQ_EnterMask(SPI_M_IRQ_SITE, maskRegPtr, maskBits);
+        }
+        spimState.irqUserCount++;
+    }
+    return (SPI_M_OK);
+}
+
+/*!
+*******************************************************************************
+** \brief   Locks the bus for a sequence of transfers. Calls may be nested.
+**
+**          In main context, the lock is always granted: ISRs holding the
+**          lock have completed and registered ISR users are masked. ISRs
+**          which have not been registered by SPI_M_AddIrqUser() must use
+**          SPI_M_TryLock() instead.
+**
+*******************************************************************************
+*/
+void SPI_M_Lock (void)
+{
+    IRQ_GLOBAL_BLOCK(SPI_M_IRQ_SITE)
+    {
+        spimEnterLock();
+    }
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Locks the bus if it is not held by anyone else.
+**
+** \return
+**          - 1 if the lock has been acquired. Release it with SPI_M_Unlock().
+**          - 0 if the bus is busy.
+**
+*******************************************************************************
+*/
+uint8_t SPI_M_TryLock (void)
+{
+    uint8_t acquired = 0;
+
+    IRQ_GLOBAL_BLOCK(SPI_M_IRQ_SITE)
+    {
+        if (spimState.lockNesting == 0)
+        {
+            spimEnterLock();
+            acquired = 1;
+        }
+    }
+    return (acquired);
+}
+
+/*!
+*******************************************************************************
+** \brief   Releases the bus. The outermost call restores the interrupt
+**          enable bits of the registered ISR users.
+**
+*******************************************************************************
+*/
+void SPI_M_Unlock (void)
+{
+    uint8_t ii;
+
+    IRQ_GLOBAL_BLOCK(SPI_M_IRQ_SITE)
+    {
+        if (spimState.lockNesting && (--spimState.lockNesting == 0))
+        {
+            for (ii = spimState.irqUserCount; ii--; )
+            {
+                IRQ_LeaveMask(SPI_M_IRQ_SITE,
+                              spimState.irqUserArr[ii].maskRegPtr,
+                              spimState.irqUserArr[ii].state);
+            }
+        }
+    }
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Indicates whether the bus is locked.
+**
+** \return
+**          - 1 if the bus is locked.
+**          - 0 otherwise.
+**
+*******************************************************************************
+*/
+uint8_t SPI_M_IsLocked (void)
+{
+    return (spimState.lockNesting ? 1 : 0);
+}
+
 ////*****************************************************************************
 ////*********************** INTERRUPT SERVICE ROUTINES **************************
 ////*****************************************************************************
@@ -53,6 +53,16 @@
     #define F_CPU                   8000000
 #endif // F_CPU
 
+//! Maximum number of interrupt driven SPI users, see SPI_M_AddIrqUser()
+#ifndef SPI_M_MAX_IRQ_USERS
+    #define SPI_M_MAX_IRQ_USERS     2
+#endif // SPI_M_MAX_IRQ_USERS
+
+//! Critical section site of the driver, see IRQ_PROFILING.
+#ifndef SPI_M_IRQ_SITE
+#define SPI_M_IRQ_SITE              (IRQ_SITE_BASE_DRIVER + 13)
+#endif
+
 //*****************************************************************************
 //************************* SPI_M SPECIFIC ERROR CODES ************************
 //*****************************************************************************
@@ -71,6 +81,9 @@
 /*! Register verification after init failed. */
 #define SPI_M_ERR_VERIFY_FAIL       SPI_M_ERR_BASE + 1
 
+/*! All slots for interrupt driven SPI users are occupied. */
+#define SPI_M_ERR_NO_SLOT           SPI_M_ERR_BASE + 2
+
 //*****************************************************************************
 //******************************** DATA TYPES *********************************
 //*****************************************************************************
@@ -90,5 +103,12 @@ void    SPI_M_SetClockParity (SPI_ClockPolarityT clockParity);
 void    SPI_M_SetClockPhase (SPI_ClockPhaseT clockPhase);
 void    SPI_M_SetClockDivision (SPI_ClockDivisionT clockDivider);
 uint8_t SPI_M_Transceive (uint8_t byte);
+void    SPI_M_TransmitBlock (const uint8_t* srcPtr, uint8_t count);
+void    SPI_M_ReceiveBlock (uint8_t* destPtr, uint8_t count);
+uint8_t SPI_M_AddIrqUser (volatile uint8_t* maskRegPtr, uint8_t maskBits);
+void    SPI_M_Lock (void);
+uint8_t SPI_M_TryLock (void);
+void    SPI_M_Unlock (void);
+uint8_t SPI_M_IsLocked (void);
 
 #endif // SPI_M_H
@@ -20,6 +20,9 @@
 #include <avr/interrupt.h>
 #include <drivers/macros_pin.h>
 #include "spi_s.h"
+#if SPI_WITH_POWER_MANAGER
+#include <drivers/power.h>
+#endif
 
 #if SPI_S_DEBUG
 #include <stdio.h>
@@ -74,6 +77,14 @@ uint8_t SPI_S_Init (SPI_DataOrderT dataOrder,
     uint8_t accu = 0;
     uint8_t spi_sreg = SREG;
 
+#if SPI_WITH_POWER_MANAGER
+    // there is no exit path, so acquire the clock only once:
+    if (!spisState.initialized)
+    {
+        (void) POWER_Acquire(POWER_Spi);
+    }
+#endif
+
     // set up pin configuration:
 
     // SS pin is configured as an input regardless of the setting of DD_SS.
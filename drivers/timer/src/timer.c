@@ -36,9 +36,12 @@
 #include <setjmp.h>
 #include <avr/io.h>
 #include <avr/interrupt.h>
-#include <util/atomic.h>
+#include <drivers/irq.h>
 #include <drivers/macros_pin.h>
 #include "timer.h"
+#if TIMER_WITH_POWER_MANAGER
+#include <drivers/power.h>
+#endif
 
 //*****************************************************************************
 //*************************** DEFINES AND MACROS ******************************
@@ -57,6 +60,13 @@
 
 #endif
 
+// The system clock is F_CPU / 2^TIMER_CLOCK_SHIFT:
+#if TIMER_WITH_CLOCK_SCALING
+#define TIMER_CLOCK_SHIFT timerClockShift
+#else
+#define TIMER_CLOCK_SHIFT 0
+#endif
+
 
 //*****************************************************************************
 //**************************** LOCAL DATA TYPES *******************************
@@ -142,6 +152,17 @@ typedef struct
 
 static timerHandleT timerHandleArr[TIMER_NUMBER_OF_TIMERS];
 
+#if TIMER_WITH_CLOCK_SCALING
+static uint8_t timerClockShift = 0;
+#endif
+
+#if TIMER_WITH_POWER_MANAGER
+static const POWER_PeripheralT timerPowerArr[TIMER_NUMBER_OF_TIMERS] =
+{
+    POWER_Timer0, POWER_Timer1, POWER_Timer2
+};
+#endif
+
 
 //*****************************************************************************
 //********************** LOCAL FUNCTION DECLARATIONS **************************
@@ -158,6 +179,7 @@ static uint8_t timerSetPinsAsInputs (timerHandleT* handlePtr);
 static inline void timerStopClock (timerHandleT* handlePtr);
 static inline void timerResetTimerRegister (timerHandleT* handlePtr);
 static inline void timerSetOcraRegister (timerHandleT* handlePtr, uint16_t value);
+static inline uint32_t timerCyclesPerTick (timerHandleT* handlePtr);
 #if TIMER_WITH_COUNTDOWN
 static void   timerNextSmallerPrescaler (uint32_t cycles,
                                          uint16_t* prescalerValue,
@@ -607,7 +629,7 @@ static inline void timerResetTimerRegister (timerHandleT* handlePtr)
                         *handlePtr->tcnt.uint8Ptr :
                         *handlePtr->tcnt.uint16Ptr;
         handlePtr->stopwatchCycles += timer_value * \
-            TIMER_GetClockPrescalerValue(handlePtr->clockPrescaler);
+            timerCyclesPerTick(handlePtr);
     }
 
     if (handlePtr->bitWidth == timerBitWidth_8)
@@ -645,6 +667,20 @@ static inline void timerSetOcraRegister (timerHandleT* handlePtr, uint16_t value
     return;
 }
 
+/*!
+*******************************************************************************
+** \brief   Return the number of undivided F_CPU cycles per timer tick.
+**
+** \param   handlePtr       A valid timer handle.
+**
+*******************************************************************************
+*/
+static inline uint32_t timerCyclesPerTick (timerHandleT* handlePtr)
+{
+    return ((uint32_t)TIMER_GetClockPrescalerValue(handlePtr->clockPrescaler)
+            << TIMER_CLOCK_SHIFT);
+}
+
 #if TIMER_WITH_COUNTDOWN
 /*!
 *******************************************************************************
@@ -713,6 +749,7 @@ static void timerSetCountdownForRemainingCycles (timerHandleT* handlePtr)
 {
     TIMER_ClockPrescalerT prescaler_type;
     uint16_t prescaler_val = 0;
+    uint32_t tick_cycles = 0;
     uint32_t timer_cycles = 0;
     uint32_t max_timer_val = 0;
 
@@ -728,13 +765,14 @@ static void timerSetCountdownForRemainingCycles (timerHandleT* handlePtr)
     handlePtr->timerState = timerStateCountdown;
 
     // Calculate new settings:
-    timerNextSmallerPrescaler(handlePtr->countdownRemainingCycles,
+    timerNextSmallerPrescaler(handlePtr->countdownRemainingCycles >> TIMER_CLOCK_SHIFT,
                               &prescaler_val, &prescaler_type);
-    timer_cycles = handlePtr->countdownRemainingCycles / prescaler_val;
+    tick_cycles = (uint32_t)prescaler_val << TIMER_CLOCK_SHIFT;
+    timer_cycles = handlePtr->countdownRemainingCycles / tick_cycles;
     max_timer_val = (1UL << (handlePtr->bitWidth == timerBitWidth_8 ? 8 : 16));
     handlePtr->countdownRemainingOverflows = timer_cycles / max_timer_val;
     handlePtr->countdownRemainder = (uint16_t)(timer_cycles % max_timer_val);
-    handlePtr->countdownRemainingCycles %= prescaler_val;
+    handlePtr->countdownRemainingCycles %= tick_cycles;
 
     // If overflows will occur, enable the overflow interrupt.
     // Otherwise, just count the remainder.
@@ -832,7 +870,7 @@ static void timerOverflowHandler (timerHandleT* handlePtr)
     {
         handlePtr->stopwatchCycles += \
             ((handlePtr->bitWidth == timerBitWidth_8) ? 0x100UL : 0x10000UL) * \
-            TIMER_GetClockPrescalerValue(handlePtr->clockPrescaler);
+            timerCyclesPerTick(handlePtr);
         if (handlePtr->stopwatchTimeCallbackPtr)
         {
             if (handlePtr->stopwatchTimeRemainingOverflows > 0)
@@ -1069,6 +1107,13 @@ TIMER_HandleT TIMER_Init (TIMER_TimerIdT          timerId,
     {
         return (NULL);
     }
+#if TIMER_WITH_POWER_MANAGER
+    // acquire the clock unless the timer is re-initialized:
+    if (handlePtr->tccraPtr == NULL)
+    {
+        (void) POWER_Acquire(timerPowerArr[timerId]);
+    }
+#endif
     // Reset handle:
     memset(handlePtr, 0, sizeof(timerHandleT));
 
@@ -1135,6 +1180,9 @@ TIMER_HandleT TIMER_Init (TIMER_TimerIdT          timerId,
     {
         timerResetRegisters (handlePtr);
         memset (handlePtr, 0, sizeof(timerHandleT));
+#if TIMER_WITH_POWER_MANAGER
+        (void) POWER_Release(timerPowerArr[timerId]);
+#endif
         return (NULL);
     }
 
@@ -1175,7 +1223,7 @@ uint8_t TIMER_IsInitialized (TIMER_HandleT handle)
     uint8_t initialized = 0;
 
 #if TIMER_INTERRUPT_SAFETY
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    IRQ_GLOBAL_BLOCK(TIMER_IRQ_SITE)
 #endif
     {
         timerHandleT* handlePtr = (timerHandleT*)handle;
@@ -1206,7 +1254,7 @@ uint8_t TIMER_IsInitialized (TIMER_HandleT handle)
 uint8_t TIMER_Exit (TIMER_HandleT handle)
 {
 #if TIMER_INTERRUPT_SAFETY
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    IRQ_GLOBAL_BLOCK(TIMER_IRQ_SITE)
 #endif
     {
         timerHandleT* handlePtr = (timerHandleT*)handle;
@@ -1225,6 +1273,10 @@ uint8_t TIMER_Exit (TIMER_HandleT handle)
         // Reset timer registers:
         timerResetRegisters(handlePtr);
 
+#if TIMER_WITH_POWER_MANAGER
+        (void) POWER_Release(timerPowerArr[handlePtr->timerId]);
+#endif
+
         // Reset handle:
         memset(handlePtr, 0, sizeof(timerHandleT));
     }
@@ -1251,7 +1303,7 @@ uint8_t TIMER_Start (TIMER_HandleT handle)
     uint8_t timsk = 0;
 
 #if TIMER_INTERRUPT_SAFETY
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    IRQ_GLOBAL_BLOCK(TIMER_IRQ_SITE)
 #endif
     {
         timerHandleT* handlePtr = (timerHandleT*)handle;
@@ -1316,7 +1368,7 @@ uint8_t TIMER_OneShot (TIMER_HandleT handle)
     uint8_t timsk = 0;
 
 #if TIMER_INTERRUPT_SAFETY
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    IRQ_GLOBAL_BLOCK(TIMER_IRQ_SITE)
 #endif
     {
         timerHandleT* handlePtr = (timerHandleT*)handle;
@@ -1386,7 +1438,7 @@ uint8_t TIMER_OneShot (TIMER_HandleT handle)
 uint8_t TIMER_Stop (TIMER_HandleT handle, TIMER_StopT stopMode)
 {
 #if TIMER_INTERRUPT_SAFETY
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    IRQ_GLOBAL_BLOCK(TIMER_IRQ_SITE)
 #endif
     {
         uint8_t timsk = 0;
@@ -1470,7 +1522,7 @@ uint8_t TIMER_SetOverflowCallback (TIMER_HandleT handle,
                                    uint16_t callbackPeriod)
 {
 #if TIMER_INTERRUPT_SAFETY
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    IRQ_GLOBAL_BLOCK(TIMER_IRQ_SITE)
 #endif
     {
         uint8_t timsk = 0;
@@ -1548,7 +1600,7 @@ uint8_t TIMER_SetOutputCompareRegisters (TIMER_HandleT handle,
                                          uint16_t outputCompareB)
 {
 #if TIMER_INTERRUPT_SAFETY
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    IRQ_GLOBAL_BLOCK(TIMER_IRQ_SITE)
 #endif
     {
         timerHandleT* handlePtr = (timerHandleT*)handle;
@@ -1618,7 +1670,7 @@ uint8_t TIMER_SetClockPrescaler (TIMER_HandleT handle,
     uint8_t result = 0;
 
 #if TIMER_INTERRUPT_SAFETY
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    IRQ_GLOBAL_BLOCK(TIMER_IRQ_SITE)
 #endif
     {
         uint8_t timsk = 0;
@@ -1703,6 +1755,54 @@ uint16_t TIMER_GetClockPrescalerValue (TIMER_ClockPrescalerT prescaler)
     }
 }
 
+#if TIMER_WITH_CLOCK_SCALING
+/*!
+*******************************************************************************
+** \brief   Notify the driver that the system clock has been scaled.
+**
+**          The stopwatch and countdowns count undivided F_CPU cycles, so
+**          their results and the RUNLOOP timing, which builds on them, stay
+**          valid across clock changes. The ticks of the current timer
+**          iteration are accounted at the old clock. A pending stopwatch
+**          time callback and the current countdown period keep their
+**          timer ticks, so they expire early or late by the scaling
+**          factor; subsequent periods are correct.
+**
+**          This function matches CLOCK_ListenerT and must be called with
+**          interrupts disabled, e.g., by the CLOCK driver.
+**
+** \param   optArgPtr       Unused.
+** \param   clockShift      The system clock is F_CPU / 2^clockShift now.
+**
+*******************************************************************************
+*/
+void TIMER_ClockChanged (void* optArgPtr, uint8_t clockShift)
+{
+    timerHandleT* handle_ptr;
+    uint32_t      prescaler;
+    uint32_t      timer_value;
+    uint8_t       ii;
+
+    (void) optArgPtr;
+    for (ii = 0; ii < TIMER_NUMBER_OF_TIMERS; ii++)
+    {
+        handle_ptr = &timerHandleArr[ii];
+        if (handle_ptr->stopwatchEnable)
+        {
+            prescaler = TIMER_GetClockPrescalerValue(handle_ptr->clockPrescaler);
+            timer_value = (handle_ptr->bitWidth == timerBitWidth_8) ?
+                            *handle_ptr->tcnt.uint8Ptr :
+                            *handle_ptr->tcnt.uint16Ptr;
+            // replace the contribution of the current timer value:
+            handle_ptr->stopwatchCycles += (timer_value * prescaler) << timerClockShift;
+            handle_ptr->stopwatchCycles -= (timer_value * prescaler) << clockShift;
+        }
+    }
+    timerClockShift = clockShift;
+    return;
+}
+#endif // TIMER_WITH_CLOCK_SCALING
+
 #if TIMER_WITH_COUNTDOWN
 /*!
 *******************************************************************************
@@ -1746,7 +1846,7 @@ uint8_t TIMER_StartCountdown (TIMER_HandleT handle,
                               uint16_t numberOfExecutions)
 {
 #if TIMER_INTERRUPT_SAFETY
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    IRQ_GLOBAL_BLOCK(TIMER_IRQ_SITE)
 #endif
     {
         timerHandleT* handlePtr = (timerHandleT*)handle;
@@ -1832,10 +1932,10 @@ uint8_t TIMER_EnableDisableStopwatch (TIMER_HandleT handle,
                                       TIMER_StopwatchEnableDisableT enableDisable)
 {
 #if TIMER_INTERRUPT_SAFETY
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    IRQ_GLOBAL_BLOCK(TIMER_IRQ_SITE)
 #endif
     {
-        uint16_t prescaler = 0;
+        uint32_t prescaler = 0;
         uint32_t timer_value = 0;
         uint8_t timsk = 0;
 
@@ -1871,7 +1971,7 @@ uint8_t TIMER_EnableDisableStopwatch (TIMER_HandleT handle,
         if (enableDisable == TIMER_Stopwatch_Enable)
         {
             // In case that the timer is already running, get the current time:
-            prescaler = TIMER_GetClockPrescalerValue(handlePtr->clockPrescaler);
+            prescaler = timerCyclesPerTick(handlePtr);
             timer_value = (handlePtr->bitWidth == timerBitWidth_8) ?
                             *handlePtr->tcnt.uint8Ptr :
                             *handlePtr->tcnt.uint16Ptr;
@@ -1924,10 +2024,10 @@ uint8_t TIMER_GetStopwatchSystemClockCycles (TIMER_HandleT handle,
                                              TIMER_StopwatchResetT stopwatchReset)
 {
 #if TIMER_INTERRUPT_SAFETY
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    IRQ_GLOBAL_BLOCK(TIMER_IRQ_SITE)
 #endif
     {
-        uint16_t prescaler = 0;
+        uint32_t prescaler = 0;
         uint32_t timer_value = 0;
         uint8_t timsk = 0;
 
@@ -1945,7 +2045,7 @@ uint8_t TIMER_GetStopwatchSystemClockCycles (TIMER_HandleT handle,
         // Enter critical section:
         *handlePtr->timskPtr &= ~( (1 << OCIE0A) | (1 << TOIE0) );
 
-        prescaler = TIMER_GetClockPrescalerValue(handlePtr->clockPrescaler);
+        prescaler = timerCyclesPerTick(handlePtr);
         timer_value = (handlePtr->bitWidth == timerBitWidth_8) ?
                         *handlePtr->tcnt.uint8Ptr :
                         *handlePtr->tcnt.uint16Ptr;
@@ -2001,10 +2101,10 @@ uint8_t TIMER_GetStopwatchTimeMs (TIMER_HandleT handle,
                                   TIMER_StopwatchResetT stopwatchReset)
 {
 #if TIMER_INTERRUPT_SAFETY
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    IRQ_GLOBAL_BLOCK(TIMER_IRQ_SITE)
 #endif
     {
-        uint16_t prescaler = 0;
+        uint32_t prescaler = 0;
         uint32_t timer_value = 0;
         uint32_t elapsed_cycles = 0;
         uint8_t timsk = 0;
@@ -2023,7 +2123,7 @@ uint8_t TIMER_GetStopwatchTimeMs (TIMER_HandleT handle,
         // Enter critical section:
         *handlePtr->timskPtr &= ~( (1 << OCIE0A) | (1 << TOIE0) );
 
-        prescaler = TIMER_GetClockPrescalerValue(handlePtr->clockPrescaler);
+        prescaler = timerCyclesPerTick(handlePtr);
         timer_value = (handlePtr->bitWidth == timerBitWidth_8) ?
                         *handlePtr->tcnt.uint8Ptr :
                         *handlePtr->tcnt.uint16Ptr;
@@ -2093,10 +2193,10 @@ uint8_t TIMER_SetStopwatchTimeCallback(TIMER_HandleT handle,
                                        uint32_t clockCycles)
 {
 #if TIMER_INTERRUPT_SAFETY
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    IRQ_GLOBAL_BLOCK(TIMER_IRQ_SITE)
 #endif
     {
-        uint16_t prescaler = 0;
+        uint32_t prescaler = 0;
         uint32_t timer_value = 0;
         uint32_t current_cycles = 0;
         uint32_t timer_cycles = 0;
@@ -2133,7 +2233,7 @@ uint8_t TIMER_SetStopwatchTimeCallback(TIMER_HandleT handle,
         handlePtr->stopwatchTimeCallbackArgPtr = callbackArgPtr;
 
         // Get  the number of currently elapsed system clock cycles:
-        prescaler = TIMER_GetClockPrescalerValue(handlePtr->clockPrescaler);
+        prescaler = timerCyclesPerTick(handlePtr);
         timer_value = (handlePtr->bitWidth == timerBitWidth_8) ?
                         *handlePtr->tcnt.uint8Ptr :
                         *handlePtr->tcnt.uint16Ptr;
@@ -43,6 +43,23 @@
 #define TIMER_COUNTDOWN_IMPRECISION 256
 #endif
 
+/*! Switch to enable TIMER_ClockChanged(), which keeps the stopwatch and
+**  countdowns in units of undivided F_CPU cycles while the system clock is
+**  scaled at runtime by the CLOCK driver. */
+#ifndef TIMER_WITH_CLOCK_SCALING
+#define TIMER_WITH_CLOCK_SCALING    0
+#endif
+
+//! Switch to acquire the timer clocks from the POWER manager (PRR).
+#ifndef TIMER_WITH_POWER_MANAGER
+#define TIMER_WITH_POWER_MANAGER    0
+#endif
+
+
+//! Critical section site of the driver, see IRQ_PROFILING.
+#ifndef TIMER_IRQ_SITE
+#define TIMER_IRQ_SITE                  (IRQ_SITE_BASE_DRIVER + 3)
+#endif
 
 //*****************************************************************************
 //************************* TIMER SPECIFIC ERROR CODES ************************
@@ -182,6 +199,10 @@ uint8_t TIMER_SetClockPrescaler (TIMER_HandleT handle,
 
 uint16_t TIMER_GetClockPrescalerValue (TIMER_ClockPrescalerT prescaler);
 
+#if TIMER_WITH_CLOCK_SCALING
+void TIMER_ClockChanged (void* optArgPtr, uint8_t clockShift);
+#endif // TIMER_WITH_CLOCK_SCALING
+
 #if TIMER_WITH_COUNTDOWN
 uint8_t TIMER_StartCountdown (TIMER_HandleT handle,
                               TIMER_CallbackT callbackPtr,
@@ -0,0 +1,534 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   Interrupt-driven TWI (I2C) master driver with a transaction queue.
+**
+**          Transactions are described by TWI_TransactionT structures which
+**          are owned by the caller. TWI_Submit() appends a transaction to
+**          the queue and returns immediately. The transactions are then
+**          processed one after another by the TWI_vect state machine. When
+**          a transaction has completed, its result field is updated and its
+**          callback is executed in interrupt context. Thus, polling a sensor
+**          from a runloop task does not block other tasks during the
+**          transfer.
+**
+**          If TWI_WITH_TIMEOUT is set and a timer handle is passed to
+**          TWI_Init(), a periodic countdown checks whether the bus makes
+**          progress. A stalled transaction is aborted with #TWI_ERR_TIMEOUT,
+**          the TWI hardware is reset and the next transaction is started.
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <util/twi.h>
+#include <drivers/macros_pin.h>
+#include <drivers/irq.h>
+#include <drivers/timer.h>
+#include "twi.h"
+#if TWI_WITH_POWER_MANAGER
+#include <drivers/power.h>
+#endif
+
+//*****************************************************************************
+//*************************** DEFINES AND MACROS ******************************
+//*****************************************************************************
+
+#if (atmega644p || atmega644 || atmega16)
+#define TWI_SCL                 C,0
+#define TWI_SDA                 C,1
+#endif
+
+#if TWI_WITH_TIMEOUT && !TIMER_WITH_COUNTDOWN
+#error "TWI_WITH_TIMEOUT requires TIMER_WITH_COUNTDOWN to be set."
+#endif
+
+//! Acknowledge the current state and continue with the next bus operation.
+#define TWI_CONTINUE            ((1 << TWINT) | (1 << TWEN) | (1 << TWIE))
+
+//! Transmit a START or repeated START condition.
+#define TWI_START               (TWI_CONTINUE | (1 << TWSTA))
+
+//! Transmit a STOP condition. No interrupt follows a STOP condition.
+#define TWI_STOP                ((1 << TWINT) | (1 << TWEN) | (1 << TWSTO))
+
+//! Release the bus without a STOP condition.
+#define TWI_RELEASE             ((1 << TWINT) | (1 << TWEN))
+
+/*! Maximum number of polls of TWSTO before a transaction is started. This
+**  covers several SCL periods even at low SCL frequencies. */
+#define TWI_STOP_WAIT_LIMIT     ((uint16_t)((F_CPU) / 10000UL))
+
+//*****************************************************************************
+//**************************** LOCAL DATA TYPES *******************************
+//*****************************************************************************
+
+
+//*****************************************************************************
+//**************************** LOCAL VARIABLES ********************************
+//*****************************************************************************
+
+//! Internal state of the TWI driver.
+static struct
+{
+    TWI_TransactionT* queueArr[TWI_QUEUE_LENGTH]; //!< transaction queue
+    uint8_t           readPos;      //!< queue index of current transaction
+    uint8_t           used;         //!< number of queued transactions
+    uint8_t           byteIdx;      //!< byte index within the current phase
+    uint8_t           retries;      //!< arbitration retries of current transaction
+#if TWI_WITH_TIMEOUT
+    TIMER_HandleT     timerHandle;  //!< timer for the timeout check
+    uint8_t           progress;     //!< set on start and on each TWI interrupt
+#endif // TWI_WITH_TIMEOUT
+    uint8_t           initialized : 1;
+    uint8_t           active : 1;   //!< the head of the queue is on the bus
+} twiState;
+
+//*****************************************************************************
+//********************** LOCAL FUNCTION DECLARATIONS **************************
+//*****************************************************************************
+
+static void twiStartNext (void);
+static void twiComplete (uint8_t result);
+#if TWI_WITH_TIMEOUT
+static void twiTimeoutCallback (void* optArgPtr);
+#endif // TWI_WITH_TIMEOUT
+
+//*****************************************************************************
+//**************************** LOCAL FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   Starts the transaction at the head of the queue.
+**
+**          Must be called with interrupts disabled. A STOP condition which
+**          is still being transmitted is awaited first, which takes at most
+**          a few SCL periods. The wait is bounded by TWI_STOP_WAIT_LIMIT
+**          since this function is also called from the TWI interrupt. If
+**          the STOP condition is stuck, the TWI hardware is reset and a
+**          stalled bus is left to the timeout check.
+**
+*******************************************************************************
+*/
+static void twiStartNext (void)
+{
+    uint16_t wait = TWI_STOP_WAIT_LIMIT;
+
+    while ((TWCR & (1 << TWSTO)) && --wait);
+    if (wait == 0)
+    {
+        TWCR = 0;
+        TWCR = (1 << TWEN);
+    }
+#if TWI_WITH_TIMEOUT
+    // A new transaction gets at least one full period until the check:
+    twiState.progress = 1;
+#endif // TWI_WITH_TIMEOUT
+    twiState.active  = 1;
+    twiState.byteIdx = 0;
+    twiState.retries = 0;
+    TWCR = TWI_START;
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Completes the transaction at the head of the queue.
+**
+**          The bus operation which ends the transaction must already have
+**          been issued by the caller. The completion callback is executed
+**          and the next queued transaction is started.
+**
+** \param   result  The result that will be reported to the caller.
+**
+*******************************************************************************
+*/
+static void twiComplete (uint8_t result)
+{
+    TWI_TransactionT* transaction_ptr;
+
+    transaction_ptr = twiState.queueArr[twiState.readPos];
+    twiState.readPos = (twiState.readPos + 1) % TWI_QUEUE_LENGTH;
+    twiState.used--;
+    twiState.active = 0;
+
+    transaction_ptr->result = result;
+    if (transaction_ptr->callbackPtr)
+    {
+        transaction_ptr->callbackPtr(transaction_ptr->callbackArgPtr, result);
+    }
+
+    // The callback may already have started a new transaction:
+    if ((twiState.active == 0) && twiState.used)
+    {
+        twiStartNext();
+    }
+    return;
+}
+
+#if TWI_WITH_TIMEOUT
+/*!
+*******************************************************************************
+** \brief   Periodic timeout check, executed by the timer countdown.
+**
+**          If neither a transaction has been started nor a TWI interrupt
+**          has occurred since the previous check while a transaction is
+**          active, the TWI hardware is reset and the transaction is
+**          aborted. Hence, a transaction is aborted after one to two
+**          periods without progress.
+**
+** \param   optArgPtr   Unused.
+**
+*******************************************************************************
+*/
+static void twiTimeoutCallback (void* optArgPtr)
+{
+    (void)optArgPtr;
+    if (twiState.active && !twiState.progress)
+    {
+        // Reset the TWI hardware in order to release SCL and SDA:
+        TWCR = 0;
+        TWCR = (1 << TWEN);
+        twiComplete(TWI_ERR_TIMEOUT);
+        return; // twiComplete() may have started the next transaction
+    }
+    twiState.progress = 0;
+    return;
+}
+#endif // TWI_WITH_TIMEOUT
+
+//*****************************************************************************
+//*************************** PUBLIC FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   Initializes the TWI hardware as master.
+**
+** \param   sclFrequency
+**              The SCL clock frequency in Hz, e.g., 100000 or 400000.
+** \param   timeoutTimerHandle
+**              Handle of a timer that has been initialized in normal mode
+**              and which is used exclusively for the timeout check.
+**              May be NULL in order to disable the timeout check.
+**              Ignored if TWI_WITH_TIMEOUT is not set.
+**
+** \return
+**          - #TWI_OK on success.
+**          - #TWI_ERR_BAD_PARAMETER if the frequency cannot be generated
+**              or if the timeout countdown cannot be started.
+**          - #TWI_ERR_PENDING if transactions are still in progress.
+**
+*******************************************************************************
+*/
+uint8_t TWI_Init (uint32_t sclFrequency, TIMER_HandleT timeoutTimerHandle)
+{
+    uint32_t twbr;
+    uint8_t  prescaler_bits = 0;
+
+    if ((sclFrequency == 0) || (sclFrequency > (F_CPU / 16)))
+    {
+        return (TWI_ERR_BAD_PARAMETER);
+    }
+    if (twiState.active || twiState.used)
+    {
+        return (TWI_ERR_PENDING);
+    }
+
+    // SCL = F_CPU / (16 + 2 * TWBR * 4^TWPS):
+    twbr = ((F_CPU / sclFrequency) - 16) / 2;
+    while (twbr > 255)
+    {
+        if (prescaler_bits == 3)
+        {
+            return (TWI_ERR_BAD_PARAMETER);
+        }
+        prescaler_bits++;
+        twbr >>= 2;
+    }
+
+#if TWI_WITH_POWER_MANAGER
+    if (!twiState.initialized)
+    {
+        (void) POWER_Acquire(POWER_Twi);
+    }
+#endif
+    TWCR = 0;
+    TWBR = (uint8_t)twbr;
+    TWSR = prescaler_bits; // TWPS1:0
+
+#if TWI_INTERNAL_PULLUPS
+    SET_INPUT(TWI_SCL);
+    SET_INPUT(TWI_SDA);
+    SET_HIGH(TWI_SCL);
+    SET_HIGH(TWI_SDA);
+#endif // TWI_INTERNAL_PULLUPS
+
+    twiState.readPos = 0;
+    twiState.used    = 0;
+    TWCR = (1 << TWEN);
+
+#if TWI_WITH_TIMEOUT
+    twiState.timerHandle = timeoutTimerHandle;
+    if (timeoutTimerHandle)
+    {
+        if (TIMER_OK != TIMER_StartCountdown(timeoutTimerHandle,
+                                             twiTimeoutCallback,
+                                             NULL,
+                                             TWI_TIMEOUT_MS,
+                                             0))
+        {
+            TWCR = 0;
+#if TWI_WITH_POWER_MANAGER
+            if (!twiState.initialized)
+            {
+                (void) POWER_Release(POWER_Twi);
+            }
+#endif
+            return (TWI_ERR_BAD_PARAMETER);
+        }
+    }
+#else
+    (void)timeoutTimerHandle;
+#endif // TWI_WITH_TIMEOUT
+
+    twiState.initialized = 1;
+    return (TWI_OK);
+}
+
+/*!
+*******************************************************************************
+** \brief   Shuts down the TWI hardware and stops the timeout check.
+**
+** \return
+**          - #TWI_OK on success.
+**          - #TWI_ERR_PENDING if transactions are still in progress.
+**
+*******************************************************************************
+*/
+uint8_t TWI_Exit (void)
+{
+    if (twiState.active || twiState.used)
+    {
+        return (TWI_ERR_PENDING);
+    }
+#if TWI_WITH_TIMEOUT
+    if (twiState.timerHandle)
+    {
+        TIMER_Stop(twiState.timerHandle, TIMER_Stop_Immediately);
+        twiState.timerHandle = NULL;
+    }
+#endif // TWI_WITH_TIMEOUT
+    TWCR = 0;
+#if TWI_WITH_POWER_MANAGER
+    if (twiState.initialized)
+    {
+        (void) POWER_Release(POWER_Twi);
+    }
+#endif
+    twiState.initialized = 0;
+    return (TWI_OK);
+}
+
+/*!
+*******************************************************************************
+** \brief   Appends a transaction to the queue.
+**
+**          The function returns immediately. The result field of the
+**          transaction is set to #TWI_ERR_PENDING until the transaction has
+**          completed. Then it holds #TWI_OK or an error code, and the
+**          callback is executed. May be called from within callbacks.
+**
+** \param   transactionPtr
+**              The transaction to execute. Must remain valid until it
+**              has completed.
+**
+** \return
+**          - #TWI_OK if the transaction has been queued.
+**          - #TWI_ERR_BAD_PARAMETER if the transaction is invalid.
+**          - #TWI_ERR_NOT_INITIALIZED if the driver is not initialized.
+**          - #TWI_ERR_QUEUE_FULL if there is no free queue slot.
+**
+*******************************************************************************
+*/
+uint8_t TWI_Submit (TWI_TransactionT* transactionPtr)
+{
+    if ((transactionPtr == NULL)
+    ||  (transactionPtr->address > 0x7F)
+    ||  (transactionPtr->writeCount && (transactionPtr->writePtr == NULL))
+    ||  (transactionPtr->readCount && (transactionPtr->readPtr == NULL)))
+    {
+        return (TWI_ERR_BAD_PARAMETER);
+    }
+    if (!twiState.initialized)
+    {
+        return (TWI_ERR_NOT_INITIALIZED);
+    }
+
+    IRQ_GLOBAL_BLOCK(TWI_IRQ_SITE)
+    {
+        if (twiState.used >= TWI_QUEUE_LENGTH)
+        {
+            return (TWI_ERR_QUEUE_FULL);
+        }
+        transactionPtr->result = TWI_ERR_PENDING;
+        twiState.queueArr[(twiState.readPos + twiState.used)
+                          % TWI_QUEUE_LENGTH] = transactionPtr;
+        twiState.used++;
+        if (!twiState.active)
+        {
+            twiStartNext();
+        }
+    }
+    return (TWI_OK);
+}
+
+/*!
+*******************************************************************************
+** \brief   Tests whether transactions are queued or in progress.
+**
+** \return  1 if the driver is busy, 0 otherwise.
+**
+*******************************************************************************
+*/
+uint8_t TWI_IsBusy (void)
+{
+    return ((twiState.used != 0) ? 1 : 0);
+}
+
+/*!
+*******************************************************************************
+** \brief   Get the number of transactions which have not completed yet.
+**
+** \return  The number of queued transactions including the active one.
+**
+*******************************************************************************
+*/
+uint8_t TWI_GetQueueCount (void)
+{
+    return (twiState.used);
+}
+
+//*****************************************************************************
+//*********************** INTERRUPT SERVICE ROUTINES **************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   TWI state machine.
+**
+**          Executed whenever the TWI hardware has finished a bus operation.
+**
+*******************************************************************************
+*/
+ISR (TWI_vect, ISR_BLOCK)
+{
+    TWI_TransactionT* transaction_ptr;
+
+    transaction_ptr = twiState.queueArr[twiState.readPos];
+#if TWI_WITH_TIMEOUT
+    twiState.progress = 1;
+#endif // TWI_WITH_TIMEOUT
+
+    switch (TW_STATUS)
+    {
+        case TW_START:
+            twiState.byteIdx = 0;
+            if (transaction_ptr->writeCount || !transaction_ptr->readCount)
+            {
+                TWDR = (transaction_ptr->address << 1) | TW_WRITE;
+            }
+            else
+            {
+                TWDR = (transaction_ptr->address << 1) | TW_READ;
+            }
+            TWCR = TWI_CONTINUE;
+            break;
+
+        case TW_REP_START:
+            // a repeated start is only issued for the read phase:
+            twiState.byteIdx = 0;
+            TWDR = (transaction_ptr->address << 1) | TW_READ;
+            TWCR = TWI_CONTINUE;
+            break;
+
+        case TW_MT_SLA_ACK:
+        case TW_MT_DATA_ACK:
+            if (twiState.byteIdx < transaction_ptr->writeCount)
+            {
+                TWDR = transaction_ptr->writePtr[twiState.byteIdx++];
+                TWCR = TWI_CONTINUE;
+            }
+            else if (transaction_ptr->readCount)
+            {
+                TWCR = TWI_START;
+            }
+            else
+            {
+                TWCR = TWI_STOP;
+                twiComplete(TWI_OK);
+            }
+            break;
+
+        case TW_MT_DATA_NACK:
+            TWCR = TWI_STOP;
+            twiComplete(TWI_ERR_DATA_NACK);
+            break;
+
+        case TW_MT_SLA_NACK:
+        case TW_MR_SLA_NACK:
+            TWCR = TWI_STOP;
+            twiComplete(TWI_ERR_ADDRESS_NACK);
+            break;
+
+        case TW_MT_ARB_LOST: // equals TW_MR_ARB_LOST
+            if (twiState.retries < TWI_ARBITRATION_RETRIES)
+            {
+                // restart as soon as the bus becomes free:
+                twiState.retries++;
+                TWCR = TWI_START;
+            }
+            else
+            {
+                TWCR = TWI_RELEASE;
+                twiComplete(TWI_ERR_ARBITRATION_LOST);
+            }
+            break;
+
+        case TW_MR_SLA_ACK:
+            // acknowledge all but the last byte:
+            TWCR = TWI_CONTINUE |
+                   ((transaction_ptr->readCount > 1) ? (1 << TWEA) : 0);
+            break;
+
+        case TW_MR_DATA_ACK:
+            transaction_ptr->readPtr[twiState.byteIdx++] = TWDR;
+            TWCR = TWI_CONTINUE |
+                   (((twiState.byteIdx + 1) < transaction_ptr->readCount) ?
+                    (1 << TWEA) : 0);
+            break;
+
+        case TW_MR_DATA_NACK:
+            transaction_ptr->readPtr[twiState.byteIdx++] = TWDR;
+            TWCR = TWI_STOP;
+            twiComplete(TWI_OK);
+            break;
+
+        case TW_BUS_ERROR:
+        default:
+            TWCR = TWI_STOP;
+            twiComplete(TWI_ERR_BUS_ERROR);
+            break;
+    }
+}
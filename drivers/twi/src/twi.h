@@ -0,0 +1,145 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   TWI (I2C) master interface declarations
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#ifndef TWI_H
+#define TWI_H
+
+#include <stdint.h>
+#include <drivers/timer.h>
+
+//*****************************************************************************
+//*************************** DEFINES AND MACROS ******************************
+//*****************************************************************************
+
+//! CPU clock frequency
+#ifndef F_CPU
+#define F_CPU                       18432000
+#endif
+
+//! Maximum number of transactions that can be queued, must be in [1 ... 255].
+#ifndef TWI_QUEUE_LENGTH
+#define TWI_QUEUE_LENGTH            8
+#endif
+
+//! Switch to acquire the TWI clock from the POWER manager (PRR).
+#ifndef TWI_WITH_POWER_MANAGER
+#define TWI_WITH_POWER_MANAGER      0
+#endif
+
+/*! Set to 1 in order to abort stalled transactions. Requires the countdown
+**  feature of the timer driver (TIMER_WITH_COUNTDOWN). */
+#ifndef TWI_WITH_TIMEOUT
+#define TWI_WITH_TIMEOUT            TIMER_WITH_COUNTDOWN
+#endif
+
+/*! Period of the timeout check in milliseconds. A transaction is aborted if
+**  the bus has made no progress for one to two periods. */
+#ifndef TWI_TIMEOUT_MS
+#define TWI_TIMEOUT_MS              10
+#endif
+
+//! Number of retries when the arbitration is lost to another master.
+#ifndef TWI_ARBITRATION_RETRIES
+#define TWI_ARBITRATION_RETRIES     3
+#endif
+
+//! Set to 1 in order to enable the internal pull-ups on SCL and SDA.
+#ifndef TWI_INTERNAL_PULLUPS
+#define TWI_INTERNAL_PULLUPS        0
+#endif
+
+//! Critical section site of the driver, see IRQ_PROFILING.
+#ifndef TWI_IRQ_SITE
+#define TWI_IRQ_SITE                    (IRQ_SITE_BASE_DRIVER + 5)
+#endif
+
+//*****************************************************************************
+//************************** TWI SPECIFIC ERROR CODES *************************
+//*****************************************************************************
+
+/*! TWI specific error base */
+#ifndef TWI_ERR_BASE
+#define TWI_ERR_BASE                60
+#endif
+
+/*! TWI returns with no errors. */
+#define TWI_OK                      0
+
+/*! A bad parameter has been passed. */
+#define TWI_ERR_BAD_PARAMETER       TWI_ERR_BASE + 0
+
+/*! The driver has not been initialized. */
+#define TWI_ERR_NOT_INITIALIZED     TWI_ERR_BASE + 1
+
+/*! The transaction queue is full. */
+#define TWI_ERR_QUEUE_FULL          TWI_ERR_BASE + 2
+
+/*! The transaction is queued or in progress. */
+#define TWI_ERR_PENDING             TWI_ERR_BASE + 3
+
+/*! The slave did not acknowledge its address. */
+#define TWI_ERR_ADDRESS_NACK        TWI_ERR_BASE + 4
+
+/*! The slave did not acknowledge a data byte. */
+#define TWI_ERR_DATA_NACK           TWI_ERR_BASE + 5
+
+/*! The arbitration has been lost too often. */
+#define TWI_ERR_ARBITRATION_LOST    TWI_ERR_BASE + 6
+
+/*! An illegal START or STOP condition has been detected on the bus. */
+#define TWI_ERR_BUS_ERROR           TWI_ERR_BASE + 7
+
+/*! The bus has not made any progress within the timeout period. */
+#define TWI_ERR_TIMEOUT             TWI_ERR_BASE + 8
+
+
+//*****************************************************************************
+//******************************** DATA TYPES *********************************
+//*****************************************************************************
+
+/*! Signature of a transaction completion callback. The callback is executed
+**  in interrupt context. The result is #TWI_OK or one of the error codes. */
+typedef void (*TWI_CallbackT) (void* optArgPtr, uint8_t result);
+
+/*! A TWI transaction. First, writeCount bytes are written to the slave.
+**  Then, after a repeated start, readCount bytes are read from the slave.
+**  Either phase may be skipped by setting its count to zero. The structure
+**  is owned by the caller and must remain valid until the transaction has
+**  completed.
+*/
+typedef struct
+{
+    uint8_t           address;        //!< 7 bit slave address
+    uint8_t*          writePtr;       //!< bytes to write
+    uint8_t           writeCount;     //!< number of bytes to write
+    uint8_t*          readPtr;        //!< buffer for bytes to read
+    uint8_t           readCount;      //!< number of bytes to read
+    TWI_CallbackT     callbackPtr;    //!< completion callback, may be NULL
+    void*             callbackArgPtr; //!< optional callback argument
+    volatile uint8_t  result;         //!< set by the driver
+} TWI_TransactionT;
+
+
+//*****************************************************************************
+//************************* FUNCTION DECLARATIONS *****************************
+//*****************************************************************************
+
+uint8_t TWI_Init (uint32_t sclFrequency, TIMER_HandleT timeoutTimerHandle);
+uint8_t TWI_Exit (void);
+uint8_t TWI_Submit (TWI_TransactionT* transactionPtr);
+uint8_t TWI_IsBusy (void);
+uint8_t TWI_GetQueueCount (void);
+
+#endif // TWI_H
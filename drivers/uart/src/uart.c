@@ -40,7 +40,11 @@
 #include <avr/interrupt.h>
 #include <drivers/macros_pin.h>
 #include <drivers/buffer.h>
+#include <drivers/irq.h>
 #include "uart.h"
+#if UART_WITH_POWER_MANAGER
+#include <drivers/power.h>
+#endif
 
 //*****************************************************************************
 //*************************** DEFINES AND MACROS ******************************
@@ -100,6 +104,32 @@
 #define UCPOL   UCPOL0
 #endif
 
+// The rx ISR and UART_CtsChanged() enable the UDRE interrupt, which is
+// only safe if the tx critical sections disable interrupts globally:
+#if UART_WITH_FLOW_CONTROL && !UART_INTERRUPT_SAFETY
+#error "UART_WITH_FLOW_CONTROL requires UART_INTERRUPT_SAFETY"
+#endif
+
+#if UART_WITH_AUTOBAUD && (UART_PORT_FACTOR == UART_SINGLEPORT)
+#error "UART_WITH_AUTOBAUD is not supported on MCUs with a single UART"
+#endif
+
+#if UART_WITH_CLOCK_SCALING && (UART_PORT_FACTOR == UART_SINGLEPORT)
+#error "UART_WITH_CLOCK_SCALING is not supported on MCUs with a single UART"
+#endif
+
+#if UART_WITH_AUTOBAUD
+//! Sync character of the automatic baud rate detection.
+#define UART_AUTOBAUD_SYNC          0x55
+
+//! RXD0 and RXD1 pins on port D.
+#define UART_AUTOBAUD_RXD0_IDX      0
+#define UART_AUTOBAUD_RXD1_IDX      2
+
+//! Count of edges from the start of bit 0 to the start of bit 7 of 0x55.
+#define UART_AUTOBAUD_EDGES         8
+#endif // UART_WITH_AUTOBAUD
+
 //! Light the tx LED
 #define UART_TX_LED_ON              if(handlePtr->txLedActive)  \
                                         *handlePtr->txLedPortPtr |= \
@@ -120,6 +150,21 @@
                                         *handlePtr->rxLedPortPtr &= \
                                         ~(1 << handlePtr->rxLedIdx)
 
+#if UART_WITH_RS485
+//! Assert the RS-485 driver enable
+#define UART_DE_ON                  if(handlePtr->deActive)     \
+                                        *handlePtr->dePortPtr |=    \
+                                        (1 << handlePtr->deIdx)
+
+//! Release the RS-485 driver enable
+#define UART_DE_OFF                 if(handlePtr->deActive)     \
+                                        *handlePtr->dePortPtr &=    \
+                                        ~(1 << handlePtr->deIdx)
+#else
+#define UART_DE_ON
+#define UART_DE_OFF
+#endif // UART_WITH_RS485
+
 //! Enable UDR empty interrupt
 #define UART_UDR_EMPTY_INT_ON       *handlePtr->ucsrbPtr |=  (1 << UDRIE)
 
@@ -209,6 +254,42 @@ typedef struct
     void (*rxBufferOverflowHandlerPtr) (void);
 #endif
 
+#if UART_WITH_BRIDGE
+    void* bridgeDstPtr; //<! handle that receives forwarded characters
+    UART_BridgeTapCallbackT bridgeTapPtr;
+    void* bridgeTapArgPtr;
+    volatile uint8_t bridgeDropCount;
+#endif
+
+#if UART_WITH_FLOW_CONTROL
+    UART_FlowT        flowMode;
+    volatile uint8_t* rtsPortPtr;
+    volatile uint8_t* ctsPinPtr;
+    uint8_t           rtsIdx : 3;
+    uint8_t           ctsIdx : 3;
+    volatile uint8_t  rxThrottled  : 1; //<! Indicates that RTS or XOFF has stopped the sender.
+    volatile uint8_t  xoffReceived : 1; //<! Indicates that the receiver has sent XOFF.
+    volatile uint8_t  flowChar; //<! XON or XOFF to be sent next, 0 if none.
+#endif
+
+#if (UART_WITH_AUTOBAUD) || (UART_WITH_CLOCK_SCALING)
+    volatile uint8_t* ubrrhPtr;
+    volatile uint8_t* ubrrlPtr;
+#endif
+#if UART_WITH_AUTOBAUD
+    uint8_t           rxdMask; //<! bit of the RXD pin in PIND
+#endif
+#if UART_WITH_CLOCK_SCALING
+    uint16_t          ubrrDivisor; //<! UBRR + 1 at the undivided F_CPU
+#endif
+
+#if UART_WITH_RS485
+    volatile uint8_t* dePortPtr;
+    uint8_t           deIdx : 3;
+    uint8_t           deActive : 1;
+    uint8_t           suppressEcho : 1;
+#endif
+
     // LED parameters:
     volatile uint8_t* txLedPortPtr;
     volatile uint8_t* rxLedPortPtr;
@@ -216,10 +297,6 @@ typedef struct
     uint8_t           rxLedIdx : 3;
     uint8_t           txLedActive : 1;
     uint8_t           rxLedActive : 1;
-
-#if UART_INTERRUPT_SAFETY
-    uint8_t           sregSave;
-#endif
 } uartHandleT;
 
 //*****************************************************************************
@@ -234,6 +311,11 @@ static uartHandleT uartHandleArr[1];
 static uartHandleT uartHandleArr[2];
 #endif
 
+#if UART_WITH_CLOCK_SCALING
+// The system clock is F_CPU / 2^uartClockShift:
+static uint8_t uartClockShift = 0;
+#endif
+
 //*****************************************************************************
 //********************** LOCAL FUNCTION DECLARATIONS **************************
 //*****************************************************************************
@@ -241,13 +323,36 @@ static uartHandleT uartHandleArr[2];
 static void uartSetBaudRate (volatile uint8_t* ubrrhPtr,
                              volatile uint8_t* ubrrlPtr,
                              UART_BaudT baudRate);
-static void uartEnterTxCS (uartHandleT* handlePtr);
-static void uartLeaveTxCS (uartHandleT* handlePtr);
-static void uartEnterRxCS (uartHandleT* handlePtr);
-static void uartLeaveRxCS (uartHandleT* handlePtr);
+static IRQ_StateT uartEnterTxCS (uartHandleT* handlePtr);
+static void uartLeaveTxCS (uartHandleT* handlePtr, IRQ_StateT state);
+static IRQ_StateT uartEnterRxCS (uartHandleT* handlePtr);
+static void uartLeaveRxCS (uartHandleT* handlePtr, IRQ_StateT state);
 static void uartIsrRx     (uartHandleT* handlePtr);
 static void uartIsrUdre   (uartHandleT* handlePtr);
 static void uartIsrTx     (uartHandleT* handlePtr);
+#if UART_WITH_BRIDGE
+static uint8_t uartBridgeTx (uartHandleT* handlePtr, uint8_t byte);
+#endif
+#if UART_WITH_FLOW_CONTROL
+static uint8_t uartFlowTxHeld (uartHandleT* handlePtr);
+static void uartFlowSend (uartHandleT* handlePtr, uint8_t flowChar);
+static void uartFlowThrottle (uartHandleT* handlePtr, uint8_t throttle);
+static void uartFlowCheckRead (uartHandleT* handlePtr);
+#endif
+#if UART_WITH_AUTOBAUD
+static uint8_t uartAutoBaudWait (volatile uint8_t* regPtr,
+                                 uint8_t mask,
+                                 uint8_t value,
+                                 uint32_t maxWraps);
+static uint8_t uartAutoBaudMeasure (uartHandleT* handlePtr,
+                                    uint16_t counterPrescaler,
+                                    uint32_t maxWraps,
+                                    uint16_t* ubrrPtr,
+                                    uint8_t* u2xPtr);
+#endif
+#if UART_WITH_CLOCK_SCALING
+static void uartApplyClockShift (uartHandleT* handlePtr);
+#endif
 
 //*****************************************************************************
 //**************************** LOCAL FUNCTIONS ********************************
@@ -328,24 +433,25 @@ static void uartSetBaudRate(volatile uint8_t* ubrrhPtr,
 **          transmit buffer.
 **
 **          A critical section is a piece of code where a shared resource
-**          is accessed. The UDR empty interrupt is disabled in order to
-**          keep the shared data consistent.
+**          is accessed. If UART_INTERRUPT_SAFETY is set, all interrupts are
+**          disabled. Otherwise, only the UDR empty interrupt is disabled in
+**          order to keep the shared data consistent.
 **
 ** \param   handlePtr
 **              A handle associated with a specific AVR hardware UART.
 **
+** \return  The state which must be passed to uartLeaveTxCS().
+**
 *******************************************************************************
 */
-static void uartEnterTxCS (uartHandleT* handlePtr)
+static IRQ_StateT uartEnterTxCS (uartHandleT* handlePtr)
 {
     handlePtr->txIntEn = (*handlePtr->ucsrbPtr & (1 << UDRIE)) ? 1 : 0;
 #if UART_INTERRUPT_SAFETY
-    handlePtr->sregSave = SREG;
-    cli();
+    return (IRQ_EnterGlobal(UART_IRQ_SITE_TX));
 #else
-    UART_UDR_EMPTY_INT_OFF; // *handlePtr->ucsrbPtr &= ~(1 << UDRIE);
+    return (IRQ_EnterMask(UART_IRQ_SITE_TX, handlePtr->ucsrbPtr, (1 << UDRIE)));
 #endif
-    return;
 }
 
 /*!
@@ -353,19 +459,28 @@ static void uartEnterTxCS (uartHandleT* handlePtr)
 ** \brief   Restores the uart for leaving a critical section for the transmit
 **          buffer.
 **
+**          The UDR empty interrupt is enabled if txIntEn is set, which may
+**          have been changed within the critical section.
+**
 ** \param   handlePtr
 **              A handle associated with a specific AVR hardware UART.
+** \param   state
+**              The state returned by uartEnterTxCS().
 **
 *******************************************************************************
 */
-static void uartLeaveTxCS (uartHandleT* handlePtr)
+static void uartLeaveTxCS (uartHandleT* handlePtr, IRQ_StateT state)
 {
+#if UART_INTERRUPT_SAFETY
     if (handlePtr->txIntEn)
     {
         UART_UDR_EMPTY_INT_ON; // *handlePtr->ucsrbPtr |= (1 << UDRIE);
     }
-#if UART_INTERRUPT_SAFETY
-    SREG = handlePtr->sregSave;
+    IRQ_LeaveGlobal(UART_IRQ_SITE_TX, state);
+#else
+    (void)state;
+    IRQ_LeaveMask(UART_IRQ_SITE_TX, handlePtr->ucsrbPtr,
+                  handlePtr->txIntEn ? (1 << UDRIE) : 0);
 #endif
     return;
 }
@@ -378,17 +493,18 @@ static void uartLeaveTxCS (uartHandleT* handlePtr)
 ** \param   handlePtr
 **              A handle associated with a specific AVR hardware UART.
 **
+** \return  The state which must be passed to uartLeaveRxCS().
+**
 *******************************************************************************
 */
-static void uartEnterRxCS (uartHandleT* handlePtr)
+static IRQ_StateT uartEnterRxCS (uartHandleT* handlePtr)
 {
 #if UART_INTERRUPT_SAFETY
-    handlePtr->sregSave = SREG;
-    cli();
+    (void)handlePtr;
+    return (IRQ_EnterGlobal(UART_IRQ_SITE_RX));
 #else
-    UART_RX_COMPLETE_INT_OFF;
+    return (IRQ_EnterMask(UART_IRQ_SITE_RX, handlePtr->ucsrbPtr, (1 << RXCIE)));
 #endif
-    return;
 }
 
 /*!
@@ -398,18 +514,18 @@ static void uartEnterRxCS (uartHandleT* handlePtr)
 **
 ** \param   handlePtr
 **              A handle associated with a specific AVR hardware UART.
+** \param   state
+**              The state returned by uartEnterRxCS().
 **
 *******************************************************************************
 */
-static void uartLeaveRxCS (uartHandleT* handlePtr)
+static void uartLeaveRxCS (uartHandleT* handlePtr, IRQ_StateT state)
 {
 #if UART_INTERRUPT_SAFETY
-    SREG = handlePtr->sregSave;
+    (void)handlePtr;
+    IRQ_LeaveGlobal(UART_IRQ_SITE_RX, state);
 #else
-    if (*handlePtr->ucsrbPtr & (1 << RXEN))
-    {
-        UART_RX_COMPLETE_INT_ON;
-    }
+    IRQ_LeaveMask(UART_IRQ_SITE_RX, handlePtr->ucsrbPtr, state);
 #endif
     return;
 }
@@ -463,6 +579,48 @@ static void uartIsrRx (uartHandleT* handlePtr)
         if (handlePtr->parityErrorHandlerPtr) handlePtr->parityErrorHandlerPtr();
     }
 #endif // UART_ERROR_HANDLING
+#if UART_WITH_RS485
+    // discard the echo of our own transmission:
+    if ((handlePtr->suppressEcho) && (handlePtr->txActive))
+    {
+        UART_RX_LED_OFF;
+        return;
+    }
+#endif // UART_WITH_RS485
+#if UART_WITH_FLOW_CONTROL
+    // consume XON and XOFF, which control the transmitter:
+    if ((handlePtr->flowMode == UART_Flow_XonXoff)
+    &&  ((rx == UART_FLOW_XON) || (rx == UART_FLOW_XOFF)))
+    {
+        handlePtr->xoffReceived = (rx == UART_FLOW_XOFF);
+        if ((rx == UART_FLOW_XON)
+        &&  (BUFFER_GetUsedSize(&handlePtr->txBuffer)))
+        {
+            UART_UDR_EMPTY_INT_ON;
+        }
+        UART_RX_LED_OFF;
+        return;
+    }
+#endif // UART_WITH_FLOW_CONTROL
+#if UART_WITH_BRIDGE
+    // forward the character, bypassing callbacks and the rx buffer:
+    if (handlePtr->bridgeDstPtr != NULL)
+    {
+        if (handlePtr->bridgeTapPtr)
+        {
+            handlePtr->bridgeTapPtr(handlePtr->bridgeTapArgPtr, rx);
+        }
+        if (!uartBridgeTx((uartHandleT*)handlePtr->bridgeDstPtr, rx))
+        {
+            if (handlePtr->bridgeDropCount < 0xFF)
+            {
+                handlePtr->bridgeDropCount++;
+            }
+        }
+        UART_RX_LED_OFF;
+        return;
+    }
+#endif // UART_WITH_BRIDGE
     // execute rx trigger callback (any character):
     if (handlePtr->rxTriggerCallback.state.active)
     {
@@ -520,6 +678,14 @@ static void uartIsrRx (uartHandleT* handlePtr)
 #else // UART_ERROR_HANDLING
         BUFFER_WriteByte(&handlePtr->rxBuffer, rx, NULL);
 #endif // UART_ERROR_HANDLING
+#if UART_WITH_FLOW_CONTROL
+        if ((handlePtr->flowMode != UART_Flow_off)
+        &&  (!handlePtr->rxThrottled)
+        &&  (BUFFER_GetUsedSize(&handlePtr->rxBuffer) >= UART_FLOW_HIGH_WATER))
+        {
+            uartFlowThrottle(handlePtr, 1);
+        }
+#endif // UART_WITH_FLOW_CONTROL
     }
     UART_RX_LED_OFF;
     return;
@@ -537,6 +703,27 @@ static void uartIsrRx (uartHandleT* handlePtr)
 static void uartIsrUdre (uartHandleT* handlePtr)
 {
     volatile uint8_t txByte;
+
+#if UART_WITH_FLOW_CONTROL
+    // XON and XOFF take precedence over the tx buffer:
+    if (handlePtr->flowChar)
+    {
+        *handlePtr->udrPtr = handlePtr->flowChar;
+        handlePtr->flowChar = 0;
+        if (BUFFER_GetUsedSize(&handlePtr->txBuffer) == 0)
+        {
+            UART_UDR_EMPTY_INT_OFF;
+            UART_TX_COMPLETE_INT_ON;
+        }
+        return;
+    }
+    // suspend transmission while the receiver is not ready:
+    if (uartFlowTxHeld(handlePtr))
+    {
+        UART_UDR_EMPTY_INT_OFF;
+        return;
+    }
+#endif // UART_WITH_FLOW_CONTROL
     txByte = BUFFER_ReadByte(&handlePtr->txBuffer, NULL);
     *handlePtr->udrPtr = txByte;
 
@@ -562,9 +749,348 @@ static void uartIsrTx (uartHandleT* handlePtr)
 {
     UART_TX_COMPLETE_INT_OFF; // disable tx complete interrupt
     UART_TX_LED_OFF; // disable tx LED
+    UART_DE_OFF; // release the bus
     handlePtr->txActive = 0; // reset flag for active transmission
 }
 
+#if UART_WITH_BRIDGE
+/*!
+*******************************************************************************
+** \brief   Writes a forwarded character to the tx buffer of the destination
+**          UART and starts the transmission.
+**
+**          Must be called from within the rx ISR of the source UART, i.e.,
+**          with interrupts disabled.
+**
+** \param   handlePtr
+**              The handle of the destination UART.
+** \param   byte
+**              The forwarded character.
+**
+** \return
+**          - 1 if the character has been written to the tx buffer.
+**          - 0 if the tx buffer is full and the character has been dropped.
+**
+*******************************************************************************
+*/
+static uint8_t uartBridgeTx (uartHandleT* handlePtr, uint8_t byte)
+{
+    if (BUFFER_GetFreeSize(&handlePtr->txBuffer) == 0)
+    {
+        return (0);
+    }
+    // avoid txActive flag to be reset:
+    UART_TX_COMPLETE_INT_OFF;
+    BUFFER_WriteByte(&handlePtr->txBuffer, byte, NULL);
+    handlePtr->txActive = 1;
+    UART_TX_LED_ON;
+    UART_DE_ON;
+    UART_UDR_EMPTY_INT_ON;
+    return (1);
+}
+#endif // UART_WITH_BRIDGE
+
+#if UART_WITH_FLOW_CONTROL
+/*!
+*******************************************************************************
+** \brief   Tests whether the receiver at the other end has stopped the
+**          transmission by CTS or XOFF.
+**
+** \param   handlePtr
+**              A handle associated with a specific AVR hardware UART.
+**
+*******************************************************************************
+*/
+static uint8_t uartFlowTxHeld (uartHandleT* handlePtr)
+{
+    switch (handlePtr->flowMode)
+    {
+        case UART_Flow_RtsCts:
+            return ((*handlePtr->ctsPinPtr & (1 << handlePtr->ctsIdx)) != 0);
+        case UART_Flow_XonXoff:
+            return (handlePtr->xoffReceived);
+        default:
+            return (0);
+    }
+}
+
+/*!
+*******************************************************************************
+** \brief   Sends XON or XOFF ahead of the tx buffer.
+**
+** \param   handlePtr
+**              A handle associated with a specific AVR hardware UART.
+** \param   flowChar
+**              #UART_FLOW_XON or #UART_FLOW_XOFF.
+**
+*******************************************************************************
+*/
+static void uartFlowSend (uartHandleT* handlePtr, uint8_t flowChar)
+{
+    IRQ_StateT irq_state;
+
+    ////////////////
+    irq_state = IRQ_EnterGlobal(UART_IRQ_SITE_TX);
+    ////////////////
+
+    // avoid txActive flag to be reset:
+    UART_TX_COMPLETE_INT_OFF;
+    handlePtr->flowChar = flowChar;
+    handlePtr->txActive = 1;
+    UART_DE_ON;
+    UART_UDR_EMPTY_INT_ON;
+
+    ////////////////
+    IRQ_LeaveGlobal(UART_IRQ_SITE_TX, irq_state);
+    ////////////////
+
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Stops or releases the sender by means of RTS or XOFF/XON.
+**
+** \param   handlePtr
+**              A handle associated with a specific AVR hardware UART.
+** \param   throttle
+**              1 to stop the sender, 0 to release it.
+**
+*******************************************************************************
+*/
+static void uartFlowThrottle (uartHandleT* handlePtr, uint8_t throttle)
+{
+    handlePtr->rxThrottled = throttle;
+    if (handlePtr->flowMode == UART_Flow_RtsCts)
+    {
+        if (throttle)
+        {
+            *handlePtr->rtsPortPtr |= (1 << handlePtr->rtsIdx);
+        }
+        else
+        {
+            *handlePtr->rtsPortPtr &= ~(1 << handlePtr->rtsIdx);
+        }
+    }
+    else if (handlePtr->flowMode == UART_Flow_XonXoff)
+    {
+        uartFlowSend(handlePtr, throttle ? UART_FLOW_XOFF : UART_FLOW_XON);
+    }
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Releases the sender if the rx buffer has been read below the low
+**          water mark. Must be called within the rx critical section.
+**
+** \param   handlePtr
+**              A handle associated with a specific AVR hardware UART.
+**
+*******************************************************************************
+*/
+static void uartFlowCheckRead (uartHandleT* handlePtr)
+{
+    if ((handlePtr->rxThrottled)
+    &&  (BUFFER_GetUsedSize(&handlePtr->rxBuffer) <= UART_FLOW_LOW_WATER))
+    {
+        uartFlowThrottle(handlePtr, 0);
+    }
+    return;
+}
+#endif // UART_WITH_FLOW_CONTROL
+
+#if UART_WITH_AUTOBAUD
+/*!
+*******************************************************************************
+** \brief   Waits until the masked register value equals value.
+**
+** \param   regPtr      Points to the register, e.g., PIND.
+** \param   mask        Bits of interest.
+** \param   value       Expected value of the bits of interest.
+** \param   maxWraps    Timeout in wraps of #UART_AUTOBAUD_COUNTER.
+**
+** \return
+**          - 1 if the value has been reached.
+**          - 0 on timeout.
+**
+*******************************************************************************
+*/
+static uint8_t uartAutoBaudWait (volatile uint8_t* regPtr,
+                                 uint8_t mask,
+                                 uint8_t value,
+                                 uint32_t maxWraps)
+{
+    uint16_t now;
+    uint16_t prev = UART_AUTOBAUD_COUNTER;
+
+    while ((*regPtr & mask) != value)
+    {
+        now = UART_AUTOBAUD_COUNTER;
+        if (now < prev)
+        {
+            if (maxWraps-- == 0)
+            {
+                return (0);
+            }
+        }
+        prev = now;
+    }
+    return (1);
+}
+
+/*!
+*******************************************************************************
+** \brief   Measures a sync character on the RXD pin and computes the
+**          matching baud rate register setting.
+**
+**          The start bit is awaited with interrupts enabled. The edges of
+**          the data bits are time stamped with interrupts disabled. The
+**          function returns when the pin is high after bit 7, i.e., in the
+**          stop bit.
+**
+** \param   handlePtr   A handle associated with a specific AVR hardware UART.
+** \param   counterPrescaler
+**                      Prescaler of the clock of #UART_AUTOBAUD_COUNTER.
+** \param   maxWraps    Timeout in wraps of #UART_AUTOBAUD_COUNTER.
+** \param   ubrrPtr     Receives the UBRR value.
+** \param   u2xPtr      Receives 1 if double speed mode is required.
+**
+** \return
+**          - #UART_OK on success.
+**          - #UART_ERR_AUTOBAUD_TIMEOUT if no start bit has been detected.
+**          - #UART_ERR_AUTOBAUD_MISMATCH if the character is not 0x55 or
+**              the baud rate is out of range.
+**
+*******************************************************************************
+*/
+static uint8_t uartAutoBaudMeasure (uartHandleT* handlePtr,
+                                    uint16_t counterPrescaler,
+                                    uint32_t maxWraps,
+                                    uint16_t* ubrrPtr,
+                                    uint8_t* u2xPtr)
+{
+    uint16_t   stamp_arr[UART_AUTOBAUD_EDGES];
+    uint16_t   now;
+    uint16_t   prev;
+    uint16_t   interval;
+    uint16_t   avg;
+    uint32_t   cycles; // system clock cycles of 7 bits
+    uint32_t   divisor;
+    uint32_t   deviation;
+    uint16_t   ubrr;
+    uint8_t    level = 0;
+    uint8_t    edges = 0;
+    uint8_t    ii;
+    IRQ_StateT irq_state;
+
+    if (!uartAutoBaudWait(&PIND, handlePtr->rxdMask, 0, maxWraps))
+    {
+        return (UART_ERR_AUTOBAUD_TIMEOUT);
+    }
+
+    ////////////////
+    irq_state = IRQ_EnterGlobal(UART_IRQ_SITE_INIT);
+    ////////////////
+
+    prev = UART_AUTOBAUD_COUNTER;
+    while (edges < UART_AUTOBAUD_EDGES)
+    {
+        now = UART_AUTOBAUD_COUNTER;
+        if (((PIND & handlePtr->rxdMask) != 0) != level)
+        {
+            level ^= 1;
+            stamp_arr[edges++] = now;
+            prev = now;
+        }
+        else if ((uint16_t)(now - prev) > 0x7FFF)
+        {
+            break; // not a sync character
+        }
+    }
+    // let bit 7 and the parity bit pass:
+    prev = UART_AUTOBAUD_COUNTER;
+    while ((edges == UART_AUTOBAUD_EDGES) && !(PIND & handlePtr->rxdMask))
+    {
+        if ((uint16_t)(UART_AUTOBAUD_COUNTER - prev) > 0x7FFF)
+        {
+            edges = 0;
+        }
+    }
+
+    ////////////////
+    IRQ_LeaveGlobal(UART_IRQ_SITE_INIT, irq_state);
+    ////////////////
+
+    if (edges < UART_AUTOBAUD_EDGES)
+    {
+        return (UART_ERR_AUTOBAUD_MISMATCH);
+    }
+
+    // each interval must be a single bit time (within 25 %):
+    avg = (uint16_t)(stamp_arr[UART_AUTOBAUD_EDGES - 1] - stamp_arr[0])
+        / (UART_AUTOBAUD_EDGES - 1);
+    for (ii = 1; ii < UART_AUTOBAUD_EDGES; ii++)
+    {
+        interval = stamp_arr[ii] - stamp_arr[ii - 1];
+        if ((interval < avg - (avg >> 2)) || (interval > avg + (avg >> 2)))
+        {
+            return (UART_ERR_AUTOBAUD_MISMATCH);
+        }
+    }
+
+    // nearest UBRR in normal mode, U2X if the error exceeds 1.5 %:
+    cycles = (uint32_t)(uint16_t)(stamp_arr[UART_AUTOBAUD_EDGES - 1]
+                                  - stamp_arr[0]) * counterPrescaler;
+    divisor = 16UL * (UART_AUTOBAUD_EDGES - 1);
+    ubrr = (uint16_t)((cycles + divisor / 2) / divisor);
+    deviation = (ubrr * divisor > cycles) ? (ubrr * divisor - cycles)
+                                          : (cycles - ubrr * divisor);
+    *u2xPtr = 0;
+    if ((ubrr == 0) || (deviation * 200 > 3 * cycles))
+    {
+        *u2xPtr = 1;
+        divisor >>= 1;
+        ubrr = (uint16_t)((cycles + divisor / 2) / divisor);
+    }
+    if ((ubrr == 0) || (ubrr > 4096))
+    {
+        return (UART_ERR_AUTOBAUD_MISMATCH);
+    }
+    *ubrrPtr = ubrr - 1;
+    return (UART_OK);
+}
+#endif // UART_WITH_AUTOBAUD
+
+#if UART_WITH_CLOCK_SCALING
+/*!
+*******************************************************************************
+** \brief   Set up the baud rate register for the current system clock.
+**
+** \param   handlePtr   A valid UART handle.
+**
+*******************************************************************************
+*/
+static void uartApplyClockShift (uartHandleT* handlePtr)
+{
+    uint16_t divisor = handlePtr->ubrrDivisor >> uartClockShift;
+
+    // round to nearest, the bit shifted out last is the half:
+    if (uartClockShift
+    &&  ((handlePtr->ubrrDivisor >> (uartClockShift - 1)) & 0x01))
+    {
+        divisor++;
+    }
+    if (divisor == 0)
+    {
+        divisor = 1;
+    }
+    *handlePtr->ubrrhPtr = (divisor - 1) >> 8;
+    *handlePtr->ubrrlPtr = (divisor - 1) & 0xFF;
+    return;
+}
+#endif // UART_WITH_CLOCK_SCALING
+
 //*****************************************************************************
 //*************************** PUBLIC FUNCTIONS ********************************
 //*****************************************************************************
@@ -588,6 +1114,13 @@ static void uartIsrTx (uartHandleT* handlePtr)
 ** \param   ledParamsPtr
 **                      Optional pointer. Specifies setup for activity LEDs.
 **
+** \attention
+**          With RTS/CTS flow control (see UART_SetFlowControl()), the
+**          driver does not monitor the CTS pin by an interrupt. Once CTS
+**          has suspended the transmission, it is only resumed when the
+**          application calls UART_CtsChanged(), e.g., from a pin change
+**          callback of the EXTINT driver that is attached to CTS.
+**
 ** \return
 **          - A valid UART_HandleT handle on success.
 **          - NULL if a bad parameter has been passed.
@@ -603,7 +1136,7 @@ UART_HandleT UART_Init (UART_InterfaceIdT id,
                         UART_LedParamsT*  ledParamsPtr)
 {
     uartHandleT* handlePtr = NULL;
-    uint8_t sreg_save = 0;
+    IRQ_StateT irq_state;
     uint8_t ucsra     = 0;
     uint8_t ucsrb     = 0;
     uint8_t ucsrc     = 0;
@@ -623,6 +1156,14 @@ UART_HandleT UART_Init (UART_InterfaceIdT id,
         return (NULL);
     }
 
+#if UART_WITH_POWER_MANAGER
+    // acquire the USART clock once per port, there is no exit path:
+    if (!handlePtr->initialized)
+    {
+        (void) POWER_Acquire((id == UART_InterfaceId0) ? POWER_Usart0 : POWER_Usart1);
+    }
+#endif
+
     // Reset handle:
     memset(handlePtr, 0, sizeof(uartHandleT));
 
@@ -666,9 +1207,22 @@ UART_HandleT UART_Init (UART_InterfaceIdT id,
     }
 #endif
 
+#if (UART_WITH_AUTOBAUD) || (UART_WITH_CLOCK_SCALING)
+    handlePtr->ubrrhPtr = ubrrh_ptr;
+    handlePtr->ubrrlPtr = ubrrl_ptr;
+#endif
+#if UART_WITH_AUTOBAUD
+    handlePtr->rxdMask  = (1 << UART_AUTOBAUD_RXD0_IDX);
+#if (UART_PORT_FACTOR == UART_MULTIPORT_2)
+    if (id == UART_InterfaceId1)
+    {
+        handlePtr->rxdMask = (1 << UART_AUTOBAUD_RXD1_IDX);
+    }
+#endif
+#endif // UART_WITH_AUTOBAUD
+
     // Disable interrupts temporarily:
-    sreg_save = SREG;
-    cli();
+    irq_state = IRQ_EnterGlobal(UART_IRQ_SITE_INIT);
 
     /* normal transmission speed, no MPCM */
     *handlePtr->ucsraPtr = 0x00;
@@ -685,6 +1239,10 @@ UART_HandleT UART_Init (UART_InterfaceIdT id,
 
     // set up the register configuration:
     uartSetBaudRate(ubrrh_ptr, ubrrl_ptr, baudRate);
+#if UART_WITH_CLOCK_SCALING
+    handlePtr->ubrrDivisor = (((uint16_t)*ubrrh_ptr << 8) | *ubrrl_ptr) + 1;
+    uartApplyClockShift(handlePtr);
+#endif
 
     // parity setup
     switch (parityMode)
@@ -698,7 +1256,7 @@ UART_HandleT UART_Init (UART_InterfaceIdT id,
             ucsrc |= (1 << UPM1);
             break;
         default:
-            SREG = sreg_save;
+            IRQ_LeaveGlobal(UART_IRQ_SITE_INIT, irq_state);
             return (NULL);
     }
 
@@ -711,7 +1269,7 @@ UART_HandleT UART_Init (UART_InterfaceIdT id,
             ucsrc |= (1 << USBS);
             break;
         default:
-            SREG = sreg_save;
+            IRQ_LeaveGlobal(UART_IRQ_SITE_INIT, irq_state);
             return (NULL);
     }
 
@@ -733,7 +1291,7 @@ UART_HandleT UART_Init (UART_InterfaceIdT id,
             ucsrc |= ((1 << UCSZ1) | (1 << UCSZ0));
             break;
         default:
-            SREG = sreg_save;
+            IRQ_LeaveGlobal(UART_IRQ_SITE_INIT, irq_state);
             return (NULL);
     }
 
@@ -753,7 +1311,7 @@ UART_HandleT UART_Init (UART_InterfaceIdT id,
             ucsrb |= (1 << RXCIE) | (1 << RXEN) | (1 << TXEN);
             break;
         default:
-            SREG = sreg_save;
+            IRQ_LeaveGlobal(UART_IRQ_SITE_INIT, irq_state);
             return (NULL);
     }
 
@@ -808,7 +1366,7 @@ UART_HandleT UART_Init (UART_InterfaceIdT id,
     handlePtr->initialized = 1;
 
     // restore SREG:
-    SREG = sreg_save;
+    IRQ_LeaveGlobal(UART_IRQ_SITE_INIT, irq_state);
 
     return ((UART_HandleT)handlePtr);
 }
@@ -869,6 +1427,7 @@ uint8_t UART_RegisterRxTriggerCallback (UART_HandleT handle,
                                         UART_RxCallbackOptionsT options)
 {
     uartHandleT* handlePtr = (uartHandleT*)handle;
+    IRQ_StateT   irq_state;
 
     if ((handlePtr == NULL) || (funcPtr == NULL))
     {
@@ -876,7 +1435,7 @@ uint8_t UART_RegisterRxTriggerCallback (UART_HandleT handle,
     }
 
     ////////////////
-    uartEnterRxCS(handlePtr);
+    irq_state = uartEnterRxCS(handlePtr);
     ////////////////
 
     handlePtr->rxTriggerCallback.funcPtr = funcPtr;
@@ -886,7 +1445,7 @@ uint8_t UART_RegisterRxTriggerCallback (UART_HandleT handle,
     handlePtr->rxTriggerCallback.state.active = 1;
 
     ////////////////
-    uartLeaveRxCS(handlePtr);
+    uartLeaveRxCS(handlePtr, irq_state);
     ////////////////
 
     return (UART_OK);
@@ -913,6 +1472,7 @@ uint8_t UART_UnregisterRxTriggerCallback (UART_HandleT handle)
 {
     uint8_t found = 0; // indicates if a callback has been registered
     uartHandleT* handlePtr = (uartHandleT*) handle;
+    IRQ_StateT   irq_state;
 
     if (handlePtr == NULL)
     {
@@ -920,7 +1480,7 @@ uint8_t UART_UnregisterRxTriggerCallback (UART_HandleT handle)
     }
 
     ////////////////
-    uartEnterRxCS(handlePtr);
+    irq_state = uartEnterRxCS(handlePtr);
     ////////////////
 
     if (handlePtr->rxTriggerCallback.funcPtr) found = 1;
@@ -928,7 +1488,7 @@ uint8_t UART_UnregisterRxTriggerCallback (UART_HandleT handle)
            sizeof(handlePtr->rxTriggerCallback));
 
     ////////////////
-    uartLeaveRxCS(handlePtr);
+    uartLeaveRxCS(handlePtr, irq_state);
     ////////////////
 
     if (found)
@@ -983,6 +1543,7 @@ uint8_t UART_RegisterRxCallback (UART_HandleT handle,
 {
     uint8_t ii;
     uartHandleT* handlePtr = (uartHandleT*) handle;
+    IRQ_StateT   irq_state;
 
     if ((handlePtr == NULL) || (funcPtr == NULL))
     {
@@ -990,7 +1551,7 @@ uint8_t UART_RegisterRxCallback (UART_HandleT handle,
     }
 
     ////////////////
-    uartEnterRxCS(handlePtr);
+    irq_state = uartEnterRxCS(handlePtr);
     ////////////////
 
     // search for free slot:
@@ -1012,14 +1573,14 @@ uint8_t UART_RegisterRxCallback (UART_HandleT handle,
                 options.writeRxToBuffer;
         handlePtr->rxCallbackArray[ii].state.active = 1;
         ////////////////
-        uartLeaveRxCS(handlePtr);
+        uartLeaveRxCS(handlePtr, irq_state);
         ////////////////
         return (UART_OK);
     }
     else
     {
         ////////////////
-        uartLeaveRxCS(handlePtr);
+        uartLeaveRxCS(handlePtr, irq_state);
         ////////////////
         return (UART_ERR_NO_CALLBACK_SLOT);
     }
@@ -1048,6 +1609,7 @@ uint8_t UART_UnregisterRxCallback (UART_HandleT handle, uint8_t rxByte)
     uint8_t ii; // temporary counter
     uint8_t found = 0; // indicates the count of callbacks found
     uartHandleT* handlePtr = (uartHandleT*) handle;
+    IRQ_StateT   irq_state;
 
     if (handlePtr == NULL)
     {
@@ -1055,7 +1617,7 @@ uint8_t UART_UnregisterRxCallback (UART_HandleT handle, uint8_t rxByte)
     }
 
     ////////////////
-    uartEnterRxCS(handlePtr);
+    irq_state = uartEnterRxCS(handlePtr);
     ////////////////
 
     for (ii = 0; ii < UART_RX_CALLBACK_COUNT; ii++)
@@ -1068,7 +1630,7 @@ uint8_t UART_UnregisterRxCallback (UART_HandleT handle, uint8_t rxByte)
     }
 
     ////////////////
-    uartLeaveRxCS(handlePtr);
+    uartLeaveRxCS(handlePtr, irq_state);
     ////////////////
 
     if (found)
@@ -1131,24 +1693,25 @@ void UART_RxCallbackOnBackspace (void* optArgPtr)
 void UART_TxByte (UART_HandleT handle, uint8_t byte)
 {
     uartHandleT* handlePtr = (uartHandleT*) handle;
+    IRQ_StateT   irq_state;
 
     if (handlePtr == NULL) return;
 
     ////////////////
-    uartEnterTxCS(handlePtr);
+    irq_state = uartEnterTxCS(handlePtr);
     ////////////////
 
     // active waiting if buffer impends to overflow:
     while (BUFFER_GetFreeSize(&handlePtr->txBuffer) == 0)
     {
         ////////////////
-        uartLeaveTxCS(handlePtr);
+        uartLeaveTxCS(handlePtr, irq_state);
         ////////////////
 
         ; // no-op -> allow TX interrupt
 
         ////////////////
-        uartEnterTxCS(handlePtr);
+        irq_state = uartEnterTxCS(handlePtr);
         ////////////////
     }
 
@@ -1158,12 +1721,13 @@ void UART_TxByte (UART_HandleT handle, uint8_t byte)
     BUFFER_WriteByte(&handlePtr->txBuffer, byte, NULL);
     handlePtr->txActive = 1;
     UART_TX_LED_ON;
+    UART_DE_ON;
 
     // action UART_UDR_EMPTY_INT_ON when leaving the CS:
     handlePtr->txIntEn = 1;
 
     ////////////////
-    uartLeaveTxCS(handlePtr);
+    uartLeaveTxCS(handlePtr, irq_state);
     ////////////////
 
     return;
@@ -1189,11 +1753,12 @@ uint8_t UART_RxByte (UART_HandleT handle)
 {
     uint8_t rxByte;
     uartHandleT* handlePtr = (uartHandleT*)handle;
+    IRQ_StateT   irq_state;
 
     if (handlePtr == NULL) return ('\0');
 
     ////////////////
-    uartEnterRxCS(handlePtr);
+    irq_state = uartEnterRxCS(handlePtr);
     ////////////////
 
     // active waiting if buffer is empty, wait for valid input data
@@ -1202,20 +1767,23 @@ uint8_t UART_RxByte (UART_HandleT handle)
         handlePtr->rxWaiting = 1;
 
         ////////////////
-        uartLeaveRxCS(handlePtr);
+        uartLeaveRxCS(handlePtr, irq_state);
         ////////////////
 
         ; // no-op -> allow RX interrupt
 
         ////////////////
-        uartEnterRxCS(handlePtr);
+        irq_state = uartEnterRxCS(handlePtr);
         ////////////////
     }
     handlePtr->rxWaiting = 0;
     rxByte = BUFFER_ReadByte(&handlePtr->rxBuffer, NULL);
+#if UART_WITH_FLOW_CONTROL
+    uartFlowCheckRead(handlePtr);
+#endif
 
     ////////////////
-    uartLeaveRxCS(handlePtr);
+    uartLeaveRxCS(handlePtr, irq_state);
     ////////////////
 
     return (rxByte);
@@ -1248,11 +1816,12 @@ uint8_t UART_TxField (UART_HandleT handle, uint8_t* fieldPtr, uint8_t byteCount)
 {
     uint8_t txCount;
     uartHandleT* handlePtr = (uartHandleT*)handle;
+    IRQ_StateT   irq_state;
 
     if (handlePtr == NULL) return (0);
 
     ////////////////
-    uartEnterTxCS(handlePtr);
+    irq_state = uartEnterTxCS(handlePtr);
     ////////////////
 
     // avoid txActive flag to be reset:
@@ -1261,12 +1830,13 @@ uint8_t UART_TxField (UART_HandleT handle, uint8_t* fieldPtr, uint8_t byteCount)
     txCount = BUFFER_WriteField(&handlePtr->txBuffer, fieldPtr, byteCount, NULL);
     handlePtr->txActive = 1;
     UART_TX_LED_ON;
+    UART_DE_ON;
 
     // action UART_UDR_EMPTY_INT_ON when leaving the CS:
     handlePtr->txIntEn = 1;
 
     ////////////////
-    uartLeaveTxCS(handlePtr);
+    uartLeaveTxCS(handlePtr, irq_state);
     ////////////////
 
     return (txCount);
@@ -1299,17 +1869,21 @@ uint8_t UART_RxField (UART_HandleT handle, uint8_t* fieldPtr, uint8_t byteCount)
 {
     uint8_t rxCount;
     uartHandleT* handlePtr = (uartHandleT*)handle;
+    IRQ_StateT   irq_state;
 
     if (handlePtr == NULL) return (0);
 
     ////////////////
-    uartEnterRxCS(handlePtr);
+    irq_state = uartEnterRxCS(handlePtr);
     ////////////////
 
     rxCount = BUFFER_ReadField(&handlePtr->rxBuffer, fieldPtr, byteCount, NULL);
+#if UART_WITH_FLOW_CONTROL
+    uartFlowCheckRead(handlePtr);
+#endif
 
     ////////////////
-    uartLeaveRxCS(handlePtr);
+    uartLeaveRxCS(handlePtr, irq_state);
     ////////////////
 
     return (rxCount);
@@ -1328,17 +1902,21 @@ uint8_t UART_RxField (UART_HandleT handle, uint8_t* fieldPtr, uint8_t byteCount)
 void UART_RxDiscard (UART_HandleT handle)
 {
     uartHandleT* handlePtr = (uartHandleT*)handle;
+    IRQ_StateT   irq_state;
 
     if (handlePtr == NULL) return;
 
     ////////////////
-    uartEnterRxCS(handlePtr);
+    irq_state = uartEnterRxCS(handlePtr);
     ////////////////
 
     BUFFER_Discard(&handlePtr->rxBuffer);
+#if UART_WITH_FLOW_CONTROL
+    uartFlowCheckRead(handlePtr);
+#endif
 
     ////////////////
-    uartLeaveRxCS(handlePtr);
+    uartLeaveRxCS(handlePtr, irq_state);
     ////////////////
 
     return;
@@ -1365,6 +1943,479 @@ void UART_TxFlush (UART_HandleT handle)
     return;
 }
 
+#if UART_WITH_BRIDGE
+
+/*!
+*******************************************************************************
+** \brief   Set up or clear a bridge from one UART interface to another.
+**
+**          While the bridge is set up, the rx ISR of the source UART writes
+**          each received character directly to the tx buffer of the
+**          destination UART and starts its transmission, without any
+**          involvement of the main program. Forwarded characters bypass
+**          the rx buffer and the rx callbacks of the source UART. If the
+**          tx buffer of the destination is full, the character is dropped.
+**          Call the function for both directions to get a transparent
+**          bidirectional bridge.
+**
+** \attention
+**          While bridged, the main program must not transmit on the
+**          destination UART unless UART_INTERRUPT_SAFETY is set to 1.
+**
+** \param   srcHandle   Handle of the UART whose received characters will
+**                      be forwarded.
+** \param   dstHandle   Handle of the UART that transmits the forwarded
+**                      characters. Set to NULL to clear the bridge.
+** \param   tapPtr      Optional callback, which is executed within ISR
+**                      context for each forwarded character. May be NULL.
+** \param   optArgPtr   Optional argument that will be passed to the tap
+**                      callback.
+**
+** \return
+**          - #UART_OK on success.
+**          - #UART_ERR_BAD_PARAMETER if a handle is invalid, both handles
+**              are equal or the transmitter of the destination is disabled.
+**
+*******************************************************************************
+*/
+uint8_t UART_SetBridge (UART_HandleT srcHandle,
+                        UART_HandleT dstHandle,
+                        UART_BridgeTapCallbackT tapPtr,
+                        void* optArgPtr)
+{
+    uartHandleT* handlePtr = (uartHandleT*)srcHandle;
+    uartHandleT* dst_ptr   = (uartHandleT*)dstHandle;
+    IRQ_StateT   irq_state;
+
+    if ((handlePtr == NULL) || (!handlePtr->initialized)
+    ||  (dst_ptr == handlePtr))
+    {
+        return (UART_ERR_BAD_PARAMETER);
+    }
+    if ((dst_ptr != NULL)
+    &&  ((!dst_ptr->initialized) || !(*dst_ptr->ucsrbPtr & (1 << TXEN))))
+    {
+        return (UART_ERR_BAD_PARAMETER);
+    }
+
+    ////////////////
+    irq_state = uartEnterRxCS(handlePtr);
+    ////////////////
+
+    handlePtr->bridgeDstPtr    = dst_ptr;
+    handlePtr->bridgeTapPtr    = (dst_ptr != NULL) ? tapPtr : NULL;
+    handlePtr->bridgeTapArgPtr = optArgPtr;
+    handlePtr->bridgeDropCount = 0;
+
+    ////////////////
+    uartLeaveRxCS(handlePtr, irq_state);
+    ////////////////
+
+    return (UART_OK);
+}
+
+/*!
+*******************************************************************************
+** \brief   Get the count of characters that have been dropped by the bridge
+**          because the tx buffer of the destination was full.
+**
+**          The counter saturates at 255 and is reset by UART_SetBridge().
+**
+** \param   srcHandle   Handle of the source UART of the bridge.
+**
+** \return  The count of dropped characters.
+**
+*******************************************************************************
+*/
+uint8_t UART_GetBridgeDropCount (UART_HandleT srcHandle)
+{
+    uartHandleT* handlePtr = (uartHandleT*)srcHandle;
+
+    if (handlePtr == NULL) return (0);
+    return (handlePtr->bridgeDropCount);
+}
+
+#endif // UART_WITH_BRIDGE
+
+#if UART_WITH_FLOW_CONTROL
+
+/*!
+*******************************************************************************
+** \brief   Set up flow control.
+**
+**          The receiver stops the sender when the rx buffer reaches
+**          #UART_FLOW_HIGH_WATER and releases it when the rx buffer has
+**          been read down to #UART_FLOW_LOW_WATER. With #UART_Flow_RtsCts,
+**          RTS is deasserted (high) to stop the sender, and the transmitter
+**          suspends while CTS is deasserted (high). With #UART_Flow_XonXoff,
+**          XOFF and XON are sent ahead of the tx buffer, and received XON
+**          and XOFF characters are consumed by the rx ISR and suspend or
+**          resume the transmitter.
+**
+** \attention
+**          The transmitter checks CTS before each character. In order to
+**          resume a suspended transmission when CTS is asserted again,
+**          UART_CtsChanged() must be called, e.g., from a pin change
+**          interrupt callback of the EXTINT driver.
+**
+** \param   handle          A handle associated with a specific AVR
+**                          hardware UART.
+** \param   flowParamsPtr   Specifies the mode and pins. Set to NULL to
+**                          switch flow control off.
+**
+** \return
+**          - #UART_OK on success.
+**          - #UART_ERR_BAD_PARAMETER if a bad parameter has been passed.
+**
+*******************************************************************************
+*/
+uint8_t UART_SetFlowControl (UART_HandleT handle,
+                             UART_FlowParamsT* flowParamsPtr)
+{
+    uartHandleT* handlePtr = (uartHandleT*)handle;
+    UART_FlowT   mode = UART_Flow_off;
+    IRQ_StateT   irq_state;
+
+    if (handlePtr == NULL)
+    {
+        return (UART_ERR_BAD_PARAMETER);
+    }
+    if (flowParamsPtr)
+    {
+        mode = flowParamsPtr->mode;
+        if ((mode > UART_Flow_XonXoff)
+        ||  ((mode == UART_Flow_RtsCts)
+          && ((flowParamsPtr->rtsPortPtr == NULL)
+           || (flowParamsPtr->rtsDdrPtr == NULL)
+           || (flowParamsPtr->ctsPinPtr == NULL)
+           || (flowParamsPtr->ctsDdrPtr == NULL))))
+        {
+            return (UART_ERR_BAD_PARAMETER);
+        }
+    }
+
+    ////////////////
+    irq_state = IRQ_EnterGlobal(UART_IRQ_SITE_INIT);
+    ////////////////
+
+    handlePtr->flowMode     = mode;
+    handlePtr->rxThrottled  = 0;
+    handlePtr->xoffReceived = 0;
+    handlePtr->flowChar     = 0;
+    if (mode == UART_Flow_RtsCts)
+    {
+        handlePtr->rtsPortPtr = flowParamsPtr->rtsPortPtr;
+        handlePtr->rtsIdx     = flowParamsPtr->rtsIdx;
+        handlePtr->ctsPinPtr  = flowParamsPtr->ctsPinPtr;
+        handlePtr->ctsIdx     = flowParamsPtr->ctsIdx;
+        // assert RTS:
+        *handlePtr->rtsPortPtr &= ~(1 << handlePtr->rtsIdx);
+        *flowParamsPtr->rtsDdrPtr |= (1 << flowParamsPtr->rtsIdx);
+        *flowParamsPtr->ctsDdrPtr &= ~(1 << flowParamsPtr->ctsIdx);
+    }
+    if (BUFFER_GetUsedSize(&handlePtr->rxBuffer) >= UART_FLOW_HIGH_WATER)
+    {
+        uartFlowThrottle(handlePtr, 1);
+    }
+
+    ////////////////
+    IRQ_LeaveGlobal(UART_IRQ_SITE_INIT, irq_state);
+    ////////////////
+
+    return (UART_OK);
+}
+
+/*!
+*******************************************************************************
+** \brief   Resumes a transmission that has been suspended by CTS.
+**
+**          Call this function when CTS has changed, e.g., from within a
+**          pin change interrupt callback. It may also be called
+**          periodically.
+**
+** \param   handle      A handle associated with a specific AVR hardware UART.
+**
+*******************************************************************************
+*/
+void UART_CtsChanged (UART_HandleT handle)
+{
+    uartHandleT* handlePtr = (uartHandleT*)handle;
+    IRQ_StateT   irq_state;
+
+    if (handlePtr == NULL) return;
+
+    ////////////////
+    irq_state = IRQ_EnterGlobal(UART_IRQ_SITE_TX);
+    ////////////////
+
+    if ((!uartFlowTxHeld(handlePtr))
+    &&  (BUFFER_GetUsedSize(&handlePtr->txBuffer)))
+    {
+        UART_UDR_EMPTY_INT_ON;
+    }
+
+    ////////////////
+    IRQ_LeaveGlobal(UART_IRQ_SITE_TX, irq_state);
+    ////////////////
+
+    return;
+}
+
+#endif // UART_WITH_FLOW_CONTROL
+
+#if UART_WITH_RS485
+
+/*!
+*******************************************************************************
+** \brief   Set up the RS-485 half-duplex mode.
+**
+**          The driver enable (DE) pin of the transceiver is asserted (high)
+**          as soon as a transmission starts and released from within the
+**          tx complete ISR, i.e., right after the stop bit of the last
+**          character has left the shift register. No software delays are
+**          involved in the turnaround.
+**          If the receiver of the transceiver stays enabled while
+**          transmitting, set suppressEcho in order to discard the
+**          characters that are received while a transmission is active.
+**
+** \param   handle          A handle associated with a specific AVR
+**                          hardware UART.
+** \param   rs485ParamsPtr  Specifies the DE pin and echo suppression.
+**                          Set to NULL to switch the RS-485 mode off.
+**
+** \return
+**          - #UART_OK on success.
+**          - #UART_ERR_BAD_PARAMETER if a bad parameter has been passed.
+**
+*******************************************************************************
+*/
+uint8_t UART_SetRs485 (UART_HandleT handle,
+                       UART_Rs485ParamsT* rs485ParamsPtr)
+{
+    uartHandleT* handlePtr = (uartHandleT*)handle;
+    IRQ_StateT   irq_state;
+
+    if ((handlePtr == NULL)
+    ||  ((rs485ParamsPtr)
+      && ((rs485ParamsPtr->dePortPtr == NULL)
+       || (rs485ParamsPtr->deDdrPtr == NULL))))
+    {
+        return (UART_ERR_BAD_PARAMETER);
+    }
+
+    ////////////////
+    irq_state = IRQ_EnterGlobal(UART_IRQ_SITE_INIT);
+    ////////////////
+
+    UART_DE_OFF;
+    handlePtr->deActive = 0;
+    handlePtr->suppressEcho = 0;
+    if (rs485ParamsPtr)
+    {
+        handlePtr->dePortPtr    = rs485ParamsPtr->dePortPtr;
+        handlePtr->deIdx        = rs485ParamsPtr->deIdx;
+        handlePtr->deActive     = 1;
+        handlePtr->suppressEcho = rs485ParamsPtr->suppressEcho;
+        if (handlePtr->txActive)
+        {
+            UART_DE_ON;
+        }
+        else
+        {
+            UART_DE_OFF;
+        }
+        *rs485ParamsPtr->deDdrPtr |= (1 << rs485ParamsPtr->deIdx);
+    }
+
+    ////////////////
+    IRQ_LeaveGlobal(UART_IRQ_SITE_INIT, irq_state);
+    ////////////////
+
+    return (UART_OK);
+}
+
+#endif // UART_WITH_RS485
+
+#if UART_WITH_AUTOBAUD
+
+/*!
+*******************************************************************************
+** \brief   Detect the baud rate of the host and set up the UART accordingly.
+**
+**          The host must send the sync character 'U' (0x55) at least twice.
+**          The receiver is disabled and the RXD pin is polled against
+**          #UART_AUTOBAUD_COUNTER. The edges from the start of data bit 0
+**          to the start of data bit 7 span 7 bit times, and each single
+**          interval must match the average. The baud rate register is set
+**          to the nearest value, using the double speed mode (U2X) if
+**          normal mode deviates by more than 1.5 %. Then the receiver is
+**          enabled again, and the next character must be received as 0x55
+**          without frame error. The measurement does not depend on the
+**          parity setting.
+**
+** \attention
+**          Interrupts are disabled while a character is being measured,
+**          i.e., for about one character time. The function blocks for up
+**          to timeoutMs per sync character. The rx buffer is discarded on
+**          success. The polling loop limits the resolution to about 12
+**          system clock cycles per edge, which is sufficient for baud
+**          rates up to 250000 at 18.432 MHz.
+**
+** \param   handle      A handle associated with a specific AVR hardware UART.
+** \param   counterPrescaler
+**                      Prescaler of the clock of #UART_AUTOBAUD_COUNTER.
+**                      7 bit times must not exceed 32767 counter ticks,
+**                      e.g., prescaler 8 for baud rates down to 4800 at
+**                      18.432 MHz.
+** \param   timeoutMs   Maximum time to wait for each sync character.
+** \param   baudRatePtr Optional pointer, receives the detected baud rate.
+**
+** \return
+**          - #UART_OK on success.
+**          - #UART_ERR_BAD_PARAMETER if a bad parameter has been passed.
+**          - #UART_ERR_AUTOBAUD_TIMEOUT if no sync character has been
+**              received within timeoutMs.
+**          - #UART_ERR_AUTOBAUD_MISMATCH if the characters have not been
+**              recognized as sync characters or the baud rate is out of
+**              range.
+**          On failure, the previous baud rate setting is restored.
+**
+*******************************************************************************
+*/
+uint8_t UART_AutoBaud (UART_HandleT handle,
+                       uint16_t counterPrescaler,
+                       uint16_t timeoutMs,
+                       uint32_t* baudRatePtr)
+{
+    uartHandleT* handlePtr = (uartHandleT*)handle;
+    uint32_t     max_wraps;
+    uint16_t     ubrr;
+    uint8_t      u2x;
+    uint8_t      ucsra;
+    uint8_t      ucsrb;
+    uint8_t      ubrrh;
+    uint8_t      ubrrl;
+    uint8_t      status;
+    uint8_t      rx;
+    uint8_t      result;
+    IRQ_StateT   irq_state;
+
+    if ((handlePtr == NULL) || (!handlePtr->initialized)
+    ||  (counterPrescaler == 0))
+    {
+        return (UART_ERR_BAD_PARAMETER);
+    }
+    max_wraps = ((uint32_t)timeoutMs * (F_CPU / 1000UL))
+              / ((uint32_t)counterPrescaler << 16) + 1;
+
+    // disable the receiver, so that the pin can be polled as plain input:
+    irq_state = IRQ_EnterGlobal(UART_IRQ_SITE_INIT);
+    ucsra = *handlePtr->ucsraPtr;
+    ucsrb = *handlePtr->ucsrbPtr;
+    ubrrh = *handlePtr->ubrrhPtr;
+    ubrrl = *handlePtr->ubrrlPtr;
+    *handlePtr->ucsrbPtr &= ~((1 << RXEN) | (1 << RXCIE));
+    IRQ_LeaveGlobal(UART_IRQ_SITE_INIT, irq_state);
+
+    result = uartAutoBaudMeasure(handlePtr, counterPrescaler, max_wraps,
+                                 &ubrr, &u2x);
+    if (result == UART_OK)
+    {
+        // apply and confirm with the next sync character:
+        irq_state = IRQ_EnterGlobal(UART_IRQ_SITE_INIT);
+        // write back MPCM only, writing flags would clear TXC:
+        *handlePtr->ucsraPtr = (ucsra & (1 << MPCM)) | (u2x << U2X);
+        *handlePtr->ubrrhPtr = ubrr >> 8;
+        *handlePtr->ubrrlPtr = ubrr & 0xFF;
+        *handlePtr->ucsrbPtr |= (1 << RXEN);
+#if UART_WITH_CLOCK_SCALING
+        handlePtr->ubrrDivisor = (ubrr + 1) << uartClockShift;
+#endif
+        IRQ_LeaveGlobal(UART_IRQ_SITE_INIT, irq_state);
+
+        if (!uartAutoBaudWait(handlePtr->ucsraPtr, (1 << RXC), (1 << RXC),
+                              max_wraps))
+        {
+            result = UART_ERR_AUTOBAUD_TIMEOUT;
+        }
+        else
+        {
+            status = *handlePtr->ucsraPtr;
+            rx = *handlePtr->udrPtr;
+            if ((status & (1 << FE)) || (rx != UART_AUTOBAUD_SYNC))
+            {
+                result = UART_ERR_AUTOBAUD_MISMATCH;
+            }
+        }
+    }
+
+    irq_state = IRQ_EnterGlobal(UART_IRQ_SITE_INIT);
+    if (result != UART_OK)
+    {
+        // restore the previous baud rate:
+        *handlePtr->ucsrbPtr &= ~(1 << RXEN);
+        *handlePtr->ucsraPtr = ucsra & ((1 << U2X) | (1 << MPCM));
+        *handlePtr->ubrrhPtr = ubrrh;
+        *handlePtr->ubrrlPtr = ubrrl;
+    }
+    *handlePtr->ucsrbPtr |= ucsrb & ((1 << RXEN) | (1 << RXCIE));
+    IRQ_LeaveGlobal(UART_IRQ_SITE_INIT, irq_state);
+
+    if (result == UART_OK)
+    {
+        UART_RxDiscard(handle);
+        if (baudRatePtr)
+        {
+#if UART_WITH_CLOCK_SCALING
+            *baudRatePtr = (F_CPU >> uartClockShift)
+                           / ((u2x ? 8UL : 16UL) * (ubrr + 1UL));
+#else
+            *baudRatePtr = F_CPU / ((u2x ? 8UL : 16UL) * (ubrr + 1UL));
+#endif
+        }
+    }
+    return (result);
+}
+
+#endif // UART_WITH_AUTOBAUD
+
+#if UART_WITH_CLOCK_SCALING
+/*!
+*******************************************************************************
+** \brief   Notify the driver that the system clock has been scaled.
+**
+**          The baud rate registers of all initialized UARTs are recomputed
+**          for the new clock. The baud rate error grows with the clock
+**          division, e.g., 115200 bps at 18.432 MHz is exact up to a
+**          clock shift of 1 only, so check the error for the used shifts.
+**          Characters that are in transit while the clock is changed are
+**          corrupted.
+**
+**          This function matches CLOCK_ListenerT and must be called with
+**          interrupts disabled, e.g., by the CLOCK driver.
+**
+** \param   optArgPtr   Unused.
+** \param   clockShift  The system clock is F_CPU / 2^clockShift now.
+**
+*******************************************************************************
+*/
+void UART_ClockChanged (void* optArgPtr, uint8_t clockShift)
+{
+    uint8_t ii;
+
+    (void) optArgPtr;
+    uartClockShift = clockShift;
+    for (ii = 0; ii < (sizeof(uartHandleArr) / sizeof(uartHandleArr[0])); ii++)
+    {
+        if (uartHandleArr[ii].initialized)
+        {
+            uartApplyClockShift(&uartHandleArr[ii]);
+        }
+    }
+    return;
+}
+#endif // UART_WITH_CLOCK_SCALING
+
 #if UART_ERROR_HANDLING
 
 /*!
@@ -1383,17 +2434,18 @@ void UART_SetFrameErrorHandler (UART_HandleT handle,
                                 void (*frameErrorHandlerPtr) (void))
 {
     uartHandleT* handlePtr = (uartHandleT*)handle;
+    IRQ_StateT   irq_state;
 
     if(handlePtr == NULL) return;
 
     ////////////////
-    uartEnterRxCS(handlePtr);
+    irq_state = uartEnterRxCS(handlePtr);
     ////////////////
 
     handlePtr->frameErrorHandlerPtr = frameErrorHandlerPtr;
 
     ////////////////
-    uartLeaveRxCS(handlePtr);
+    uartLeaveRxCS(handlePtr, irq_state);
     ////////////////
 
     return;
@@ -1415,17 +2467,18 @@ void UART_SetDataOverRunHandler (UART_HandleT handle,
                                  void (*dataOverRunHandlerPtr) (void))
 {
     uartHandleT* handlePtr = (uartHandleT*)handle;
+    IRQ_StateT   irq_state;
 
     if(handlePtr == NULL) return;
 
     ////////////////
-    uartEnterRxCS(handlePtr);
+    irq_state = uartEnterRxCS(handlePtr);
     ////////////////
 
     handlePtr->dataOverRunHandlerPtr = dataOverRunHandlerPtr;
 
     ////////////////
-    uartLeaveRxCS(handlePtr);
+    uartLeaveRxCS(handlePtr, irq_state);
     ////////////////
 
     return;
@@ -1447,17 +2500,18 @@ void UART_SetParityErrorHandler (UART_HandleT handle,
                                  void (*parityErrorHandlerPtr) (void))
 {
     uartHandleT* handlePtr = (uartHandleT*)handle;
+    IRQ_StateT   irq_state;
 
     if(handlePtr == NULL) return;
 
     ////////////////
-    uartEnterRxCS(handlePtr);
+    irq_state = uartEnterRxCS(handlePtr);
     ////////////////
 
     handlePtr->parityErrorHandlerPtr = parityErrorHandlerPtr;
 
     ////////////////
-    uartLeaveRxCS(handlePtr);
+    uartLeaveRxCS(handlePtr, irq_state);
     ////////////////
 
     return;
@@ -1479,17 +2533,18 @@ void UART_SetRxBufferOverflowHandler (UART_HandleT handle,
         void (*rxBufferOverflowHandlerPtr) (void))
 {
     uartHandleT* handlePtr = (uartHandleT*)handle;
+    IRQ_StateT   irq_state;
 
     if(handlePtr == NULL) return;
 
     ////////////////
-    uartEnterRxCS(handlePtr);
+    irq_state = uartEnterRxCS(handlePtr);
     ////////////////
 
     handlePtr->rxBufferOverflowHandlerPtr = rxBufferOverflowHandlerPtr;
 
     ////////////////
-    uartLeaveRxCS(handlePtr);
+    uartLeaveRxCS(handlePtr, irq_state);
     ////////////////
 
     return;
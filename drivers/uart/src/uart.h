@@ -54,11 +54,82 @@
 #define UART_ENABLE_RX_CALLBACK_NESTED_INTERRUPTS   0
 #endif
 
+/*! Switch to enable the bridge mode, which forwards received characters
+**  from one UART interface directly to the tx buffer of another one. */
+#ifndef UART_WITH_BRIDGE
+#define UART_WITH_BRIDGE        0
+#endif
+
+//! Switch to enable RTS/CTS and XON/XOFF flow control.
+#ifndef UART_WITH_FLOW_CONTROL
+#define UART_WITH_FLOW_CONTROL  0
+#endif
+
+/*! The receiver is throttled when the rx buffer holds this many bytes.
+**  The remaining space must absorb the bytes that the sender transmits
+**  until it reacts on RTS or XOFF. */
+#ifndef UART_FLOW_HIGH_WATER
+#define UART_FLOW_HIGH_WATER    (UART_BUFFER_LENGTH_RX * 3 / 4)
+#endif
+
+//! The receiver is released when the rx buffer holds this many bytes.
+#ifndef UART_FLOW_LOW_WATER
+#define UART_FLOW_LOW_WATER     (UART_BUFFER_LENGTH_RX / 4)
+#endif
+
+//! XON character for software flow control.
+#ifndef UART_FLOW_XON
+#define UART_FLOW_XON           0x11
+#endif
+
+//! XOFF character for software flow control.
+#ifndef UART_FLOW_XOFF
+#define UART_FLOW_XOFF          0x13
+#endif
+
+//! Switch to enable the automatic baud rate detection.
+#ifndef UART_WITH_AUTOBAUD
+#define UART_WITH_AUTOBAUD      0
+#endif
+
+/*! Free-running 16 bit counter used for the automatic baud rate detection,
+**  e.g., TCNT1 of timer 1 in normal mode started by the TIMER driver. */
+#ifndef UART_AUTOBAUD_COUNTER
+#define UART_AUTOBAUD_COUNTER   TCNT1
+#endif
+
+//! Switch to enable the RS-485 half-duplex mode.
+#ifndef UART_WITH_RS485
+#define UART_WITH_RS485         0
+#endif
+
+/*! Switch to enable UART_ClockChanged(), which re-times the baud rate when
+**  the system clock is scaled at runtime by the CLOCK driver. */
+#ifndef UART_WITH_CLOCK_SCALING
+#define UART_WITH_CLOCK_SCALING 0
+#endif
+
+//! Switch to acquire the USART clock from the POWER manager (PRR).
+#ifndef UART_WITH_POWER_MANAGER
+#define UART_WITH_POWER_MANAGER 0
+#endif
+
 //! CPU frequency
 #ifndef F_CPU
 #define F_CPU                   18432000
 #endif
 
+//! Critical section sites of the driver, see IRQ_PROFILING.
+#ifndef UART_IRQ_SITE_TX
+#define UART_IRQ_SITE_TX                (IRQ_SITE_BASE_DRIVER + 0)
+#endif
+#ifndef UART_IRQ_SITE_RX
+#define UART_IRQ_SITE_RX                (IRQ_SITE_BASE_DRIVER + 1)
+#endif
+#ifndef UART_IRQ_SITE_INIT
+#define UART_IRQ_SITE_INIT              (IRQ_SITE_BASE_DRIVER + 2)
+#endif
+
 //*****************************************************************************
 //************************* UART SPECIFIC ERROR CODES *************************
 //*****************************************************************************
@@ -80,6 +151,12 @@
 /*! The callback function has not been found. */
 #define UART_ERR_CALLBACK_NOT_FOUND UART_ERR_BASE + 2
 
+/*! No sync character has been received in time. */
+#define UART_ERR_AUTOBAUD_TIMEOUT   UART_ERR_BASE + 3
+
+/*! The received characters did not match the sync character. */
+#define UART_ERR_AUTOBAUD_MISMATCH  UART_ERR_BASE + 4
+
 
 //*****************************************************************************
 //******************************** DATA TYPES *********************************
@@ -177,6 +254,40 @@ typedef struct
     uint8_t writeRxToBuffer : 1;
 } UART_RxCallbackOptionsT;
 
+/*! Signature of a bridge tap callback, which observes each forwarded
+**  character. */
+typedef void (*UART_BridgeTapCallbackT) (void* optArgPtr, uint8_t rxByte);
+
+/*! Specifies flow control modes. */
+typedef enum
+{
+    UART_Flow_off = 0,
+    UART_Flow_RtsCts,   //<! RTS and CTS pins, both active low
+    UART_Flow_XonXoff   //<! XON and XOFF characters
+} UART_FlowT;
+
+/*! Specifies the flow control mode and the RTS and CTS pins, which are
+**  only required for #UART_Flow_RtsCts. */
+typedef struct
+{
+    UART_FlowT        mode;
+    volatile uint8_t* rtsPortPtr;
+    volatile uint8_t* rtsDdrPtr;
+    volatile uint8_t* ctsPinPtr;
+    volatile uint8_t* ctsDdrPtr;
+    uint8_t           rtsIdx : 3;
+    uint8_t           ctsIdx : 3;
+} UART_FlowParamsT;
+
+/*! Specifies the driver enable pin of an RS-485 transceiver. */
+typedef struct
+{
+    volatile uint8_t* dePortPtr;
+    volatile uint8_t* deDdrPtr;
+    uint8_t           deIdx : 3;
+    uint8_t           suppressEcho : 1; //<! discard rx while transmitting
+} UART_Rs485ParamsT;
+
 //*****************************************************************************
 //************************* FUNCTION DECLARATIONS *****************************
 //*****************************************************************************
@@ -212,6 +323,36 @@ uint8_t UART_RxField(UART_HandleT handle, uint8_t* fieldPtr, uint8_t byteCount);
 void    UART_RxDiscard(UART_HandleT handle);
 void    UART_TxFlush(UART_HandleT handle);
 
+#if UART_WITH_BRIDGE
+uint8_t UART_SetBridge(UART_HandleT srcHandle,
+                       UART_HandleT dstHandle,
+                       UART_BridgeTapCallbackT tapPtr,
+                       void* optArgPtr);
+uint8_t UART_GetBridgeDropCount(UART_HandleT srcHandle);
+#endif // UART_WITH_BRIDGE
+
+#if UART_WITH_FLOW_CONTROL
+uint8_t UART_SetFlowControl(UART_HandleT handle,
+                            UART_FlowParamsT* flowParamsPtr);
+void    UART_CtsChanged(UART_HandleT handle);
+#endif // UART_WITH_FLOW_CONTROL
+
+#if UART_WITH_RS485
+uint8_t UART_SetRs485(UART_HandleT handle,
+                      UART_Rs485ParamsT* rs485ParamsPtr);
+#endif // UART_WITH_RS485
+
+#if UART_WITH_AUTOBAUD
+uint8_t UART_AutoBaud(UART_HandleT handle,
+                      uint16_t counterPrescaler,
+                      uint16_t timeoutMs,
+                      uint32_t* baudRatePtr);
+#endif // UART_WITH_AUTOBAUD
+
+#if UART_WITH_CLOCK_SCALING
+void    UART_ClockChanged(void* optArgPtr, uint8_t clockShift);
+#endif // UART_WITH_CLOCK_SCALING
+
 #if UART_ERROR_HANDLING
 void UART_SetFrameErrorHandler      (UART_HandleT handle,
                                      void (*frameErrorHandlerPtr) (void));
@@ -0,0 +1,391 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   Cyclic CAN message scheduler.
+**
+**          The application provides a table of messages with their periods
+**          and offsets. Each message is packed once into the register
+**          layout of the MCP2515 and sent with MCP2515_TransmitRaw(), so
+**          the tick does not pack frames. A countdown of the TIMER driver
+**          executes the scheduler every millisecond in its compare match
+**          ISR, which loads each due message into a free transmit buffer
+**          of the MCP2515. Hence, the timing of cyclic messages does not
+**          depend on the load of the main loop or the runloop.
+**
+**          If no permitted transmit buffer is free or the SPI is locked
+**          by another bus user, see SPI_M_TryLock(), the message stays
+**          pending and is loaded on one of the next ticks. The delay is
+**          recorded in the statistics of the message, which allow to judge
+**          the jitter.
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <drivers/irq.h>
+#include <drivers/spi_m.h>
+#include <drivers/timer.h>
+#include <drivers/mcp2515.h>
+#include "cancyclic.h"
+
+//*****************************************************************************
+//*************************** DEFINES AND MACROS ******************************
+//*****************************************************************************
+
+#if !TIMER_WITH_COUNTDOWN
+#error "CANCYCLIC requires TIMER_WITH_COUNTDOWN"
+#endif
+
+//*****************************************************************************
+//**************************** LOCAL VARIABLES ********************************
+//*****************************************************************************
+
+//! Internal state of the scheduler.
+static struct
+{
+    TIMER_HandleT     timerHandle;
+    CANCYCLIC_EntryT* entryArr;
+    uint8_t           entryCount;
+    uint8_t           initialized : 1;
+} cancyclicState;
+
+//*****************************************************************************
+//********************** LOCAL FUNCTION DECLARATIONS **************************
+//*****************************************************************************
+
+static void cancyclicBuildFrame (CANCYCLIC_EntryT* entryPtr);
+static void cancyclicTick (void* optArgPtr);
+
+//*****************************************************************************
+//**************************** LOCAL FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   Pack the message of an entry into its frame.
+**
+*******************************************************************************
+*/
+static void cancyclicBuildFrame (CANCYCLIC_EntryT* entryPtr)
+{
+    MCP2515_CanMessageT* msg_ptr = &entryPtr->msg;
+    MCP2515_RawMessageT* frame_ptr = &entryPtr->frame;
+
+#if MCP2515_CAN_2_B_SUPPORT
+    if (msg_ptr->ief)
+    {
+        MCP2515_RawSetExtId(frame_ptr, msg_ptr->sid, msg_ptr->eid);
+    }
+    else
+    {
+        MCP2515_RawSetStdId(frame_ptr, msg_ptr->sid);
+    }
+#else
+    MCP2515_RawSetStdId(frame_ptr, msg_ptr->sid);
+#endif // MCP2515_CAN_2_B_SUPPORT
+    MCP2515_RawSetDlc(frame_ptr, msg_ptr->dlc, msg_ptr->rtr);
+    memcpy(frame_ptr->dataArray, msg_ptr->dataArray,
+           sizeof(frame_ptr->dataArray));
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Millisecond tick, executed by the timer's compare match ISR.
+**
+*******************************************************************************
+*/
+static void cancyclicTick (void* optArgPtr)
+{
+    CANCYCLIC_EntryT* entry_ptr;
+    uint8_t spi_free;
+    uint8_t ii;
+
+    (void) optArgPtr;
+
+    // The bus may be held by the interrupted context:
+    spi_free = SPI_M_TryLock();
+
+    for (ii = 0; ii < cancyclicState.entryCount; ii++)
+    {
+        entry_ptr = &cancyclicState.entryArr[ii];
+        if (entry_ptr->countdownMs)
+        {
+            entry_ptr->countdownMs--;
+        }
+        else
+        {
+            entry_ptr->countdownMs = entry_ptr->periodMs - 1;
+            if (entry_ptr->pending)
+            {
+                // still not loaded since the last period:
+                if (entry_ptr->stats.missCount < UINT16_MAX)
+                {
+                    entry_ptr->stats.missCount++;
+                }
+            }
+            entry_ptr->pending = 1;
+            entry_ptr->latenessMs = 0;
+        }
+
+        if (!entry_ptr->pending)
+        {
+            continue;
+        }
+        if (spi_free)
+        {
+            if (entry_ptr->updateCallbackPtr)
+            {
+                entry_ptr->updateCallbackPtr(entry_ptr->optArgPtr,
+                                             &entry_ptr->frame);
+            }
+            if (MCP2515_TransmitRaw(&entry_ptr->frame, entry_ptr->txParams))
+            {
+                entry_ptr->pending = 0;
+                entry_ptr->stats.sentCount++;
+                if (entry_ptr->latenessMs)
+                {
+                    entry_ptr->stats.lateCount++;
+                    if (entry_ptr->latenessMs > entry_ptr->stats.maxLatenessMs)
+                    {
+                        entry_ptr->stats.maxLatenessMs = entry_ptr->latenessMs;
+                    }
+                }
+                continue;
+            }
+        }
+        if (entry_ptr->latenessMs < UINT8_MAX)
+        {
+            entry_ptr->latenessMs++;
+        }
+    }
+    if (spi_free)
+    {
+        SPI_M_Unlock();
+    }
+    return;
+}
+
+//*****************************************************************************
+//*************************** PUBLIC FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   Start the transmission of cyclic messages.
+**
+**          The MCP2515 driver must be initialized before. The table must
+**          stay valid until CANCYCLIC_Stop() is called.
+**
+** \param   timerHandle A timer initialized in normal mode, which is used
+**                      exclusively by the scheduler.
+** \param   entryArr    The table of cyclic messages.
+** \param   entryCount  The number of entries in the table.
+**
+** \return
+**          - #CANCYCLIC_OK on success.
+**          - #CANCYCLIC_ERR_BAD_PARAMETER if a bad parameter has been passed
+**              or if an entry has a period of 0.
+**          - A TIMER specific error code if the countdown could not be
+**              started.
+**
+*******************************************************************************
+*/
+uint8_t CANCYCLIC_Init (TIMER_HandleT timerHandle,
+                        CANCYCLIC_EntryT* entryArr,
+                        uint8_t entryCount)
+{
+    uint8_t ii;
+    uint8_t result;
+
+    if ((timerHandle == NULL)
+    ||  (entryArr == NULL)
+    ||  (entryCount == 0))
+    {
+        return (CANCYCLIC_ERR_BAD_PARAMETER);
+    }
+    for (ii = 0; ii < entryCount; ii++)
+    {
+        if (entryArr[ii].periodMs == 0)
+        {
+            return (CANCYCLIC_ERR_BAD_PARAMETER);
+        }
+        cancyclicBuildFrame(&entryArr[ii]);
+        entryArr[ii].countdownMs = entryArr[ii].offsetMs;
+        entryArr[ii].latenessMs = 0;
+        entryArr[ii].pending = 0;
+        memset(&entryArr[ii].stats, 0, sizeof(CANCYCLIC_StatsT));
+    }
+
+    cancyclicState.timerHandle = timerHandle;
+    cancyclicState.entryArr = entryArr;
+    cancyclicState.entryCount = entryCount;
+    result = TIMER_StartCountdown(timerHandle, cancyclicTick, NULL, 1, 0);
+    if (result != TIMER_OK)
+    {
+        return (result);
+    }
+    cancyclicState.initialized = 1;
+    return (CANCYCLIC_OK);
+}
+
+/*!
+*******************************************************************************
+** \brief   Stop the transmission of cyclic messages. Messages that have
+**          already been loaded into transmit buffers are still sent.
+**
+*******************************************************************************
+*/
+void CANCYCLIC_Stop (void)
+{
+    if (!cancyclicState.initialized)
+    {
+        return;
+    }
+    (void)TIMER_Stop(cancyclicState.timerHandle, TIMER_Stop_Immediately);
+    cancyclicState.initialized = 0;
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Replace the data of a cyclic message consistently.
+**
+** \param   index   The index of the message in the table.
+** \param   dataPtr The new data.
+** \param   length  The number of bytes to copy (0 ... 8). The DLC of the
+**                  message is not modified.
+**
+** \return
+**          - #CANCYCLIC_OK on success.
+**          - #CANCYCLIC_ERR_NOT_INITIALIZED if the scheduler is not running.
+**          - #CANCYCLIC_ERR_BAD_PARAMETER if a bad parameter has been passed.
+**
+*******************************************************************************
+*/
+uint8_t CANCYCLIC_SetData (uint8_t index,
+                           const uint8_t* dataPtr,
+                           uint8_t length)
+{
+    if (!cancyclicState.initialized)
+    {
+        return (CANCYCLIC_ERR_NOT_INITIALIZED);
+    }
+    if ((index >= cancyclicState.entryCount)
+    ||  (dataPtr == NULL)
+    ||  (length > 8))
+    {
+        return (CANCYCLIC_ERR_BAD_PARAMETER);
+    }
+    IRQ_GLOBAL_BLOCK(CANCYCLIC_IRQ_SITE)
+    {
+        memcpy(cancyclicState.entryArr[index].frame.dataArray, dataPtr, length);
+    }
+    return (CANCYCLIC_OK);
+}
+
+/*!
+*******************************************************************************
+** \brief   Replace a cyclic message, including its identifier and DLC.
+**          The frame is rebuilt consistently. The schedule of the message
+**          is not modified.
+**
+** \param   index   The index of the message in the table.
+** \param   msgPtr  The new message.
+**
+** \return
+**          - #CANCYCLIC_OK on success.
+**          - #CANCYCLIC_ERR_NOT_INITIALIZED if the scheduler is not running.
+**          - #CANCYCLIC_ERR_BAD_PARAMETER if a bad parameter has been passed.
+**
+*******************************************************************************
+*/
+uint8_t CANCYCLIC_SetMessage (uint8_t index,
+                              const MCP2515_CanMessageT* msgPtr)
+{
+    if (!cancyclicState.initialized)
+    {
+        return (CANCYCLIC_ERR_NOT_INITIALIZED);
+    }
+    if ((index >= cancyclicState.entryCount) || (msgPtr == NULL))
+    {
+        return (CANCYCLIC_ERR_BAD_PARAMETER);
+    }
+    IRQ_GLOBAL_BLOCK(CANCYCLIC_IRQ_SITE)
+    {
+        cancyclicState.entryArr[index].msg = *msgPtr;
+        cancyclicBuildFrame(&cancyclicState.entryArr[index]);
+    }
+    return (CANCYCLIC_OK);
+}
+
+/*!
+*******************************************************************************
+** \brief   Get the statistics of a cyclic message.
+**
+** \param   index       The index of the message in the table.
+** \param   statsPtr    Receives the statistics.
+**
+** \return
+**          - #CANCYCLIC_OK on success.
+**          - #CANCYCLIC_ERR_NOT_INITIALIZED if the scheduler is not running.
+**          - #CANCYCLIC_ERR_BAD_PARAMETER if a bad parameter has been passed.
+**
+*******************************************************************************
+*/
+uint8_t CANCYCLIC_GetStats (uint8_t index, CANCYCLIC_StatsT* statsPtr)
+{
+    if (!cancyclicState.initialized)
+    {
+        return (CANCYCLIC_ERR_NOT_INITIALIZED);
+    }
+    if ((index >= cancyclicState.entryCount) || (statsPtr == NULL))
+    {
+        return (CANCYCLIC_ERR_BAD_PARAMETER);
+    }
+    IRQ_GLOBAL_BLOCK(CANCYCLIC_IRQ_SITE)
+    {
+        *statsPtr = cancyclicState.entryArr[index].stats;
+    }
+    return (CANCYCLIC_OK);
+}
+
+/*!
+*******************************************************************************
+** \brief   Clear the statistics of a cyclic message.
+**
+** \param   index       The index of the message in the table.
+**
+** \return
+**          - #CANCYCLIC_OK on success.
+**          - #CANCYCLIC_ERR_NOT_INITIALIZED if the scheduler is not running.
+**          - #CANCYCLIC_ERR_BAD_PARAMETER if a bad parameter has been passed.
+**
+*******************************************************************************
+*/
+uint8_t CANCYCLIC_ResetStats (uint8_t index)
+{
+    if (!cancyclicState.initialized)
+    {
+        return (CANCYCLIC_ERR_NOT_INITIALIZED);
+    }
+    if (index >= cancyclicState.entryCount)
+    {
+        return (CANCYCLIC_ERR_BAD_PARAMETER);
+    }
+    IRQ_GLOBAL_BLOCK(CANCYCLIC_IRQ_SITE)
+    {
+        memset(&cancyclicState.entryArr[index].stats, 0,
+               sizeof(CANCYCLIC_StatsT));
+    }
+    return (CANCYCLIC_OK);
+}
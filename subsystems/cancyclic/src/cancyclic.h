@@ -0,0 +1,108 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   The cancyclic subsystem transmits CAN messages periodically,
+**          driven by a hardware timer.
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#ifndef CANCYCLIC_H
+#define CANCYCLIC_H
+
+#include <stdint.h>
+#include <drivers/timer.h>
+#include <drivers/mcp2515.h>
+
+//*****************************************************************************
+//*************************** DEFINES AND MACROS ******************************
+//*****************************************************************************
+
+//! Critical section site of the subsystem, see IRQ_PROFILING.
+#ifndef CANCYCLIC_IRQ_SITE
+#define CANCYCLIC_IRQ_SITE              (IRQ_SITE_BASE_SUBSYSTEM + 4)
+#endif
+
+//*****************************************************************************
+//************************ CANCYCLIC SPECIFIC ERROR CODES *********************
+//*****************************************************************************
+
+/*! CANCYCLIC specific error base */
+#ifndef CANCYCLIC_ERR_BASE
+#define CANCYCLIC_ERR_BASE                  200
+#endif
+
+/*! CANCYCLIC returns with no errors. */
+#define CANCYCLIC_OK                        0
+
+/*! A bad parameter has been passed. */
+#define CANCYCLIC_ERR_BAD_PARAMETER         CANCYCLIC_ERR_BASE + 0
+
+/*! The scheduler is not initialized. */
+#define CANCYCLIC_ERR_NOT_INITIALIZED       CANCYCLIC_ERR_BASE + 1
+
+//*****************************************************************************
+//******************************** DATA TYPES *********************************
+//*****************************************************************************
+
+/*! Optional callback that updates the data of the prebuilt frame right
+**  before it is loaded into a transmit buffer. The frame is passed in the
+**  register layout of the MCP2515, see the MCP2515_Raw...() helpers. It
+**  runs in the timer ISR and should hence be short. */
+typedef void (*CANCYCLIC_UpdateCallbackT) (void* optArgPtr,
+                                           MCP2515_RawMessageT* msgPtr);
+
+//! Statistics of a cyclic message.
+typedef struct
+{
+    uint16_t sentCount;     //!< messages loaded into a transmit buffer
+    uint16_t lateCount;     //!< messages loaded after the tick they were due
+    uint16_t missCount;     //!< periods skipped as the message was still late
+    uint8_t  maxLatenessMs; //!< maximum delay between due and load
+} CANCYCLIC_StatsT;
+
+/*! Entry of the cyclic message table, which is owned by the application.
+**  The members below "managed by the scheduler" must not be accessed.
+**  The frame that is transmitted is built from msg by CANCYCLIC_Init(),
+**  so msg must be modified by CANCYCLIC_SetMessage() afterwards. */
+typedef struct
+{
+    MCP2515_CanMessageT       msg;      //!< prebuilt message
+    MCP2515_TxParamsT         txParams; //!< permitted buffers and priority
+    uint16_t                  periodMs; //!< transmission period, > 0
+    uint16_t                  offsetMs; //!< delay of the first transmission
+    CANCYCLIC_UpdateCallbackT updateCallbackPtr; //!< may be NULL
+    void*                     optArgPtr; //!< passed to updateCallbackPtr
+
+    // managed by the scheduler:
+    MCP2515_RawMessageT       frame;
+    uint16_t                  countdownMs;
+    uint8_t                   latenessMs;
+    uint8_t                   pending;
+    CANCYCLIC_StatsT          stats;
+} CANCYCLIC_EntryT;
+
+//*****************************************************************************
+//************************* FUNCTION DECLARATIONS *****************************
+//*****************************************************************************
+
+uint8_t CANCYCLIC_Init (TIMER_HandleT timerHandle,
+                        CANCYCLIC_EntryT* entryArr,
+                        uint8_t entryCount);
+void    CANCYCLIC_Stop (void);
+uint8_t CANCYCLIC_SetData (uint8_t index,
+                           const uint8_t* dataPtr,
+                           uint8_t length);
+uint8_t CANCYCLIC_SetMessage (uint8_t index,
+                              const MCP2515_CanMessageT* msgPtr);
+uint8_t CANCYCLIC_GetStats (uint8_t index, CANCYCLIC_StatsT* statsPtr);
+uint8_t CANCYCLIC_ResetStats (uint8_t index);
+
+#endif // CANCYCLIC_H
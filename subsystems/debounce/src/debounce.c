@@ -0,0 +1,282 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   The debounce subsystem debounces up to 32 digital inputs.
+**
+**          DEBOUNCE_Task() samples the PIN registers of the configured
+**          ports as a whole and debounces all inputs in parallel by means
+**          of vertical counters: bit n of the two counter words forms a
+**          2 bit counter for input n, which counts the consecutive samples
+**          that differ from the debounced state. An input toggles when its
+**          counter wraps after 4 samples and the counter is reset whenever
+**          the sample equals the debounced state. Hence, the cost of a tick
+**          is the same few word operations, regardless of the number of
+**          inputs.
+**
+**          DEBOUNCE_Task() should be registered with RUNLOOP_AddTask() with
+**          a period of #DEBOUNCE_TICK_MS. Press, release and long press
+**          events are passed to the event callback in the context of the
+**          runloop. Inputs that are active when DEBOUNCE_Init() is called
+**          do not generate a press event.
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <avr/io.h>
+#include <avr/cpufunc.h>
+#include <drivers/macros_pin.h>
+#include "debounce.h"
+
+//*****************************************************************************
+//*************************** DEFINES AND MACROS ******************************
+//*****************************************************************************
+
+#if (DEBOUNCE_PORT_COUNT < 1) || (DEBOUNCE_PORT_COUNT > 4)
+#error "DEBOUNCE_PORT_COUNT must be in range 1 ... 4"
+#endif
+
+//! Number of inputs.
+#define DEBOUNCE_INPUT_COUNT    (8 * DEBOUNCE_PORT_COUNT)
+
+//*****************************************************************************
+//**************************** LOCAL VARIABLES ********************************
+//*****************************************************************************
+
+//! Internal state of the debounce subsystem.
+static struct
+{
+    DEBOUNCE_EventCallbackT callbackPtr;
+    void*    callbackArgPtr;
+    uint32_t inputMask;
+    uint32_t activeLowMask;
+    uint32_t longPressMask;
+    uint32_t state;         //!< debounced state, 1 means active
+    uint32_t count0;        //!< bit 0 of the vertical counters
+    uint32_t count1;        //!< bit 1 of the vertical counters
+    uint32_t longPending;   //!< active inputs that wait for a long press
+    uint8_t  holdArr[DEBOUNCE_INPUT_COUNT]; //!< ticks since press
+} debounceState;
+
+//*****************************************************************************
+//********************** LOCAL FUNCTION DECLARATIONS **************************
+//*****************************************************************************
+
+static inline uint32_t debounceSample (void);
+static void debounceDispatch (uint32_t mask, DEBOUNCE_EventT event);
+
+//*****************************************************************************
+//**************************** LOCAL FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   Samples all inputs. A set bit denotes an active input.
+**
+*******************************************************************************
+*/
+static inline uint32_t debounceSample (void)
+{
+    uint32_t sample;
+
+    sample = PIN(DEBOUNCE_PORT_0);
+#if DEBOUNCE_PORT_COUNT > 1
+    sample |= (uint32_t)PIN(DEBOUNCE_PORT_1) << 8;
+#endif
+#if DEBOUNCE_PORT_COUNT > 2
+    sample |= (uint32_t)PIN(DEBOUNCE_PORT_2) << 16;
+#endif
+#if DEBOUNCE_PORT_COUNT > 3
+    sample |= (uint32_t)PIN(DEBOUNCE_PORT_3) << 24;
+#endif
+    return ((sample ^ debounceState.activeLowMask) & debounceState.inputMask);
+}
+
+/*!
+*******************************************************************************
+** \brief   Executes the event callback for each input given by mask.
+**
+*******************************************************************************
+*/
+static void debounceDispatch (uint32_t mask, DEBOUNCE_EventT event)
+{
+    uint8_t input = 0;
+
+    while (mask)
+    {
+        if (mask & 0x01)
+        {
+            debounceState.callbackPtr(input, event,
+                                      debounceState.callbackArgPtr);
+        }
+        mask >>= 1;
+        input++;
+    }
+    return;
+}
+
+//*****************************************************************************
+//*************************** PUBLIC FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   Initializes the debounce subsystem and configures the inputs.
+**
+**          The pins of the inputs are configured as inputs. The pull-up
+**          resistors of active low inputs are enabled.
+**
+** \param   inputMask       Bit n selects input n, i.e., pin n % 8 of
+**                          DEBOUNCE_PORT_(n / 8).
+** \param   activeLowMask   Inputs which are active when the pin is low.
+** \param   longPressMask   Inputs which report long press events.
+** \param   callbackPtr     The event callback.
+** \param   optArgPtr       Optional argument that is passed to the callback.
+**
+** \return
+**          - #DEBOUNCE_OK on success.
+**          - #DEBOUNCE_ERR_BAD_PARAMETER if callbackPtr is NULL or the masks
+**              select inputs beyond DEBOUNCE_PORT_COUNT ports.
+**
+*******************************************************************************
+*/
+uint8_t DEBOUNCE_Init (uint32_t inputMask,
+                       uint32_t activeLowMask,
+                       uint32_t longPressMask,
+                       DEBOUNCE_EventCallbackT callbackPtr,
+                       void* optArgPtr)
+{
+    if ((callbackPtr == NULL)
+#if DEBOUNCE_PORT_COUNT < 4
+    ||  (inputMask >> DEBOUNCE_INPUT_COUNT)
+#endif
+    )
+    {
+        return (DEBOUNCE_ERR_BAD_PARAMETER);
+    }
+
+    memset(&debounceState, 0, sizeof(debounceState));
+    debounceState.callbackPtr    = callbackPtr;
+    debounceState.callbackArgPtr = optArgPtr;
+    debounceState.inputMask      = inputMask;
+    debounceState.activeLowMask  = activeLowMask & inputMask;
+    debounceState.longPressMask  = longPressMask & inputMask;
+
+    DDR(DEBOUNCE_PORT_0)  &= ~(uint8_t)inputMask;
+    PORT(DEBOUNCE_PORT_0) |= (uint8_t)debounceState.activeLowMask;
+#if DEBOUNCE_PORT_COUNT > 1
+    DDR(DEBOUNCE_PORT_1)  &= ~(uint8_t)(inputMask >> 8);
+    PORT(DEBOUNCE_PORT_1) |= (uint8_t)(debounceState.activeLowMask >> 8);
+#endif
+#if DEBOUNCE_PORT_COUNT > 2
+    DDR(DEBOUNCE_PORT_2)  &= ~(uint8_t)(inputMask >> 16);
+    PORT(DEBOUNCE_PORT_2) |= (uint8_t)(debounceState.activeLowMask >> 16);
+#endif
+#if DEBOUNCE_PORT_COUNT > 3
+    DDR(DEBOUNCE_PORT_3)  &= ~(uint8_t)(inputMask >> 24);
+    PORT(DEBOUNCE_PORT_3) |= (uint8_t)(debounceState.activeLowMask >> 24);
+#endif
+
+    _NOP(); // synchronize the pull-ups before the first sample
+    debounceState.state = debounceSample();
+    return (DEBOUNCE_OK);
+}
+
+/*!
+*******************************************************************************
+** \brief   Samples and debounces the inputs and executes the event
+**          callback for each event.
+**
+**          The function matches RUNLOOP_TaskCallbackT and should be
+**          registered with RUNLOOP_AddTask() with a period of
+**          #DEBOUNCE_TICK_MS.
+**
+** \param   optArgPtr   Not used.
+**
+** \return
+**          - #DEBOUNCE_OK
+**
+*******************************************************************************
+*/
+uint8_t DEBOUNCE_Task (void* optArgPtr)
+{
+    uint32_t delta;
+    uint32_t toggle;
+    uint32_t pressed;
+    uint32_t released;
+    uint32_t long_pressed = 0;
+    uint32_t pending;
+    uint8_t  input;
+
+    if (debounceState.callbackPtr == NULL)
+    {
+        return (DEBOUNCE_OK);
+    }
+
+    // vertical counters, reset where the sample equals the state:
+    delta  = debounceSample() ^ debounceState.state;
+    debounceState.count1 = (debounceState.count1 ^ debounceState.count0)
+                         & delta;
+    debounceState.count0 = ~debounceState.count0 & delta;
+    toggle = delta & ~(debounceState.count0 | debounceState.count1);
+    debounceState.state ^= toggle;
+
+    pressed  = toggle & debounceState.state;
+    released = toggle & ~debounceState.state;
+
+    // count the hold time of pressed inputs that wait for a long press:
+    debounceState.longPending = (debounceState.longPending & ~released)
+                              | (pressed & debounceState.longPressMask);
+    pending = debounceState.longPending;
+    for (input = 0; pending; input++, pending >>= 1)
+    {
+        if (!(pending & 0x01))
+        {
+            continue;
+        }
+        if (pressed & ((uint32_t)1 << input))
+        {
+            debounceState.holdArr[input] = 0;
+        }
+        else if (++debounceState.holdArr[input] >= DEBOUNCE_LONG_PRESS_TICKS)
+        {
+            long_pressed |= ((uint32_t)1 << input);
+        }
+    }
+    debounceState.longPending &= ~long_pressed;
+
+    if (released)
+    {
+        debounceDispatch(released, DEBOUNCE_Event_Release);
+    }
+    if (pressed)
+    {
+        debounceDispatch(pressed, DEBOUNCE_Event_Press);
+    }
+    if (long_pressed)
+    {
+        debounceDispatch(long_pressed, DEBOUNCE_Event_LongPress);
+    }
+    return (DEBOUNCE_OK);
+}
+
+/*!
+*******************************************************************************
+** \brief   Get the debounced state of all inputs. A set bit denotes an
+**          active input.
+**
+*******************************************************************************
+*/
+uint32_t DEBOUNCE_GetState (void)
+{
+    return (debounceState.state);
+}
@@ -0,0 +1,109 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   The debounce subsystem debounces up to 32 digital inputs and
+**          reports press, release and long press events.
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#ifndef DEBOUNCE_H
+#define DEBOUNCE_H
+
+#include <stdint.h>
+
+//*****************************************************************************
+//*************************** DEFINES AND MACROS ******************************
+//*****************************************************************************
+
+//! Number of ports that are sampled (1 ... 4).
+#ifndef DEBOUNCE_PORT_COUNT
+#define DEBOUNCE_PORT_COUNT                 1
+#endif
+
+/*! Ports that are sampled. The pins of DEBOUNCE_PORT_n are the inputs
+**  8 * n ... 8 * n + 7. */
+#ifndef DEBOUNCE_PORT_0
+#define DEBOUNCE_PORT_0                     A
+#endif
+
+#ifndef DEBOUNCE_PORT_1
+#define DEBOUNCE_PORT_1                     B
+#endif
+
+#ifndef DEBOUNCE_PORT_2
+#define DEBOUNCE_PORT_2                     C
+#endif
+
+#ifndef DEBOUNCE_PORT_3
+#define DEBOUNCE_PORT_3                     D
+#endif
+
+/*! Period in ms at which DEBOUNCE_Task() should be executed. An input
+**  changes its state after 4 consecutive equal samples. */
+#ifndef DEBOUNCE_TICK_MS
+#define DEBOUNCE_TICK_MS                    10
+#endif
+
+//! Number of ticks an input has to be held for a long press (1 ... 255).
+#ifndef DEBOUNCE_LONG_PRESS_TICKS
+#define DEBOUNCE_LONG_PRESS_TICKS           100
+#endif
+
+//*****************************************************************************
+//************************ DEBOUNCE SPECIFIC ERROR CODES **********************
+//*****************************************************************************
+
+/*! DEBOUNCE specific error base */
+#ifndef DEBOUNCE_ERR_BASE
+#define DEBOUNCE_ERR_BASE                   140
+#endif
+
+/*! DEBOUNCE returns with no errors. */
+#define DEBOUNCE_OK                         0
+
+/*! A bad parameter has been passed. */
+#define DEBOUNCE_ERR_BAD_PARAMETER          DEBOUNCE_ERR_BASE + 0
+
+//*****************************************************************************
+//******************************** DATA TYPES *********************************
+//*****************************************************************************
+
+//! Events reported by the debounce subsystem.
+typedef enum
+{
+    DEBOUNCE_Event_Press,
+    DEBOUNCE_Event_Release,
+    DEBOUNCE_Event_LongPress
+} DEBOUNCE_EventT;
+
+/*! Event callback, executed from within DEBOUNCE_Task().
+**
+**  \param  input       Index of the input (0 ... 31).
+**  \param  event       The event.
+**  \param  optArgPtr   The argument that has been passed to DEBOUNCE_Init().
+*/
+typedef void (*DEBOUNCE_EventCallbackT) (uint8_t input,
+                                         DEBOUNCE_EventT event,
+                                         void* optArgPtr);
+
+//*****************************************************************************
+//************************* FUNCTION DECLARATIONS *****************************
+//*****************************************************************************
+
+uint8_t  DEBOUNCE_Init (uint32_t inputMask,
+                        uint32_t activeLowMask,
+                        uint32_t longPressMask,
+                        DEBOUNCE_EventCallbackT callbackPtr,
+                        void* optArgPtr);
+uint8_t  DEBOUNCE_Task (void* optArgPtr);
+uint32_t DEBOUNCE_GetState (void);
+
+#endif // DEBOUNCE_H
@@ -0,0 +1,588 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   The flashlog subsystem streams records to a NOR flash device.
+**
+**          Records (e.g., ADC samples, CAN frames or trace events) are
+**          appended to one of two page buffers in SRAM by FLASHLOG_Write(),
+**          which may also be called from within ISRs. When the active
+**          buffer is full, it is handed over to FLASHLOG_Task() and the
+**          other buffer takes new records. FLASHLOG_Task() should be
+**          registered with RUNLOOP_AddTask(). Each call issues at most one
+**          flash operation and returns immediately while the device is
+**          busy: it programs a full page as soon as the page ahead of the
+**          write pointer is erased, and otherwise erases the sectors ahead
+**          of the write pointer, so that erasing happens while the log is
+**          idle. The flash device is accessed through the functions of a
+**          FLASHLOG_DeviceT, e.g., the SPI NOR driver in flashlog_spinor.c.
+**
+**          The flash is used as a ring buffer. Each page starts with a
+**          header that holds an increasing sequence number and a CRC of
+**          the page, so that no separate head pointer needs to be stored.
+**          FLASHLOG_Init() finds the sector with the newest first page and
+**          continues behind the last programmed page of that sector. Pages
+**          that have been torn by a power loss fail the CRC check and are
+**          skipped.
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <util/crc16.h>
+#include <drivers/irq.h>
+#include "flashlog.h"
+
+//*****************************************************************************
+//*************************** DEFINES AND MACROS ******************************
+//*****************************************************************************
+
+//! Sequence number of an erased page.
+#define FLASHLOG_NO_SEQUENCE    0xFFFFFFFF
+
+//*****************************************************************************
+//**************************** LOCAL DATA TYPES *******************************
+//*****************************************************************************
+
+//! Layout of the page header in the flash.
+typedef struct
+{
+    uint32_t sequence;
+    uint16_t used;      //!< number of used payload bytes
+    uint16_t crc;       //!< CRC of sequence, used and the used payload
+} flashlogHeaderT;
+
+//*****************************************************************************
+//**************************** LOCAL VARIABLES ********************************
+//*****************************************************************************
+
+//! Internal state of the flash log.
+static struct
+{
+    const FLASHLOG_DeviceT* devPtr;
+    uint8_t  pageArr[2][FLASHLOG_PAGE_SIZE]; //!< header and payload
+    uint32_t size;              //!< size of the device in bytes
+    uint32_t headAddress;       //!< address of the next page to program
+    uint32_t erasedAddress;     //!< end of the erased area ahead of the head
+    uint32_t nextSequence;      //!< sequence of the next page
+    uint16_t fill;              //!< used payload bytes of the active buffer
+    uint16_t dropCount;         //!< number of dropped records
+    uint8_t  active;            //!< index of the buffer that takes records
+    uint8_t  pending;           //!< set while the other buffer is programmed
+    uint8_t  flushRequest;      //!< set by FLASHLOG_Flush()
+    uint8_t  initialized;
+} flashlogState;
+
+//*****************************************************************************
+//********************** LOCAL FUNCTION DECLARATIONS **************************
+//*****************************************************************************
+
+static uint16_t flashlogCrc (const flashlogHeaderT* headerPtr,
+                             const uint8_t* payloadPtr);
+static uint8_t  flashlogReadPage (uint32_t address,
+                                  flashlogHeaderT* headerPtr,
+                                  uint8_t* payloadPtr);
+static uint8_t  flashlogIsBlank (uint32_t address, uint8_t* scratchPtr);
+static void     flashlogHandOver (void);
+
+//*****************************************************************************
+//**************************** LOCAL FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   Computes the CRC of a page, excluding the CRC field.
+**
+*******************************************************************************
+*/
+static uint16_t flashlogCrc (const flashlogHeaderT* headerPtr,
+                             const uint8_t* payloadPtr)
+{
+    const uint8_t* byte_ptr = (const uint8_t*)headerPtr;
+    uint16_t crc = 0xFFFF;
+    uint16_t ii;
+
+    for (ii = 0; ii < offsetof(flashlogHeaderT, crc); ii++)
+    {
+        crc = _crc_ccitt_update(crc, byte_ptr[ii]);
+    }
+    for (ii = 0; ii < headerPtr->used; ii++)
+    {
+        crc = _crc_ccitt_update(crc, payloadPtr[ii]);
+    }
+    return (crc);
+}
+
+/*!
+*******************************************************************************
+** \brief   Reads and validates a page.
+**
+** \param   address     Address of the page.
+** \param   headerPtr   Receives the page header.
+** \param   payloadPtr  Receives the payload, must provide space for
+**                      FLASHLOG_PAGE_PAYLOAD_SIZE bytes.
+**
+** \return  1 if the page is valid, 0 otherwise.
+**
+*******************************************************************************
+*/
+static uint8_t flashlogReadPage (uint32_t address,
+                                 flashlogHeaderT* headerPtr,
+                                 uint8_t* payloadPtr)
+{
+    const FLASHLOG_DeviceT* dev_ptr = flashlogState.devPtr;
+
+    while (dev_ptr->isBusyPtr(dev_ptr->devArgPtr));
+    dev_ptr->readPtr(dev_ptr->devArgPtr, address,
+                     (uint8_t*)headerPtr, sizeof(flashlogHeaderT));
+    if ((headerPtr->sequence == FLASHLOG_NO_SEQUENCE)
+    ||  (headerPtr->used > FLASHLOG_PAGE_PAYLOAD_SIZE))
+    {
+        return (0);
+    }
+    dev_ptr->readPtr(dev_ptr->devArgPtr, address + FLASHLOG_PAGE_HEADER_SIZE,
+                     payloadPtr, headerPtr->used);
+    return (headerPtr->crc == flashlogCrc(headerPtr, payloadPtr));
+}
+
+/*!
+*******************************************************************************
+** \brief   Tests whether a page is completely erased.
+**
+** \param   address     Address of the page.
+** \param   scratchPtr  Buffer of FLASHLOG_PAGE_SIZE bytes.
+**
+** \return  1 if all bytes of the page are 0xFF, 0 otherwise.
+**
+*******************************************************************************
+*/
+static uint8_t flashlogIsBlank (uint32_t address, uint8_t* scratchPtr)
+{
+    const FLASHLOG_DeviceT* dev_ptr = flashlogState.devPtr;
+    uint16_t ii;
+
+    while (dev_ptr->isBusyPtr(dev_ptr->devArgPtr));
+    dev_ptr->readPtr(dev_ptr->devArgPtr, address,
+                     scratchPtr, FLASHLOG_PAGE_SIZE);
+    for (ii = 0; ii < FLASHLOG_PAGE_SIZE; ii++)
+    {
+        if (scratchPtr[ii] != 0xFF)
+        {
+            return (0);
+        }
+    }
+    return (1);
+}
+
+/*!
+*******************************************************************************
+** \brief   Hands the active buffer over to FLASHLOG_Task() and activates
+**          the other one. Must be called with interrupts disabled and only
+**          if no buffer is pending.
+**
+*******************************************************************************
+*/
+static void flashlogHandOver (void)
+{
+    ((flashlogHeaderT*)flashlogState.pageArr[flashlogState.active])->used =
+        flashlogState.fill;
+    flashlogState.pending = 1;
+    flashlogState.active ^= 1;
+    flashlogState.fill = 0;
+    return;
+}
+
+//*****************************************************************************
+//*************************** PUBLIC FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   Initializes the log and locates the write pointer.
+**
+**          This function reads the first page of each sector and the pages
+**          of the newest sector. It may take a while on large devices and
+**          should be called once at startup.
+**
+** \param   devicePtr   Access functions and geometry of the flash device.
+**                      The structure must remain valid while the log is
+**                      used.
+**
+** \return
+**          - #FLASHLOG_OK on success.
+**          - #FLASHLOG_ERR_BAD_PARAMETER if the device description is
+**              invalid.
+**
+*******************************************************************************
+*/
+uint8_t FLASHLOG_Init (const FLASHLOG_DeviceT* devicePtr)
+{
+    flashlogHeaderT header;
+    uint8_t*        scratch_ptr;
+    uint32_t        newest_sequence = 0;
+    uint32_t        sector_address;
+    uint32_t        address;
+    uint16_t        newest_sector = 0;
+    uint16_t        sector;
+    uint8_t         newest_valid = 0;
+
+    if ((devicePtr == NULL)
+    ||  (devicePtr->isBusyPtr == NULL)
+    ||  (devicePtr->programPtr == NULL)
+    ||  (devicePtr->erasePtr == NULL)
+    ||  (devicePtr->readPtr == NULL)
+    ||  (devicePtr->sectorSize < FLASHLOG_PAGE_SIZE)
+    ||  (devicePtr->sectorSize % FLASHLOG_PAGE_SIZE)
+    ||  (devicePtr->sectorCount < FLASHLOG_ERASE_AHEAD + 2))
+    {
+        return (FLASHLOG_ERR_BAD_PARAMETER);
+    }
+
+    flashlogState.initialized  = 0;
+    flashlogState.devPtr       = devicePtr;
+    flashlogState.size         = devicePtr->sectorSize * devicePtr->sectorCount;
+    flashlogState.fill         = 0;
+    flashlogState.dropCount    = 0;
+    flashlogState.active       = 0;
+    flashlogState.pending      = 0;
+    flashlogState.flushRequest = 0;
+
+    // the page buffers are not in use yet and serve as scratch buffers:
+    scratch_ptr = flashlogState.pageArr[0];
+
+    // the newest sector is the one with the newest valid first page:
+    for (sector = 0; sector < devicePtr->sectorCount; sector++)
+    {
+        if (!flashlogReadPage((uint32_t)sector * devicePtr->sectorSize,
+                              &header, scratch_ptr))
+        {
+            continue;
+        }
+        if (!newest_valid || (header.sequence > newest_sequence))
+        {
+            newest_valid = 1;
+            newest_sector = sector;
+            newest_sequence = header.sequence;
+        }
+    }
+
+    if (!newest_valid)
+    {
+        // nothing has been logged yet, start with erasing the first sector:
+        flashlogState.headAddress   = 0;
+        flashlogState.erasedAddress = 0;
+        flashlogState.nextSequence  = 0;
+    }
+    else
+    {
+        // continue behind the last page of the newest sector which is not
+        // blank, torn pages are skipped as well:
+        sector_address = (uint32_t)newest_sector * devicePtr->sectorSize;
+        address = sector_address + FLASHLOG_PAGE_SIZE;
+        while ((address < sector_address + devicePtr->sectorSize)
+        &&     !flashlogIsBlank(address, scratch_ptr))
+        {
+            address += FLASHLOG_PAGE_SIZE;
+        }
+        flashlogState.nextSequence = newest_sequence
+                                   + (address - sector_address)
+                                   / FLASHLOG_PAGE_SIZE;
+        flashlogState.headAddress   = address % flashlogState.size;
+        flashlogState.erasedAddress = (sector_address + devicePtr->sectorSize)
+                                    % flashlogState.size;
+    }
+
+    memset(flashlogState.pageArr, 0xFF, sizeof(flashlogState.pageArr));
+    flashlogState.initialized = 1;
+    return (FLASHLOG_OK);
+}
+
+/*!
+*******************************************************************************
+** \brief   Appends a record to the log.
+**
+**          The record is copied into the active page buffer. This function
+**          may be called from within ISRs.
+**
+** \param   recordPtr   The record.
+** \param   length      Length of the record in bytes, at most
+**                      #FLASHLOG_RECORD_MAX_LENGTH.
+**
+** \return
+**          - #FLASHLOG_OK on success.
+**          - #FLASHLOG_ERR_BAD_PARAMETER if recordPtr is NULL or length is
+**              out of range.
+**          - #FLASHLOG_ERR_NOT_INITIALIZED if the log is not initialized.
+**          - #FLASHLOG_ERR_BUFFER_FULL if both page buffers are in use.
+**              The record has been dropped.
+**
+*******************************************************************************
+*/
+uint8_t FLASHLOG_Write (const uint8_t* recordPtr, uint8_t length)
+{
+    uint8_t* dest_ptr;
+    uint8_t  result = FLASHLOG_OK;
+
+    if ((recordPtr == NULL)
+    ||  (length == 0)
+    ||  (length > FLASHLOG_RECORD_MAX_LENGTH))
+    {
+        return (FLASHLOG_ERR_BAD_PARAMETER);
+    }
+    if (!flashlogState.initialized)
+    {
+        return (FLASHLOG_ERR_NOT_INITIALIZED);
+    }
+
+    IRQ_GLOBAL_BLOCK(FLASHLOG_IRQ_SITE)
+    {
+        if (flashlogState.fill + 1 + length > FLASHLOG_PAGE_PAYLOAD_SIZE)
+        {
+            if (flashlogState.pending)
+            {
+                if (flashlogState.dropCount < 0xFFFF)
+                {
+                    flashlogState.dropCount++;
+                }
+                result = FLASHLOG_ERR_BUFFER_FULL;
+            }
+            else
+            {
+                flashlogHandOver();
+            }
+        }
+        if (result == FLASHLOG_OK)
+        {
+            dest_ptr = &flashlogState.pageArr[flashlogState.active]
+                           [FLASHLOG_PAGE_HEADER_SIZE + flashlogState.fill];
+            *dest_ptr++ = length;
+            memcpy(dest_ptr, recordPtr, length);
+            flashlogState.fill += 1 + length;
+        }
+    }
+    return (result);
+}
+
+/*!
+*******************************************************************************
+** \brief   Requests that the partially filled page buffer is programmed.
+**
+**          The page is handed over by the next call of FLASHLOG_Task().
+**          Subsequent records are written to the next page. Use
+**          FLASHLOG_IsIdle() in order to find out when all records have
+**          been programmed.
+**
+*******************************************************************************
+*/
+void FLASHLOG_Flush (void)
+{
+    flashlogState.flushRequest = 1;
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Programs full pages and erases sectors ahead of the write
+**          pointer.
+**
+**          Issues at most one flash operation per call and returns
+**          immediately if the device is busy. The function matches
+**          RUNLOOP_TaskCallbackT and can directly be registered with
+**          RUNLOOP_AddTask(). It must not be called from within ISRs.
+**
+** \param   optArgPtr   Not used.
+**
+** \return
+**          - #FLASHLOG_OK
+**
+*******************************************************************************
+*/
+uint8_t FLASHLOG_Task (void* optArgPtr)
+{
+    const FLASHLOG_DeviceT* dev_ptr = flashlogState.devPtr;
+    flashlogHeaderT*        header_ptr;
+    uint8_t*                page_ptr;
+    uint32_t                erased_size;
+
+    if (!flashlogState.initialized)
+    {
+        return (FLASHLOG_OK);
+    }
+
+    if (flashlogState.flushRequest)
+    {
+        IRQ_GLOBAL_BLOCK(FLASHLOG_IRQ_SITE)
+        {
+            if (!flashlogState.pending)
+            {
+                if (flashlogState.fill)
+                {
+                    flashlogHandOver();
+                }
+                flashlogState.flushRequest = 0;
+            }
+        }
+    }
+
+    if (dev_ptr->isBusyPtr(dev_ptr->devArgPtr))
+    {
+        return (FLASHLOG_OK);
+    }
+
+    erased_size = (flashlogState.erasedAddress + flashlogState.size
+                   - flashlogState.headAddress) % flashlogState.size;
+
+    // program the pending page if its location has been erased:
+    if (flashlogState.pending && (erased_size >= FLASHLOG_PAGE_SIZE))
+    {
+        page_ptr = flashlogState.pageArr[flashlogState.active ^ 1];
+        header_ptr = (flashlogHeaderT*)page_ptr;
+        header_ptr->sequence = flashlogState.nextSequence;
+        header_ptr->crc = flashlogCrc(header_ptr,
+                                      page_ptr + FLASHLOG_PAGE_HEADER_SIZE);
+        dev_ptr->programPtr(dev_ptr->devArgPtr,
+                            flashlogState.headAddress,
+                            page_ptr,
+                            FLASHLOG_PAGE_HEADER_SIZE + header_ptr->used);
+        memset(page_ptr, 0xFF, FLASHLOG_PAGE_SIZE);
+        flashlogState.headAddress = (flashlogState.headAddress
+                                     + FLASHLOG_PAGE_SIZE) % flashlogState.size;
+        flashlogState.nextSequence++;
+        flashlogState.pending = 0;
+        return (FLASHLOG_OK);
+    }
+
+    // keep FLASHLOG_ERASE_AHEAD sectors erased ahead of the write pointer:
+    if (erased_size < (uint32_t)FLASHLOG_ERASE_AHEAD * dev_ptr->sectorSize)
+    {
+        dev_ptr->erasePtr(dev_ptr->devArgPtr, flashlogState.erasedAddress);
+        flashlogState.erasedAddress = (flashlogState.erasedAddress
+                                       + dev_ptr->sectorSize)
+                                    % flashlogState.size;
+    }
+    return (FLASHLOG_OK);
+}
+
+/*!
+*******************************************************************************
+** \brief   Tests whether all records have been programmed.
+**
+** \return  1 if both page buffers are empty, no flush is pending, and the
+**          device is not busy. 0 otherwise.
+**
+*******************************************************************************
+*/
+uint8_t FLASHLOG_IsIdle (void)
+{
+    const FLASHLOG_DeviceT* dev_ptr = flashlogState.devPtr;
+    uint8_t                 idle = 0;
+
+    if (!flashlogState.initialized)
+    {
+        return (1);
+    }
+    IRQ_GLOBAL_BLOCK(FLASHLOG_IRQ_SITE)
+    {
+        idle = !flashlogState.pending
+            && !flashlogState.flushRequest
+            && !flashlogState.fill;
+    }
+    return (idle && !dev_ptr->isBusyPtr(dev_ptr->devArgPtr));
+}
+
+/*!
+*******************************************************************************
+** \brief   Get the address of the page that will be programmed next.
+**
+**          The newest page precedes this address and the oldest pages
+**          follow behind the erased area.
+**
+*******************************************************************************
+*/
+uint32_t FLASHLOG_GetHeadAddress (void)
+{
+    return (flashlogState.headAddress);
+}
+
+/*!
+*******************************************************************************
+** \brief   Get the number of records that have been dropped because both
+**          page buffers were in use. Saturates at 0xFFFF.
+**
+*******************************************************************************
+*/
+uint16_t FLASHLOG_GetDropCount (void)
+{
+    uint16_t count = 0;
+
+    IRQ_GLOBAL_BLOCK(FLASHLOG_IRQ_SITE)
+    {
+        count = flashlogState.dropCount;
+    }
+    return (count);
+}
+
+/*!
+*******************************************************************************
+** \brief   Reads a page of the log.
+**
+**          The payload is a sequence of records, each preceded by its
+**          length byte. This function waits until the device is not busy
+**          and must not be called from within ISRs.
+**
+** \param   address     Address of the page, a multiple of
+**                      #FLASHLOG_PAGE_SIZE.
+** \param   payloadPtr  Destination of the payload, must provide space for
+**                      #FLASHLOG_PAGE_PAYLOAD_SIZE bytes.
+** \param   usedPtr     Receives the number of used payload bytes.
+** \param   sequencePtr Receives the sequence number of the page. May be
+**                      NULL.
+**
+** \return
+**          - #FLASHLOG_OK on success.
+**          - #FLASHLOG_ERR_BAD_PARAMETER if a parameter is invalid.
+**          - #FLASHLOG_ERR_NOT_INITIALIZED if the log is not initialized.
+**          - #FLASHLOG_ERR_NOT_FOUND if the page is erased or corrupt.
+**
+*******************************************************************************
+*/
+uint8_t FLASHLOG_ReadPage (uint32_t address,
+                           uint8_t* payloadPtr,
+                           uint16_t* usedPtr,
+                           uint32_t* sequencePtr)
+{
+    flashlogHeaderT header;
+
+    if ((payloadPtr == NULL) || (usedPtr == NULL)
+    ||  (address % FLASHLOG_PAGE_SIZE))
+    {
+        return (FLASHLOG_ERR_BAD_PARAMETER);
+    }
+    if (!flashlogState.initialized)
+    {
+        return (FLASHLOG_ERR_NOT_INITIALIZED);
+    }
+    if (address >= flashlogState.size)
+    {
+        return (FLASHLOG_ERR_BAD_PARAMETER);
+    }
+    if (!flashlogReadPage(address, &header, payloadPtr))
+    {
+        return (FLASHLOG_ERR_NOT_FOUND);
+    }
+    *usedPtr = header.used;
+    if (sequencePtr)
+    {
+        *sequencePtr = header.sequence;
+    }
+    return (FLASHLOG_OK);
+}
@@ -0,0 +1,128 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   The flashlog subsystem streams records to a NOR flash device.
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#ifndef FLASHLOG_H
+#define FLASHLOG_H
+
+#include <stdint.h>
+
+//*****************************************************************************
+//*************************** DEFINES AND MACROS ******************************
+//*****************************************************************************
+
+//! Size of a program page of the flash device in bytes.
+#ifndef FLASHLOG_PAGE_SIZE
+#define FLASHLOG_PAGE_SIZE                  256
+#endif
+
+/*! Number of sectors that are kept erased ahead of the write pointer.
+**  Erasing a sector takes much longer than programming a page, so erasing
+**  ahead while the log is idle keeps the page buffers from overflowing. */
+#ifndef FLASHLOG_ERASE_AHEAD
+#define FLASHLOG_ERASE_AHEAD                1
+#endif
+
+/*! Size of the header at the start of each page: sequence number
+**  (4 bytes), number of used payload bytes (2 bytes) and CRC (2 bytes). */
+#define FLASHLOG_PAGE_HEADER_SIZE           8
+
+//! Number of payload bytes per page.
+#define FLASHLOG_PAGE_PAYLOAD_SIZE          (FLASHLOG_PAGE_SIZE - \
+                                             FLASHLOG_PAGE_HEADER_SIZE)
+
+/*! Maximum length of a record. Each record is stored with a length byte
+**  and never spans two pages. */
+#define FLASHLOG_RECORD_MAX_LENGTH          (FLASHLOG_PAGE_PAYLOAD_SIZE - 1)
+
+//! Critical section site of the subsystem, see IRQ_PROFILING.
+#ifndef FLASHLOG_IRQ_SITE
+#define FLASHLOG_IRQ_SITE               (IRQ_SITE_BASE_SUBSYSTEM + 1)
+#endif
+
+//*****************************************************************************
+//************************ FLASHLOG SPECIFIC ERROR CODES **********************
+//*****************************************************************************
+
+/*! FLASHLOG specific error base */
+#ifndef FLASHLOG_ERR_BASE
+#define FLASHLOG_ERR_BASE                   130
+#endif
+
+/*! FLASHLOG returns with no errors. */
+#define FLASHLOG_OK                         0
+
+/*! A bad parameter has been passed. */
+#define FLASHLOG_ERR_BAD_PARAMETER          FLASHLOG_ERR_BASE + 0
+
+/*! The log has not been initialized. */
+#define FLASHLOG_ERR_NOT_INITIALIZED        FLASHLOG_ERR_BASE + 1
+
+/*! Both page buffers are in use, the record has been dropped. */
+#define FLASHLOG_ERR_BUFFER_FULL            FLASHLOG_ERR_BASE + 2
+
+/*! The page does not hold valid log data. */
+#define FLASHLOG_ERR_NOT_FOUND              FLASHLOG_ERR_BASE + 3
+
+//*****************************************************************************
+//******************************** DATA TYPES *********************************
+//*****************************************************************************
+
+/*! Access functions and geometry of a NOR flash device. The functions are
+**  called from FLASHLOG_Init(), FLASHLOG_Task() and FLASHLOG_ReadPage()
+**  only. Programming and erasing must only start the operation; the log
+**  polls isBusyPtr before it issues the next one.
+*/
+typedef struct
+{
+    //! Returns non-zero while a program or erase operation is in progress.
+    uint8_t (*isBusyPtr) (void* devArgPtr);
+
+    //! Starts programming count bytes (at most one page) at address.
+    void (*programPtr) (void* devArgPtr,
+                        uint32_t address,
+                        const uint8_t* dataPtr,
+                        uint16_t count);
+
+    //! Starts erasing the sector which begins at address.
+    void (*erasePtr) (void* devArgPtr, uint32_t address);
+
+    //! Reads count bytes at address. The device must not be busy.
+    void (*readPtr) (void* devArgPtr,
+                     uint32_t address,
+                     uint8_t* dataPtr,
+                     uint16_t count);
+
+    void*    devArgPtr;     //!< passed to each function
+    uint32_t sectorSize;    //!< multiple of FLASHLOG_PAGE_SIZE
+    uint16_t sectorCount;   //!< at least FLASHLOG_ERASE_AHEAD + 2
+} FLASHLOG_DeviceT;
+
+//*****************************************************************************
+//************************* FUNCTION DECLARATIONS *****************************
+//*****************************************************************************
+
+uint8_t  FLASHLOG_Init (const FLASHLOG_DeviceT* devicePtr);
+uint8_t  FLASHLOG_Write (const uint8_t* recordPtr, uint8_t length);
+void     FLASHLOG_Flush (void);
+uint8_t  FLASHLOG_Task (void* optArgPtr);
+uint8_t  FLASHLOG_IsIdle (void);
+uint32_t FLASHLOG_GetHeadAddress (void);
+uint16_t FLASHLOG_GetDropCount (void);
+uint8_t  FLASHLOG_ReadPage (uint32_t address,
+                            uint8_t* payloadPtr,
+                            uint16_t* usedPtr,
+                            uint32_t* sequencePtr);
+
+#endif // FLASHLOG_H
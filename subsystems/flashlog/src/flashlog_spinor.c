@@ -0,0 +1,248 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   SPI NOR flash device for the flashlog subsystem.
+**
+**          Implements the functions of a FLASHLOG_DeviceT for serial NOR
+**          flash devices with the common command set (e.g., W25Qxx,
+**          SST25, AT25SF): page program (0x02), 4 KiB sector erase (0x20),
+**          read (0x03) and polling of the busy flag in the status register
+**          (0x05). Program and erase only transfer the command and the data,
+**          the device then executes the operation on its own while the
+**          flashlog subsystem polls the busy flag.
+**
+**          The SPI master must have been initialized by the application in
+**          SPI mode 0 or 3, e.g., together with the MCP2515 driver. Other
+**          devices on the bus may be accessed from within ISRs, so each
+**          SPI transfer holds the bus lock of the SPI driver, see
+**          SPI_M_Lock(). The device functions must be called from the main
+**          context.
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <avr/io.h>
+#include <drivers/macros_pin.h>
+#include <drivers/spi_m.h>
+#include "flashlog.h"
+#include "flashlog_spinor.h"
+
+//*****************************************************************************
+//*************************** DEFINES AND MACROS ******************************
+//*****************************************************************************
+
+// SPI NOR commands:
+#define FLASHLOG_SPINOR_CMD_WRITE_ENABLE    0x06
+#define FLASHLOG_SPINOR_CMD_PAGE_PROGRAM    0x02
+#define FLASHLOG_SPINOR_CMD_SECTOR_ERASE    0x20
+#define FLASHLOG_SPINOR_CMD_READ_STATUS     0x05
+#define FLASHLOG_SPINOR_CMD_READ            0x03
+
+//! Write in progress flag of the status register.
+#define FLASHLOG_SPINOR_STATUS_BUSY         0x01
+
+//*****************************************************************************
+//********************** LOCAL FUNCTION DECLARATIONS **************************
+//*****************************************************************************
+
+static inline void flashlogSpiNorSelect (uint8_t command, uint32_t address);
+static inline void flashlogSpiNorWriteEnable (void);
+static uint8_t flashlogSpiNorIsBusy (void* devArgPtr);
+static void    flashlogSpiNorProgram (void* devArgPtr,
+                                      uint32_t address,
+                                      const uint8_t* dataPtr,
+                                      uint16_t count);
+static void    flashlogSpiNorErase (void* devArgPtr, uint32_t address);
+static void    flashlogSpiNorRead (void* devArgPtr,
+                                   uint32_t address,
+                                   uint8_t* dataPtr,
+                                   uint16_t count);
+
+//*****************************************************************************
+//**************************** LOCAL FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   Selects the device and shifts out a command with a 24 bit
+**          address. The caller must deselect the device.
+**
+*******************************************************************************
+*/
+static inline void flashlogSpiNorSelect (uint8_t command, uint32_t address)
+{
+    SET_LOW(FLASHLOG_SPINOR_CS);
+    (void)SPI_M_Transceive(command);
+    (void)SPI_M_Transceive((uint8_t)(address >> 16));
+    (void)SPI_M_Transceive((uint8_t)(address >> 8));
+    (void)SPI_M_Transceive((uint8_t)address);
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Sends the write enable command, which must precede each program
+**          and erase command. Must be called within the critical section.
+**
+*******************************************************************************
+*/
+static inline void flashlogSpiNorWriteEnable (void)
+{
+    SET_LOW(FLASHLOG_SPINOR_CS);
+    (void)SPI_M_Transceive(FLASHLOG_SPINOR_CMD_WRITE_ENABLE);
+    SET_HIGH(FLASHLOG_SPINOR_CS);
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Reads the busy flag from the status register.
+**
+*******************************************************************************
+*/
+static uint8_t flashlogSpiNorIsBusy (void* devArgPtr)
+{
+    uint8_t status;
+
+    ////////////////
+    SPI_M_Lock();
+    ////////////////
+    SET_LOW(FLASHLOG_SPINOR_CS);
+    (void)SPI_M_Transceive(FLASHLOG_SPINOR_CMD_READ_STATUS);
+    status = SPI_M_Transceive(0xFF);
+    SET_HIGH(FLASHLOG_SPINOR_CS);
+    ////////////////
+    SPI_M_Unlock();
+    ////////////////
+
+    return ((status & FLASHLOG_SPINOR_STATUS_BUSY) ? 1 : 0);
+}
+
+/*!
+*******************************************************************************
+** \brief   Starts programming count bytes at address. The bytes must not
+**          cross a page boundary.
+**
+*******************************************************************************
+*/
+static void flashlogSpiNorProgram (void* devArgPtr,
+                                   uint32_t address,
+                                   const uint8_t* dataPtr,
+                                   uint16_t count)
+{
+    ////////////////
+    SPI_M_Lock();
+    ////////////////
+    flashlogSpiNorWriteEnable();
+    flashlogSpiNorSelect(FLASHLOG_SPINOR_CMD_PAGE_PROGRAM, address);
+    while (count--)
+    {
+        (void)SPI_M_Transceive(*dataPtr++);
+    }
+    SET_HIGH(FLASHLOG_SPINOR_CS); // starts programming
+    ////////////////
+    SPI_M_Unlock();
+    ////////////////
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Starts erasing the sector at address.
+**
+*******************************************************************************
+*/
+static void flashlogSpiNorErase (void* devArgPtr, uint32_t address)
+{
+    ////////////////
+    SPI_M_Lock();
+    ////////////////
+    flashlogSpiNorWriteEnable();
+    flashlogSpiNorSelect(FLASHLOG_SPINOR_CMD_SECTOR_ERASE, address);
+    SET_HIGH(FLASHLOG_SPINOR_CS); // starts erasing
+    ////////////////
+    SPI_M_Unlock();
+    ////////////////
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Reads count bytes at address.
+**
+*******************************************************************************
+*/
+static void flashlogSpiNorRead (void* devArgPtr,
+                                uint32_t address,
+                                uint8_t* dataPtr,
+                                uint16_t count)
+{
+    ////////////////
+    SPI_M_Lock();
+    ////////////////
+    flashlogSpiNorSelect(FLASHLOG_SPINOR_CMD_READ, address);
+    while (count--)
+    {
+        *dataPtr++ = SPI_M_Transceive(0xFF);
+    }
+    SET_HIGH(FLASHLOG_SPINOR_CS);
+    ////////////////
+    SPI_M_Unlock();
+    ////////////////
+    return;
+}
+
+//*****************************************************************************
+//*************************** PUBLIC FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   Sets up a device description for an SPI NOR flash and
+**          configures the chip select pin.
+**
+** \param   devicePtr   The device description to fill in. It is passed to
+**                      FLASHLOG_Init() afterwards.
+** \param   sectorCount Number of sectors of #FLASHLOG_SPINOR_SECTOR_SIZE
+**                      bytes that are used by the log, starting at address
+**                      0. The device must provide at least this size.
+**
+** \return
+**          - #FLASHLOG_OK on success.
+**          - #FLASHLOG_ERR_BAD_PARAMETER if devicePtr is NULL, sectorCount
+**              exceeds 24 bit addressing or the SPI master has not been
+**              initialized.
+**
+*******************************************************************************
+*/
+uint8_t FLASHLOG_SpiNorInit (FLASHLOG_DeviceT* devicePtr,
+                             uint16_t sectorCount)
+{
+    if ((devicePtr == NULL)
+    ||  ((uint32_t)sectorCount * FLASHLOG_SPINOR_SECTOR_SIZE > 0x1000000UL)
+    ||  !SPI_M_IsInitialized())
+    {
+        return (FLASHLOG_ERR_BAD_PARAMETER);
+    }
+
+    SET_HIGH(FLASHLOG_SPINOR_CS);
+    SET_OUTPUT(FLASHLOG_SPINOR_CS);
+
+    devicePtr->isBusyPtr   = flashlogSpiNorIsBusy;
+    devicePtr->programPtr  = flashlogSpiNorProgram;
+    devicePtr->erasePtr    = flashlogSpiNorErase;
+    devicePtr->readPtr     = flashlogSpiNorRead;
+    devicePtr->devArgPtr   = NULL;
+    devicePtr->sectorSize  = FLASHLOG_SPINOR_SECTOR_SIZE;
+    devicePtr->sectorCount = sectorCount;
+    return (FLASHLOG_OK);
+}
@@ -0,0 +1,43 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   SPI NOR flash device for the flashlog subsystem
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#ifndef FLASHLOG_SPINOR_H
+#define FLASHLOG_SPINOR_H
+
+#include <stdint.h>
+#include "flashlog.h"
+
+//*****************************************************************************
+//*************************** DEFINES AND MACROS ******************************
+//*****************************************************************************
+
+//! Chip Select (port,pin) of the flash device.
+#ifndef FLASHLOG_SPINOR_CS
+#define FLASHLOG_SPINOR_CS                  B,3
+#endif
+
+//! Size of an erase sector (command 0x20) in bytes.
+#ifndef FLASHLOG_SPINOR_SECTOR_SIZE
+#define FLASHLOG_SPINOR_SECTOR_SIZE         4096UL
+#endif
+
+//*****************************************************************************
+//************************* FUNCTION DECLARATIONS *****************************
+//*****************************************************************************
+
+uint8_t FLASHLOG_SpiNorInit (FLASHLOG_DeviceT* devicePtr,
+                             uint16_t sectorCount);
+
+#endif // FLASHLOG_SPINOR_H
@@ -0,0 +1,395 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   Test set for the FLASHLOG subsystem.
+**
+**          The log is run against a NOR flash model in SRAM, which behaves
+**          like a real device: programming can only clear bits, erasing
+**          sets a whole sector to 0xFF, and each operation keeps the
+**          device busy for a few polls. The results are printed via UART.
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <avr/interrupt.h>
+#include <drivers/uart.h>
+#include <subsystems/flashlog.h>
+
+
+//*****************************************************************************
+//*************************** DEFINES AND MACROS ******************************
+//*****************************************************************************
+
+//! Geometry of the flash model.
+#define APP_FLASH_SECTOR_SIZE   (2 * FLASHLOG_PAGE_SIZE)
+#define APP_FLASH_SECTOR_COUNT  4
+#define APP_FLASH_SIZE          (APP_FLASH_SECTOR_SIZE * APP_FLASH_SECTOR_COUNT)
+#define APP_FLASH_PAGE_COUNT    (APP_FLASH_SIZE / FLASHLOG_PAGE_SIZE)
+
+//! Number of polls for which the model is busy after program and erase.
+#define APP_FLASH_BUSY_POLLS    3
+
+//! Length of the test records.
+#define APP_RECORD_LENGTH       9
+
+//*****************************************************************************
+//********************** LOCAL FUNCTION DECLARATIONS **************************
+//*****************************************************************************
+
+static int8_t  appInit (void);
+static int     appStdioPut (char chr, FILE* streamPtr);
+static uint8_t appFlashIsBusy (void* devArgPtr);
+static void    appFlashProgram (void* devArgPtr,
+                                uint32_t address,
+                                const uint8_t* dataPtr,
+                                uint16_t count);
+static void    appFlashErase (void* devArgPtr, uint32_t address);
+static void    appFlashRead (void* devArgPtr,
+                             uint32_t address,
+                             uint8_t* dataPtr,
+                             uint16_t count);
+static void    appWriteRecords (uint16_t count);
+static void    appRunUntilIdle (void);
+static uint8_t appCheckLog (uint16_t expectedPageCount);
+static void    appReport (const char* namePtr, uint8_t passed);
+
+
+//*****************************************************************************
+//**************************** LOCAL VARIABLES ********************************
+//*****************************************************************************
+
+static UART_HandleT appUartHandle = NULL;
+static FILE appStdio = FDEV_SETUP_STREAM(appStdioPut, NULL, _FDEV_SETUP_WRITE);
+
+//! State of the flash model.
+static struct
+{
+    uint8_t memArr[APP_FLASH_SIZE];
+    uint8_t busyPolls;
+    uint8_t violation;  //!< set on access while busy or misaligned erase
+} appFlash;
+
+static const FLASHLOG_DeviceT appFlashDevice =
+{
+    appFlashIsBusy,
+    appFlashProgram,
+    appFlashErase,
+    appFlashRead,
+    NULL,
+    APP_FLASH_SECTOR_SIZE,
+    APP_FLASH_SECTOR_COUNT
+};
+
+//! Value of the first byte of the next test record.
+static uint8_t appRecordCounter = 0;
+
+static uint8_t appPayloadArr[FLASHLOG_PAGE_PAYLOAD_SIZE];
+
+
+//*****************************************************************************
+//**************************** LOCAL FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   Initialize the application.
+**
+** \return
+**          - 0 on success.
+**          - -1 on error.
+**
+*******************************************************************************
+*/
+static int8_t appInit (void)
+{
+    appUartHandle = UART_Init(UART_InterfaceId0,
+                              UART_Baud_230400,
+                              UART_Parity_off,
+                              UART_StopBit_1,
+                              UART_CharSize_8,
+                              UART_Transceive_Tx,
+                              NULL);
+    if(appUartHandle == NULL)
+    {
+        return(-1);
+    }
+    stdout = &appStdio;
+    sei();
+    return(0);
+}
+
+/*!
+*******************************************************************************
+** \brief   Write a character to the UART.
+**
+*******************************************************************************
+*/
+static int appStdioPut (char chr, FILE* streamPtr)
+{
+    UART_TxByte(appUartHandle, chr);
+    return(0);
+}
+
+/*!
+*******************************************************************************
+** \brief   Flash model: busy flag.
+**
+*******************************************************************************
+*/
+static uint8_t appFlashIsBusy (void* devArgPtr)
+{
+    if (appFlash.busyPolls)
+    {
+        appFlash.busyPolls--;
+        return (1);
+    }
+    return (0);
+}
+
+/*!
+*******************************************************************************
+** \brief   Flash model: page program, which can only clear bits.
+**
+*******************************************************************************
+*/
+static void appFlashProgram (void* devArgPtr,
+                             uint32_t address,
+                             const uint8_t* dataPtr,
+                             uint16_t count)
+{
+    if (appFlash.busyPolls
+    ||  (address % FLASHLOG_PAGE_SIZE) + count > FLASHLOG_PAGE_SIZE
+    ||  (address + count > APP_FLASH_SIZE))
+    {
+        appFlash.violation = 1;
+        return;
+    }
+    while (count--)
+    {
+        appFlash.memArr[address++] &= *dataPtr++;
+    }
+    appFlash.busyPolls = APP_FLASH_BUSY_POLLS;
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Flash model: sector erase.
+**
+*******************************************************************************
+*/
+static void appFlashErase (void* devArgPtr, uint32_t address)
+{
+    if (appFlash.busyPolls
+    ||  (address % APP_FLASH_SECTOR_SIZE)
+    ||  (address >= APP_FLASH_SIZE))
+    {
+        appFlash.violation = 1;
+        return;
+    }
+    memset(&appFlash.memArr[address], 0xFF, APP_FLASH_SECTOR_SIZE);
+    appFlash.busyPolls = 4 * APP_FLASH_BUSY_POLLS;
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Flash model: read.
+**
+*******************************************************************************
+*/
+static void appFlashRead (void* devArgPtr,
+                          uint32_t address,
+                          uint8_t* dataPtr,
+                          uint16_t count)
+{
+    if (appFlash.busyPolls || (address + count > APP_FLASH_SIZE))
+    {
+        appFlash.violation = 1;
+        return;
+    }
+    memcpy(dataPtr, &appFlash.memArr[address], count);
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Write count test records and run the log task after each one.
+**
+*******************************************************************************
+*/
+static void appWriteRecords (uint16_t count)
+{
+    uint8_t record_arr[APP_RECORD_LENGTH];
+    uint8_t ii;
+
+    while (count--)
+    {
+        for (ii = 0; ii < APP_RECORD_LENGTH; ii++)
+        {
+            record_arr[ii] = appRecordCounter + ii;
+        }
+        if (FLASHLOG_Write(record_arr, APP_RECORD_LENGTH) == FLASHLOG_OK)
+        {
+            appRecordCounter++;
+        }
+        (void)FLASHLOG_Task(NULL);
+    }
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Flush the log and run the log task until it is idle and has
+**          erased the sectors ahead of the write pointer.
+**
+*******************************************************************************
+*/
+static void appRunUntilIdle (void)
+{
+    uint8_t ii;
+
+    FLASHLOG_Flush();
+    while (!FLASHLOG_IsIdle())
+    {
+        (void)FLASHLOG_Task(NULL);
+    }
+    for (ii = 0; ii < 8 * APP_FLASH_BUSY_POLLS; ii++)
+    {
+        (void)FLASHLOG_Task(NULL);
+    }
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Walk through the log from the oldest to the newest page and
+**          check the sequence numbers and the contiguity of the records.
+**
+** \return  1 if the log holds expectedPageCount valid pages and ends with
+**          the last written record, 0 otherwise.
+**
+*******************************************************************************
+*/
+static uint8_t appCheckLog (uint16_t expectedPageCount)
+{
+    uint32_t address;
+    uint32_t sequence;
+    uint32_t last_sequence = 0;
+    uint16_t used;
+    uint16_t page_count = 0;
+    uint16_t pos;
+    uint8_t  expected_first = 0;
+    uint8_t  have_record = 0;
+    uint8_t  ii;
+
+    address = FLASHLOG_GetHeadAddress();
+    for (ii = 0; ii < APP_FLASH_PAGE_COUNT; ii++)
+    {
+        if (FLASHLOG_ReadPage(address, appPayloadArr, &used, &sequence)
+            == FLASHLOG_OK)
+        {
+            if (page_count && (sequence <= last_sequence))
+            {
+                return (0);
+            }
+            last_sequence = sequence;
+            page_count++;
+            for (pos = 0; pos < used; pos += 1 + appPayloadArr[pos])
+            {
+                if ((appPayloadArr[pos] != APP_RECORD_LENGTH)
+                ||  (have_record
+                     && (appPayloadArr[pos + 1] != expected_first)))
+                {
+                    return (0);
+                }
+                have_record = 1;
+                expected_first = appPayloadArr[pos + 1] + 1;
+            }
+        }
+        address = (address + FLASHLOG_PAGE_SIZE) % APP_FLASH_SIZE;
+    }
+    return ((page_count == expectedPageCount)
+        &&  (expected_first == appRecordCounter)
+        &&  !appFlash.violation);
+}
+
+/*!
+*******************************************************************************
+** \brief   Print the result of a test.
+**
+*******************************************************************************
+*/
+static void appReport (const char* namePtr, uint8_t passed)
+{
+    printf("%-24s %s\n", namePtr, passed ? "PASS" : "FAIL");
+    return;
+}
+
+
+//*****************************************************************************
+//*************************** PUBLIC FUNCTIONS ********************************
+//*****************************************************************************
+
+int main(int argc, char* argv[])
+{
+    uint32_t head;
+    uint16_t records_per_page;
+
+    if(appInit()) return(-1);
+    printf("\n\nFLASHLOG test\n");
+
+    records_per_page = FLASHLOG_PAGE_PAYLOAD_SIZE / (1 + APP_RECORD_LENGTH);
+    memset(appFlash.memArr, 0x5A, sizeof(appFlash.memArr)); // unerased flash
+
+    // start on a device without a log:
+    appReport("init",
+              (FLASHLOG_Init(&appFlashDevice) == FLASHLOG_OK)
+              && (FLASHLOG_GetHeadAddress() == 0));
+
+    // fill three pages:
+    appWriteRecords(3 * records_per_page);
+    appRunUntilIdle();
+    appReport("write", appCheckLog(3)
+              && (FLASHLOG_GetHeadAddress() == 3 * FLASHLOG_PAGE_SIZE));
+
+    // the write pointer is recovered after a reset:
+    head = FLASHLOG_GetHeadAddress();
+    appReport("recover", (FLASHLOG_Init(&appFlashDevice) == FLASHLOG_OK)
+                         && (FLASHLOG_GetHeadAddress() == head)
+                         && appCheckLog(3));
+
+    // a page which has been torn by a power loss is skipped:
+    appFlash.memArr[head + FLASHLOG_PAGE_HEADER_SIZE + 5] = 0x00;
+    appReport("torn page", (FLASHLOG_Init(&appFlashDevice) == FLASHLOG_OK)
+                           && (FLASHLOG_GetHeadAddress()
+                               == head + FLASHLOG_PAGE_SIZE)
+                           && appCheckLog(3));
+
+    // wrap around, one sector is always kept erased ahead:
+    appWriteRecords(3 * APP_FLASH_PAGE_COUNT * records_per_page);
+    appRunUntilIdle();
+    appReport("wrap around", appCheckLog(APP_FLASH_PAGE_COUNT
+                                         - APP_FLASH_SECTOR_SIZE
+                                           / FLASHLOG_PAGE_SIZE)
+                             && (FLASHLOG_GetDropCount() == 0));
+
+    // both buffers fill up if the task is not executed:
+    while (FLASHLOG_Write(appPayloadArr, APP_RECORD_LENGTH) == FLASHLOG_OK);
+    appReport("overflow", FLASHLOG_GetDropCount() == 1);
+
+    UART_TxFlush(appUartHandle);
+    while (1);
+    return(0);
+}
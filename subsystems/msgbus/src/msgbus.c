@@ -0,0 +1,339 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   Topic based publish/subscribe message bus.
+**
+**          Producers, e.g., ISRs of the CAN or ADC drivers, allocate a
+**          message from the bus' pool, fill in the payload and publish it
+**          under a topic. Publishing only appends a pointer to the
+**          delivery queue, so the producer's work does not depend on the
+**          number of subscribers. MSGBUS_Dispatch() delivers the queued
+**          messages by reference to all subscribers of their topic, as
+**          listed in the subscriber table in flash, and releases them
+**          afterwards. Subscribers may keep a message by reference
+**          counting instead of copying it.
+**
+**          Example:
+**
+**          const MSGBUS_SubscriberT appSubscriberArr[] PROGMEM =
+**          {
+**              { APP_TOPIC_CAN_RX, appLogger,  NULL },
+**              { APP_TOPIC_CAN_RX, appGateway, NULL },
+**          };
+**          MSGBUS_Init(appSubscriberArr, 2);
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <avr/pgmspace.h>
+#include <drivers/irq.h>
+#include <subsystems/pool.h>
+#include "msgbus.h"
+#if MSGBUS_WITH_RUNLOOP
+#include <subsystems/runloop.h>
+#endif
+
+//*****************************************************************************
+//**************************** LOCAL VARIABLES ********************************
+//*****************************************************************************
+
+//! Message storage.
+POOL_DEFINE(msgbusPool, sizeof(MSGBUS_MsgT), MSGBUS_MSG_COUNT);
+
+//! Internal state of the message bus.
+static struct
+{
+    const MSGBUS_SubscriberT* subscriberArr; //!< in flash
+    uint8_t                   subscriberCount;
+    MSGBUS_MsgT*              queueArr[MSGBUS_QUEUE_LENGTH];
+    uint8_t                   readPos;
+    uint8_t                   used;
+    uint8_t                   dropCount;
+    uint8_t                   dispatchPending : 1;
+} msgbusState;
+
+//*****************************************************************************
+//********************** LOCAL FUNCTION DECLARATIONS **************************
+//*****************************************************************************
+
+#if MSGBUS_WITH_RUNLOOP
+static uint8_t msgbusDispatchTask (void* optArgPtr);
+#endif
+
+//*****************************************************************************
+//**************************** LOCAL FUNCTIONS ********************************
+//*****************************************************************************
+
+#if MSGBUS_WITH_RUNLOOP
+/*!
+*******************************************************************************
+** \brief   RUNLOOP task that delivers the queued messages.
+**
+*******************************************************************************
+*/
+static uint8_t msgbusDispatchTask (void* optArgPtr)
+{
+    (void) optArgPtr;
+    MSGBUS_Dispatch();
+    return (RUNLOOP_OK);
+}
+#endif // MSGBUS_WITH_RUNLOOP
+
+//*****************************************************************************
+//*************************** PUBLIC FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   Set up the subscriber table.
+**
+** \param   subscriberArr   Subscriber table in flash (PROGMEM).
+** \param   subscriberCount Number of entries in the table.
+**
+** \return
+**          - #MSGBUS_OK on success.
+**          - #MSGBUS_ERR_BAD_PARAMETER if subscriberArr is NULL while
+**              subscriberCount is not 0.
+**
+*******************************************************************************
+*/
+uint8_t MSGBUS_Init (const MSGBUS_SubscriberT* subscriberArr,
+                     uint8_t subscriberCount)
+{
+    if ((subscriberArr == NULL) && (subscriberCount))
+    {
+        return (MSGBUS_ERR_BAD_PARAMETER);
+    }
+    IRQ_GLOBAL_BLOCK(MSGBUS_IRQ_SITE)
+    {
+        msgbusState.subscriberArr   = subscriberArr;
+        msgbusState.subscriberCount = subscriberCount;
+    }
+    return (MSGBUS_OK);
+}
+
+/*!
+*******************************************************************************
+** \brief   Allocate a message. May be called from within ISRs.
+**
+** \return
+**          - The message, which is owned by the caller until it is passed
+**              to MSGBUS_Publish() or MSGBUS_Release().
+**          - NULL if the pool is exhausted.
+**
+*******************************************************************************
+*/
+MSGBUS_MsgT* MSGBUS_Alloc (void)
+{
+    MSGBUS_MsgT* msg_ptr = (MSGBUS_MsgT*)POOL_Alloc(&msgbusPool);
+
+    if (msg_ptr)
+    {
+        msg_ptr->refCount = 1;
+        msg_ptr->length = 0;
+    }
+    return (msg_ptr);
+}
+
+/*!
+*******************************************************************************
+** \brief   Publish a message. May be called from within ISRs.
+**
+**          The caller's reference is passed to the bus in any case, i.e.,
+**          the message must not be accessed afterwards unless it has been
+**          retained before.
+**
+** \param   topic       Topic ID.
+** \param   msgPtr      Message allocated by MSGBUS_Alloc().
+**
+** \return
+**          - #MSGBUS_OK on success.
+**          - #MSGBUS_ERR_BAD_PARAMETER if a bad parameter has been passed.
+**          - #MSGBUS_ERR_QUEUE_FULL if the message has been dropped.
+**
+*******************************************************************************
+*/
+uint8_t MSGBUS_Publish (uint8_t topic, MSGBUS_MsgT* msgPtr)
+{
+    uint8_t result = MSGBUS_OK;
+    uint8_t schedule = 0;
+#if MSGBUS_WITH_RUNLOOP
+    uint8_t task_id;
+#endif
+
+    if (msgPtr == NULL)
+    {
+        return (MSGBUS_ERR_BAD_PARAMETER);
+    }
+    if (topic >= MSGBUS_TOPIC_COUNT)
+    {
+        MSGBUS_Release(msgPtr);
+        return (MSGBUS_ERR_BAD_PARAMETER);
+    }
+    msgPtr->topic = topic;
+
+    IRQ_GLOBAL_BLOCK(MSGBUS_IRQ_SITE)
+    {
+        if (msgbusState.used >= MSGBUS_QUEUE_LENGTH)
+        {
+            if (msgbusState.dropCount < UINT8_MAX)
+            {
+                msgbusState.dropCount++;
+            }
+            result = MSGBUS_ERR_QUEUE_FULL;
+        }
+        else
+        {
+            msgbusState.queueArr[(msgbusState.readPos + msgbusState.used)
+                                 % MSGBUS_QUEUE_LENGTH] = msgPtr;
+            msgbusState.used++;
+            if (!msgbusState.dispatchPending)
+            {
+                msgbusState.dispatchPending = 1;
+                schedule = 1;
+            }
+        }
+    }
+
+    if (result != MSGBUS_OK)
+    {
+        MSGBUS_Release(msgPtr);
+    }
+#if MSGBUS_WITH_RUNLOOP
+    else if (schedule)
+    {
+        if (RUNLOOP_OK != RUNLOOP_AddTask(msgbusDispatchTask, NULL,
+                                          1, 0, 0, &task_id))
+        {
+            // retry with the next publication:
+            IRQ_GLOBAL_BLOCK(MSGBUS_IRQ_SITE)
+            {
+                msgbusState.dispatchPending = 0;
+            }
+        }
+    }
+#else
+    (void) schedule;
+#endif // MSGBUS_WITH_RUNLOOP
+    return (result);
+}
+
+/*!
+*******************************************************************************
+** \brief   Acquire an additional reference to a message.
+**
+** \param   msgPtr      The message.
+**
+*******************************************************************************
+*/
+void MSGBUS_Retain (MSGBUS_MsgT* msgPtr)
+{
+    if (msgPtr == NULL)
+    {
+        return;
+    }
+    IRQ_GLOBAL_BLOCK(MSGBUS_IRQ_SITE)
+    {
+        msgPtr->refCount++;
+    }
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Release a reference to a message. The message is returned to
+**          the pool with its last reference.
+**
+** \param   msgPtr      The message.
+**
+*******************************************************************************
+*/
+void MSGBUS_Release (MSGBUS_MsgT* msgPtr)
+{
+    uint8_t ref_count = 1;
+
+    if (msgPtr == NULL)
+    {
+        return;
+    }
+    IRQ_GLOBAL_BLOCK(MSGBUS_IRQ_SITE)
+    {
+        ref_count = --msgPtr->refCount;
+    }
+    if (ref_count == 0)
+    {
+        (void) POOL_Free(&msgbusPool, msgPtr);
+    }
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Deliver all queued messages to their subscribers.
+**
+**          Called by a RUNLOOP task if MSGBUS_WITH_RUNLOOP is set,
+**          otherwise by the application. Must not be called from ISRs.
+**
+*******************************************************************************
+*/
+void MSGBUS_Dispatch (void)
+{
+    MSGBUS_SubscriberT subscriber;
+    MSGBUS_MsgT*       msg_ptr;
+    uint8_t            ii;
+
+    do
+    {
+        msg_ptr = NULL;
+        IRQ_GLOBAL_BLOCK(MSGBUS_IRQ_SITE)
+        {
+            if (msgbusState.used)
+            {
+                msg_ptr = msgbusState.queueArr[msgbusState.readPos];
+                msgbusState.readPos = (msgbusState.readPos + 1)
+                                      % MSGBUS_QUEUE_LENGTH;
+                msgbusState.used--;
+            }
+            else
+            {
+                msgbusState.dispatchPending = 0;
+            }
+        }
+        if (msg_ptr)
+        {
+            for (ii = 0; ii < msgbusState.subscriberCount; ii++)
+            {
+                memcpy_P(&subscriber, &msgbusState.subscriberArr[ii],
+                         sizeof(subscriber));
+                if ((subscriber.topic == msg_ptr->topic)
+                &&  (subscriber.callbackPtr))
+                {
+                    subscriber.callbackPtr(subscriber.optArgPtr, msg_ptr);
+                }
+            }
+            MSGBUS_Release(msg_ptr);
+        }
+    } while (msg_ptr);
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Get the number of messages that have been dropped because the
+**          delivery queue was full (saturates at 255).
+**
+*******************************************************************************
+*/
+uint8_t MSGBUS_GetDropCount (void)
+{
+    return (msgbusState.dropCount);
+}
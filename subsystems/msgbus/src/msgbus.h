@@ -0,0 +1,121 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   Topic based publish/subscribe message bus
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#ifndef MSGBUS_H
+#define MSGBUS_H
+
+#include <stdint.h>
+
+//*****************************************************************************
+//*************************** DEFINES AND MACROS ******************************
+//*****************************************************************************
+
+//! Number of topics, topic IDs must be in range [0 ... MSGBUS_TOPIC_COUNT-1].
+#ifndef MSGBUS_TOPIC_COUNT
+#define MSGBUS_TOPIC_COUNT          16
+#endif
+
+//! Payload size of a message in bytes, e.g., a CAN message.
+#ifndef MSGBUS_PAYLOAD_SIZE
+#define MSGBUS_PAYLOAD_SIZE         16
+#endif
+
+//! Number of messages in the message pool, must be in range [1 ... 255].
+#ifndef MSGBUS_MSG_COUNT
+#define MSGBUS_MSG_COUNT            8
+#endif
+
+//! Number of published messages awaiting delivery, must be in [1 ... 255].
+#ifndef MSGBUS_QUEUE_LENGTH
+#define MSGBUS_QUEUE_LENGTH         8
+#endif
+
+/*! Set to 1 in order to deliver messages from a RUNLOOP task that is
+**  scheduled on publication. Requires RUNLOOP_INTERRUPT_SAFETY if messages
+**  are published from within ISRs. If set to 0, the application must call
+**  MSGBUS_Dispatch() from its main loop. */
+#ifndef MSGBUS_WITH_RUNLOOP
+#define MSGBUS_WITH_RUNLOOP         1
+#endif
+
+//! Critical section site of the subsystem, see IRQ_PROFILING.
+#ifndef MSGBUS_IRQ_SITE
+#define MSGBUS_IRQ_SITE                 (IRQ_SITE_BASE_SUBSYSTEM + 3)
+#endif
+
+//*****************************************************************************
+//************************ MSGBUS SPECIFIC ERROR CODES ************************
+//*****************************************************************************
+
+/*! MSGBUS specific error base */
+#ifndef MSGBUS_ERR_BASE
+#define MSGBUS_ERR_BASE             160
+#endif
+
+/*! MSGBUS returns with no errors. */
+#define MSGBUS_OK                   0
+
+/*! A bad parameter has been passed. */
+#define MSGBUS_ERR_BAD_PARAMETER    MSGBUS_ERR_BASE + 0
+
+/*! The delivery queue is full, the message has been dropped. */
+#define MSGBUS_ERR_QUEUE_FULL       MSGBUS_ERR_BASE + 1
+
+//*****************************************************************************
+//******************************** DATA TYPES *********************************
+//*****************************************************************************
+
+//! Message, allocated by MSGBUS_Alloc().
+typedef struct
+{
+    uint8_t topic;      //!< set by MSGBUS_Publish()
+    uint8_t refCount;   //!< managed by the bus, do not modify
+    uint8_t length;     //!< number of valid payload bytes, set by the producer
+    uint8_t payloadArr[MSGBUS_PAYLOAD_SIZE];
+} MSGBUS_MsgT;
+
+/*! Subscriber callback, executed in the context of MSGBUS_Dispatch().
+**  The message is valid until the callback returns. In order to keep it
+**  longer, call MSGBUS_Retain() and MSGBUS_Release() later on.
+**  The payload must not be modified, as it is shared by all subscribers.
+**
+**  \param  optArgPtr   The argument of the subscriber table entry.
+**  \param  msgPtr      The message.
+*/
+typedef void (*MSGBUS_CallbackT) (void* optArgPtr, MSGBUS_MsgT* msgPtr);
+
+/*! Entry of the subscriber table, which resides in flash (PROGMEM).
+**  Several entries may refer to the same topic. */
+typedef struct
+{
+    uint8_t          topic;
+    MSGBUS_CallbackT callbackPtr;
+    void*            optArgPtr;
+} MSGBUS_SubscriberT;
+
+//*****************************************************************************
+//************************* FUNCTION DECLARATIONS *****************************
+//*****************************************************************************
+
+uint8_t      MSGBUS_Init (const MSGBUS_SubscriberT* subscriberArr,
+                          uint8_t subscriberCount);
+MSGBUS_MsgT* MSGBUS_Alloc (void);
+uint8_t      MSGBUS_Publish (uint8_t topic, MSGBUS_MsgT* msgPtr);
+void         MSGBUS_Retain (MSGBUS_MsgT* msgPtr);
+void         MSGBUS_Release (MSGBUS_MsgT* msgPtr);
+void         MSGBUS_Dispatch (void);
+uint8_t      MSGBUS_GetDropCount (void);
+
+#endif // MSGBUS_H
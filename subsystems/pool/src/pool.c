@@ -0,0 +1,230 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   Fixed-block memory pool allocator.
+**
+**          A pool hands out blocks of equal size in O(1). Released blocks
+**          are kept in a singly linked free list, which is stored within
+**          the blocks themselves. Blocks that have never been allocated are
+**          taken from the end of the storage, so pools defined by
+**          POOL_DEFINE() need no initialization at runtime.
+**
+**          Pools allow passing the ownership of buffers, e.g., CAN
+**          messages or framed packets, from ISRs to the main context
+**          instead of copying them: the producer allocates and fills a
+**          block, passes the pointer and the consumer releases it.
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <drivers/irq.h>
+#include "pool.h"
+
+//*****************************************************************************
+//*************************** PUBLIC FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   Set up a pool at runtime. Pools that are known at compile time
+**          should be defined by POOL_DEFINE() instead.
+**
+** \param   poolPtr     The pool to set up.
+** \param   memPtr      Storage of blockSize * blockCount bytes.
+** \param   blockSize   Block size in bytes, at least sizeof(void*).
+** \param   blockCount  Number of blocks.
+**
+** \return
+**          - #POOL_OK on success.
+**          - #POOL_ERR_BAD_PARAMETER if a bad parameter has been passed.
+**
+*******************************************************************************
+*/
+uint8_t POOL_Init (POOL_PoolT* poolPtr,
+                   uint8_t* memPtr,
+                   uint8_t blockSize,
+                   uint8_t blockCount)
+{
+    if ((poolPtr == NULL)
+    ||  (memPtr == NULL)
+    ||  (blockSize < sizeof(void*))
+    ||  (blockCount == 0))
+    {
+        return (POOL_ERR_BAD_PARAMETER);
+    }
+    poolPtr->memPtr      = memPtr;
+    poolPtr->freeListPtr = NULL;
+    poolPtr->blockSize   = blockSize;
+    poolPtr->blockCount  = blockCount;
+    poolPtr->freshIdx    = 0;
+    poolPtr->usedCount   = 0;
+    poolPtr->highWater   = 0;
+    poolPtr->failCount   = 0;
+    return (POOL_OK);
+}
+
+/*!
+*******************************************************************************
+** \brief   Allocate a block.
+**
+** \param   poolPtr     The pool.
+**
+** \return
+**          - Pointer to the block on success.
+**          - NULL if the pool is exhausted or poolPtr is NULL.
+**
+*******************************************************************************
+*/
+void* POOL_Alloc (POOL_PoolT* poolPtr)
+{
+    void* block_ptr = NULL;
+
+    if (poolPtr == NULL)
+    {
+        return (NULL);
+    }
+
+#if POOL_INTERRUPT_SAFETY
+    IRQ_GLOBAL_BLOCK(POOL_IRQ_SITE)
+#endif
+    {
+        if (poolPtr->freeListPtr)
+        {
+            block_ptr = poolPtr->freeListPtr;
+            poolPtr->freeListPtr = *(void**)block_ptr;
+        }
+        else if (poolPtr->freshIdx < poolPtr->blockCount)
+        {
+            block_ptr = poolPtr->memPtr
+                        + (uint16_t)poolPtr->freshIdx * poolPtr->blockSize;
+            poolPtr->freshIdx++;
+        }
+
+        if (block_ptr)
+        {
+            poolPtr->usedCount++;
+            if (poolPtr->usedCount > poolPtr->highWater)
+            {
+                poolPtr->highWater = poolPtr->usedCount;
+            }
+        }
+        else if (poolPtr->failCount < UINT8_MAX)
+        {
+            poolPtr->failCount++;
+        }
+    }
+    return (block_ptr);
+}
+
+/*!
+*******************************************************************************
+** \brief   Release a block.
+**
+** \param   poolPtr     The pool the block has been allocated from.
+** \param   blockPtr    The block.
+**
+** \return
+**          - #POOL_OK on success.
+**          - #POOL_ERR_BAD_PARAMETER if blockPtr is no allocated block of
+**              the pool. Releasing a block twice is not detected.
+**
+*******************************************************************************
+*/
+uint8_t POOL_Free (POOL_PoolT* poolPtr, void* blockPtr)
+{
+    uint16_t offset;
+    uint8_t  result = POOL_OK;
+
+    if ((poolPtr == NULL)
+    ||  ((uint8_t*)blockPtr < poolPtr->memPtr))
+    {
+        return (POOL_ERR_BAD_PARAMETER);
+    }
+    offset = (uint8_t*)blockPtr - poolPtr->memPtr;
+    if ((offset % poolPtr->blockSize)
+    ||  (offset / poolPtr->blockSize >= poolPtr->blockCount))
+    {
+        return (POOL_ERR_BAD_PARAMETER);
+    }
+
+#if POOL_INTERRUPT_SAFETY
+    IRQ_GLOBAL_BLOCK(POOL_IRQ_SITE)
+#endif
+    {
+        if ((poolPtr->usedCount == 0)
+        ||  (offset / poolPtr->blockSize >= poolPtr->freshIdx))
+        {
+            result = POOL_ERR_BAD_PARAMETER;
+        }
+        else
+        {
+            *(void**)blockPtr = poolPtr->freeListPtr;
+            poolPtr->freeListPtr = blockPtr;
+            poolPtr->usedCount--;
+        }
+    }
+    return (result);
+}
+
+/*!
+*******************************************************************************
+** \brief   Get the statistics of a pool.
+**
+** \param   poolPtr     The pool.
+** \param   statsPtr    Receives the statistics.
+**
+*******************************************************************************
+*/
+void POOL_GetStats (POOL_PoolT* poolPtr, POOL_StatsT* statsPtr)
+{
+    if ((poolPtr == NULL) || (statsPtr == NULL))
+    {
+        return;
+    }
+
+#if POOL_INTERRUPT_SAFETY
+    IRQ_GLOBAL_BLOCK(POOL_IRQ_SITE)
+#endif
+    {
+        statsPtr->blockCount = poolPtr->blockCount;
+        statsPtr->usedCount  = poolPtr->usedCount;
+        statsPtr->highWater  = poolPtr->highWater;
+        statsPtr->failCount  = poolPtr->failCount;
+    }
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Reset the high-water mark to the current usage and clear the
+**          count of failed allocations.
+**
+** \param   poolPtr     The pool.
+**
+*******************************************************************************
+*/
+void POOL_ResetStats (POOL_PoolT* poolPtr)
+{
+    if (poolPtr == NULL)
+    {
+        return;
+    }
+
+#if POOL_INTERRUPT_SAFETY
+    IRQ_GLOBAL_BLOCK(POOL_IRQ_SITE)
+#endif
+    {
+        poolPtr->highWater = poolPtr->usedCount;
+        poolPtr->failCount = 0;
+    }
+    return;
+}
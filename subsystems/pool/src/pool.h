@@ -0,0 +1,105 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   Fixed-block memory pool allocator
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#ifndef POOL_H
+#define POOL_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+//*****************************************************************************
+//*************************** DEFINES AND MACROS ******************************
+//*****************************************************************************
+
+/*! Set to 1 if pools are shared between ISRs and the main context, which
+**  is the intended use. */
+#ifndef POOL_INTERRUPT_SAFETY
+#define POOL_INTERRUPT_SAFETY       1
+#endif
+
+//! Blocks are linked through their first bytes, hence they hold a pointer.
+#define POOL_BLOCK_SIZE(size)       (((size) < sizeof(void*)) ? \
+                                     sizeof(void*) : (size))
+
+/*! Defines a pool of blockCount blocks with blockSize bytes each at compile
+**  time. The pool can be used right away without initialization and be
+**  shared with other modules by "extern POOL_PoolT name;".
+**  blockCount must be in range [1 ... 255] and blockSize in [1 ... 255]. */
+#define POOL_DEFINE(name, blockSize, blockCount)                            \
+    static uint8_t name##MemArr[POOL_BLOCK_SIZE(blockSize) * (blockCount)]; \
+    POOL_PoolT name = { name##MemArr, NULL, POOL_BLOCK_SIZE(blockSize),     \
+                        (blockCount), 0, 0, 0, 0 }
+
+//! Critical section site of the subsystem, see IRQ_PROFILING.
+#ifndef POOL_IRQ_SITE
+#define POOL_IRQ_SITE                   (IRQ_SITE_BASE_SUBSYSTEM + 2)
+#endif
+
+//*****************************************************************************
+//************************* POOL SPECIFIC ERROR CODES *************************
+//*****************************************************************************
+
+/*! POOL specific error base */
+#ifndef POOL_ERR_BASE
+#define POOL_ERR_BASE               150
+#endif
+
+/*! POOL returns with no errors. */
+#define POOL_OK                     0
+
+/*! A bad parameter has been passed. */
+#define POOL_ERR_BAD_PARAMETER      POOL_ERR_BASE + 0
+
+//*****************************************************************************
+//******************************** DATA TYPES *********************************
+//*****************************************************************************
+
+/*! Pool control structure. Use POOL_DEFINE() or POOL_Init() for setup and
+**  do not access the members directly. */
+typedef struct
+{
+    uint8_t* memPtr;      //!< start address of the block storage
+    void*    freeListPtr; //!< released blocks, linked through their first bytes
+    uint8_t  blockSize;   //!< block size in bytes
+    uint8_t  blockCount;  //!< number of blocks
+    uint8_t  freshIdx;    //!< index of the first block never allocated
+    uint8_t  usedCount;   //!< currently allocated blocks
+    uint8_t  highWater;   //!< maximum of usedCount
+    uint8_t  failCount;   //!< failed allocations, saturates at 255
+} POOL_PoolT;
+
+//! Pool statistics.
+typedef struct
+{
+    uint8_t blockCount;
+    uint8_t usedCount;
+    uint8_t highWater;
+    uint8_t failCount;
+} POOL_StatsT;
+
+//*****************************************************************************
+//************************* FUNCTION DECLARATIONS *****************************
+//*****************************************************************************
+
+uint8_t POOL_Init (POOL_PoolT* poolPtr,
+                   uint8_t* memPtr,
+                   uint8_t blockSize,
+                   uint8_t blockCount);
+void*   POOL_Alloc (POOL_PoolT* poolPtr);
+uint8_t POOL_Free (POOL_PoolT* poolPtr, void* blockPtr);
+void    POOL_GetStats (POOL_PoolT* poolPtr, POOL_StatsT* statsPtr);
+void    POOL_ResetStats (POOL_PoolT* poolPtr);
+
+#endif // POOL_H
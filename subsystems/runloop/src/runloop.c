@@ -72,11 +72,18 @@
 #include <string.h>
 #include <avr/wdt.h>
 #include <avr/sleep.h>
-#include <util/atomic.h>
+#include <drivers/irq.h>
 #include <drivers/timer.h>
 #include <drivers/uart.h>
 #include <subsystems/cmdl.h>
 #include "runloop.h"
+#if ((RUNLOOP_WITH_UPTIME) && (RUNLOOP_UPTIME_FROM_RTC)) \
+ || ((RUNLOOP_WITH_POWER_MANAGER) && (RTC_USE_TIMER2))
+#include <drivers/rtc.h>
+#endif
+#if RUNLOOP_WITH_POWER_MANAGER
+#include <drivers/power.h>
+#endif
 
 #if RUNLOOP_DEBUG
 #include <stdio.h>
@@ -87,6 +94,13 @@
 //*************************** DEFINES AND MACROS ******************************
 //*****************************************************************************
 
+#if (RUNLOOP_WITH_PHASE_STAGGERING) && (RUNLOOP_MAX_NUMBER_OF_TASKS > 16)
+#error "RUNLOOP_WITH_PHASE_STAGGERING requires RUNLOOP_MAX_NUMBER_OF_TASKS <= 16"
+#endif
+
+#if (RUNLOOP_WITH_UPTIME) && (RUNLOOP_UPTIME_FROM_RTC) && !(RTC_USE_TIMER2)
+#error "RUNLOOP_UPTIME_FROM_RTC requires RTC_USE_TIMER2"
+#endif
 
 //*****************************************************************************
 //**************************** LOCAL DATA TYPES *******************************
@@ -109,9 +123,24 @@ typedef struct runloopTask
     uint16_t remainingExecutions;
     uint32_t cyclesToNextExecution;
     uint32_t cyclesPerPeriod;
+#if RUNLOOP_WITH_ADMISSION_CONTROL
+    uint32_t wcetCycles;
+    uint16_t utilization; // in permille
+#endif
     runloopTaskStateT state : 2;
 } runloopTaskT;
 
+#if RUNLOOP_WITH_IDLE_TASKS
+// Idle task structure:
+typedef struct runloopIdleTask
+{
+    RUNLOOP_TaskCallbackT callbackPtr;
+    void* callbackArgPtr;
+    uint32_t cyclesPerSlice;
+    runloopTaskStateT state; // empty, new or active
+} runloopIdleTaskT;
+#endif
+
 
 //*****************************************************************************
 //**************************** LOCAL VARIABLES ********************************
@@ -123,6 +152,12 @@ static runloopTaskT runloopTaskSlotArr [RUNLOOP_MAX_NUMBER_OF_TASKS];
 // Next task to schedule:
 static runloopTaskT* runloopTaskHeadPtr = NULL;
 
+#if RUNLOOP_WITH_IDLE_TASKS
+// Idle tasks and the next one to execute in a round robin manner:
+static runloopIdleTaskT runloopIdleSlotArr [RUNLOOP_MAX_NUMBER_OF_IDLE_TASKS];
+static uint8_t runloopIdleNext = 0;
+#endif
+
 // UART handle:
 static UART_HandleT runloopUartHandle = NULL;
 
@@ -151,6 +186,11 @@ static RUNLOOP_SyncErrorCallbackT runloopSyncErrorCallback = NULL;
 
 #if RUNLOOP_WITH_UPTIME
 static uint64_t runloopUptimeCycles = 0;
+#if RUNLOOP_UPTIME_FROM_RTC
+// RTC timestamp at which the runloop was started:
+static uint32_t runloopRtcStartSeconds = 0;
+static uint8_t runloopRtcStartTicks = 0;
+#endif
 #endif
 
 static char* runloopRunningStr = "RUNNING";
@@ -173,6 +213,33 @@ static uint8_t runloopUpdateAndExecuteTasks (uint32_t elapsedCycles);
 #if RUNLOOP_DEBUG
 static void runloopPrintTask(uint8_t ii, uint32_t elapsedCycles, runloopTaskT* taskPtr);
 #endif
+#if (RUNLOOP_WITH_UPTIME) && (RUNLOOP_UPTIME_FROM_RTC)
+static uint64_t runloopRtcUptimeTicks (void);
+#endif
+#if RUNLOOP_WITH_PHASE_STAGGERING
+static uint32_t runloopGcd (uint32_t a, uint32_t b);
+static uint8_t runloopGetPeriodicTasks (uint32_t* periodMsArr,
+                                        uint32_t* phaseMsArr);
+static uint32_t runloopFindInitialDelay (uint32_t periodMs);
+static uint8_t runloopMaxCoincidence (uint16_t candidateMask,
+                                      const uint16_t* coincidenceMaskArr);
+#endif
+#if RUNLOOP_WITH_ADMISSION_CONTROL
+static uint16_t runloopUtilization (uint32_t wcetCycles,
+                                    uint32_t cyclesPerPeriod);
+static uint16_t runloopTotalUtilization (void);
+static void runloopProfileTask (runloopTaskT* taskPtr, uint32_t startCycles);
+#endif
+#if RUNLOOP_WITH_IDLE_TASKS
+static uint8_t runloopExecuteIdleSlice (void);
+#endif
+static uint8_t runloopAddTask (RUNLOOP_TaskCallbackT callbackPtr,
+                               void* callbackArgPtr,
+                               uint16_t numberOfExecutions,
+                               uint32_t periodMs,
+                               uint32_t initialDelayMs,
+                               uint16_t wcetUs,
+                               uint8_t* taskIdPtr);
 
 
 //*****************************************************************************
@@ -254,7 +321,7 @@ static void runloopStopwatchCallback (void* optArgPtr)
 static void runloopActivateNewTasks (uint32_t elapsedCycles)
 {
 #if RUNLOOP_INTERRUPT_SAFETY
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    IRQ_GLOBAL_BLOCK(RUNLOOP_IRQ_SITE)
 #endif
     {
         uint8_t ii = 0;
@@ -299,6 +366,9 @@ static uint8_t runloopUpdateAndExecuteTasks (uint32_t elapsedCycles)
     uint8_t result = 0;
     uint8_t tasks_executed = 0;
     uint32_t elapsed_cycles_overdue = 0;
+#if RUNLOOP_WITH_ADMISSION_CONTROL
+    uint32_t start_cycles = 0;
+#endif
 
     for (ii = 0; ii < RUNLOOP_MAX_NUMBER_OF_TASKS; ii++)
     {
@@ -318,7 +388,15 @@ static uint8_t runloopUpdateAndExecuteTasks (uint32_t elapsedCycles)
             {
                 // Execute task:
                 wdt_reset();
+#if RUNLOOP_WITH_ADMISSION_CONTROL
+                TIMER_GetStopwatchSystemClockCycles(runloopTimerHandle,
+                                                    &start_cycles,
+                                                    TIMER_Stopwatch_NoReset);
+#endif
                 result = task_ptr->callbackPtr(task_ptr->callbackArgPtr);
+#if RUNLOOP_WITH_ADMISSION_CONTROL
+                runloopProfileTask(task_ptr, start_cycles);
+#endif
                 tasks_executed++;
                 if (result != RUNLOOP_OK)
                 {
@@ -328,7 +406,7 @@ static uint8_t runloopUpdateAndExecuteTasks (uint32_t elapsedCycles)
                     // Task returned with RUNLOOP_OK_TASK_ABORT or with error code,
                     // invalidate task:
 #if RUNLOOP_INTERRUPT_SAFETY
-                    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+                    IRQ_GLOBAL_BLOCK(RUNLOOP_IRQ_SITE)
 #endif
                     {
                         memset(task_ptr, 0, sizeof(runloopTaskT));
@@ -382,7 +460,7 @@ static uint8_t runloopUpdateAndExecuteTasks (uint32_t elapsedCycles)
                     {
                         // Task was executed for the last time, invalidate task:
 #if RUNLOOP_INTERRUPT_SAFETY
-                        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+                        IRQ_GLOBAL_BLOCK(RUNLOOP_IRQ_SITE)
 #endif
                         {
                             memset(task_ptr, 0, sizeof(runloopTaskT));
@@ -403,7 +481,15 @@ static uint8_t runloopUpdateAndExecuteTasks (uint32_t elapsedCycles)
             {
                 // Execute task:
                 wdt_reset();
+#if RUNLOOP_WITH_ADMISSION_CONTROL
+                TIMER_GetStopwatchSystemClockCycles(runloopTimerHandle,
+                                                    &start_cycles,
+                                                    TIMER_Stopwatch_NoReset);
+#endif
                 result = task_ptr->callbackPtr(task_ptr->callbackArgPtr);
+#if RUNLOOP_WITH_ADMISSION_CONTROL
+                runloopProfileTask(task_ptr, start_cycles);
+#endif
                 tasks_executed++;
                 task_ptr->cyclesToNextExecution = task_ptr->cyclesPerPeriod;
                 if (result != RUNLOOP_OK)
@@ -414,7 +500,7 @@ static uint8_t runloopUpdateAndExecuteTasks (uint32_t elapsedCycles)
                     // Task returned with RUNLOOP_OK_TASK_ABORT or with error code,
                     // invalidate task:
 #if RUNLOOP_INTERRUPT_SAFETY
-                    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+                    IRQ_GLOBAL_BLOCK(RUNLOOP_IRQ_SITE)
 #endif
                     {
                         memset(task_ptr, 0, sizeof(runloopTaskT));
@@ -436,7 +522,7 @@ static uint8_t runloopUpdateAndExecuteTasks (uint32_t elapsedCycles)
                     {
                         // Task was executed only once, invalidate task:
 #if RUNLOOP_INTERRUPT_SAFETY
-                        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+                        IRQ_GLOBAL_BLOCK(RUNLOOP_IRQ_SITE)
 #endif
                         {
                             memset(task_ptr, 0, sizeof(runloopTaskT));
@@ -477,6 +563,469 @@ static void runloopPrintTask(uint8_t ii, uint32_t elapsedCycles, runloopTaskT* t
 }
 #endif
 
+#if (RUNLOOP_WITH_UPTIME) && (RUNLOOP_UPTIME_FROM_RTC)
+/*!
+*******************************************************************************
+** \brief   Get the RTC ticks elapsed since RUNLOOP_Run() was called.
+**
+*******************************************************************************
+*/
+static uint64_t runloopRtcUptimeTicks (void)
+{
+    uint32_t seconds;
+    uint8_t ticks;
+
+    // the uptime is monotonic, unlike the calendar time:
+    RTC_GetUptime(&seconds, &ticks);
+    return (((uint64_t)(seconds - runloopRtcStartSeconds) * RTC_TICKS_PER_SECOND
+             + ticks) - runloopRtcStartTicks);
+}
+#endif
+
+#if RUNLOOP_WITH_PHASE_STAGGERING
+/*!
+*******************************************************************************
+** \brief   Greatest common divisor of a and b.
+**
+*******************************************************************************
+*/
+static uint32_t runloopGcd (uint32_t a, uint32_t b)
+{
+    uint32_t tmp;
+
+    while (b)
+    {
+        tmp = a % b;
+        a = b;
+        b = tmp;
+    }
+    return (a);
+}
+
+/*!
+*******************************************************************************
+** \brief   Collect the periods and the times to the next execution of all
+**          tasks that will be executed more than once.
+**
+** \param   periodMsArr Receives the periods in ms. Periods below 1 ms are
+**                      reported as 1 ms, so they can be used as divisors.
+** \param   phaseMsArr  Receives the times to the next execution in ms,
+**                      rounded to the nearest millisecond.
+**
+** \return  The number of periodic tasks.
+**
+*******************************************************************************
+*/
+static uint8_t runloopGetPeriodicTasks (uint32_t* periodMsArr,
+                                        uint32_t* phaseMsArr)
+{
+    runloopTaskT* task_ptr;
+    uint8_t ii;
+    uint8_t count = 0;
+
+    for (ii = 0; ii < RUNLOOP_MAX_NUMBER_OF_TASKS; ii++)
+    {
+        task_ptr = &runloopTaskSlotArr[ii];
+        if ((task_ptr->state == runloopTaskStateEmpty)
+        ||  (task_ptr->cyclesPerPeriod == 0)
+        ||  (task_ptr->remainingExecutions < 2))
+        {
+            continue;
+        }
+        periodMsArr[count] = task_ptr->cyclesPerPeriod / ((F_CPU) / 1000UL);
+        if (periodMsArr[count] == 0)
+        {
+            periodMsArr[count] = 1;
+        }
+        phaseMsArr[count] = (task_ptr->cyclesToNextExecution
+                             + ((F_CPU) / 2000UL)) / ((F_CPU) / 1000UL);
+        count++;
+    }
+    return (count);
+}
+
+/*!
+*******************************************************************************
+** \brief   Find the initial delay for a new task that maximizes the minimum
+**          distance between its executions and those of all periodic tasks.
+**
+**          Two tasks with periods P1 and P2 can only be executed at times
+**          that differ by multiples of gcd(P1, P2), hence their distance
+**          depends on the delay modulo the gcd only. The delays within the
+**          least common multiple of all these gcds, which is a divisor of
+**          periodMs, are probed in steps of 1 ms without any division. Ties
+**          are resolved in favor of the delay with the least tasks at the
+**          minimum distance. At most #RUNLOOP_STAGGERING_MAX_PROBES delays
+**          are probed, hence the cost is bounded by that number times the
+**          number of periodic tasks.
+**
+** \param   periodMs    The period of the new task.
+**
+** \return  The initial delay in ms.
+**
+*******************************************************************************
+*/
+static uint32_t runloopFindInitialDelay (uint32_t periodMs)
+{
+    uint32_t modulus_arr[RUNLOOP_MAX_NUMBER_OF_TASKS];
+    uint32_t residue_arr[RUNLOOP_MAX_NUMBER_OF_TASKS];
+    uint32_t span = 1;
+    uint32_t delay;
+    uint32_t distance;
+    uint32_t min_distance;
+    uint32_t best_delay = 0;
+    uint32_t best_distance = 0;
+    uint8_t best_hits = UINT8_MAX;
+    uint8_t hits;
+    uint8_t count;
+    uint8_t ii;
+
+    if (periodMs == 0)
+    {
+        return (0);
+    }
+    count = runloopGetPeriodicTasks(modulus_arr, residue_arr);
+    for (ii = 0; ii < count; ii++)
+    {
+        modulus_arr[ii] = runloopGcd(periodMs, modulus_arr[ii]);
+        // residue of (delay - phase) modulo the gcd for delay 0:
+        residue_arr[ii] = (modulus_arr[ii] - residue_arr[ii] % modulus_arr[ii])
+                          % modulus_arr[ii];
+        span = span / runloopGcd(span, modulus_arr[ii]) * modulus_arr[ii];
+    }
+    if (span > RUNLOOP_STAGGERING_MAX_PROBES)
+    {
+        span = RUNLOOP_STAGGERING_MAX_PROBES;
+    }
+
+    for (delay = 0; delay < span; delay++)
+    {
+        min_distance = UINT32_MAX;
+        hits = 0;
+        for (ii = 0; ii < count; ii++)
+        {
+            distance = modulus_arr[ii] - residue_arr[ii];
+            if (residue_arr[ii] < distance)
+            {
+                distance = residue_arr[ii];
+            }
+            if (distance < min_distance)
+            {
+                min_distance = distance;
+                hits = 1;
+            }
+            else if (distance == min_distance)
+            {
+                hits++;
+            }
+            if (++residue_arr[ii] == modulus_arr[ii])
+            {
+                residue_arr[ii] = 0;
+            }
+        }
+        if ((delay == 0)
+        ||  (min_distance > best_distance)
+        ||  ((min_distance == best_distance) && (hits < best_hits)))
+        {
+            best_delay = delay;
+            best_distance = min_distance;
+            best_hits = hits;
+        }
+    }
+    return (best_delay);
+}
+
+/*!
+*******************************************************************************
+** \brief   Get the size of the largest set of tasks that are executed at
+**          the same time.
+**
+**          A set of periodic tasks is executed at the same time at some
+**          point if and only if each pair of the set coincides (generalized
+**          Chinese remainder theorem), so the largest such set is searched
+**          among the candidates recursively.
+**
+** \param   candidateMask       Tasks that may be added to the set.
+** \param   coincidenceMaskArr  For each task, the tasks it coincides with.
+**
+** \return  The size of the largest set.
+**
+*******************************************************************************
+*/
+static uint8_t runloopMaxCoincidence (uint16_t candidateMask,
+                                      const uint16_t* coincidenceMaskArr)
+{
+    uint8_t ii;
+    uint8_t size;
+    uint8_t max_size = 0;
+
+    for (ii = 0; candidateMask; ii++)
+    {
+        if (candidateMask & ((uint16_t)1 << ii))
+        {
+            candidateMask &= ~((uint16_t)1 << ii);
+            size = 1 + runloopMaxCoincidence(candidateMask
+                                             & coincidenceMaskArr[ii],
+                                             coincidenceMaskArr);
+            if (size > max_size)
+            {
+                max_size = size;
+            }
+        }
+    }
+    return (max_size);
+}
+#endif // RUNLOOP_WITH_PHASE_STAGGERING
+
+#if RUNLOOP_WITH_ADMISSION_CONTROL
+/*!
+*******************************************************************************
+** \brief   Utilization of a task in permille, rounded up. Tasks that are
+**          executed only once do not contribute.
+**
+*******************************************************************************
+*/
+static uint16_t runloopUtilization (uint32_t wcetCycles,
+                                    uint32_t cyclesPerPeriod)
+{
+    uint64_t utilization;
+
+    if (cyclesPerPeriod == 0)
+    {
+        return (0);
+    }
+    utilization = ((uint64_t)wcetCycles * 1000 + cyclesPerPeriod - 1)
+                  / cyclesPerPeriod;
+    return ((utilization > UINT16_MAX) ? UINT16_MAX : (uint16_t)utilization);
+}
+
+/*!
+*******************************************************************************
+** \brief   Sum of the utilization of all tasks in permille, saturated.
+**
+*******************************************************************************
+*/
+static uint16_t runloopTotalUtilization (void)
+{
+    uint32_t total = 0;
+    uint8_t ii;
+
+    for (ii = 0; ii < RUNLOOP_MAX_NUMBER_OF_TASKS; ii++)
+    {
+        if ((runloopTaskSlotArr[ii].state != runloopTaskStateEmpty)
+        &&  (runloopTaskSlotArr[ii].remainingExecutions > 1))
+        {
+            total += runloopTaskSlotArr[ii].utilization;
+        }
+    }
+    return ((total > UINT16_MAX) ? UINT16_MAX : (uint16_t)total);
+}
+
+/*!
+*******************************************************************************
+** \brief   Raise the WCET of a task to its last execution time if exceeded.
+**
+** \param   taskPtr     The task that has just been executed.
+** \param   startCycles Stopwatch reading before the task was executed.
+**
+*******************************************************************************
+*/
+static void runloopProfileTask (runloopTaskT* taskPtr, uint32_t startCycles)
+{
+    uint32_t stop_cycles = 0;
+
+    TIMER_GetStopwatchSystemClockCycles(runloopTimerHandle,
+                                        &stop_cycles,
+                                        TIMER_Stopwatch_NoReset);
+    if (stop_cycles - startCycles > taskPtr->wcetCycles)
+    {
+        taskPtr->wcetCycles = stop_cycles - startCycles;
+        taskPtr->utilization = runloopUtilization(taskPtr->wcetCycles,
+                                                  taskPtr->cyclesPerPeriod);
+    }
+    return;
+}
+#endif // RUNLOOP_WITH_ADMISSION_CONTROL
+
+#if RUNLOOP_WITH_IDLE_TASKS
+/*!
+*******************************************************************************
+** \brief   Execute a slice of the next idle task whose slice fits into the
+**          time left until the next timed task.
+**
+** \return  1 if a slice was executed, 0 otherwise.
+**
+*******************************************************************************
+*/
+static uint8_t runloopExecuteIdleSlice (void)
+{
+    runloopIdleTaskT* idle_ptr = NULL;
+    uint32_t remaining_cycles = UINT32_MAX;
+    uint32_t elapsed_cycles = 0;
+    uint32_t guard_cycles = (RUNLOOP_IDLE_GUARD_US) * ((F_CPU) / 1000UL) / 1000UL;
+    uint8_t ii;
+    uint8_t idx = 0;
+    uint8_t result;
+
+    if (runloopTaskHeadPtr)
+    {
+        TIMER_GetStopwatchSystemClockCycles(runloopTimerHandle,
+                                            &elapsed_cycles,
+                                            TIMER_Stopwatch_NoReset);
+        if (runloopTaskHeadPtr->cyclesToNextExecution <= elapsed_cycles)
+        {
+            return (0);
+        }
+        remaining_cycles = runloopTaskHeadPtr->cyclesToNextExecution
+                           - elapsed_cycles;
+    }
+    if (remaining_cycles <= guard_cycles)
+    {
+        return (0);
+    }
+    remaining_cycles -= guard_cycles;
+
+    for (ii = 0; ii < RUNLOOP_MAX_NUMBER_OF_IDLE_TASKS; ii++)
+    {
+        idx = (runloopIdleNext + ii) % RUNLOOP_MAX_NUMBER_OF_IDLE_TASKS;
+        if ((runloopIdleSlotArr[idx].state == runloopTaskStateActive)
+        &&  (runloopIdleSlotArr[idx].cyclesPerSlice <= remaining_cycles))
+        {
+            idle_ptr = &runloopIdleSlotArr[idx];
+            break;
+        }
+    }
+    if (idle_ptr == NULL)
+    {
+        return (0);
+    }
+    runloopIdleNext = (idx + 1) % RUNLOOP_MAX_NUMBER_OF_IDLE_TASKS;
+
+    wdt_reset();
+    result = idle_ptr->callbackPtr(idle_ptr->callbackArgPtr);
+    if (result != RUNLOOP_OK)
+    {
+        // Work finished or error, invalidate idle task:
+#if RUNLOOP_INTERRUPT_SAFETY
+        IRQ_GLOBAL_BLOCK(RUNLOOP_IRQ_SITE)
+#endif
+        {
+            memset(idle_ptr, 0, sizeof(runloopIdleTaskT));
+        }
+        if ((result != RUNLOOP_OK_TASK_ABORT)
+        &&  (runloopTaskErrorCallback))
+        {
+            runloopTaskErrorCallback(RUNLOOP_MAX_NUMBER_OF_TASKS + idx, result);
+        }
+    }
+    return (1);
+}
+#endif // RUNLOOP_WITH_IDLE_TASKS
+
+/*!
+*******************************************************************************
+** \brief   Add a new task to the RUNLOOP, see RUNLOOP_AddTask().
+**
+** \param   wcetUs      Worst-case execution time in microseconds, which is
+**                      only evaluated if RUNLOOP_WITH_ADMISSION_CONTROL
+**                      is set.
+**
+*******************************************************************************
+*/
+static uint8_t runloopAddTask (RUNLOOP_TaskCallbackT callbackPtr,
+                               void* callbackArgPtr,
+                               uint16_t numberOfExecutions,
+                               uint32_t periodMs,
+                               uint32_t initialDelayMs,
+                               uint16_t wcetUs,
+                               uint8_t* taskIdPtr)
+{
+    uint8_t ii = 0;
+    runloopTaskT* task_ptr = NULL;
+#if RUNLOOP_WITH_ADMISSION_CONTROL
+    uint32_t wcet_cycles = 0;
+    uint16_t utilization = 0;
+#endif
+
+    if ((callbackPtr == NULL)
+    ||  ((periodMs == 0) && (numberOfExecutions != 1)))
+    {
+        return (RUNLOOP_ERR_BAD_PARAMETER);
+    }
+
+#if RUNLOOP_WITH_PHASE_STAGGERING
+    if (initialDelayMs == RUNLOOP_INITIAL_DELAY_AUTO)
+    {
+        initialDelayMs = runloopFindInitialDelay(periodMs);
+    }
+#endif
+
+#if RUNLOOP_WITH_ADMISSION_CONTROL
+    wcet_cycles = (uint32_t)wcetUs * ((F_CPU) / 1000UL) / 1000UL;
+    if (numberOfExecutions != 1)
+    {
+        utilization = runloopUtilization(wcet_cycles,
+                                         periodMs * ((F_CPU) / 1000UL));
+    }
+#else
+    (void) wcetUs;
+#endif
+
+#if RUNLOOP_INTERRUPT_SAFETY
+    IRQ_GLOBAL_BLOCK(RUNLOOP_IRQ_SITE)
+#endif
+    {
+#if RUNLOOP_WITH_ADMISSION_CONTROL
+        // One-shot tasks and tasks without a declared WCET are always
+        // admitted, so an exceeded bound does not block them:
+        if ((utilization != 0)
+        &&  ((uint32_t)runloopTotalUtilization() + utilization
+             > (RUNLOOP_UTILIZATION_BOUND_PERMILLE)))
+        {
+            return (RUNLOOP_ERR_UTILIZATION_EXCEEDED);
+        }
+#endif
+        // Search empty task slot:
+        for (ii = 0; ii < RUNLOOP_MAX_NUMBER_OF_TASKS; ii++)
+        {
+            if (runloopTaskSlotArr[ii].state == runloopTaskStateEmpty) break;
+        }
+        if (ii >= RUNLOOP_MAX_NUMBER_OF_TASKS)
+        {
+            return (RUNLOOP_ERR_NO_TASK_SLOT_FREE);
+        }
+        task_ptr = &runloopTaskSlotArr[ii];
+        task_ptr->state = runloopTaskStateNew;
+    }
+
+    // Populate task:
+    task_ptr->callbackPtr = callbackPtr;
+    task_ptr->callbackArgPtr = callbackArgPtr;
+    if (numberOfExecutions == 0)
+    {
+        // Infinite execution:
+        task_ptr->remainingExecutions = UINT16_MAX;
+    }
+    else
+    {
+        // Finite execution:
+        task_ptr->remainingExecutions = numberOfExecutions;
+    }
+    task_ptr->cyclesToNextExecution = initialDelayMs * ((F_CPU) / 1000UL);
+    task_ptr->cyclesPerPeriod = periodMs * ((F_CPU) / 1000UL);
+#if RUNLOOP_WITH_ADMISSION_CONTROL
+    task_ptr->wcetCycles = wcet_cycles;
+    task_ptr->utilization = utilization;
+#endif
+
+    runloopHandle.flagTaskAdded = 1;
+
+    // Disclose task id:
+    *taskIdPtr = ii;
+
+    return (RUNLOOP_OK);
+}
+
 //*****************************************************************************
 //*************************** PUBLIC FUNCTIONS ********************************
 //*****************************************************************************
@@ -564,6 +1113,10 @@ uint8_t RUNLOOP_Init (TIMER_TimerIdT timerId,
 
     // Initialize local data structures:
     memset (runloopTaskSlotArr, 0, sizeof(runloopTaskSlotArr));
+#if RUNLOOP_WITH_IDLE_TASKS
+    memset (runloopIdleSlotArr, 0, sizeof(runloopIdleSlotArr));
+    runloopIdleNext = 0;
+#endif
     memset (&runloopHandle, 0, sizeof(runloopHandle));
 
     // Initialize timer:
@@ -642,6 +1195,11 @@ uint8_t RUNLOOP_Init (TIMER_TimerIdT timerId,
 **                              Must be greater than 0.
 ** \param   initialDelayMs      Defines an initial delay before the task will
 **                              be executed for the first time.
+**                              If RUNLOOP_WITH_PHASE_STAGGERING is set,
+**                              RUNLOOP_INITIAL_DELAY_AUTO lets the runloop
+**                              choose a delay below periodMs that staggers the
+**                              task against the other periodic tasks. This
+**                              must not be used from within ISRs.
 ** \param   taskIdPtr           Receives a unique identifier of the task, which
 **                              may be used to identify tasks in the error
 **                              callbacks. The argument may be NULL if not needed.
@@ -661,55 +1219,177 @@ uint8_t RUNLOOP_AddTask (RUNLOOP_TaskCallbackT callbackPtr,
                          uint32_t initialDelayMs,
                          uint8_t* taskIdPtr)
 {
+    return (runloopAddTask(callbackPtr,
+                           callbackArgPtr,
+                           numberOfExecutions,
+                           periodMs,
+                           initialDelayMs,
+                           0,
+                           taskIdPtr));
+}
+
+#if RUNLOOP_WITH_ADMISSION_CONTROL
+/*!
+*******************************************************************************
+** \brief   Add a new task with a declared worst-case execution time to the
+**          RUNLOOP. The task is only accepted if the total utilization of
+**          all periodic tasks including the new one does not exceed
+**          RUNLOOP_UTILIZATION_BOUND_PERMILLE. Tasks that are executed
+**          once or declare a WCET of 0 are always accepted. Tasks added by
+**          RUNLOOP_AddTask() start with a WCET of 0, which is learned
+**          during execution.
+**
+** \param   wcetUs      Worst-case execution time in microseconds.
+**
+**          See RUNLOOP_AddTask() for the other parameters.
+**
+** \return
+**          - #RUNLOOP_OK on success.
+**          - #RUNLOOP_ERR_BAD_PARAMETER if callbackPtr is NULL or if periodMs
+**              is 0.
+**          - #RUNLOOP_ERR_UTILIZATION_EXCEEDED if the task was rejected.
+**          - #RUNLOOP_ERR_NO_TASK_SLOT_FREE if all task slots are taken.
+**
+*******************************************************************************
+*/
+uint8_t RUNLOOP_AddTaskWithWcet (RUNLOOP_TaskCallbackT callbackPtr,
+                                 void* callbackArgPtr,
+                                 uint16_t numberOfExecutions,
+                                 uint32_t periodMs,
+                                 uint32_t initialDelayMs,
+                                 uint16_t wcetUs,
+                                 uint8_t* taskIdPtr)
+{
+    return (runloopAddTask(callbackPtr,
+                           callbackArgPtr,
+                           numberOfExecutions,
+                           periodMs,
+                           initialDelayMs,
+                           wcetUs,
+                           taskIdPtr));
+}
+
+/*!
+*******************************************************************************
+** \brief   Get the total utilization of the periodic tasks, based on their
+**          declared or measured WCETs, and the remaining capacity.
+**
+** \param   utilizationPtr  Receives the total utilization in permille.
+** \param   remainingPtr    Receives the utilization in permille that can
+**                          still be admitted, 0 if the bound is exceeded.
+**
+** \return
+**          - #RUNLOOP_OK on success.
+**          - #RUNLOOP_ERR_BAD_PARAMETER if a pointer is NULL.
+**
+*******************************************************************************
+*/
+uint8_t RUNLOOP_GetCapacity (uint16_t* utilizationPtr,
+                             uint16_t* remainingPtr)
+{
+    uint16_t utilization = 0;
+
+    if ((utilizationPtr == NULL) || (remainingPtr == NULL))
+    {
+        return (RUNLOOP_ERR_BAD_PARAMETER);
+    }
+#if RUNLOOP_INTERRUPT_SAFETY
+    IRQ_GLOBAL_BLOCK(RUNLOOP_IRQ_SITE)
+#endif
+    {
+        utilization = runloopTotalUtilization();
+    }
+    *utilizationPtr = utilization;
+    *remainingPtr = (utilization < (RUNLOOP_UTILIZATION_BOUND_PERMILLE)) ?
+                    (RUNLOOP_UTILIZATION_BOUND_PERMILLE) - utilization : 0;
+    return (RUNLOOP_OK);
+}
+#endif // RUNLOOP_WITH_ADMISSION_CONTROL
+
+#if RUNLOOP_WITH_IDLE_TASKS
+/*!
+*******************************************************************************
+** \brief   Add an idle task to the RUNLOOP.
+**
+**          Idle tasks perform background work in slices whenever no timed
+**          task is due. A slice is only started if the time until the next
+**          timed task exceeds sliceUs plus RUNLOOP_IDLE_GUARD_US, hence
+**          idle tasks never delay timed tasks as long as each execution
+**          of the callback returns within sliceUs. Multiple idle tasks are
+**          executed in a round robin manner.
+**
+**          The callback returns RUNLOOP_OK if there is more work to do and
+**          RUNLOOP_OK_TASK_ABORT when the work is finished, which removes
+**          the idle task. Other return values remove the idle task as well
+**          and are reported to the task error callback with the task id.
+**
+** \param   callbackPtr     Performs a slice of the work.
+** \param   callbackArgPtr  The argument that will be passed to the callback.
+**                          May be NULL if not required by the callback.
+** \param   sliceUs         Maximum execution time of the callback in
+**                          microseconds.
+** \param   taskIdPtr       Receives the id of the idle task, which is in range
+**                          [RUNLOOP_MAX_NUMBER_OF_TASKS ...
+**                          RUNLOOP_MAX_NUMBER_OF_TASKS +
+**                          RUNLOOP_MAX_NUMBER_OF_IDLE_TASKS - 1].
+**                          The argument may be NULL if not needed.
+**
+** \return
+**          - #RUNLOOP_OK on success.
+**          - #RUNLOOP_ERR_BAD_PARAMETER if callbackPtr is NULL.
+**          - #RUNLOOP_ERR_NO_TASK_SLOT_FREE if all idle task slots are taken.
+**
+*******************************************************************************
+*/
+uint8_t RUNLOOP_AddIdleTask (RUNLOOP_TaskCallbackT callbackPtr,
+                             void* callbackArgPtr,
+                             uint16_t sliceUs,
+                             uint8_t* taskIdPtr)
+{
+    runloopIdleTaskT* idle_ptr = NULL;
     uint8_t ii = 0;
-    runloopTaskT* task_ptr = NULL;
 
-    if ((callbackPtr == NULL)
-    ||  ((periodMs == 0) && (numberOfExecutions != 1)))
+    if (callbackPtr == NULL)
     {
         return (RUNLOOP_ERR_BAD_PARAMETER);
     }
 
 #if RUNLOOP_INTERRUPT_SAFETY
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    IRQ_GLOBAL_BLOCK(RUNLOOP_IRQ_SITE)
 #endif
     {
-        // Search empty task slot:
-        for (ii = 0; ii < RUNLOOP_MAX_NUMBER_OF_TASKS; ii++)
-        {
-            if (runloopTaskSlotArr[ii].state == runloopTaskStateEmpty) break;
-        }
-        if (ii >= RUNLOOP_MAX_NUMBER_OF_TASKS)
+        // Search empty idle task slot:
+        for (ii = 0; ii < RUNLOOP_MAX_NUMBER_OF_IDLE_TASKS; ii++)
         {
-            return (RUNLOOP_ERR_NO_TASK_SLOT_FREE);
+            if (runloopIdleSlotArr[ii].state == runloopTaskStateEmpty)
+            {
+                idle_ptr = &runloopIdleSlotArr[ii];
+                idle_ptr->state = runloopTaskStateNew;
+                break;
+            }
         }
-        task_ptr = &runloopTaskSlotArr[ii];
-        task_ptr->state = runloopTaskStateNew;
-    }
-
-    // Populate task:
-    task_ptr->callbackPtr = callbackPtr;
-    task_ptr->callbackArgPtr = callbackArgPtr;
-    if (numberOfExecutions == 0)
-    {
-        // Infinite execution:
-        task_ptr->remainingExecutions = UINT16_MAX;
     }
-    else
+    if (idle_ptr == NULL)
     {
-        // Finite execution:
-        task_ptr->remainingExecutions = numberOfExecutions;
+        return (RUNLOOP_ERR_NO_TASK_SLOT_FREE);
     }
-    task_ptr->cyclesToNextExecution = initialDelayMs * ((F_CPU) / 1000UL);
-    task_ptr->cyclesPerPeriod = periodMs * ((F_CPU) / 1000UL);
 
-    runloopHandle.flagTaskAdded = 1;
+    // Populate idle task:
+    idle_ptr->callbackPtr = callbackPtr;
+    idle_ptr->callbackArgPtr = callbackArgPtr;
+    idle_ptr->cyclesPerSlice = (uint32_t)sliceUs * ((F_CPU) / 1000UL) / 1000UL;
+    idle_ptr->state = runloopTaskStateActive;
 
-    // Disclose task id:
-    *taskIdPtr = ii;
+    // Wake up the runloop:
+    runloopHandle.flagTaskAdded = 1;
 
+    if (taskIdPtr)
+    {
+        *taskIdPtr = RUNLOOP_MAX_NUMBER_OF_TASKS + ii;
+    }
     return (RUNLOOP_OK);
 }
+#endif // RUNLOOP_WITH_IDLE_TASKS
 
 /*!
 *******************************************************************************
@@ -730,9 +1410,20 @@ void RUNLOOP_Run (void)
 #if (RUNLOOP_WITH_UPTIME) && (RUNLOOP_UPTIME_UPDATE_INTERVAL_MS)
     uint32_t sleep_cycles = 0;
 #endif
+#if (!RUNLOOP_DEBUG) && (RUNLOOP_WITH_POWER_MANAGER)
+    uint8_t sleep_mode;
+#endif
 
 #if RUNLOOP_WITH_UPTIME
     runloopUptimeCycles = 0;
+#if RUNLOOP_UPTIME_FROM_RTC
+    RTC_GetUptime(&runloopRtcStartSeconds, &runloopRtcStartTicks);
+#endif
+#endif
+
+#if RUNLOOP_WITH_POWER_MANAGER
+    // All drivers are expected to be initialized by now:
+    POWER_GateUnused();
 #endif
 
     // Reset flags:
@@ -786,7 +1477,7 @@ void RUNLOOP_Run (void)
                                                     TIMER_Stopwatch_Reset);
 #if RUNLOOP_WITH_UPTIME
 #if RUNLOOP_INTERRUPT_SAFETY
-                ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+                IRQ_GLOBAL_BLOCK(RUNLOOP_IRQ_SITE)
 #endif
                 {
                     runloopUptimeCycles += stopwatch_cycles;
@@ -846,6 +1537,22 @@ void RUNLOOP_Run (void)
             }
 #endif
 
+#if RUNLOOP_WITH_IDLE_TASKS
+            // Execute idle slices until the next timed task is due:
+            while ((runloopHandle.running)
+#if RUNLOOP_WITH_CMDL
+            &&     (runloopHandle.flagCmdl == 0)
+#endif
+            &&     (runloopHandle.flagPause == 0)
+            &&     (runloopHandle.flagStopwatch == 0)
+            &&     (runloopHandle.flagTaskAdded == 0)
+            &&     (runloopExecuteIdleSlice()))
+            {
+                // Reset watchdog:
+                wdt_reset();
+            }
+#endif
+
             // Sleep while the runloop is idle:
             while ((runloopHandle.running)
 #if RUNLOOP_WITH_CMDL
@@ -863,6 +1570,17 @@ void RUNLOOP_Run (void)
                 cli();
                 #if RUNLOOP_DEBUG
                 set_sleep_mode(SLEEP_MODE_IDLE);
+                #elif RUNLOOP_WITH_POWER_MANAGER
+                // Deepest mode that keeps the acquired peripherals running:
+                sleep_mode = POWER_GetSleepMode();
+                set_sleep_mode(sleep_mode);
+                #if RTC_USE_TIMER2
+                if (sleep_mode == SLEEP_MODE_PWR_SAVE)
+                {
+                    // the asynchronous timer must be ready to wake us up:
+                    RTC_PrepareSleep();
+                }
+                #endif
                 #else
                 // Timer 2 allows wake-up from power save mode / extended stand-by
                 if (runloopHandle.timerId == TIMER_TimerId_2)
@@ -935,6 +1653,58 @@ void RUNLOOP_Stop (void* optArgPtr)
     return;
 }
 
+#if RUNLOOP_WITH_PHASE_STAGGERING
+/*!
+*******************************************************************************
+** \brief   Get the projected peak load of the runloop, i.e., the maximum
+**          number of periodic tasks that will be due in the same
+**          millisecond at any time of the hyperperiod. Tasks with a single
+**          remaining execution are not taken into account.
+**
+** \param   peakTasksPtr    Receives the number of tasks.
+**
+** \return
+**          - #RUNLOOP_OK on success.
+**          - #RUNLOOP_ERR_BAD_PARAMETER if peakTasksPtr is NULL.
+**
+*******************************************************************************
+*/
+uint8_t RUNLOOP_GetPeakLoad (uint8_t* peakTasksPtr)
+{
+    uint32_t period_ms_arr[RUNLOOP_MAX_NUMBER_OF_TASKS];
+    uint32_t phase_ms_arr[RUNLOOP_MAX_NUMBER_OF_TASKS];
+    uint16_t coincidence_mask_arr[RUNLOOP_MAX_NUMBER_OF_TASKS];
+    uint32_t gcd;
+    uint8_t count;
+    uint8_t ii;
+    uint8_t jj;
+
+    if (peakTasksPtr == NULL)
+    {
+        return (RUNLOOP_ERR_BAD_PARAMETER);
+    }
+    count = runloopGetPeriodicTasks(period_ms_arr, phase_ms_arr);
+    memset(coincidence_mask_arr, 0, sizeof(coincidence_mask_arr));
+    for (ii = 0; ii < count; ii++)
+    {
+        for (jj = ii + 1; jj < count; jj++)
+        {
+            // Two tasks coincide if their phases are congruent modulo the
+            // gcd of their periods:
+            gcd = runloopGcd(period_ms_arr[ii], period_ms_arr[jj]);
+            if ((phase_ms_arr[ii] % gcd) == (phase_ms_arr[jj] % gcd))
+            {
+                coincidence_mask_arr[ii] |= ((uint16_t)1 << jj);
+                coincidence_mask_arr[jj] |= ((uint16_t)1 << ii);
+            }
+        }
+    }
+    *peakTasksPtr = runloopMaxCoincidence(((uint32_t)1 << count) - 1,
+                                          coincidence_mask_arr);
+    return (RUNLOOP_OK);
+}
+#endif // RUNLOOP_WITH_PHASE_STAGGERING
+
 #if RUNLOOP_WITH_UPTIME
 /*!
 *******************************************************************************
@@ -966,7 +1736,12 @@ uint8_t RUNLOOP_GetUptimeClockCycles (uint64_t* systemClockCyclesPtr)
         return (RUNLOOP_ERR_BAD_PARAMETER);
     }
 
+#if RUNLOOP_UPTIME_FROM_RTC
+    *systemClockCyclesPtr = runloopRtcUptimeTicks() * (F_CPU)
+                            / RTC_TICKS_PER_SECOND;
+#else
     *systemClockCyclesPtr = runloopUptimeCycles;
+#endif
 
     return (RUNLOOP_OK);
 }
@@ -1023,7 +1798,11 @@ uint8_t RUNLOOP_GetUptimeHumanReadable (uint16_t* daysPtr,
     }
 
     // Calculate human readable data:
+#if RUNLOOP_UPTIME_FROM_RTC
+    tmp = runloopRtcUptimeTicks() * 1000 / RTC_TICKS_PER_SECOND; // in ms
+#else
     tmp = runloopUptimeCycles / ((F_CPU) / 1000); // total time in ms
+#endif
     *millisecondsPtr = tmp % 1000;
     tmp /= 1000;
     *secondsPtr = tmp % 60;
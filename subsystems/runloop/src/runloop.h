@@ -58,6 +58,81 @@
 #define RUNLOOP_UPTIME_UPDATE_INTERVAL_MS   0
 #endif
 
+/*! If RUNLOOP_WITH_UPTIME is enabled, set to 1 in order to derive the
+**  uptime from the RTC driver instead of the runloop timer. This requires
+**  RTC_USE_TIMER2, and the RTC must be initialized before RUNLOOP_Run() is
+**  called. The uptime then has a resolution of 1/256 s, is always up to
+**  date, keeps counting while the runloop is paused or the system clock is
+**  stopped in sleep mode, and is not affected by RTC_SetTime(). */
+#ifndef RUNLOOP_UPTIME_FROM_RTC
+#define RUNLOOP_UPTIME_FROM_RTC             0
+#endif
+
+/*! Set to 1 in order to let the POWER manager shut down all unused
+**  peripherals when RUNLOOP_Run() starts and select the deepest sleep
+**  mode that keeps the acquired peripherals running while idle. If
+**  RTC_USE_TIMER2 is set, RTC_PrepareSleep() is called before power-save
+**  mode is entered. */
+#ifndef RUNLOOP_WITH_POWER_MANAGER
+#define RUNLOOP_WITH_POWER_MANAGER          0
+#endif
+
+/*! Set to 1 in order to let RUNLOOP_AddTask() choose the initial delay of
+**  periodic tasks if RUNLOOP_INITIAL_DELAY_AUTO is passed. The delay is
+**  chosen such that the new task is executed as far apart as possible from
+**  the executions of all periodic tasks with equal or harmonic periods,
+**  which spreads the load over the hyperperiod. Requires
+**  RUNLOOP_MAX_NUMBER_OF_TASKS <= 16. */
+#ifndef RUNLOOP_WITH_PHASE_STAGGERING
+#define RUNLOOP_WITH_PHASE_STAGGERING       0
+#endif
+
+/*! Maximum number of initial delays (in steps of 1 ms) that are probed by
+**  RUNLOOP_AddTask() with RUNLOOP_INITIAL_DELAY_AUTO. Each probe iterates
+**  over all periodic tasks, so this bounds the execution time of the call
+**  at the expense of a possibly less favorable delay for long periods. */
+#ifndef RUNLOOP_STAGGERING_MAX_PROBES
+#define RUNLOOP_STAGGERING_MAX_PROBES       250
+#endif
+
+/*! Set to 1 in order to keep track of the CPU utilization of the periodic
+**  tasks. Tasks may declare their worst-case execution time (WCET) by
+**  RUNLOOP_AddTaskWithWcet(); the runloop additionally measures the
+**  execution time of each task and raises its WCET to the maximum
+**  observed value. Periodic tasks with a declared WCET that would raise
+**  the total utilization above RUNLOOP_UTILIZATION_BOUND_PERMILLE are
+**  rejected; one-shot tasks and tasks without a WCET are always accepted. */
+#ifndef RUNLOOP_WITH_ADMISSION_CONTROL
+#define RUNLOOP_WITH_ADMISSION_CONTROL      0
+#endif
+
+/*! If RUNLOOP_WITH_ADMISSION_CONTROL is enabled, this defines the maximum
+**  total utilization of all periodic tasks in permille. The default is
+**  the rate-monotonic bound for large task sets (ln 2). Since tasks are
+**  not preempted, lower values should be chosen if tasks have tight
+**  periods compared to the WCET of other tasks. */
+#ifndef RUNLOOP_UTILIZATION_BOUND_PERMILLE
+#define RUNLOOP_UTILIZATION_BOUND_PERMILLE  690
+#endif
+
+/*! Set to 1 in order to support idle tasks, which perform background work
+**  such as checksum computation or log flushing in bounded slices while
+**  the runloop would otherwise sleep. See RUNLOOP_AddIdleTask(). */
+#ifndef RUNLOOP_WITH_IDLE_TASKS
+#define RUNLOOP_WITH_IDLE_TASKS             0
+#endif
+
+//! Maximum number of idle tasks. Should be < 256 - RUNLOOP_MAX_NUMBER_OF_TASKS.
+#ifndef RUNLOOP_MAX_NUMBER_OF_IDLE_TASKS
+#define RUNLOOP_MAX_NUMBER_OF_IDLE_TASKS    4
+#endif
+
+/*! Minimum time in microseconds that must remain between the end of an
+**  idle slice and the next timed task, covering the runloop's overhead. */
+#ifndef RUNLOOP_IDLE_GUARD_US
+#define RUNLOOP_IDLE_GUARD_US               100
+#endif
+
 /*! Set to 1 if RUNLOOP_AddTask(), RUNLOOP_GetUptimeClockCycles(),
 **  or RUNLOOP_GetUptimeHumanReadable() will be called from within ISRs. */
 #ifndef RUNLOOP_INTERRUPT_SAFETY
@@ -69,6 +144,16 @@
 #define RUNLOOP_DEBUG                       0
 #endif
 
+#if RUNLOOP_WITH_PHASE_STAGGERING
+//! Passed as initialDelayMs to RUNLOOP_AddTask() for automatic placement.
+#define RUNLOOP_INITIAL_DELAY_AUTO          UINT32_MAX
+#endif
+
+//! Critical section site of the subsystem, see IRQ_PROFILING.
+#ifndef RUNLOOP_IRQ_SITE
+#define RUNLOOP_IRQ_SITE                (IRQ_SITE_BASE_SUBSYSTEM + 0)
+#endif
+
 //*****************************************************************************
 //************************* RUNLOOP SPECIFIC ERROR CODES **********************
 //*****************************************************************************
@@ -97,6 +182,9 @@
 /*! There is no task slot free to register a new task. */
 #define RUNLOOP_ERR_NO_TASK_SLOT_FREE       RUNLOOP_ERR_BASE + 3
 
+/*! The task would exceed RUNLOOP_UTILIZATION_BOUND_PERMILLE. */
+#define RUNLOOP_ERR_UTILIZATION_EXCEEDED    RUNLOOP_ERR_BASE + 4
+
 
 //*****************************************************************************
 //******************************** DATA TYPES *********************************
@@ -134,10 +222,34 @@ uint8_t RUNLOOP_AddTask (RUNLOOP_TaskCallbackT callbackPtr,
                          uint32_t initialDelayMs,
                          uint8_t* taskIdPtr);
 
+#if RUNLOOP_WITH_ADMISSION_CONTROL
+uint8_t RUNLOOP_AddTaskWithWcet (RUNLOOP_TaskCallbackT callbackPtr,
+                                 void* callbackArgPtr,
+                                 uint16_t numberOfExecutions,
+                                 uint32_t periodMs,
+                                 uint32_t initialDelayMs,
+                                 uint16_t wcetUs,
+                                 uint8_t* taskIdPtr);
+
+uint8_t RUNLOOP_GetCapacity (uint16_t* utilizationPtr,
+                             uint16_t* remainingPtr);
+#endif
+
+#if RUNLOOP_WITH_IDLE_TASKS
+uint8_t RUNLOOP_AddIdleTask (RUNLOOP_TaskCallbackT callbackPtr,
+                             void* callbackArgPtr,
+                             uint16_t sliceUs,
+                             uint8_t* taskIdPtr);
+#endif
+
 void RUNLOOP_Run (void);
 
 void RUNLOOP_Stop (void* optArgPtr);
 
+#if RUNLOOP_WITH_PHASE_STAGGERING
+uint8_t RUNLOOP_GetPeakLoad (uint8_t* peakTasksPtr);
+#endif
+
 #if RUNLOOP_WITH_UPTIME
 uint8_t RUNLOOP_GetUptimeClockCycles (uint64_t* systemClockCyclesPtr);
 
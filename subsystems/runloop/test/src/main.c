@@ -53,11 +53,17 @@ static uint8_t appToggleLedTask (void* optArgPtr);
 static uint8_t appPrintUptimeTask (void* optArgPtr);
 static uint8_t appActiveWaitingTask (void* optArgPtr);
 static uint8_t appSendCanMessageTask (void* optArgPtr);
+#if RUNLOOP_WITH_ADMISSION_CONTROL
+static uint8_t appNopTask (void* optArgPtr);
+#endif
 #if RUNLOOP_WITH_CMDL
 static void    appAddToggleLedTaskViaCmdl (uint8_t argc, char* argv[]);
 static void    appAddPrintUptimeTaskViaCmdl (uint8_t argc, char* argv[]);
 static void    appAddActiveWaitingTaskViaCmdl (uint8_t argc, char* argv[]);
 static void    appAddSendCanMessageTaskViaCmdl (uint8_t argc, char* argv[]);
+#if RUNLOOP_WITH_ADMISSION_CONTROL
+static void    appTestAdmissionViaCmdl (uint8_t argc, char* argv[]);
+#endif
 #else
 static void    appAddToggleLedTaskViaKey (void* optArgPtr);
 static void    appAddPrintUptimeTaskViaKey (void* optArgPtr);
@@ -178,6 +184,15 @@ static int8_t appInit (void)
         printf ("CMDL_RegisterCommand: %d\n", result);
         return result;
     }
+#if RUNLOOP_WITH_ADMISSION_CONTROL
+    result = CMDL_RegisterCommand(appTestAdmissionViaCmdl,
+                                  "admission");
+    if (result != CMDL_OK)
+    {
+        printf ("CMDL_RegisterCommand: %d\n", result);
+        return result;
+    }
+#endif
 #else
     // Register UART callback that adds a task to the runloop:
     memset(&uart_cb_opts, 0, sizeof(uart_cb_opts));
@@ -423,6 +438,19 @@ static uint8_t appSendCanMessageTask (void* optArgPtr)
     return (RUNLOOP_OK);
 }
 
+#if RUNLOOP_WITH_ADMISSION_CONTROL
+/*!
+*******************************************************************************
+** \brief   Task that does nothing. Its declared WCET loads the runloop.
+**
+*******************************************************************************
+*/
+static uint8_t appNopTask (void* optArgPtr)
+{
+    return (RUNLOOP_OK);
+}
+#endif
+
 #if RUNLOOP_WITH_CMDL
 /*!
 *******************************************************************************
@@ -603,6 +631,93 @@ static void appAddSendCanMessageTaskViaCmdl (uint8_t argc, char* argv[])
     return;
 }
 
+#if RUNLOOP_WITH_ADMISSION_CONTROL
+/*!
+*******************************************************************************
+** \brief   Callback for the CMDL which tests the admission control.
+**
+**          A periodic task that exceeds the remaining capacity must be
+**          rejected. Then, a periodic task exhausts the utilization bound
+**          with its declared WCET. Afterwards, a further periodic task with
+**          a WCET must be rejected, while a one-shot task and a periodic
+**          task without a WCET must still be accepted. All tasks expire
+**          after a few executions. Requires 3 free task slots.
+**
+** \param   argc    Not used.
+** \param   argv    Not used.
+**
+*******************************************************************************
+*/
+static void appTestAdmissionViaCmdl (uint8_t argc, char* argv[])
+{
+    uint8_t result = 0;
+    uint8_t failed = 0;
+    uint16_t utilization = 0;
+    uint16_t remaining = 0;
+
+    // Tasks that have already been executed contribute their measured
+    // utilization, so the capacity is taken from the runloop:
+    RUNLOOP_GetCapacity(&utilization, &remaining);
+    printf("Utilization: %u Remaining: %u\n", utilization, remaining);
+
+    // A WCET of n * 50 us over a 50 ms period is n permille. A periodic
+    // task exceeding the remaining capacity by 1 permille must be rejected:
+    result = RUNLOOP_AddTaskWithWcet(&appNopTask,
+                                     NULL,
+                                     4,   // number of executions
+                                     50,  // period in ms
+                                     0,   // initial delay in ms
+                                     (uint16_t)((remaining + 1) * 50U),
+                                     NULL);
+    if (result != (RUNLOOP_ERR_UTILIZATION_EXCEEDED))
+    {
+        printf("Periodic task exceeding the capacity: %d\n", result);
+        failed = 1;
+    }
+
+    // Exhaust the bound with the remaining capacity:
+    result = RUNLOOP_AddTaskWithWcet(&appNopTask,
+                                     NULL,
+                                     4,   // number of executions
+                                     50,  // period in ms
+                                     0,   // initial delay in ms
+                                     (uint16_t)(remaining * 50U),
+                                     NULL);
+    if (result != (RUNLOOP_OK))
+    {
+        printf("Error in RUNLOOP_AddTaskWithWcet(): %d\n", result);
+        return;
+    }
+
+    // Now, a periodic task with a WCET of 1 permille must be rejected:
+    result = RUNLOOP_AddTaskWithWcet(&appNopTask, NULL, 4, 50, 0, 50, NULL);
+    if (result != (RUNLOOP_ERR_UTILIZATION_EXCEEDED))
+    {
+        printf("Periodic task with WCET: %d\n", result);
+        failed = 1;
+    }
+
+    // A one-shot task must be admitted regardless of its WCET:
+    result = RUNLOOP_AddTaskWithWcet(&appNopTask, NULL, 1, 0, 0, 100, NULL);
+    if (result != (RUNLOOP_OK))
+    {
+        printf("One-shot task with WCET: %d\n", result);
+        failed = 1;
+    }
+
+    // A periodic task without a WCET must be admitted:
+    result = RUNLOOP_AddTask(&appNopTask, NULL, 4, 50, 0, NULL);
+    if (result != (RUNLOOP_OK))
+    {
+        printf("Periodic task without WCET: %d\n", result);
+        failed = 1;
+    }
+
+    printf("Admission test %s\n", failed ? "FAILED" : "PASSED");
+    return;
+}
+#endif // RUNLOOP_WITH_ADMISSION_CONTROL
+
 #else // RUNLOOP_WITH_CMDL
 
 /*!
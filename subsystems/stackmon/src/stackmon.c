@@ -0,0 +1,329 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   The stackmon subsystem monitors the stack low-water mark.
+**
+**          The free SRAM between the end of the .bss section and RAMEND is
+**          painted with #STACKMON_PAINT_PATTERN from within the .init1
+**          section, i.e., before the stack is used for the first time.
+**          The lowest address that has been touched by the stack can then
+**          be found by scanning upwards from the top of the heap until the
+**          first byte is found that differs from the paint pattern.
+**
+**          STACKMON_Update() performs this scan incrementally in chunks of
+**          #STACKMON_SCAN_CHUNK_SIZE bytes, so that it can be called from a
+**          runloop task without blocking other tasks. A scan pass never
+**          proceeds beyond the low-water mark that has already been found.
+**          STACKMON_Task() can directly be registered with RUNLOOP_AddTask()
+**          in order to execute the threshold callback as soon as the stack
+**          headroom drops below the configured threshold.
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <avr/io.h>
+#include "stackmon.h"
+
+//*****************************************************************************
+//*************************** DEFINES AND MACROS ******************************
+//*****************************************************************************
+
+//! Stringification helpers for the inline assembly of the paint loop.
+#define STACKMON_XSTR(x)        #x
+#define STACKMON_STR(x)         STACKMON_XSTR(x)
+
+//! Address of the first byte above the top of the SRAM.
+#define STACKMON_STACK_TOP_PTR  ((uint8_t*)(RAMEND + 1))
+
+//*****************************************************************************
+//**************************** LOCAL DATA TYPES *******************************
+//*****************************************************************************
+
+
+//*****************************************************************************
+//**************************** LOCAL VARIABLES ********************************
+//*****************************************************************************
+
+//! End of the .bss section, provided by the linker script.
+extern uint8_t _end;
+
+#if STACKMON_WITH_HEAP
+//! Current top of the heap, provided by avr-libc's malloc implementation.
+extern void* __brkval;
+#endif // STACKMON_WITH_HEAP
+
+//! Lowest address that has been found to be used by the stack so far.
+static uint8_t* stackmonLowWaterPtr = STACKMON_STACK_TOP_PTR;
+
+//! Position of the incremental scan, NULL if no scan pass is in progress.
+static uint8_t* stackmonScanPtr = NULL;
+
+//! Internal state of the stack monitor.
+static struct
+{
+    STACKMON_ThresholdCallbackT callbackPtr;    //!< threshold callback
+    void*                       callbackArgPtr; //!< optional callback argument
+    uint16_t                    threshold;      //!< headroom threshold in bytes
+    uint8_t                     tripped : 1;    //!< set when callback was executed
+} stackmonState;
+
+//*****************************************************************************
+//********************** LOCAL FUNCTION DECLARATIONS **************************
+//*****************************************************************************
+
+static void stackmonPaint (void) __attribute__ ((naked, used, section (".init1")));
+static inline uint8_t* stackmonGetHeapEnd (void);
+
+//*****************************************************************************
+//**************************** LOCAL FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   Paints the SRAM from the end of the .bss section up to RAMEND.
+**
+**          This function is placed in the .init1 section and is therefore
+**          executed by the startup code before the stack pointer is set up
+**          and before .data and .bss are initialized. It must not be called
+**          directly. Since __zero_reg__ is not yet cleared at this stage,
+**          the loop is written in assembly. Only basic assembly is used, as
+**          required for naked functions.
+**
+*******************************************************************************
+*/
+static void stackmonPaint (void)
+{
+    __asm__ __volatile__ (
+        "    ldi r30, lo8(_end)     \n"
+        "    ldi r31, hi8(_end)     \n"
+        "    ldi r24, " STACKMON_STR(STACKMON_PAINT_PATTERN) "\n"
+        "    ldi r25, hi8(" STACKMON_STR(RAMEND) ")\n"
+        "1:  st  Z+, r24            \n"
+        "    cpi r30, lo8(" STACKMON_STR(RAMEND) ")\n"
+        "    cpc r31, r25           \n"
+        "    brlo 1b                \n"
+        "    breq 1b                \n");
+}
+
+/*!
+*******************************************************************************
+** \brief   Get the first address above the heap.
+**
+** \return  Pointer to the lowest address that may be used by the stack.
+**
+*******************************************************************************
+*/
+static inline uint8_t* stackmonGetHeapEnd (void)
+{
+#if STACKMON_WITH_HEAP
+    if (__brkval)
+    {
+        return ((uint8_t*)__brkval);
+    }
+#endif // STACKMON_WITH_HEAP
+    return (&_end);
+}
+
+//*****************************************************************************
+//*************************** PUBLIC FUNCTIONS ********************************
+//*****************************************************************************
+
+/*!
+*******************************************************************************
+** \brief   Initializes the stack monitor.
+**
+**          The SRAM is painted at startup independently of this function.
+**          Calling STACKMON_Init() again re-arms the threshold callback.
+**
+** \param   thresholdBytes
+**              If the minimum stack headroom drops below this number of
+**              bytes, the threshold callback will be executed by
+**              STACKMON_Task().
+** \param   thresholdCallback
+**              Callback that is executed once when the headroom drops
+**              below the threshold. May be NULL.
+** \param   optArgPtr
+**              Optional argument that is passed to the threshold callback.
+**
+** \return
+**          - #STACKMON_OK on success.
+**          - #STACKMON_ERR_BAD_PARAMETER if the threshold exceeds the SRAM.
+**
+*******************************************************************************
+*/
+uint8_t STACKMON_Init (uint16_t thresholdBytes,
+                       STACKMON_ThresholdCallbackT thresholdCallback,
+                       void* optArgPtr)
+{
+    if (thresholdBytes > (RAMEND - RAMSTART))
+    {
+        return (STACKMON_ERR_BAD_PARAMETER);
+    }
+    stackmonState.callbackPtr    = thresholdCallback;
+    stackmonState.callbackArgPtr = optArgPtr;
+    stackmonState.threshold      = thresholdBytes;
+    stackmonState.tripped        = 0;
+    return (STACKMON_OK);
+}
+
+/*!
+*******************************************************************************
+** \brief   Performs one step of the incremental low-water scan.
+**
+**          At most #STACKMON_SCAN_CHUNK_SIZE bytes are examined. A scan pass
+**          starts at the top of the heap and ends at the first byte which
+**          does not match the paint pattern or at the current low-water mark,
+**          whichever comes first.
+**
+** \return
+**          - 1 if a scan pass has been completed by this call.
+**          - 0 if the scan pass is still in progress.
+**
+*******************************************************************************
+*/
+uint8_t STACKMON_Update (void)
+{
+    uint8_t* heap_end_ptr;
+    uint8_t  count = STACKMON_SCAN_CHUNK_SIZE;
+
+    heap_end_ptr = stackmonGetHeapEnd();
+    if ((stackmonScanPtr == NULL) || (stackmonScanPtr < heap_end_ptr))
+    {
+        stackmonScanPtr = heap_end_ptr;
+    }
+    while (count--)
+    {
+        if ((stackmonScanPtr >= stackmonLowWaterPtr) ||
+            (*(volatile uint8_t*)stackmonScanPtr != STACKMON_PAINT_PATTERN))
+        {
+            if (stackmonScanPtr < stackmonLowWaterPtr)
+            {
+                stackmonLowWaterPtr = stackmonScanPtr;
+            }
+            stackmonScanPtr = NULL;
+            return (1);
+        }
+        stackmonScanPtr++;
+    }
+    return (0);
+}
+
+/*!
+*******************************************************************************
+** \brief   Performs a complete scan pass in a single call.
+**
+**          A scan pass which is currently in progress is restarted.
+**          The runtime of this function depends on the amount of free SRAM.
+**
+*******************************************************************************
+*/
+void STACKMON_Scan (void)
+{
+    stackmonScanPtr = NULL;
+    while (!STACKMON_Update());
+    return;
+}
+
+/*!
+*******************************************************************************
+** \brief   Get the maximum stack usage observed so far.
+**
+** \return  Peak stack size in bytes according to the last completed scan.
+**
+*******************************************************************************
+*/
+uint16_t STACKMON_GetStackUsage (void)
+{
+    return ((uint16_t)(STACKMON_STACK_TOP_PTR - stackmonLowWaterPtr));
+}
+
+/*!
+*******************************************************************************
+** \brief   Get the minimum headroom between heap and stack observed so far.
+**
+** \return  Number of bytes that have never been used by either heap or stack
+**          according to the last completed scan.
+**
+*******************************************************************************
+*/
+uint16_t STACKMON_GetMinHeadroom (void)
+{
+    uint8_t* heap_end_ptr;
+
+    heap_end_ptr = stackmonGetHeapEnd();
+    if (stackmonLowWaterPtr <= heap_end_ptr)
+    {
+        return (0);
+    }
+    return ((uint16_t)(stackmonLowWaterPtr - heap_end_ptr));
+}
+
+/*!
+*******************************************************************************
+** \brief   Get the current headroom between heap and stack.
+**
+** \return  Number of bytes between the top of the heap and the current
+**          stack pointer.
+**
+*******************************************************************************
+*/
+uint16_t STACKMON_GetCurrentHeadroom (void)
+{
+    uint8_t* heap_end_ptr;
+    uint8_t* stack_ptr;
+
+    heap_end_ptr = stackmonGetHeapEnd();
+    stack_ptr    = (uint8_t*)SP;
+    if (stack_ptr <= heap_end_ptr)
+    {
+        return (0);
+    }
+    return ((uint16_t)(stack_ptr - heap_end_ptr));
+}
+
+/*!
+*******************************************************************************
+** \brief   Runloop task that updates the low-water mark and checks the
+**          threshold.
+**
+**          The function complies with RUNLOOP_TaskCallbackT and can be passed
+**          to RUNLOOP_AddTask(). Each invocation performs one incremental
+**          scan step. Whenever a scan pass has been completed, the minimum
+**          headroom is compared to the threshold. The threshold callback
+**          is executed at most once until STACKMON_Init() is called again.
+**
+** \param   optArgPtr
+**              Unused.
+**
+** \return
+**          - #STACKMON_OK (equals RUNLOOP_OK), so that the task keeps running.
+**
+*******************************************************************************
+*/
+uint8_t STACKMON_Task (void* optArgPtr)
+{
+    uint16_t headroom;
+
+    (void)optArgPtr;
+    if (STACKMON_Update() &&
+        stackmonState.callbackPtr &&
+        !stackmonState.tripped)
+    {
+        headroom = STACKMON_GetMinHeadroom();
+        if (headroom < stackmonState.threshold)
+        {
+            stackmonState.tripped = 1;
+            stackmonState.callbackPtr(stackmonState.callbackArgPtr, headroom);
+        }
+    }
+    return (STACKMON_OK);
+}
@@ -0,0 +1,85 @@
+/*!
+*******************************************************************************
+*******************************************************************************
+** \brief   The stackmon subsystem keeps track of the stack low-water mark and
+**          reports the remaining SRAM headroom between heap and stack.
+**
+** \author  agent
+**
+** Copyright (C) 2026 agent
+**
+** This file is part of AVR3nk, available at https://github.com/r3nk/AVR3nk
+**
+*******************************************************************************
+*******************************************************************************
+*/
+
+#ifndef STACKMON_H
+#define STACKMON_H
+
+#include <stdint.h>
+
+//*****************************************************************************
+//*************************** DEFINES AND MACROS ******************************
+//*****************************************************************************
+
+/*! Byte pattern that is painted into the free SRAM at startup. Any byte
+**  between heap and stack that differs from this pattern is considered to
+**  have been used by the stack. */
+#ifndef STACKMON_PAINT_PATTERN
+#define STACKMON_PAINT_PATTERN              0xC5
+#endif
+
+/*! Maximum number of bytes that are examined by a single call of
+**  STACKMON_Update(). Keeps the runtime of the incremental scan bounded. */
+#ifndef STACKMON_SCAN_CHUNK_SIZE
+#define STACKMON_SCAN_CHUNK_SIZE            64
+#endif
+
+/*! Set to 1 if the application uses malloc(). The top of the heap is then
+**  taken from the allocator instead of the end of the .bss section. */
+#ifndef STACKMON_WITH_HEAP
+#define STACKMON_WITH_HEAP                  0
+#endif
+
+//*****************************************************************************
+//************************ STACKMON SPECIFIC ERROR CODES **********************
+//*****************************************************************************
+
+/*! STACKMON specific error base */
+#ifndef STACKMON_ERR_BASE
+#define STACKMON_ERR_BASE                   120
+#endif
+
+/*! STACKMON returns with no errors. */
+#define STACKMON_OK                         0
+
+/*! A bad parameter has been passed. */
+#define STACKMON_ERR_BAD_PARAMETER          STACKMON_ERR_BASE + 0
+
+
+//*****************************************************************************
+//******************************** DATA TYPES *********************************
+//*****************************************************************************
+
+/*! Signature of the callback that is executed when the stack headroom
+**  falls below the configured threshold. */
+typedef void (*STACKMON_ThresholdCallbackT) (void* optArgPtr,
+                                             uint16_t headroomBytes);
+
+
+//*****************************************************************************
+//************************* FUNCTION DECLARATIONS *****************************
+//*****************************************************************************
+
+uint8_t  STACKMON_Init (uint16_t thresholdBytes,
+                        STACKMON_ThresholdCallbackT thresholdCallback,
+                        void* optArgPtr);
+uint8_t  STACKMON_Update (void);
+void     STACKMON_Scan (void);
+uint16_t STACKMON_GetStackUsage (void);
+uint16_t STACKMON_GetMinHeadroom (void);
+uint16_t STACKMON_GetCurrentHeadroom (void);
+uint8_t  STACKMON_Task (void* optArgPtr);
+
+#endif // STACKMON_H